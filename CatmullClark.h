@@ -49,9 +49,6 @@ typedef struct {
     int32_t twinID;
     int32_t edgeID;
     int32_t vertexID;
-#ifndef CC_DISABLE_UV
-    int32_t uvID;
-#endif
 } cc_Halfedge_SemiRegular;
 
 // mesh data-structure
@@ -68,10 +65,38 @@ typedef struct {
     cc_VertexUv *uvs;
     cc_Halfedge *halfedges;
     cc_Crease *creases;
+    uint8_t *faceHoles;     // per-face hole flags (NULL if the mesh has no holes)
 } cc_Mesh;
 
+// loader options
+typedef enum {
+    CC_LOAD_NO_HOLES = 1,       // drop the hole flags of the faces (kept otherwise)
+    CC_LOAD_NO_VALIDATION = 2   // skip ccm_Validate (trusted files only)
+} cc_LoadFlag;
+
+// mesh validation checks
+typedef enum {
+    CC_VALIDATION_COUNTS,       // negative or inconsistent element counts
+    CC_VALIDATION_HALFEDGES,    // out-of-range face, edge, vertex, or uv IDs
+    CC_VALIDATION_NEXT_PREV,    // next and prev that are not inverses
+    CC_VALIDATION_TWINS,        // twins that are not symmetric or mirrored
+    CC_VALIDATION_FACES,        // invalid face mappings or face cycles
+    CC_VALIDATION_EDGES,        // invalid edge mappings or shared edge IDs
+    CC_VALIDATION_VERTICES,     // invalid vertex mappings or non-manifold vertices
+    CC_VALIDATION_CREASES,      // broken crease chains or invalid sharpness
+
+    CC_VALIDATION_CHECK_COUNT
+} cc_ValidationCheck;
+
+// mesh validation diagnostics
+typedef struct {
+    int32_t errorCounts[CC_VALIDATION_CHECK_COUNT];  // failures per check
+    int32_t elementIDs[CC_VALIDATION_CHECK_COUNT];   // smallest failing element (-1 if none)
+} cc_Validation;
+
 // ctor / dtor
 CCDEF cc_Mesh *ccm_Load(const char *filename);
+CCDEF cc_Mesh *ccm_LoadWithFlags(const char *filename, int32_t flags);
 CCDEF cc_Mesh *ccm_Create(int32_t vertexCount,
                           int32_t uvCount,
                           int32_t halfedgeCount,
@@ -82,6 +107,10 @@ CCDEF void ccm_Release(cc_Mesh *mesh);
 // export
 CCDEF bool ccm_Save(const cc_Mesh *mesh, const char *filename);
 
+// validation (O(n), the diagnostics are optional)
+CCDEF bool ccm_Validate(const cc_Mesh *mesh, cc_Validation *validation);
+CCDEF const char *ccm_ValidationCheckName(cc_ValidationCheck check);
+
 // count queries
 CCDEF int32_t ccm_FaceCount(const cc_Mesh *mesh);
 CCDEF int32_t ccm_EdgeCount(const cc_Mesh *mesh);
@@ -116,6 +145,7 @@ CCDEF int32_t ccm_CreasePrevID(const cc_Mesh *mesh, int32_t edgeID);
 CCDEF float ccm_CreaseSharpness(const cc_Mesh *mesh, int32_t edgeID);
 CCDEF cc_VertexPoint ccm_VertexPoint(const cc_Mesh *mesh, int32_t vertexID);
 CCDEF cc_VertexUv ccm_Uv(const cc_Mesh *mesh, int32_t uvID);
+CCDEF bool ccm_FaceIsHole(const cc_Mesh *mesh, int32_t faceID);
 CCDEF int32_t ccm_HalfedgeNextID_Quad(int32_t halfedgeID);
 CCDEF int32_t ccm_HalfedgePrevID_Quad(int32_t halfedgeID);
 CCDEF int32_t ccm_HalfedgeFaceID_Quad(int32_t halfedgeID);
@@ -130,21 +160,84 @@ CCDEF int32_t ccm_FaceToHalfedgeID_Quad(int32_t faceID);
 CCDEF int32_t ccm_NextVertexHalfedgeID(const cc_Mesh *mesh, int32_t halfedgeID);
 CCDEF int32_t ccm_PrevVertexHalfedgeID(const cc_Mesh *mesh, int32_t halfedgeID);
 
+// cage editing API
+
+// editor data-structure (edits the mesh in place)
+typedef struct {
+    cc_Mesh *mesh;
+    int32_t vertexCapacity;
+    int32_t uvCapacity;
+    int32_t halfedgeCapacity;
+    int32_t edgeCapacity;
+    int32_t faceCapacity;
+    int32_t *anchorIDs;     // halfedges whose one-ring needs updating
+    int32_t anchorCount;
+    int32_t anchorCapacity;
+} cc_MeshEditor;
+
+// ctor / dtor
+CCDEF cc_MeshEditor *cce_Create(cc_Mesh *mesh);
+CCDEF void cce_Release(cc_MeshEditor *editor);
+
+// local operators (O(1) in the size of the mesh)
+CCDEF int32_t cce_SplitEdge(cc_MeshEditor *editor, int32_t halfedgeID, float t);
+CCDEF int32_t cce_SplitFace(cc_MeshEditor *editor,
+                            int32_t halfedgeID1,
+                            int32_t halfedgeID2);
+CCDEF int32_t cce_InsertEdgeLoop(cc_MeshEditor *editor, int32_t halfedgeID, float t);
+CCDEF int32_t cce_ExtrudeFace(cc_MeshEditor *editor,
+                              int32_t faceID,
+                              cc_VertexPoint offset);
+CCDEF bool cce_DeleteFace(cc_MeshEditor *editor, int32_t faceID);
+CCDEF void cce_SetCreaseSharpness(cc_MeshEditor *editor,
+                                  int32_t edgeID,
+                                  float sharpness);
+CCDEF bool cce_SetFaceHole(cc_MeshEditor *editor, int32_t faceID, bool isHole);
+
+// halfedge reordering and memory trimming (O(n))
+CCDEF void cce_Compact(cc_MeshEditor *editor);
+
 // subdivision surface API
 
+// storage formats for the vertex points of the deepest subd levels
+typedef enum {
+    CC_VERTEX_FORMAT_FP32,      // 3x32-bit floats (default)
+    CC_VERTEX_FORMAT_FP16,      // 3x16-bit IEEE half floats
+    CC_VERTEX_FORMAT_UNORM16    // 3x16-bit unorms relative to a bounding box
+} cc_VertexFormat;
+
 // subd data-structure
 typedef struct {
     const cc_Mesh *cage;
     cc_VertexPoint *vertexPoints;
     cc_Halfedge_SemiRegular *halfedges;
     cc_Crease *creases;
+#ifndef CC_DISABLE_UV
+    cc_VertexUv *uvs;
+#endif
+    uint16_t *packedVertexPoints;
+    cc_VertexPoint packedBounds[2];
+    cc_VertexFormat packedFormat;
+    int32_t packedDepth;
     int32_t maxDepth;
+    void *mappedData;           // file mapping (NULL for heap-allocated subds)
+    int64_t mappedByteCount;
+    int32_t *valenceBuckets;    // cage vertices sorted by valence (built on first use)
 } cc_Subd;
 
 // ctor / dtor
 CCDEF cc_Subd *ccs_Create(const cc_Mesh *cage, int32_t maxDepth);
 CCDEF void ccs_Release(cc_Subd *subd);
 
+// file-backed ctors (the subd buffers are memory-mapped from a file)
+CCDEF cc_Subd *
+ccs_CreateMapped(const cc_Mesh *cage, int32_t maxDepth, const char *filename);
+CCDEF cc_Subd *ccs_OpenMapped(const cc_Mesh *cage, const char *filename);
+
+// change the depth of an existing subd (existing levels are kept as is)
+CCDEF bool ccs_Grow(cc_Subd *subd, int32_t maxDepth);
+CCDEF void ccs_Shrink(cc_Subd *subd, int32_t maxDepth);
+
 // subd queries
 CCDEF int32_t ccs_MaxDepth(const cc_Subd *subd);
 CCDEF int32_t ccs_VertexCount(const cc_Subd *subd);
@@ -178,6 +271,7 @@ CCDEF int32_t ccs_CreasePrevID      (const cc_Subd *subd, int32_t edgeID, int32_
 CCDEF float ccs_CreaseSharpness_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth);
 CCDEF float ccs_CreaseSharpness     (const cc_Subd *subd, int32_t edgeID, int32_t depth);
 CCDEF cc_VertexPoint ccs_VertexPoint(const cc_Subd *subd, int32_t vertexID, int32_t depth);
+CCDEF bool ccs_FaceIsHole(const cc_Subd *subd, int32_t faceID, int32_t depth);
 
 // halfedge remapping (O(1))
 CCDEF int32_t ccs_NextVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth);
@@ -205,12 +299,148 @@ CCDEF void ccs_RefineCreases(cc_Subd *subd);
 CCDEF void ccs_RefineVertexUvs(cc_Subd *subd);
 #endif
 
+// update a refined subd after editing the sharpness of a list of cage edges
+CCDEF void ccs_RefineCreaseList(cc_Subd *subd,
+                                const int32_t *edgeIDs,
+                                int32_t edgeCount);
+CCDEF void ccs_RefineVertexPointList_Gather(cc_Subd *subd,
+                                            const int32_t *edgeIDs,
+                                            int32_t edgeCount);
+
+// cage skinning methods
+typedef enum {
+    CC_SKIN_LINEAR,             // bones are 3x4 row-major matrices (12 floats)
+    CC_SKIN_DUAL_QUATERNION     // bones are unit dual quaternions (8 floats): the
+                                // real part (x, y, z, w), then the dual part (x, y, z, w)
+} cc_SkinMethod;
+
+// cage skinning data (per-vertex bone weights stored in compressed rows)
+typedef struct {
+    cc_SkinMethod method;
+    const int32_t *offsets;     // cage vertexCount + 1 entries
+    const int32_t *boneIDs;
+    const float *weights;
+    const float *bones;         // bone palette
+} cc_Skin;
+
+// (re-)compute catmull clark vertex points over a cage skinned on the fly
+CCDEF cc_VertexPoint ccm_SkinnedVertexPoint(const cc_Mesh *mesh,
+                                            const cc_Skin *skin,
+                                            int32_t vertexID);
+CCDEF void ccs_RefineVertexPoints_Skinned_Gather(cc_Subd *subd,
+                                                 const cc_Skin *skin);
+
+#ifndef CC_DISABLE_UV
+// displacement image sampled bilinearly at the UVs of the deepest subd level
+typedef struct {
+    const float *const *tiles;  // UDIM tiles (index = UDIM - 1001), NULL if empty
+    int32_t tileCount;
+    int32_t width, height;      // tile resolution (rows by increasing v)
+    int32_t channelCount;       // 1: along the normal, 3: object-space vector
+    float scale;
+} cc_Displacement;
+
+// (re-)compute catmull clark vertex points displaced at the deepest subd level
+CCDEF void ccs_RefineVertexPoints_Displaced_Gather(cc_Subd *subd,
+                                                   const cc_Displacement *displacement);
+#endif
+
 // (re-)compute catmull clark vertex points without semi-sharp creases
 CCDEF void ccs_Refine_NoCreases_Gather(cc_Subd *subd);
 CCDEF void ccs_Refine_NoCreases_Scatter(cc_Subd *subd);
 CCDEF void ccs_RefineVertexPoints_NoCreases_Gather(cc_Subd *subd);
 CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd);
 
+// reduced-precision vertex point storage for the levels [minDepth, maxDepth]
+CCDEF void ccs_PackVertexPoints(cc_Subd *subd,
+                                int32_t minDepth,
+                                cc_VertexFormat format);
+CCDEF void ccs_UnpackVertexPoints(cc_Subd *subd);
+CCDEF cc_VertexFormat ccs_VertexFormatAtDepth(const cc_Subd *subd, int32_t depth);
+
+// bulk data-access over an ID range [firstID, firstID + count) or an ID list
+CCDEF void ccs_GetVertexPoints(const cc_Subd *subd,
+                               int32_t depth,
+                               int32_t firstVertexID,
+                               int32_t vertexCount,
+                               cc_VertexPoint *vertexPoints);
+CCDEF void ccs_GetVertexPointList(const cc_Subd *subd,
+                                  int32_t depth,
+                                  const int32_t *vertexIDs,
+                                  int32_t vertexCount,
+                                  cc_VertexPoint *vertexPoints);
+#ifndef CC_DISABLE_UV
+CCDEF void ccs_GetHalfedgeVertexUvs(const cc_Subd *subd,
+                                    int32_t depth,
+                                    int32_t firstHalfedgeID,
+                                    int32_t halfedgeCount,
+                                    cc_VertexUv *vertexUvs);
+CCDEF void ccs_GetHalfedgeVertexUvList(const cc_Subd *subd,
+                                       int32_t depth,
+                                       const int32_t *halfedgeIDs,
+                                       int32_t halfedgeCount,
+                                       cc_VertexUv *vertexUvs);
+#endif
+CCDEF void ccs_GetFaceVertexIDs(const cc_Subd *subd,      // 4 IDs per face
+                                int32_t depth,
+                                int32_t firstFaceID,
+                                int32_t faceCount,
+                                int32_t *vertexIDs);
+CCDEF void ccs_GetFaceVertexIDList(const cc_Subd *subd,   // 4 IDs per face
+                                   int32_t depth,
+                                   const int32_t *faceIDs,
+                                   int32_t faceCount,
+                                   int32_t *vertexIDs);
+CCDEF void ccs_GetEdgeVertexIDs(const cc_Subd *subd,      // 2 IDs per edge
+                                int32_t depth,
+                                int32_t firstEdgeID,
+                                int32_t edgeCount,
+                                int32_t *vertexIDs);
+CCDEF void ccs_GetEdgeVertexIDList(const cc_Subd *subd,   // 2 IDs per edge
+                                   int32_t depth,
+                                   const int32_t *edgeIDs,
+                                   int32_t edgeCount,
+                                   int32_t *vertexIDs);
+
+#ifndef CC_DISABLE_UV
+// tangent frames that follow the UVs of a subd level (one per halfedge)
+CCDEF void ccs_ComputeHalfedgeTangents(const cc_Subd *subd,
+                                       int32_t depth,
+                                       cc_VertexPoint *tangents,
+                                       cc_VertexPoint *bitangents);
+#endif
+
+// standalone copy of a subd level (release with ccm_Release)
+CCDEF cc_Mesh *ccs_ExtractMesh(const cc_Subd *subd, int32_t depth);
+
+// blend-shape data-structure (cage deltas refined to a given subd depth)
+typedef struct {
+    const cc_Subd *subd;
+    int32_t depth;
+    int32_t shapeCount;
+    int32_t *offsets;           // shapeCount + 1 entries
+    int32_t *vertexIDs;         // subd vertex IDs at depth
+    cc_VertexPoint *deltas;
+} cc_BlendShapes;
+
+// ctor / dtor (the per-shape cage deltas are given in compressed rows)
+CCDEF cc_BlendShapes *ccb_Create(const cc_Subd *subd,
+                                 int32_t depth,
+                                 int32_t shapeCount,
+                                 const int32_t *offsets,
+                                 const int32_t *vertexIDs,
+                                 const cc_VertexPoint *deltas);
+CCDEF void ccb_Release(cc_BlendShapes *shapes);
+
+// queries
+CCDEF int32_t ccb_ShapeCount(const cc_BlendShapes *shapes);
+CCDEF int32_t ccb_DeltaCount(const cc_BlendShapes *shapes);
+
+// weighted blend of the refined deltas over the subd vertex points at depth
+CCDEF void ccb_Apply(const cc_BlendShapes *shapes,
+                     const float *weights,
+                     cc_VertexPoint *vertexPoints);
+
 
 #ifdef __cplusplus
 } // extern "C"
@@ -238,6 +468,7 @@ CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd);
 #    include <stdlib.h>
 #    define CC_MALLOC(x) (malloc(x))
 #    define CC_FREE(x) (free(x))
+#    define CC_REALLOC(x, size) (realloc(x, size))
 #else
 #    ifndef CC_FREE
 #        error CC_MALLOC defined without CC_FREE
@@ -254,6 +485,41 @@ CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd);
 #    define CC_MEMSET(ptr, value, num) memset(ptr, value, num)
 #endif
 
+#ifndef CC_SQRTF
+#    include <math.h>
+#    define CC_SQRTF(x) sqrtf(x)
+#endif
+
+#ifndef CC_PREFETCH
+#   if defined(__GNUC__) || defined(__clang__)
+#       define CC_PREFETCH(ptr) __builtin_prefetch(ptr)
+#   else
+#       define CC_PREFETCH(ptr)
+#   endif
+#endif
+
+#if defined(_MSC_VER)
+#   define CC__FORCE_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#   define CC__FORCE_INLINE inline __attribute__((always_inline))
+#else
+#   define CC__FORCE_INLINE inline
+#endif
+
+#if !defined(CC_DISABLE_MMAP) && (defined(__APPLE__) \
+    || (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L))
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   define CC__MMAP
+#endif
+
+#if defined(__F16C__) && !defined(CC_DISABLE_F16C)
+#   include <immintrin.h>
+#   define CC__F16C
+#endif
+
 #ifndef _OPENMP
 #   ifndef CC_ATOMIC
 #       define CC_ATOMIC
@@ -293,11 +559,36 @@ CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd);
  * Utility functions
  *
  */
+static int32_t cc__Min(int32_t a, int32_t b)
+{
+    return a < b ? a : b;
+}
+
 static int32_t cc__Max(int32_t a, int32_t b)
 {
     return a > b ? a : b;
 }
 
+static void *cc__Realloc(void *ptr, size_t oldByteCount, size_t newByteCount)
+{
+#ifdef CC_REALLOC
+    (void)oldByteCount;
+
+    return CC_REALLOC(ptr, newByteCount);
+#else
+    void *newPtr = CC_MALLOC(newByteCount);
+
+    if (newPtr != NULL) {
+        CC_MEMCPY(newPtr,
+                  ptr,
+                  oldByteCount < newByteCount ? oldByteCount : newByteCount);
+        CC_FREE(ptr);
+    }
+
+    return newPtr;
+#endif
+}
+
 static float cc__Minf(float x, float y)
 {
     return x < y ? x : y;
@@ -324,6 +615,96 @@ static float cc__Signf(float x)
     return 0.0f;
 }
 
+
+/*******************************************************************************
+ * Half-float conversion routines
+ *
+ * Scalar fallbacks follow the IEEE 754 binary16 format with round-to-nearest
+ * even, so that they match the results of the F16C instructions.
+ *
+ */
+static uint16_t cc__FloatToHalf(float x)
+{
+    union {float f; uint32_t u;} bits = {x};
+    const uint32_t sign = (bits.u >> 16) & 0x8000u;
+    const uint32_t absBits = bits.u & 0x7FFFFFFFu;
+
+    if (absBits >= 0x7F800000u) {
+        // Inf / NaN
+        return sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u);
+    } else if (absBits >= 0x477FF000u) {
+        // overflow (rounds to Inf)
+        return sign | 0x7C00u;
+    } else if (absBits < 0x38800000u) {
+        // subnormal or zero
+        union {uint32_t u; float f;} magic = {0x3F000000u}; // 0.5f
+        union {uint32_t u; float f;} tmp = {absBits};
+
+        tmp.f+= magic.f;
+
+        return sign | (uint16_t)(tmp.u - magic.u);
+    } else {
+        // normal
+        const uint32_t odd = (absBits >> 13) & 1u;
+        const uint32_t tmp = absBits + 0xC8000FFFu + odd; // rebias + round
+
+        return sign | (uint16_t)(tmp >> 13);
+    }
+}
+
+static float cc__HalfToFloat(uint16_t h)
+{
+    const uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    const uint32_t exponent = (h >> 10) & 0x1Fu;
+    const uint32_t mantissa = h & 0x3FFu;
+    union {uint32_t u; float f;} bits;
+
+    if (exponent == 0x1Fu) {
+        bits.u = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent == 0u) {
+        // subnormal or zero: mantissa * 2^-24
+        bits.f = (float)mantissa * (1.0f / 16777216.0f);
+        bits.u|= sign;
+    } else {
+        bits.u = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+
+    return bits.f;
+}
+
+static void cc__FloatToHalfBatch(uint16_t *out, const float *in, int32_t count)
+{
+    int32_t i = 0;
+
+#ifdef CC__F16C
+    for (; i + 8 <= count; i+= 8) {
+        const __m256 x = _mm256_loadu_ps(&in[i]);
+        const __m128i h = _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT);
+
+        _mm_storeu_si128((__m128i *)&out[i], h);
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = cc__FloatToHalf(in[i]);
+    }
+}
+
+static void cc__HalfToFloatBatch(float *out, const uint16_t *in, int32_t count)
+{
+    int32_t i = 0;
+
+#ifdef CC__F16C
+    for (; i + 8 <= count; i+= 8) {
+        const __m128i h = _mm_loadu_si128((const __m128i *)&in[i]);
+
+        _mm256_storeu_ps(&out[i], _mm256_cvtph_ps(h));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = cc__HalfToFloat(in[i]);
+    }
+}
+
 static void
 cc__Lerpfv(int32_t n, float *out, const float *x, const float *y, float u)
 {
@@ -367,31 +748,6 @@ static void cc__Add3f(float *out, const float *x, const float *y)
 }
 
 
-/*******************************************************************************
- * UV Encoding / Decoding routines
- *
- */
-static cc_VertexUv cc__DecodeUv(int32_t uvEncoded)
-{
-    const uint32_t tmp = (uint32_t)uvEncoded;
-    const cc_VertexUv uv = {
-        ((tmp >>  0) & 0xFFFF) / 65535.0f,
-        ((tmp >> 16) & 0xFFFF) / 65535.0f
-    };
-
-    return uv;
-}
-
-static int32_t cc__EncodeUv(const cc_VertexUv uv)
-{
-    const uint32_t u = uv.array[0] * 65535.0f;
-    const uint32_t v = uv.array[1] * 65535.0f;
-    const uint32_t tmp = ((u & 0xFFFFu) | ((v & 0xFFFFu) << 16));
-
-    return (int32_t)tmp;
-}
-
-
 /*******************************************************************************
  * FaceCount -- Returns the number of faces
  *
@@ -700,6 +1056,10 @@ CCDEF cc_VertexUv ccm_Uv(const cc_Mesh *mesh, int32_t uvID)
 {
     return mesh->uvs[uvID];
 }
+CCDEF bool ccm_FaceIsHole(const cc_Mesh *mesh, int32_t faceID)
+{
+    return mesh->faceHoles != NULL && mesh->faceHoles[faceID] != 0;
+}
 
 
 /*******************************************************************************
@@ -786,6 +1146,7 @@ ccm_Create(
     mesh->creases = (cc_Crease *)CC_MALLOC(creaseByteCount);
     mesh->vertexPoints = (cc_VertexPoint *)CC_MALLOC(vertexByteCount);
     mesh->uvs = (cc_VertexUv *)CC_MALLOC(uvByteCount);
+    mesh->faceHoles = NULL;
 
     return mesh;
 }
@@ -804,2281 +1165,7270 @@ CCDEF void ccm_Release(cc_Mesh *mesh)
     CC_FREE(mesh->creases);
     CC_FREE(mesh->vertexPoints);
     CC_FREE(mesh->uvs);
+    CC_FREE(mesh->faceHoles);
     CC_FREE(mesh);
 }
 
 
 /*******************************************************************************
- * FaceCountAtDepth -- Returns the accumulated number of faces up to a given subdivision depth
+ * Cage editing
+ *
+ * The editor modifies a cc_Mesh in place with local operators. Each operator
+ * only visits the faces it modifies and the one-rings of their vertices, and
+ * leaves a mesh that satisfies the same invariants as the output of
+ * obj_to_ccm:
+ * - edgeToHalfedgeIDs maps each edge to the largest of its two halfedge IDs,
+ * - vertexToHalfedgeIDs maps each vertex to the last halfedge of its one-ring
+ *   in forward order if the vertex lies on a boundary, and to the largest
+ *   halfedge ID of its one-ring otherwise,
+ * - crease neighbors are those of mb_ComputeCreaseNeighbors, and boundary
+ *   edges have a sharpness of 16.
+ * New elements are appended to the arrays of the mesh, which grow
+ * geometrically; deleted elements are swapped with the last element of
+ * their array so that the arrays stay dense. The mesh can thus be passed to
+ * ccs_Create after any edit, and a subd created before an edit must be
+ * recreated. Vertex points may be modified directly through the mesh.
+ *
+ * The mesh must have been allocated with CC_MALLOC (e.g., by ccm_Load or
+ * ccm_Create) and its UVs, if any, are shared by the new halfedges: UVs are
+ * interpolated when edges are split and reused otherwise.
  *
  */
-CCDEF int32_t ccs_CumulativeFaceCountAtDepth(const cc_Mesh *cage, int32_t depth)
+static int32_t cce__Capacity(int32_t capacity, int32_t minCapacity)
 {
-    return ccs_CumulativeHalfedgeCountAtDepth(cage, depth) >> 2;
+    return cc__Max(minCapacity, capacity + (capacity >> 1));
 }
 
-CCDEF int32_t ccs_CumulativeFaceCount(const cc_Subd *subd)
-{
-    return ccs_CumulativeFaceCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+static void *
+cce__Resize(
+    void *buffer,
+    size_t elementByteSize,
+    int32_t count,
+    int32_t capacity
+) {
+    return cc__Realloc(buffer, elementByteSize * count, elementByteSize * capacity);
+}
+
+static bool
+cce__Reserve(
+    cc_MeshEditor *editor,
+    int32_t vertexCount,
+    int32_t uvCount,
+    int32_t halfedgeCount,
+    int32_t edgeCount,
+    int32_t faceCount
+) {
+    cc_Mesh *mesh = editor->mesh;
+    bool success = true;
+
+    vertexCount+= ccm_VertexCount(mesh);
+    uvCount+= ccm_UvCount(mesh);
+    halfedgeCount+= ccm_HalfedgeCount(mesh);
+    edgeCount+= ccm_EdgeCount(mesh);
+    faceCount+= ccm_FaceCount(mesh);
+
+    if (vertexCount > editor->vertexCapacity) {
+        const int32_t capacity = cce__Capacity(editor->vertexCapacity, vertexCount);
+        cc_VertexPoint *vertexPoints = (cc_VertexPoint *)
+                cce__Resize(mesh->vertexPoints,
+                            sizeof(cc_VertexPoint),
+                            ccm_VertexCount(mesh),
+                            capacity);
+        int32_t *vertexToHalfedgeIDs = (int32_t *)
+                cce__Resize(mesh->vertexToHalfedgeIDs,
+                            sizeof(int32_t),
+                            ccm_VertexCount(mesh),
+                            capacity);
+
+        if (vertexPoints != NULL) {
+            mesh->vertexPoints = vertexPoints;
+        }
+        if (vertexToHalfedgeIDs != NULL) {
+            mesh->vertexToHalfedgeIDs = vertexToHalfedgeIDs;
+        }
+        if (vertexPoints != NULL && vertexToHalfedgeIDs != NULL) {
+            editor->vertexCapacity = capacity;
+        } else {
+            success = false;
+        }
+    }
+
+    if (uvCount > editor->uvCapacity) {
+        const int32_t capacity = cce__Capacity(editor->uvCapacity, uvCount);
+        cc_VertexUv *uvs = (cc_VertexUv *)
+                cce__Resize(mesh->uvs,
+                            sizeof(cc_VertexUv),
+                            ccm_UvCount(mesh),
+                            capacity);
+
+        if (uvs != NULL) {
+            mesh->uvs = uvs;
+            editor->uvCapacity = capacity;
+        } else {
+            success = false;
+        }
+    }
+
+    if (halfedgeCount > editor->halfedgeCapacity) {
+        const int32_t capacity = cce__Capacity(editor->halfedgeCapacity, halfedgeCount);
+        cc_Halfedge *halfedges = (cc_Halfedge *)
+                cce__Resize(mesh->halfedges,
+                            sizeof(cc_Halfedge),
+                            ccm_HalfedgeCount(mesh),
+                            capacity);
+
+        if (halfedges != NULL) {
+            mesh->halfedges = halfedges;
+            editor->halfedgeCapacity = capacity;
+        } else {
+            success = false;
+        }
+    }
+
+    if (edgeCount > editor->edgeCapacity) {
+        const int32_t capacity = cce__Capacity(editor->edgeCapacity, edgeCount);
+        int32_t *edgeToHalfedgeIDs = (int32_t *)
+                cce__Resize(mesh->edgeToHalfedgeIDs,
+                            sizeof(int32_t),
+                            ccm_EdgeCount(mesh),
+                            capacity);
+        cc_Crease *creases = (cc_Crease *)
+                cce__Resize(mesh->creases,
+                            sizeof(cc_Crease),
+                            ccm_EdgeCount(mesh),
+                            capacity);
+
+        if (edgeToHalfedgeIDs != NULL) {
+            mesh->edgeToHalfedgeIDs = edgeToHalfedgeIDs;
+        }
+        if (creases != NULL) {
+            mesh->creases = creases;
+        }
+        if (edgeToHalfedgeIDs != NULL && creases != NULL) {
+            editor->edgeCapacity = capacity;
+        } else {
+            success = false;
+        }
+    }
+
+    if (faceCount > editor->faceCapacity) {
+        const int32_t capacity = cce__Capacity(editor->faceCapacity, faceCount);
+        int32_t *faceToHalfedgeIDs = (int32_t *)
+                cce__Resize(mesh->faceToHalfedgeIDs,
+                            sizeof(int32_t),
+                            ccm_FaceCount(mesh),
+                            capacity);
+
+        if (faceToHalfedgeIDs != NULL) {
+            mesh->faceToHalfedgeIDs = faceToHalfedgeIDs;
+        }
+        if (mesh->faceHoles != NULL) {
+            uint8_t *faceHoles = (uint8_t *)
+                    cce__Resize(mesh->faceHoles,
+                                sizeof(uint8_t),
+                                ccm_FaceCount(mesh),
+                                capacity);
+
+            if (faceHoles != NULL) {
+                mesh->faceHoles = faceHoles;
+            } else {
+                success = false;
+            }
+        }
+        if (faceToHalfedgeIDs != NULL && success) {
+            editor->faceCapacity = capacity;
+        } else {
+            success = false;
+        }
+    }
+
+    if (!success) {
+        CC_LOG("cc: editor allocation failed");
+    }
+
+    return success;
 }
 
 
 /*******************************************************************************
- * EdgeCountAtDepth -- Returns the accumulated number of edges up to a given subdivision depth
+ * Anchors -- Halfedges whose one-ring must be updated after an edit
+ *
+ * Operators record one outgoing halfedge per vertex they modify; the
+ * vertex, edge, and crease mappings are then recomputed over the one-rings
+ * of these vertices only.
  *
  */
-CCDEF int32_t ccs_CumulativeEdgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
+static void cce__PushAnchor(cc_MeshEditor *editor, int32_t halfedgeID)
+{
+    if (editor->anchorCount == editor->anchorCapacity) {
+        const int32_t capacity = cce__Capacity(editor->anchorCapacity, 16);
+        int32_t *anchorIDs = (int32_t *)
+                cce__Resize(editor->anchorIDs,
+                            sizeof(int32_t),
+                            editor->anchorCount,
+                            capacity);
+
+        CC_ASSERT(anchorIDs != NULL && "editor allocation failed");
+        editor->anchorIDs = anchorIDs;
+        editor->anchorCapacity = capacity;
+    }
+
+    editor->anchorIDs[editor->anchorCount++] = halfedgeID;
+}
+
+static void
+cce__RemapAnchors(cc_MeshEditor *editor, int32_t oldHalfedgeID, int32_t newHalfedgeID)
 {
-    CC_ASSERT(depth >= 0);
-    const int32_t H0 = ccm_HalfedgeCount(cage);
-    const int32_t E0 = ccm_EdgeCount(cage);
-    const int32_t H1 = H0 << 2;
-    const int32_t E1 = (E0 << 1) + H0;
-    const int32_t D = depth;
-    const int32_t A = ~(0xFFFFFFFF << D); //  2^{d} - 1
+    for (int32_t anchorID = 0; anchorID < editor->anchorCount; ++anchorID) {
+        if (editor->anchorIDs[anchorID] == oldHalfedgeID) {
+            editor->anchorIDs[anchorID] = newHalfedgeID;
+        }
+    }
+}
 
-    return (A * (6 * E1 + A * H1 - H1)) / 6;
+// returns the halfedge that obj_to_ccm maps to the origin vertex of halfedgeID
+static int32_t cce__VertexHalfedgeID(const cc_Mesh *mesh, int32_t halfedgeID)
+{
+    int32_t maxHalfedgeID = halfedgeID;
+    int32_t boundaryHalfedgeID = halfedgeID;
+    int32_t iterator;
+
+    for (iterator = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
+         iterator >= 0 && iterator != halfedgeID;
+         iterator = ccm_NextVertexHalfedgeID(mesh, iterator)) {
+        maxHalfedgeID = cc__Max(maxHalfedgeID, iterator);
+        boundaryHalfedgeID = iterator;
+    }
+
+    return iterator < 0 ? boundaryHalfedgeID : maxHalfedgeID;
 }
 
-CCDEF int32_t ccs_CumulativeEdgeCount(const cc_Subd *subd)
+static bool cce__IsInteriorVertex(const cc_Mesh *mesh, int32_t halfedgeID)
 {
-    return ccs_CumulativeEdgeCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+    int32_t iterator;
+
+    for (iterator = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
+         iterator >= 0 && iterator != halfedgeID;
+         iterator = ccm_NextVertexHalfedgeID(mesh, iterator));
+
+    return iterator == halfedgeID;
 }
 
+static void cce__UpdateEdgeHalfedge(cc_Mesh *mesh, int32_t halfedgeID)
+{
+    const int32_t edgeID = ccm_HalfedgeEdgeID(mesh, halfedgeID);
+    const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
 
-/*******************************************************************************
- * HalfedgeCount -- Returns the total number of halfedges stored by the subd
- *
- * The number of halfedges is multiplied by 4 at each subdivision step.
- * It follows that the number of half-edges is given by the formula
- *    H = H0 x sum_{d=0}^{D} 4^d
- *      = H0 (4^{D+1} - 1) / 3
- * where D denotes the maximum subdivision depth and H0 the number of
- * halfedges in the control mesh.
- *
- */
-CCDEF int32_t
-ccs_CumulativeHalfedgeCountAtDepth(const cc_Mesh *cage, int32_t maxDepth)
+    mesh->edgeToHalfedgeIDs[edgeID] = cc__Max(halfedgeID, twinID);
+}
+
+static void cce__UpdateCreaseNeighbors(cc_Mesh *mesh, int32_t edgeID)
 {
-    CC_ASSERT(maxDepth >= 0);
-    const int32_t D = maxDepth;
-    const int32_t H0 = ccm_HalfedgeCount(cage);
-    const int32_t H1 = H0 << 2;
-    const int32_t tmp = ~(0xFFFFFFFF << (D << 1)); // (4^D - 1)
+    const float sharpness = ccm_CreaseSharpness(mesh, edgeID);
 
-    return (H1 * tmp) / 3;
+    mesh->creases[edgeID].nextID = edgeID;
+    mesh->creases[edgeID].prevID = edgeID;
+
+    if (sharpness > 0.0f) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+        int32_t prevCreaseCount = 0;
+        int32_t prevCreaseID = -1;
+        int32_t nextCreaseCount = 0;
+        int32_t nextCreaseID = -1;
+        int32_t halfedgeIt;
+
+        for (halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
+             halfedgeIt != halfedgeID && halfedgeIt >= 0;
+             halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeIt)) {
+            const float s = ccm_HalfedgeSharpness(mesh, halfedgeIt);
+
+            if (s > 0.0f) {
+                prevCreaseID = ccm_HalfedgeEdgeID(mesh, halfedgeIt);
+                ++prevCreaseCount;
+            }
+        }
+
+        if (prevCreaseCount == 1 && halfedgeIt == halfedgeID) {
+            mesh->creases[edgeID].prevID = prevCreaseID;
+        }
+
+        if (ccm_HalfedgeSharpness(mesh, nextID) > 0.0f) {
+            nextCreaseID = ccm_HalfedgeEdgeID(mesh, nextID);
+            ++nextCreaseCount;
+        }
+
+        for (halfedgeIt = ccm_NextVertexHalfedgeID(mesh, nextID);
+             halfedgeIt != nextID && halfedgeIt >= 0;
+             halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeIt)) {
+            const float s = ccm_HalfedgeSharpness(mesh, halfedgeIt);
+            const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeIt);
+
+            // twin check is to avoid counting for halfedgeID
+            if (s > 0.0f && twinID != halfedgeID) {
+                nextCreaseID = ccm_HalfedgeEdgeID(mesh, halfedgeIt);
+                ++nextCreaseCount;
+            }
+        }
+
+        if (nextCreaseCount == 1 && halfedgeIt == nextID) {
+            mesh->creases[edgeID].nextID = nextCreaseID;
+        }
+    }
 }
 
-CCDEF int32_t ccs_CumulativeHalfedgeCount(const cc_Subd *subd)
+static void cce__UpdateAnchors(cc_MeshEditor *editor)
 {
-    return ccs_CumulativeHalfedgeCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+    cc_Mesh *mesh = editor->mesh;
+
+    // vertex and edge mappings
+    for (int32_t anchorID = 0; anchorID < editor->anchorCount; ++anchorID) {
+        const int32_t halfedgeID = editor->anchorIDs[anchorID];
+
+        if (halfedgeID >= 0) {
+            const int32_t vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
+            const int32_t vertexHalfedgeID = cce__VertexHalfedgeID(mesh, halfedgeID);
+            int32_t halfedgeIt = vertexHalfedgeID;
+
+            mesh->vertexToHalfedgeIDs[vertexID] = vertexHalfedgeID;
+
+            do {
+                cce__UpdateEdgeHalfedge(mesh, halfedgeIt);
+                cce__UpdateEdgeHalfedge(mesh, ccm_HalfedgePrevID(mesh, halfedgeIt));
+                halfedgeIt = ccm_PrevVertexHalfedgeID(mesh, halfedgeIt);
+            } while (halfedgeIt >= 0 && halfedgeIt != vertexHalfedgeID);
+        }
+    }
+
+    // crease neighbors (depend on the edge mappings)
+    for (int32_t anchorID = 0; anchorID < editor->anchorCount; ++anchorID) {
+        const int32_t halfedgeID = editor->anchorIDs[anchorID];
+
+        if (halfedgeID >= 0) {
+            const int32_t vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
+            const int32_t vertexHalfedgeID = ccm_VertexToHalfedgeID(mesh, vertexID);
+            int32_t halfedgeIt = vertexHalfedgeID;
+
+            do {
+                const int32_t prevID = ccm_HalfedgePrevID(mesh, halfedgeIt);
+
+                cce__UpdateCreaseNeighbors(mesh, ccm_HalfedgeEdgeID(mesh, halfedgeIt));
+                cce__UpdateCreaseNeighbors(mesh, ccm_HalfedgeEdgeID(mesh, prevID));
+                halfedgeIt = ccm_PrevVertexHalfedgeID(mesh, halfedgeIt);
+            } while (halfedgeIt >= 0 && halfedgeIt != vertexHalfedgeID);
+        }
+    }
+
+    editor->anchorCount = 0;
 }
 
 
 /*******************************************************************************
- * CreaseCount -- Returns the total number of creases stored by the subd
- *
- * The number of creases is multiplied by 2 at each subdivision step.
- * It follows that the number of half-edges is given by the formula
- *    C = C0 x sum_{d=0}^{D} 2^d
- *      = C0 (2^{D+1} - 1)
- * where D denotes the maximum subdivision depth and C0 the number of
- * creases in the control mesh.
+ * Create -- Creates an editor for a given mesh
  *
  */
-CCDEF int32_t
-ccs_CumulativeCreaseCountAtDepth(const cc_Mesh *cage, int32_t maxDepth)
+CCDEF cc_MeshEditor *cce_Create(cc_Mesh *mesh)
 {
-    CC_ASSERT(maxDepth >= 0);
-    const int32_t D = maxDepth;
-    const int32_t C0 = ccm_CreaseCount(cage);
-    const int32_t C1 = C0 << 1;
-    const int32_t tmp = ~(0xFFFFFFFF << D); // (2^D - 1)
+    cc_MeshEditor *editor = (cc_MeshEditor *)CC_MALLOC(sizeof(*editor));
 
-    return (C1 * tmp);
-}
+    editor->mesh = mesh;
+    editor->vertexCapacity = ccm_VertexCount(mesh);
+    editor->uvCapacity = ccm_UvCount(mesh);
+    editor->halfedgeCapacity = ccm_HalfedgeCount(mesh);
+    editor->edgeCapacity = ccm_EdgeCount(mesh);
+    editor->faceCapacity = ccm_FaceCount(mesh);
+    editor->anchorIDs = NULL;
+    editor->anchorCount = 0;
+    editor->anchorCapacity = 0;
 
-CCDEF int32_t ccs_CumulativeCreaseCount(const cc_Subd *subd)
-{
-    return ccs_CumulativeCreaseCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+    return editor;
 }
 
 
 /*******************************************************************************
- * CumulativeVertexCount -- Returns the total number of vertices computed by the subd
+ * Release -- Releases memory used for a given editor
  *
- * The number of vertices increases according to the following formula at
- * each subdivision step:
- *  Vd+1 = Fd + Ed + Vd
+ * The mesh is not released; its arrays may still hold spare capacity,
+ * which cce_Compact trims.
  *
  */
-CCDEF int32_t
-ccs_CumulativeVertexCountAtDepth(const cc_Mesh *cage, int32_t depth)
+CCDEF void cce_Release(cc_MeshEditor *editor)
 {
-    CC_ASSERT(depth >= 0);
-    const int32_t V0 = ccm_VertexCount(cage);
-    const int32_t F0 = ccm_FaceCount(cage);
-    const int32_t E0 = ccm_EdgeCount(cage);
-    const int32_t H0 = ccm_HalfedgeCount(cage);
-    const int32_t F1 = H0;
-    const int32_t E1 = 2 * E0 + H0;
-    const int32_t V1 = V0 + E0 + F0;
-    const int32_t D = depth;
-    const int32_t A =  ~(0xFFFFFFFF << (D     ));     //  2^{d} - 1
-    const int32_t B =  ~(0xFFFFFFFF << (D << 1)) / 3; // (4^{d} - 1) / 3
-
-    return A * (E1 - (F1 << 1)) + B * F1 + D * (F1 - E1 + V1);
-}
-
-CCDEF int32_t ccs_CumulativeVertexCount(const cc_Subd *subd)
-{
-    return ccs_CumulativeVertexCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+    CC_FREE(editor->anchorIDs);
+    CC_FREE(editor);
 }
 
 
 /*******************************************************************************
- * MaxDepth -- Retrieve the maximum subdivision depth of the subd
+ * SplitEdge -- Inserts a vertex on the edge of a halfedge
+ *
+ * The new vertex is placed at lerp(origin, tip, t) along the halfedge; the
+ * halfedge keeps its ID and now ends at the new vertex. Both halves of the
+ * edge inherit its sharpness. Returns the ID of the new vertex, or -1 if
+ * memory could not be allocated.
  *
  */
-CCDEF int32_t ccs_MaxDepth(const cc_Subd *subd)
+static int32_t cce__LerpUv(cc_Mesh *mesh, int32_t uvID1, int32_t uvID2, float t)
 {
-    return subd->maxDepth;
-}
+    if (ccm_UvCount(mesh) > 0 && uvID1 >= 0 && uvID2 >= 0) {
+        const cc_VertexUv uv1 = ccm_Uv(mesh, uvID1);
+        const cc_VertexUv uv2 = ccm_Uv(mesh, uvID2);
+        const int32_t uvID = mesh->uvCount++;
 
+        cc__Lerp2f(mesh->uvs[uvID].array, uv1.array, uv2.array, t);
 
-/*******************************************************************************
- * Create -- Create a subd
- *
- */
-CCDEF cc_Subd *ccs_Create(const cc_Mesh *cage, int32_t maxDepth)
+        return uvID;
+    }
+
+    return uvID1;
+}
+
+CCDEF int32_t cce_SplitEdge(cc_MeshEditor *editor, int32_t halfedgeID, float t)
 {
-    const int32_t halfedgeCount = ccs_CumulativeHalfedgeCountAtDepth(cage, maxDepth);
-    const int32_t creaseCount = ccs_CumulativeCreaseCountAtDepth(cage, maxDepth);
-    const int32_t vertexCount = ccs_CumulativeVertexCountAtDepth(cage, maxDepth);
-    const size_t halfedgeByteCount = halfedgeCount * sizeof(cc_Halfedge_SemiRegular);
-    const size_t creaseByteCount = creaseCount * sizeof(cc_Crease);
-    const size_t vertexPointByteCount = vertexCount * sizeof(cc_VertexPoint);
-    cc_Subd *subd = (cc_Subd *)CC_MALLOC(sizeof(*subd));
+    cc_Mesh *mesh = editor->mesh;
 
-    subd->maxDepth = maxDepth;
-    subd->halfedges = (cc_Halfedge_SemiRegular *)CC_MALLOC(halfedgeByteCount);
-    subd->creases = (cc_Crease *)CC_MALLOC(creaseByteCount);
-    subd->vertexPoints = (cc_VertexPoint *)CC_MALLOC(vertexPointByteCount);
-    subd->cage = cage;
+    if (!cce__Reserve(editor, 1, 2, 2, 1, 0)) {
+        return -1;
+    }
 
-    return subd;
-}
+    {
+        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+        const int32_t edgeID = ccm_HalfedgeEdgeID(mesh, halfedgeID);
+        const int32_t newVertexID = mesh->vertexCount++;
+        const int32_t newEdgeID = mesh->edgeCount++;
+        const int32_t newHalfedgeID = mesh->halfedgeCount++;
+        const cc_VertexPoint p1 = ccm_HalfedgeVertexPoint(mesh, halfedgeID);
+        const cc_VertexPoint p2 = ccm_HalfedgeVertexPoint(mesh, nextID);
+        cc_Halfedge *newHalfedge = &mesh->halfedges[newHalfedgeID];
+
+        cc__Lerp3f(mesh->vertexPoints[newVertexID].array, p1.array, p2.array, t);
+        mesh->vertexToHalfedgeIDs[newVertexID] = newHalfedgeID;
+
+        newHalfedge->twinID = twinID;
+        newHalfedge->nextID = nextID;
+        newHalfedge->prevID = halfedgeID;
+        newHalfedge->faceID = ccm_HalfedgeFaceID(mesh, halfedgeID);
+        newHalfedge->edgeID = newEdgeID;
+        newHalfedge->vertexID = newVertexID;
+        newHalfedge->uvID = cce__LerpUv(mesh,
+                                        ccm_HalfedgeUvID(mesh, halfedgeID),
+                                        ccm_HalfedgeUvID(mesh, nextID),
+                                        t);
+        mesh->halfedges[nextID].prevID = newHalfedgeID;
+        mesh->halfedges[halfedgeID].nextID = newHalfedgeID;
+
+        if (twinID >= 0) {
+            const int32_t twinNextID = ccm_HalfedgeNextID(mesh, twinID);
+            const int32_t newTwinID = mesh->halfedgeCount++;
+            cc_Halfedge *newTwin = &mesh->halfedges[newTwinID];
+
+            newTwin->twinID = halfedgeID;
+            newTwin->nextID = twinNextID;
+            newTwin->prevID = twinID;
+            newTwin->faceID = ccm_HalfedgeFaceID(mesh, twinID);
+            newTwin->edgeID = edgeID;
+            newTwin->vertexID = newVertexID;
+            newTwin->uvID = cce__LerpUv(mesh,
+                                        ccm_HalfedgeUvID(mesh, twinID),
+                                        ccm_HalfedgeUvID(mesh, twinNextID),
+                                        1.0f - t);
+            mesh->halfedges[twinNextID].prevID = newTwinID;
+            mesh->halfedges[twinID].nextID = newTwinID;
+            mesh->halfedges[twinID].twinID = newHalfedgeID;
+            mesh->halfedges[twinID].edgeID = newEdgeID;
+            mesh->halfedges[halfedgeID].twinID = newTwinID;
+        }
 
+        mesh->creases[newEdgeID].nextID = newEdgeID;
+        mesh->creases[newEdgeID].prevID = newEdgeID;
+        mesh->creases[newEdgeID].sharpness = ccm_CreaseSharpness(mesh, edgeID);
 
-/*******************************************************************************
- * Release -- Releases memory used for a given subd
- *
- */
-CCDEF void ccs_Release(cc_Subd *subd)
-{
-    CC_FREE(subd->halfedges);
-    CC_FREE(subd->creases);
-    CC_FREE(subd->vertexPoints);
-    CC_FREE(subd);
+        cce__PushAnchor(editor, newHalfedgeID);
+        cce__PushAnchor(editor, halfedgeID);
+        cce__PushAnchor(editor, nextID);
+        cce__UpdateAnchors(editor);
+
+        return newVertexID;
+    }
 }
 
 
 /*******************************************************************************
- * Crease data accessors
+ * SplitFace -- Splits a face along the diagonal joining two of its vertices
  *
- * These accessors are hidden from the user because not all edges within
- * the subd map to a crease. In particular: any edge create within a face
- * does not have an associated crease. This is because such edges will never
- * be sharp by construction.
+ * The diagonal joins the origins of the two halfedges, which must belong to
+ * the same face and must not be consecutive. The face keeps its ID for the
+ * part that contains halfedgeID1. Returns the ID of the new face, or -1 if
+ * the split is invalid or memory could not be allocated.
  *
  */
-static const cc_Crease *
-ccs__Crease(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+CCDEF int32_t
+cce_SplitFace(cc_MeshEditor *editor, int32_t halfedgeID1, int32_t halfedgeID2)
 {
-    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
-    const int32_t stride = ccs_CumulativeCreaseCountAtDepth(subd->cage,
-                                                            depth - 1);
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t faceID = ccm_HalfedgeFaceID(mesh, halfedgeID1);
 
-    return &subd->creases[stride + edgeID];
-}
+    if (ccm_HalfedgeFaceID(mesh, halfedgeID2) != faceID
+        || halfedgeID1 == halfedgeID2
+        || ccm_HalfedgeNextID(mesh, halfedgeID1) == halfedgeID2
+        || ccm_HalfedgeNextID(mesh, halfedgeID2) == halfedgeID1) {
+        return -1;
+    }
 
-CCDEF float
-ccs_CreaseSharpness_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
-{
-    return ccs__Crease(subd, edgeID, depth)->sharpness;
-}
+    if (!cce__Reserve(editor, 0, 0, 2, 1, 1)) {
+        return -1;
+    }
 
-CCDEF float
-ccs_CreaseSharpness(const cc_Subd *subd, int32_t edgeID, int32_t depth)
-{
-    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+    {
+        const int32_t prevID1 = ccm_HalfedgePrevID(mesh, halfedgeID1);
+        const int32_t prevID2 = ccm_HalfedgePrevID(mesh, halfedgeID2);
+        const int32_t newFaceID = mesh->faceCount++;
+        const int32_t newEdgeID = mesh->edgeCount++;
+        const int32_t newHalfedgeID1 = mesh->halfedgeCount++; // in the new face
+        const int32_t newHalfedgeID2 = mesh->halfedgeCount++;
+        cc_Halfedge *newHalfedge1 = &mesh->halfedges[newHalfedgeID1];
+        cc_Halfedge *newHalfedge2 = &mesh->halfedges[newHalfedgeID2];
+
+        newHalfedge1->twinID = newHalfedgeID2;
+        newHalfedge1->nextID = halfedgeID2;
+        newHalfedge1->prevID = prevID1;
+        newHalfedge1->faceID = newFaceID;
+        newHalfedge1->edgeID = newEdgeID;
+        newHalfedge1->vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID1);
+        newHalfedge1->uvID = ccm_HalfedgeUvID(mesh, halfedgeID1);
+
+        newHalfedge2->twinID = newHalfedgeID1;
+        newHalfedge2->nextID = halfedgeID1;
+        newHalfedge2->prevID = prevID2;
+        newHalfedge2->faceID = faceID;
+        newHalfedge2->edgeID = newEdgeID;
+        newHalfedge2->vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID2);
+        newHalfedge2->uvID = ccm_HalfedgeUvID(mesh, halfedgeID2);
+
+        mesh->halfedges[prevID1].nextID = newHalfedgeID1;
+        mesh->halfedges[halfedgeID2].prevID = newHalfedgeID1;
+        mesh->halfedges[prevID2].nextID = newHalfedgeID2;
+        mesh->halfedges[halfedgeID1].prevID = newHalfedgeID2;
+
+        for (int32_t halfedgeIt = halfedgeID2;
+                     halfedgeIt != newHalfedgeID1;
+                     halfedgeIt = ccm_HalfedgeNextID(mesh, halfedgeIt)) {
+            mesh->halfedges[halfedgeIt].faceID = newFaceID;
+        }
 
-    if (edgeID < creaseCount) {
-        return ccs_CreaseSharpness_Fast(subd, edgeID, depth);
-    } else {
-        return 0.0f;
+        mesh->faceToHalfedgeIDs[faceID] = halfedgeID1;
+        mesh->faceToHalfedgeIDs[newFaceID] = halfedgeID2;
+        if (mesh->faceHoles != NULL) {
+            mesh->faceHoles[newFaceID] = mesh->faceHoles[faceID];
+        }
+        mesh->creases[newEdgeID].nextID = newEdgeID;
+        mesh->creases[newEdgeID].prevID = newEdgeID;
+        mesh->creases[newEdgeID].sharpness = 0.0f;
+
+        cce__PushAnchor(editor, newHalfedgeID1);
+        cce__PushAnchor(editor, newHalfedgeID2);
+        cce__UpdateAnchors(editor);
+
+        return newFaceID;
     }
 }
 
-CCDEF int32_t
-ccs_CreaseNextID_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
-{
-    return ccs__Crease(subd, edgeID, depth)->nextID;
-}
 
-CCDEF int32_t
-ccs_CreaseNextID(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+/*******************************************************************************
+ * InsertEdgeLoop -- Splits the strip of quads that crosses a given edge
+ *
+ * The strip is followed across opposite edges of quads in both directions
+ * until it closes, reaches a boundary, a non-quad face, or a quad that it
+ * already crosses. Each crossed edge is split at parameter t (measured
+ * along halfedgeID and consistently across the strip) and each quad is
+ * split in two. Returns the number of quads that were split, or -1 if
+ * memory could not be allocated.
+ *
+ */
+static bool cce__IsQuad(const cc_Mesh *mesh, int32_t halfedgeID)
 {
-    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+    const int32_t nextID1 = ccm_HalfedgeNextID(mesh, halfedgeID);
+    const int32_t nextID2 = ccm_HalfedgeNextID(mesh, nextID1);
+    const int32_t nextID3 = ccm_HalfedgeNextID(mesh, nextID2);
 
-    if (edgeID < creaseCount) {
-        return ccs_CreaseNextID_Fast(subd, edgeID, depth);
-    } else {
-        return edgeID;
-    }
+    return nextID1 != halfedgeID
+        && nextID2 != halfedgeID
+        && nextID3 != halfedgeID
+        && ccm_HalfedgeNextID(mesh, nextID3) == halfedgeID;
 }
 
-CCDEF int32_t
-ccs_CreasePrevID_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+static int32_t cce__OppositeHalfedgeID(const cc_Mesh *mesh, int32_t halfedgeID)
 {
-    return ccs__Crease(subd, edgeID, depth)->prevID;
+    return ccm_HalfedgeNextID(mesh, ccm_HalfedgeNextID(mesh, halfedgeID));
 }
 
 CCDEF int32_t
-ccs_CreasePrevID(const cc_Subd *subd, int32_t edgeID, int32_t depth)
-{
-    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+cce_InsertEdgeLoop(cc_MeshEditor *editor, int32_t halfedgeID, float t)
+{
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t maxQuadCount = ccm_FaceCount(mesh);
+    int32_t *halfedgeIDs = NULL; // (in, out) halfedge pair of each quad
+    int32_t quadCount = 0;
+    int32_t capacity = 0;
+    int32_t firstID = halfedgeID;
+    int32_t startID;
+    bool isClosed;
+
+    if (!cce__IsQuad(mesh, firstID)) {
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, firstID);
+
+        if (twinID < 0 || !cce__IsQuad(mesh, twinID)) {
+            return 0;
+        }
 
-    if (edgeID < creaseCount) {
-        return ccs_CreasePrevID_Fast(subd, edgeID, depth);
-    } else {
-        return edgeID;
+        firstID = twinID;
+        t = 1.0f - t;
     }
-}
 
+    // walk back to the first quad of the strip
+    startID = firstID;
+    for (int32_t quadID = 0; quadID < maxQuadCount; ++quadID) {
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, startID);
+        int32_t prevID;
 
-/*******************************************************************************
- * Halfedge data accessors
- *
- */
-static const cc_Halfedge_SemiRegular *
-ccs__Halfedge(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
-    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(subd->cage,
-                                                              depth - 1);
+        if (twinID < 0 || !cce__IsQuad(mesh, twinID)) {
+            break;
+        }
 
-    return &subd->halfedges[stride + halfedgeID];
-}
+        prevID = cce__OppositeHalfedgeID(mesh, twinID);
 
-CCDEF int32_t
-ccs_HalfedgeVertexID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    return ccs__Halfedge(subd, halfedgeID, depth)->vertexID;
-}
+        if (prevID == firstID) {
+            break;
+        }
 
-CCDEF int32_t
-ccs_HalfedgeTwinID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    return ccs__Halfedge(subd, halfedgeID, depth)->twinID;
-}
+        startID = prevID;
+    }
 
-CCDEF int32_t
-ccs_HalfedgeNextID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    (void)subd;
-    (void)depth;
+    // walk forward and record the quads
+    for (int32_t halfedgeIt = startID; quadCount < maxQuadCount;) {
+        const int32_t faceID = ccm_HalfedgeFaceID(mesh, halfedgeIt);
+        const int32_t oppositeID = cce__OppositeHalfedgeID(mesh, halfedgeIt);
+        const int32_t nextID = ccm_HalfedgeTwinID(mesh, oppositeID);
+        bool isCrossed = false;
 
-    return ccm_HalfedgeNextID_Quad(halfedgeID);
-}
+        for (int32_t quadID = 0; quadID < quadCount && !isCrossed; ++quadID) {
+            isCrossed = ccm_HalfedgeFaceID(mesh, halfedgeIDs[2 * quadID]) == faceID;
+        }
 
-CCDEF int32_t
-ccs_HalfedgePrevID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    (void)subd;
-    (void)depth;
+        if (isCrossed) {
+            break;
+        }
 
-    return ccm_HalfedgePrevID_Quad(halfedgeID);
-}
+        if (quadCount == capacity) {
+            const int32_t newCapacity = cce__Capacity(capacity, 16);
+            int32_t *tmp = (int32_t *)cce__Resize(halfedgeIDs,
+                                                  2 * sizeof(int32_t),
+                                                  quadCount,
+                                                  newCapacity);
 
-CCDEF int32_t
-ccs_HalfedgeFaceID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    (void)subd;
-    (void)depth;
+            if (tmp == NULL) {
+                CC_LOG("cc: editor allocation failed");
+                CC_FREE(halfedgeIDs);
 
-    return ccm_HalfedgeFaceID_Quad(halfedgeID);
-}
+                return -1;
+            }
 
-CCDEF int32_t
-ccs_HalfedgeEdgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    return ccs__Halfedge(subd, halfedgeID, depth)->edgeID;
-}
+            halfedgeIDs = tmp;
+            capacity = newCapacity;
+        }
 
-CCDEF float
-ccs_HalfedgeSharpness(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+        halfedgeIDs[2 * quadCount + 0] = halfedgeIt;
+        halfedgeIDs[2 * quadCount + 1] = oppositeID;
+        ++quadCount;
 
-    return ccs_CreaseSharpness(subd, edgeID, depth);
-}
+        if (nextID < 0 || nextID == startID || !cce__IsQuad(mesh, nextID)) {
+            break;
+        }
 
-CCDEF cc_VertexPoint
-ccs_HalfedgeVertexPoint(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
+        halfedgeIt = nextID;
+    }
 
-    return ccs_VertexPoint(subd, vertexID, depth);
-}
+    // a closed strip shares its first and last crossed edges
+    isClosed = ccm_HalfedgeTwinID(mesh, halfedgeIDs[2 * quadCount - 1]) == startID;
 
-#ifndef CC_DISABLE_UV
-static uint32_t
-ccs__HalfedgeVertexUvID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    return ccs__Halfedge(subd, halfedgeID, depth)->uvID;
-}
+    // split the crossed edges, then the quads
+    {
+        bool success = cce_SplitEdge(editor, startID, t) >= 0;
 
-CCDEF cc_VertexUv
-ccs_HalfedgeVertexUv(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
-{
-    return cc__DecodeUv(ccs__HalfedgeVertexUvID(subd, halfedgeID, depth));
-}
-#endif
+        for (int32_t quadID = 0; quadID < quadCount && success; ++quadID) {
+            if (quadID < quadCount - 1 || !isClosed) {
+                const int32_t oppositeID = halfedgeIDs[2 * quadID + 1];
 
+                success = cce_SplitEdge(editor, oppositeID, 1.0f - t) >= 0;
+            }
+        }
 
-/*******************************************************************************
- * Vertex data accessors
- *
- */
-CCDEF cc_VertexPoint
-ccs_VertexPoint(const cc_Subd *subd, int32_t vertexID, int32_t depth)
-{
-    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(subd->cage, depth - 1);
+        for (int32_t quadID = 0; quadID < quadCount && success; ++quadID) {
+            const int32_t inID = halfedgeIDs[2 * quadID + 0];
+            const int32_t outID = halfedgeIDs[2 * quadID + 1];
+
+            success = cce_SplitFace(editor,
+                                    ccm_HalfedgeNextID(mesh, inID),
+                                    ccm_HalfedgeNextID(mesh, outID)) >= 0;
+        }
+
+        CC_FREE(halfedgeIDs);
 
-    return subd->vertexPoints[stride + vertexID];
+        return success ? quadCount : -1;
+    }
 }
 
 
 /*******************************************************************************
- * Vertex halfedge iteration
+ * ExtrudeFace -- Extrudes a face along a given offset
+ *
+ * The face is moved to a set of new vertices translated by the offset and
+ * keeps its ID; its former boundary is connected to it by a ring of new
+ * quads, which are stored contiguously. The new edges are smooth and the
+ * existing creases stay at the base of the extrusion. Returns the ID of the
+ * first new quad, or -1 if memory could not be allocated.
  *
  */
-CCDEF int32_t
-ccs_PrevVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+static int32_t cce__FaceHalfedgeCount(const cc_Mesh *mesh, int32_t faceID)
 {
-    const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
+    const int32_t firstID = ccm_FaceToHalfedgeID(mesh, faceID);
+    int32_t halfedgeIt = firstID;
+    int32_t halfedgeCount = 0;
 
-    return ccs_HalfedgeTwinID(subd, prevID, depth);
+    do {
+        ++halfedgeCount;
+        halfedgeIt = ccm_HalfedgeNextID(mesh, halfedgeIt);
+    } while (halfedgeIt != firstID);
+
+    return halfedgeCount;
 }
 
 CCDEF int32_t
-ccs_NextVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+cce_ExtrudeFace(cc_MeshEditor *editor, int32_t faceID, cc_VertexPoint offset)
 {
-    const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t firstID = ccm_FaceToHalfedgeID(mesh, faceID);
+    const int32_t n = cce__FaceHalfedgeCount(mesh, faceID);
 
-    return ccs_HalfedgeNextID(subd, twinID, depth);
-}
+    if (!cce__Reserve(editor, n, 0, 4 * n, 2 * n, n)) {
+        return -1;
+    }
 
+    {
+        const int32_t vertexCount = ccm_VertexCount(mesh);
+        const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+        const int32_t edgeCount = ccm_EdgeCount(mesh);
+        const int32_t faceCount = ccm_FaceCount(mesh);
+        int32_t halfedgeID = firstID;
+
+        // side quads (bottom, right, top, and left halfedges)
+        for (int32_t i = 0; i < n; ++i) {
+            const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+            const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+            const int32_t sideID = halfedgeCount + 4 * i;
+            const int32_t prevSideID = halfedgeCount + 4 * ((i + n - 1) % n);
+            const int32_t nextSideID = halfedgeCount + 4 * ((i + 1) % n);
+            const int32_t newFaceID = faceCount + i;
+            const int32_t newVertexID = vertexCount + i;
+            const cc_VertexPoint vertexPoint = ccm_HalfedgeVertexPoint(mesh, halfedgeID);
+            cc_Halfedge *side = &mesh->halfedges[sideID];
+
+            cc__Add3f(mesh->vertexPoints[newVertexID].array,
+                      vertexPoint.array,
+                      offset.array);
+            mesh->vertexToHalfedgeIDs[newVertexID] = halfedgeID;
+
+            side[0].twinID = twinID;
+            side[0].nextID = sideID + 1;
+            side[0].prevID = sideID + 3;
+            side[0].edgeID = ccm_HalfedgeEdgeID(mesh, halfedgeID);
+            side[0].vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
+            side[0].uvID = ccm_HalfedgeUvID(mesh, halfedgeID);
+
+            side[1].twinID = nextSideID + 3;
+            side[1].nextID = sideID + 2;
+            side[1].prevID = sideID + 0;
+            side[1].edgeID = edgeCount + n + i;
+            side[1].vertexID = ccm_HalfedgeVertexID(mesh, nextID);
+            side[1].uvID = ccm_HalfedgeUvID(mesh, nextID);
+
+            side[2].twinID = halfedgeID;
+            side[2].nextID = sideID + 3;
+            side[2].prevID = sideID + 1;
+            side[2].edgeID = edgeCount + i;
+            side[2].vertexID = vertexCount + (i + 1) % n;
+            side[2].uvID = ccm_HalfedgeUvID(mesh, nextID);
+
+            side[3].twinID = prevSideID + 1;
+            side[3].nextID = sideID + 0;
+            side[3].prevID = sideID + 2;
+            side[3].edgeID = edgeCount + n + (i + n - 1) % n;
+            side[3].vertexID = newVertexID;
+            side[3].uvID = ccm_HalfedgeUvID(mesh, halfedgeID);
+
+            for (int32_t j = 0; j < 4; ++j) {
+                side[j].faceID = newFaceID;
+            }
+
+            if (twinID >= 0) {
+                mesh->halfedges[twinID].twinID = sideID;
+            }
+
+            mesh->faceToHalfedgeIDs[newFaceID] = sideID;
+            if (mesh->faceHoles != NULL) {
+                mesh->faceHoles[newFaceID] = mesh->faceHoles[faceID];
+            }
+
+            for (int32_t j = 0; j < 2; ++j) {
+                const int32_t newEdgeID = edgeCount + j * n + i;
+
+                mesh->creases[newEdgeID].nextID = newEdgeID;
+                mesh->creases[newEdgeID].prevID = newEdgeID;
+                mesh->creases[newEdgeID].sharpness = 0.0f;
+            }
+
+            halfedgeID = nextID;
+        }
 
-/*******************************************************************************
- * Face to Halfedge Mapping
- *
- */
-CCDEF int32_t
-ccs_FaceToHalfedgeID(const cc_Subd *subd, int32_t faceID, int32_t depth)
-{
-    (void)subd;
-    (void)depth;
+        // extruded face
+        for (int32_t i = 0; i < n; ++i) {
+            cc_Halfedge *halfedge = &mesh->halfedges[halfedgeID];
 
-    return ccm_FaceToHalfedgeID_Quad(faceID);
+            halfedge->twinID = halfedgeCount + 4 * i + 2;
+            halfedge->edgeID = edgeCount + i;
+            halfedge->vertexID = vertexCount + i;
+
+            cce__PushAnchor(editor, halfedgeID);
+            cce__PushAnchor(editor, halfedgeCount + 4 * i);
+            halfedgeID = halfedge->nextID;
+        }
+
+        mesh->vertexCount+= n;
+        mesh->halfedgeCount+= 4 * n;
+        mesh->edgeCount+= 2 * n;
+        mesh->faceCount+= n;
+        cce__UpdateAnchors(editor);
+
+        return faceCount;
+    }
 }
 
 
 /*******************************************************************************
- * Edge to Halfedge Mapping
+ * DeleteFace -- Removes a face from the mesh
  *
- * This procedure returns one of the ID of one of the halfedge that constitutes
- * the edge. This routine has O(depth) complexity.
+ * Edges that are no longer shared become sharp boundary edges, and edges
+ * and vertices that no longer belong to any face are removed. Elements are
+ * removed by moving the last element of their array in their slot, so
+ * the IDs of at most one face, and of a few edges, halfedges, and vertices
+ * change. Returns false if the deletion would leave a non-manifold vertex,
+ * i.e., a boundary vertex shared by two fans of faces, or if memory could
+ * not be allocated.
  *
  */
-static int32_t ccs__EdgeToHalfedgeID_First(const cc_Mesh *cage, int32_t edgeID)
+static void cce__SortDescending(int32_t *ids, int32_t count)
 {
-    const int32_t edgeCount = ccm_EdgeCount(cage);
+    for (int32_t i = 1; i < count; ++i) {
+        const int32_t id = ids[i];
+        int32_t j = i;
 
-    if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
-        const int32_t halfedgeID = edgeID - 2 * edgeCount;
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        for (; j > 0 && ids[j - 1] < id; --j) {
+            ids[j] = ids[j - 1];
+        }
 
-        return cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
+        ids[j] = id;
+    }
+}
 
-    } else if /* */ ((edgeID & 1) == 1) {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID >> 1);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+static void cce__RemoveHalfedge(cc_MeshEditor *editor, int32_t halfedgeID)
+{
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t lastID = --mesh->halfedgeCount;
 
-        return 4 * nextID + 3;
+    cce__RemapAnchors(editor, halfedgeID, -1);
 
-    } else /* */ {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID >> 1);
+    if (halfedgeID != lastID) {
+        const cc_Halfedge halfedge = mesh->halfedges[lastID];
 
-        return 4 * halfedgeID + 0;
+        mesh->halfedges[halfedgeID] = halfedge;
+        mesh->halfedges[halfedge.nextID].prevID = halfedgeID;
+        mesh->halfedges[halfedge.prevID].nextID = halfedgeID;
+
+        if (halfedge.twinID >= 0) {
+            mesh->halfedges[halfedge.twinID].twinID = halfedgeID;
+        }
+        if (mesh->faceToHalfedgeIDs[halfedge.faceID] == lastID) {
+            mesh->faceToHalfedgeIDs[halfedge.faceID] = halfedgeID;
+        }
+        if (mesh->edgeToHalfedgeIDs[halfedge.edgeID] == lastID) {
+            mesh->edgeToHalfedgeIDs[halfedge.edgeID] = halfedgeID;
+        }
+        if (mesh->vertexToHalfedgeIDs[halfedge.vertexID] == lastID) {
+            mesh->vertexToHalfedgeIDs[halfedge.vertexID] = halfedgeID;
+        }
+
+        cce__RemapAnchors(editor, lastID, halfedgeID);
+        cce__PushAnchor(editor, halfedgeID);
     }
 }
 
-CCDEF int32_t
-ccs_EdgeToHalfedgeID(
-    const cc_Subd *subd,
-    int32_t edgeID,
-    int32_t depth
-) {
-#if 0 // recursive version
-    if (depth > 1) {
-        int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(subd->cage, depth - 1);
+static void cce__RemoveEdge(cc_MeshEditor *editor, int32_t edgeID)
+{
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t lastID = --mesh->edgeCount;
 
-        if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
-            int32_t halfedgeID = edgeID - 2 * edgeCount;
-            int32_t nextID = ccm_NextFaceHalfedgeID_Quad(halfedgeID);
+    if (edgeID != lastID) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, lastID);
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
 
-            return cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
+        mesh->edgeToHalfedgeIDs[edgeID] = halfedgeID;
+        mesh->creases[edgeID] = mesh->creases[lastID];
+        mesh->halfedges[halfedgeID].edgeID = edgeID;
 
-        } else if /* [E, 2E) */ (edgeID >= edgeCount) {
-            int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd,
-                                                      edgeID >> 1,
-                                                      depth - 1);
-            int32_t nextID = ccm_NextFaceHalfedgeID_Quad(halfedgeID);
+        if (twinID >= 0) {
+            mesh->halfedges[twinID].edgeID = edgeID;
+            cce__PushAnchor(editor, twinID);
+        } else {
+            cce__PushAnchor(editor, ccm_HalfedgeNextID(mesh, halfedgeID));
+        }
 
-            return 4 * nextID + 3;
+        cce__PushAnchor(editor, halfedgeID);
+    }
+}
 
-        } else /* [0, E) */ {
-            int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID >> 1, depth - 1);
+static void cce__RemoveFace(cc_MeshEditor *editor, int32_t faceID)
+{
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t lastID = --mesh->faceCount;
 
-            return 4 * halfedgeID + 0;
+    if (faceID != lastID) {
+        const int32_t firstID = ccm_FaceToHalfedgeID(mesh, lastID);
+        int32_t halfedgeIt = firstID;
+
+        mesh->faceToHalfedgeIDs[faceID] = firstID;
+        if (mesh->faceHoles != NULL) {
+            mesh->faceHoles[faceID] = mesh->faceHoles[lastID];
         }
-    } else {
-        return ccs__EdgeToHalfedgeID_First(subd->cage, edgeID);
+
+        do {
+            mesh->halfedges[halfedgeIt].faceID = faceID;
+            halfedgeIt = ccm_HalfedgeNextID(mesh, halfedgeIt);
+        } while (halfedgeIt != firstID);
     }
-#else // non-recursive version
-    uint32_t heap = 1u;
-    int32_t edgeHalfedgeID = 0;
-    int32_t heapDepth = depth;
+}
 
-    // build heap
-    for (; heapDepth > 1; --heapDepth) {
-        const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(subd->cage,
-                                                            heapDepth - 1);
+static void cce__RemoveVertex(cc_MeshEditor *editor, int32_t vertexID)
+{
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t lastID = --mesh->vertexCount;
 
-        if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
-            const int32_t halfedgeID = edgeID - 2 * edgeCount;
-            const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+    if (vertexID != lastID) {
+        const int32_t firstID = ccm_VertexToHalfedgeID(mesh, lastID);
+        int32_t halfedgeIt = firstID;
 
-            edgeHalfedgeID = cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
-            break;
-        } else {
-            heap = (heap << 1) | (edgeID & 1);
-            edgeID>>= 1;
-        }
-    }
+        mesh->vertexPoints[vertexID] = mesh->vertexPoints[lastID];
+        mesh->vertexToHalfedgeIDs[vertexID] = firstID;
 
-    // initialize root cfg
-    if (heapDepth == 1) {
-        edgeHalfedgeID = ccs__EdgeToHalfedgeID_First(subd->cage, edgeID);
+        do {
+            mesh->halfedges[halfedgeIt].vertexID = vertexID;
+            halfedgeIt = ccm_PrevVertexHalfedgeID(mesh, halfedgeIt);
+        } while (halfedgeIt >= 0 && halfedgeIt != firstID);
     }
+}
 
-    // read heap
-    while (heap > 1u) {
-        if ((heap & 1u) == 1u) {
-            const int32_t nextID = ccm_HalfedgeNextID_Quad(edgeHalfedgeID);
+CCDEF bool cce_DeleteFace(cc_MeshEditor *editor, int32_t faceID)
+{
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t firstID = ccm_FaceToHalfedgeID(mesh, faceID);
+    const int32_t n = cce__FaceHalfedgeCount(mesh, faceID);
+    int32_t *halfedgeIDs, *edgeIDs, *vertexIDs;
+    int32_t edgeCount = 0;
+    int32_t vertexCount = 0;
+    int32_t halfedgeID = firstID;
 
-            edgeHalfedgeID = 4 * nextID + 3;
-        } else {
-            edgeHalfedgeID = 4 * edgeHalfedgeID + 0;
+    for (int32_t i = 0; i < n; ++i) {
+        const int32_t prevID = ccm_HalfedgePrevID(mesh, halfedgeID);
+
+        if (ccm_HalfedgeTwinID(mesh, halfedgeID) >= 0
+            && ccm_HalfedgeTwinID(mesh, prevID) >= 0
+            && !cce__IsInteriorVertex(mesh, halfedgeID)) {
+            return false;
         }
 
-        heap>>= 1;
+        halfedgeID = ccm_HalfedgeNextID(mesh, halfedgeID);
     }
 
-    return edgeHalfedgeID;
-#endif
-}
+    halfedgeIDs = (int32_t *)CC_MALLOC(3 * sizeof(int32_t) * n);
 
+    if (halfedgeIDs == NULL) {
+        CC_LOG("cc: editor allocation failed");
 
-/*******************************************************************************
- * Vertex to Halfedge Mapping
- *
- * This procedure returns the ID of one of the halfedge that connects a
- * given vertex. This routine has O(depth) complexity.
- *
- */
-static int32_t
-ccs__VertexToHalfedgeID_First(const cc_Mesh *cage, int32_t vertexID)
-{
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
+        return false;
+    }
 
-    if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
-        const int32_t edgeID = vertexID - vertexCount - faceCount;
+    edgeIDs = &halfedgeIDs[n];
+    vertexIDs = &halfedgeIDs[2 * n];
 
-        return 4 * ccm_EdgeToHalfedgeID(cage, edgeID) + 1;
+    // detach the face from its neighbors
+    for (int32_t i = 0; i < n; ++i) {
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+        const int32_t prevID = ccm_HalfedgePrevID(mesh, halfedgeID);
+        const int32_t prevTwinID = ccm_HalfedgeTwinID(mesh, prevID);
+        const int32_t edgeID = ccm_HalfedgeEdgeID(mesh, halfedgeID);
 
-    } else if /* [V, V + F) */ (vertexID >= vertexCount) {
-        const int32_t faceID = vertexID - vertexCount;
+        halfedgeIDs[i] = halfedgeID;
 
-        return 4 * ccm_FaceToHalfedgeID(cage, faceID) + 2;
+        if (prevTwinID >= 0) {
+            cce__PushAnchor(editor, prevTwinID);
+        } else if (twinID >= 0) {
+            cce__PushAnchor(editor, ccm_HalfedgeNextID(mesh, twinID));
+        } else {
+            vertexIDs[vertexCount++] = ccm_HalfedgeVertexID(mesh, halfedgeID);
+        }
 
-    } else /* [0, V) */ {
+        if (twinID >= 0) {
+            mesh->halfedges[twinID].twinID = -1;
+            mesh->edgeToHalfedgeIDs[edgeID] = twinID;
+            mesh->creases[edgeID].sharpness = 16.0f;
+        } else {
+            edgeIDs[edgeCount++] = edgeID;
+        }
 
-        return 4 * ccm_VertexToHalfedgeID(cage, vertexID) + 0;
+        halfedgeID = ccm_HalfedgeNextID(mesh, halfedgeID);
     }
-}
 
-CCDEF int32_t
-ccs_VertexPointToHalfedgeID(const cc_Subd *subd, int32_t vertexID, int32_t depth)
-{
-#if 0 // recursive version
-    if (depth > 1) {
-        const cc_Mesh *cage = subd->cage;
-        const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth - 1);
-        const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth - 1);
+    // remove elements from the back so that removed slots are never reused
+    cce__SortDescending(halfedgeIDs, n);
+    cce__SortDescending(edgeIDs, edgeCount);
+    cce__SortDescending(vertexIDs, vertexCount);
 
-        if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
-            const int32_t edgeID = vertexID - vertexCount - faceCount;
+    for (int32_t i = 0; i < n; ++i) {
+        cce__RemoveHalfedge(editor, halfedgeIDs[i]);
+    }
 
-            return 4 * ccs_EdgeToHalfedgeID(subd, edgeID, depth - 1) + 1;
+    for (int32_t i = 0; i < edgeCount; ++i) {
+        cce__RemoveEdge(editor, edgeIDs[i]);
+    }
 
-        } else if /* [V, V + F) */ (vertexID >= vertexCount) {
-            const int32_t faceID = vertexID - vertexCount;
+    cce__RemoveFace(editor, faceID);
+    cce__UpdateAnchors(editor);
 
-            return 4 * ccm_FaceToHalfedgeID_Quad(faceID) + 2;
+    for (int32_t i = 0; i < vertexCount; ++i) {
+        cce__RemoveVertex(editor, vertexIDs[i]);
+    }
 
-        } else /* [0, V) */ {
+    CC_FREE(halfedgeIDs);
 
-            return 4 * ccs_VertexPointToHalfedgeID(subd, vertexID, depth - 1) + 0;
-        }
-    } else {
+    return true;
+}
 
-        return ccs__VertexToHalfedgeID_First(subd->cage, vertexID);
-    }
-#else // non-recursive version
-    const cc_Mesh *cage = subd->cage;
-    int32_t heapDepth = depth;
-    int32_t stride = 0;
-    int32_t halfedgeID;
 
-    // build heap
-    for (; heapDepth > 1; --heapDepth) {
-        const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, heapDepth - 1);
-        const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, heapDepth - 1);
+/*******************************************************************************
+ * SetCreaseSharpness -- Sets the sharpness of an edge
+ *
+ */
+CCDEF void
+cce_SetCreaseSharpness(cc_MeshEditor *editor, int32_t edgeID, float sharpness)
+{
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
 
-        if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
-            const int32_t edgeID = vertexID - faceCount - vertexCount;
+    mesh->creases[edgeID].sharpness = sharpness;
+    cce__PushAnchor(editor, halfedgeID);
+    cce__PushAnchor(editor, ccm_HalfedgeNextID(mesh, halfedgeID));
+    cce__UpdateAnchors(editor);
+}
 
-            halfedgeID = 4 * ccs_EdgeToHalfedgeID(subd, edgeID, heapDepth - 1) + 1;
-            break;
-        } else if /* [V, V + F) */ (vertexID >= vertexCount) {
-            const int32_t faceID = vertexID - vertexCount;
 
-            halfedgeID = 4 * ccm_FaceToHalfedgeID_Quad(faceID) + 2;
-            break;
-        } else /* [0, V) */ {
-            stride+= 2;
+/*******************************************************************************
+ * SetFaceHole -- Marks a face as a hole (or clears its hole flag)
+ *
+ * Hole faces keep their topology and still support the refinement of their
+ * neighbors, but their descendants are not computed by the gather refinement
+ * routines (see HoleTileFlags). The flags are allocated the first time a face
+ * is marked. Returns false if memory could not be allocated.
+ *
+ */
+CCDEF bool
+cce_SetFaceHole(cc_MeshEditor *editor, int32_t faceID, bool isHole)
+{
+    cc_Mesh *mesh = editor->mesh;
+
+    if (mesh->faceHoles == NULL) {
+        if (!isHole) {
+            return true;
         }
-    }
 
-    // initialize root cfg
-    if (heapDepth == 1) {
-        halfedgeID = ccs__VertexToHalfedgeID_First(subd->cage, vertexID);
+        mesh->faceHoles = (uint8_t *)CC_MALLOC(editor->faceCapacity);
+
+        if (mesh->faceHoles == NULL) {
+            CC_LOG("cc: editor allocation failed");
+
+            return false;
+        }
+
+        CC_MEMSET(mesh->faceHoles, 0, editor->faceCapacity);
     }
 
-    return halfedgeID << stride;
-#endif
+    mesh->faceHoles[faceID] = isHole ? 1 : 0;
+
+    return true;
 }
 
 
 /*******************************************************************************
- * CageFacePoints -- Applies Catmull Clark's face rule on the cage mesh
- *
- * The "Gather" routine iterates over each face of the mesh and compute the
- * resulting face vertex.
+ * Compact -- Reorders the halfedges of the mesh and trims its memory
  *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the face vertex.
+ * Edits scatter the halfedges of a face across the halfedge array. This
+ * routine stores the halfedges of each face contiguously, in face order,
+ * which restores memory locality (and the implicit layout of quad-only
+ * meshes, see ccm_HalfedgeNextID_Quad), removes unreferenced UVs, and
+ * shrinks the arrays of the mesh to their exact size.
  *
  */
-static void ccs__CageFacePoints_Gather(cc_Subd *subd)
+static void *cce__Trim(void *buffer, size_t elementByteSize, int32_t count)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    if (count > 0) {
+        void *newBuffer = cce__Resize(buffer, elementByteSize, count, count);
 
-CC_PARALLEL_FOR
-    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
-        const int32_t halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
-        cc_VertexPoint newFacePoint = ccm_HalfedgeVertexPoint(cage, halfedgeID);
-        float faceVertexCount = 1.0f;
+        if (newBuffer != NULL) {
+            return newBuffer;
+        }
+    }
 
-        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
-            const cc_VertexPoint vertexPoint = ccm_HalfedgeVertexPoint(cage, halfedgeIt);
+    return buffer;
+}
 
-            cc__Add3f(newFacePoint.array, newFacePoint.array, vertexPoint.array);
-            ++faceVertexCount;
+static void cce__CompactUvs(cc_Mesh *mesh)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t uvCount = ccm_UvCount(mesh);
+    int32_t *uvIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * uvCount);
+    int32_t newUvCount = 0;
+
+    if (uvIDs == NULL) {
+        return;
+    }
+
+    CC_MEMSET(uvIDs, 0xFF, sizeof(int32_t) * uvCount);
+
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t uvID = ccm_HalfedgeUvID(mesh, halfedgeID);
+
+        if (uvID >= 0) {
+            uvIDs[uvID] = 0;
+        }
+    }
+
+    for (int32_t uvID = 0; uvID < uvCount; ++uvID) {
+        if (uvIDs[uvID] == 0) {
+            mesh->uvs[newUvCount] = mesh->uvs[uvID];
+            uvIDs[uvID] = newUvCount++;
         }
+    }
 
-        cc__Mul3f(newFacePoint.array, newFacePoint.array, 1.0f / faceVertexCount);
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t uvID = ccm_HalfedgeUvID(mesh, halfedgeID);
 
-        newFacePoints[faceID] = newFacePoint;
+        if (uvID >= 0) {
+            mesh->halfedges[halfedgeID].uvID = uvIDs[uvID];
+        }
     }
 CC_BARRIER
+
+    mesh->uvCount = newUvCount;
+    CC_FREE(uvIDs);
 }
 
-static void ccs__CageFacePoints_Scatter(cc_Subd *subd)
+CCDEF void cce_Compact(cc_MeshEditor *editor)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    cc_Mesh *mesh = editor->mesh;
+    const int32_t vertexCount = ccm_VertexCount(mesh);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
+    const int32_t faceCount = ccm_FaceCount(mesh);
+    int32_t *halfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * halfedgeCount);
+    cc_Halfedge *halfedges =
+            (cc_Halfedge *)CC_MALLOC(sizeof(cc_Halfedge) * halfedgeCount);
+
+    if (halfedgeIDs == NULL || halfedges == NULL) {
+        CC_LOG("cc: editor allocation failed");
+        CC_FREE(halfedgeIDs);
+        CC_FREE(halfedges);
+
+        return;
+    }
+
+    // new halfedge IDs
+    for (int32_t faceID = 0, newHalfedgeID = 0; faceID < faceCount; ++faceID) {
+        const int32_t firstID = ccm_FaceToHalfedgeID(mesh, faceID);
+        int32_t halfedgeIt = firstID;
+
+        do {
+            halfedgeIDs[halfedgeIt] = newHalfedgeID++;
+            halfedgeIt = ccm_HalfedgeNextID(mesh, halfedgeIt);
+        } while (halfedgeIt != firstID);
+    }
 
 CC_PARALLEL_FOR
     for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const cc_VertexPoint vertexPoint = ccm_HalfedgeVertexPoint(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        float faceVertexCount = 1.0f;
-        float *newFacePoint = newFacePoints[faceID].array;
+        cc_Halfedge halfedge = mesh->halfedges[halfedgeID];
 
-        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
-            ++faceVertexCount;
+        if (halfedge.twinID >= 0) {
+            halfedge.twinID = halfedgeIDs[halfedge.twinID];
         }
+        halfedge.nextID = halfedgeIDs[halfedge.nextID];
+        halfedge.prevID = halfedgeIDs[halfedge.prevID];
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newFacePoint[i]+= vertexPoint.array[i] / (float)faceVertexCount;
-        }
+        halfedges[halfedgeIDs[halfedgeID]] = halfedge;
     }
 CC_BARRIER
-}
 
+    CC_FREE(mesh->halfedges);
+    mesh->halfedges = halfedges;
 
-/*******************************************************************************
- * CageEdgePoints -- Applies Catmull Clark's edge rule on the cage mesh
- *
- * The "Gather" routine iterates over each edge of the mesh and computes the
- * resulting edge vertex.
- *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the edge vertex.
- *
- */
-static void ccs__CageEdgePoints_Gather(cc_Subd *subd)
-{
+    // mappings
+CC_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        const int32_t halfedgeID = ccm_FaceToHalfedgeID(mesh, faceID);
+
+        mesh->faceToHalfedgeIDs[faceID] = halfedgeIDs[halfedgeID];
+    }
+CC_BARRIER
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+        const int32_t newHalfedgeID = halfedgeIDs[halfedgeID];
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, newHalfedgeID);
+
+        mesh->edgeToHalfedgeIDs[edgeID] = cc__Max(newHalfedgeID, twinID);
+    }
+CC_BARRIER
+
+CC_PARALLEL_FOR
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        const int32_t halfedgeID = ccm_VertexToHalfedgeID(mesh, vertexID);
+
+        mesh->vertexToHalfedgeIDs[vertexID] =
+                cce__VertexHalfedgeID(mesh, halfedgeIDs[halfedgeID]);
+    }
+CC_BARRIER
+
+    // edge orientations may have changed
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        cce__UpdateCreaseNeighbors(mesh, edgeID);
+    }
+CC_BARRIER
+
+    CC_FREE(halfedgeIDs);
+
+    if (ccm_UvCount(mesh) > 0) {
+        cce__CompactUvs(mesh);
+    }
+
+    // trim memory
+    mesh->vertexPoints = (cc_VertexPoint *)
+            cce__Trim(mesh->vertexPoints, sizeof(cc_VertexPoint), vertexCount);
+    mesh->vertexToHalfedgeIDs = (int32_t *)
+            cce__Trim(mesh->vertexToHalfedgeIDs, sizeof(int32_t), vertexCount);
+    mesh->uvs = (cc_VertexUv *)
+            cce__Trim(mesh->uvs, sizeof(cc_VertexUv), ccm_UvCount(mesh));
+    mesh->edgeToHalfedgeIDs = (int32_t *)
+            cce__Trim(mesh->edgeToHalfedgeIDs, sizeof(int32_t), edgeCount);
+    mesh->creases = (cc_Crease *)
+            cce__Trim(mesh->creases, sizeof(cc_Crease), edgeCount);
+    mesh->faceToHalfedgeIDs = (int32_t *)
+            cce__Trim(mesh->faceToHalfedgeIDs, sizeof(int32_t), faceCount);
+    if (mesh->faceHoles != NULL) {
+        mesh->faceHoles = (uint8_t *)
+                cce__Trim(mesh->faceHoles, sizeof(uint8_t), faceCount);
+    }
+    editor->vertexCapacity = vertexCount;
+    editor->uvCapacity = ccm_UvCount(mesh);
+    editor->halfedgeCapacity = halfedgeCount;
+    editor->edgeCapacity = edgeCount;
+    editor->faceCapacity = faceCount;
+}
+
+
+/*******************************************************************************
+ * FaceCountAtDepth -- Returns the accumulated number of faces up to a given subdivision depth
+ *
+ */
+CCDEF int32_t ccs_CumulativeFaceCountAtDepth(const cc_Mesh *cage, int32_t depth)
+{
+    return ccs_CumulativeHalfedgeCountAtDepth(cage, depth) >> 2;
+}
+
+CCDEF int32_t ccs_CumulativeFaceCount(const cc_Subd *subd)
+{
+    return ccs_CumulativeFaceCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+}
+
+
+/*******************************************************************************
+ * EdgeCountAtDepth -- Returns the accumulated number of edges up to a given subdivision depth
+ *
+ */
+CCDEF int32_t ccs_CumulativeEdgeCountAtDepth(const cc_Mesh *cage, int32_t depth)
+{
+    CC_ASSERT(depth >= 0);
+    const int32_t H0 = ccm_HalfedgeCount(cage);
+    const int32_t E0 = ccm_EdgeCount(cage);
+    const int32_t H1 = H0 << 2;
+    const int32_t E1 = (E0 << 1) + H0;
+    const int32_t D = depth;
+    const int32_t A = ~(0xFFFFFFFF << D); //  2^{d} - 1
+
+    return (A * (6 * E1 + A * H1 - H1)) / 6;
+}
+
+CCDEF int32_t ccs_CumulativeEdgeCount(const cc_Subd *subd)
+{
+    return ccs_CumulativeEdgeCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+}
+
+
+/*******************************************************************************
+ * HalfedgeCount -- Returns the total number of halfedges stored by the subd
+ *
+ * The number of halfedges is multiplied by 4 at each subdivision step.
+ * It follows that the number of half-edges is given by the formula
+ *    H = H0 x sum_{d=0}^{D} 4^d
+ *      = H0 (4^{D+1} - 1) / 3
+ * where D denotes the maximum subdivision depth and H0 the number of
+ * halfedges in the control mesh.
+ *
+ */
+CCDEF int32_t
+ccs_CumulativeHalfedgeCountAtDepth(const cc_Mesh *cage, int32_t maxDepth)
+{
+    CC_ASSERT(maxDepth >= 0);
+    const int32_t D = maxDepth;
+    const int32_t H0 = ccm_HalfedgeCount(cage);
+    const int32_t H1 = H0 << 2;
+    const int32_t tmp = ~(0xFFFFFFFF << (D << 1)); // (4^D - 1)
+
+    return (H1 * tmp) / 3;
+}
+
+CCDEF int32_t ccs_CumulativeHalfedgeCount(const cc_Subd *subd)
+{
+    return ccs_CumulativeHalfedgeCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+}
+
+
+/*******************************************************************************
+ * CreaseCount -- Returns the total number of creases stored by the subd
+ *
+ * The number of creases is multiplied by 2 at each subdivision step.
+ * It follows that the number of half-edges is given by the formula
+ *    C = C0 x sum_{d=0}^{D} 2^d
+ *      = C0 (2^{D+1} - 1)
+ * where D denotes the maximum subdivision depth and C0 the number of
+ * creases in the control mesh.
+ *
+ */
+CCDEF int32_t
+ccs_CumulativeCreaseCountAtDepth(const cc_Mesh *cage, int32_t maxDepth)
+{
+    CC_ASSERT(maxDepth >= 0);
+    const int32_t D = maxDepth;
+    const int32_t C0 = ccm_CreaseCount(cage);
+    const int32_t C1 = C0 << 1;
+    const int32_t tmp = ~(0xFFFFFFFF << D); // (2^D - 1)
+
+    return (C1 * tmp);
+}
+
+CCDEF int32_t ccs_CumulativeCreaseCount(const cc_Subd *subd)
+{
+    return ccs_CumulativeCreaseCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+}
+
+
+/*******************************************************************************
+ * CumulativeVertexCount -- Returns the total number of vertices computed by the subd
+ *
+ * The number of vertices increases according to the following formula at
+ * each subdivision step:
+ *  Vd+1 = Fd + Ed + Vd
+ *
+ */
+CCDEF int32_t
+ccs_CumulativeVertexCountAtDepth(const cc_Mesh *cage, int32_t depth)
+{
+    CC_ASSERT(depth >= 0);
+    const int32_t V0 = ccm_VertexCount(cage);
+    const int32_t F0 = ccm_FaceCount(cage);
+    const int32_t E0 = ccm_EdgeCount(cage);
+    const int32_t H0 = ccm_HalfedgeCount(cage);
+    const int32_t F1 = H0;
+    const int32_t E1 = 2 * E0 + H0;
+    const int32_t V1 = V0 + E0 + F0;
+    const int32_t D = depth;
+    const int32_t A =  ~(0xFFFFFFFF << (D     ));     //  2^{d} - 1
+    const int32_t B =  ~(0xFFFFFFFF << (D << 1)) / 3; // (4^{d} - 1) / 3
+
+    return A * (E1 - (F1 << 1)) + B * F1 + D * (F1 - E1 + V1);
+}
+
+CCDEF int32_t ccs_CumulativeVertexCount(const cc_Subd *subd)
+{
+    return ccs_CumulativeVertexCountAtDepth(subd->cage, ccs_MaxDepth(subd));
+}
+
+
+/*******************************************************************************
+ * MaxDepth -- Retrieve the maximum subdivision depth of the subd
+ *
+ */
+CCDEF int32_t ccs_MaxDepth(const cc_Subd *subd)
+{
+    return subd->maxDepth;
+}
+
+
+/*******************************************************************************
+ * Create -- Create a subd
+ *
+ * UVs are stored in a separate stream with one entry per halfedge, so that
+ * the topology kernels never load UV data. The stream is only allocated
+ * if the cage provides UVs; it is left to NULL otherwise.
+ *
+ */
+CCDEF cc_Subd *ccs_Create(const cc_Mesh *cage, int32_t maxDepth)
+{
+    const int32_t halfedgeCount = ccs_CumulativeHalfedgeCountAtDepth(cage, maxDepth);
+    const int32_t creaseCount = ccs_CumulativeCreaseCountAtDepth(cage, maxDepth);
+    const int32_t vertexCount = ccs_CumulativeVertexCountAtDepth(cage, maxDepth);
+    const size_t halfedgeByteCount = halfedgeCount * sizeof(cc_Halfedge_SemiRegular);
+    const size_t creaseByteCount = creaseCount * sizeof(cc_Crease);
+    const size_t vertexPointByteCount = vertexCount * sizeof(cc_VertexPoint);
+    cc_Subd *subd = (cc_Subd *)CC_MALLOC(sizeof(*subd));
+
+    subd->maxDepth = maxDepth;
+    subd->halfedges = (cc_Halfedge_SemiRegular *)CC_MALLOC(halfedgeByteCount);
+    subd->creases = (cc_Crease *)CC_MALLOC(creaseByteCount);
+    subd->vertexPoints = (cc_VertexPoint *)CC_MALLOC(vertexPointByteCount);
+    subd->packedVertexPoints = NULL;
+    subd->packedFormat = CC_VERTEX_FORMAT_FP32;
+    subd->packedDepth = maxDepth + 1;
+    subd->mappedData = NULL;
+    subd->mappedByteCount = 0;
+    subd->valenceBuckets = NULL;
+#ifndef CC_DISABLE_UV
+    if (ccm_UvCount(cage) > 0) {
+        const size_t uvByteCount = halfedgeCount * sizeof(cc_VertexUv);
+
+        subd->uvs = (cc_VertexUv *)CC_MALLOC(uvByteCount);
+    } else {
+        subd->uvs = NULL;
+    }
+#endif
+    subd->cage = cage;
+
+    return subd;
+}
+
+
+/*******************************************************************************
+ * Release -- Releases memory used for a given subd
+ *
+ */
+CCDEF void ccs_Release(cc_Subd *subd)
+{
+    if (subd->mappedData != NULL) {
+#ifdef CC__MMAP
+        munmap(subd->mappedData, (size_t)subd->mappedByteCount);
+#endif
+        CC_FREE(subd->packedVertexPoints);
+        CC_FREE(subd->valenceBuckets);
+        CC_FREE(subd);
+
+        return;
+    }
+
+    CC_FREE(subd->halfedges);
+    CC_FREE(subd->creases);
+    CC_FREE(subd->vertexPoints);
+    CC_FREE(subd->packedVertexPoints);
+    CC_FREE(subd->valenceBuckets);
+#ifndef CC_DISABLE_UV
+    CC_FREE(subd->uvs);
+#endif
+    CC_FREE(subd);
+}
+
+
+/*******************************************************************************
+ * File-backed subds
+ *
+ * ccs_CreateMapped places the halfedge, crease, vertex point, and UV buffers
+ * of the subd in a shared memory-mapped file instead of the heap, so that
+ * deep subdivision levels may exceed the amount of physical memory: the OS
+ * pages the levels in and out of the file on demand. The file holds a
+ * header followed by each buffer, aligned to CC__MAPPED_ALIGNMENT bytes.
+ * Since the levels of each buffer are stored contiguously by increasing
+ * depth, the gather kernels (ccs_Refine_Gather and
+ * ccs_Refine_NoCreases_Gather) stream through the file: each step reads
+ * level d and writes level d + 1 in increasing ID order. The scatter
+ * kernels clear the whole vertex point buffer and accumulate into it with
+ * random writes, so they should be avoided for file-backed subds. The file
+ * is created sparse, hence running out of disk space while refining results
+ * in a SIGBUS.
+ *
+ * ccs_OpenMapped reopens such a file read-only, e.g., to export the levels
+ * of a previous bake; the cage must be the one the file was created with,
+ * and the resulting subd must not be refined. File-backed subds cannot be
+ * grown, shrunk, or packed. File mappings require POSIX.1-2001 (they can be
+ * turned off with CC_DISABLE_MMAP); both functions return NULL otherwise.
+ *
+ */
+#ifdef CC__MMAP
+#define CC__MAPPED_ALIGNMENT ((int64_t)1 << 16) // multiple of the page size
+
+typedef struct {
+    int64_t magic;
+    int32_t maxDepth;
+    int32_t vertexCount;    // cage counts
+    int32_t uvCount;
+    int32_t halfedgeCount;
+    int32_t edgeCount;
+    int32_t faceCount;
+    int32_t hasUvs;
+    int32_t reserved;
+} ccs__MappedHeader;
+
+static int64_t ccs__MappedMagic()
+{
+    const union {
+        char    string[8];
+        int64_t numeric;
+    } magic = {{'c', 'c', '_', 'S', 'u', 'b', 'd', '1'}};
+
+    return magic.numeric;
+}
+
+static int64_t ccs__MappedAlign(int64_t byteCount)
+{
+    return (byteCount + CC__MAPPED_ALIGNMENT - 1) & ~(CC__MAPPED_ALIGNMENT - 1);
+}
+
+// computes the offset of each buffer within the file and returns its size
+static int64_t
+ccs__MappedLayout(
+    const cc_Mesh *cage,
+    int32_t maxDepth,
+    bool hasUvs,
+    int64_t offsets[4]
+) {
+    const int64_t halfedgeCount = ccs_CumulativeHalfedgeCountAtDepth(cage, maxDepth);
+    const int64_t creaseCount = ccs_CumulativeCreaseCountAtDepth(cage, maxDepth);
+    const int64_t vertexCount = ccs_CumulativeVertexCountAtDepth(cage, maxDepth);
+    const int64_t halfedgeByteCount = halfedgeCount * sizeof(cc_Halfedge_SemiRegular);
+    const int64_t creaseByteCount = creaseCount * sizeof(cc_Crease);
+    const int64_t vertexPointByteCount = vertexCount * sizeof(cc_VertexPoint);
+    const int64_t uvByteCount = hasUvs ? halfedgeCount * sizeof(cc_VertexUv) : 0;
+
+    offsets[0] = ccs__MappedAlign(sizeof(ccs__MappedHeader));
+    offsets[1] = offsets[0] + ccs__MappedAlign(halfedgeByteCount);
+    offsets[2] = offsets[1] + ccs__MappedAlign(creaseByteCount);
+    offsets[3] = offsets[2] + ccs__MappedAlign(vertexPointByteCount);
+
+    return offsets[3] + ccs__MappedAlign(uvByteCount);
+}
+
+static cc_Subd *
+ccs__CreateFromMapping(
+    const cc_Mesh *cage,
+    int32_t maxDepth,
+    bool hasUvs,
+    void *data,
+    int64_t byteCount
+) {
+    char *bytes = (char *)data;
+    cc_Subd *subd = (cc_Subd *)CC_MALLOC(sizeof(*subd));
+    int64_t offsets[4];
+
+    ccs__MappedLayout(cage, maxDepth, hasUvs, offsets);
+    subd->cage = cage;
+    subd->maxDepth = maxDepth;
+    subd->halfedges = (cc_Halfedge_SemiRegular *)&bytes[offsets[0]];
+    subd->creases = (cc_Crease *)&bytes[offsets[1]];
+    subd->vertexPoints = (cc_VertexPoint *)&bytes[offsets[2]];
+#ifndef CC_DISABLE_UV
+    subd->uvs = hasUvs ? (cc_VertexUv *)&bytes[offsets[3]] : NULL;
+#endif
+    subd->packedVertexPoints = NULL;
+    subd->packedFormat = CC_VERTEX_FORMAT_FP32;
+    subd->packedDepth = maxDepth + 1;
+    subd->mappedData = data;
+    subd->mappedByteCount = byteCount;
+    subd->valenceBuckets = NULL;
+
+    return subd;
+}
+#endif
+
+CCDEF cc_Subd *
+ccs_CreateMapped(const cc_Mesh *cage, int32_t maxDepth, const char *filename)
+{
+#ifdef CC__MMAP
+#ifndef CC_DISABLE_UV
+    const bool hasUvs = ccm_UvCount(cage) > 0;
+#else
+    const bool hasUvs = false;
+#endif
+    int64_t offsets[4];
+    const int64_t byteCount = ccs__MappedLayout(cage, maxDepth, hasUvs, offsets);
+    const ccs__MappedHeader header = {
+        ccs__MappedMagic(),
+        maxDepth,
+        ccm_VertexCount(cage),
+        ccm_UvCount(cage),
+        ccm_HalfedgeCount(cage),
+        ccm_EdgeCount(cage),
+        ccm_FaceCount(cage),
+        hasUvs ? 1 : 0,
+        0
+    };
+    const int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    void *data;
+
+    if (fd < 0) {
+        CC_LOG("cc: open failed");
+
+        return NULL;
+    }
+
+    if (ftruncate(fd, (off_t)byteCount) != 0) {
+        CC_LOG("cc: ftruncate failed");
+        close(fd);
+
+        return NULL;
+    }
+
+    data = mmap(NULL, (size_t)byteCount, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        CC_LOG("cc: mmap failed");
+
+        return NULL;
+    }
+
+    posix_madvise(data, (size_t)byteCount, POSIX_MADV_SEQUENTIAL);
+    CC_MEMCPY(data, &header, sizeof(header));
+
+    return ccs__CreateFromMapping(cage, maxDepth, hasUvs, data, byteCount);
+#else
+    (void)cage;
+    (void)maxDepth;
+    (void)filename;
+    CC_LOG("cc: file mappings are not supported");
+
+    return NULL;
+#endif
+}
+
+CCDEF cc_Subd *ccs_OpenMapped(const cc_Mesh *cage, const char *filename)
+{
+#ifdef CC__MMAP
+    const int fd = open(filename, O_RDONLY);
+    const ccs__MappedHeader *header;
+    struct stat info;
+    int64_t offsets[4];
+    void *data;
+
+    if (fd < 0) {
+        CC_LOG("cc: open failed");
+
+        return NULL;
+    }
+
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(*header)) {
+        CC_LOG("cc: unsupported file");
+        close(fd);
+
+        return NULL;
+    }
+
+    data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        CC_LOG("cc: mmap failed");
+
+        return NULL;
+    }
+
+    header = (const ccs__MappedHeader *)data;
+
+    if (header->magic != ccs__MappedMagic()
+        || header->maxDepth < 0
+        || header->vertexCount != ccm_VertexCount(cage)
+        || header->uvCount != ccm_UvCount(cage)
+        || header->halfedgeCount != ccm_HalfedgeCount(cage)
+        || header->edgeCount != ccm_EdgeCount(cage)
+        || header->faceCount != ccm_FaceCount(cage)
+        || ccs__MappedLayout(cage,
+                             header->maxDepth,
+                             header->hasUvs != 0,
+                             offsets) > (int64_t)info.st_size) {
+        CC_LOG("cc: file does not match the cage");
+        munmap(data, (size_t)info.st_size);
+
+        return NULL;
+    }
+
+    posix_madvise(data, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+
+    return ccs__CreateFromMapping(cage,
+                                  header->maxDepth,
+                                  header->hasUvs != 0,
+                                  data,
+                                  (int64_t)info.st_size);
+#else
+    (void)cage;
+    (void)filename;
+    CC_LOG("cc: file mappings are not supported");
+
+    return NULL;
+#endif
+}
+
+#undef CC__MAPPED_ALIGNMENT
+
+
+/*******************************************************************************
+ * Crease data accessors
+ *
+ * These accessors are hidden from the user because not all edges within
+ * the subd map to a crease. In particular: any edge create within a face
+ * does not have an associated crease. This is because such edges will never
+ * be sharp by construction.
+ *
+ */
+static const cc_Crease *
+ccs__Crease(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+{
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    const int32_t stride = ccs_CumulativeCreaseCountAtDepth(subd->cage,
+                                                            depth - 1);
+
+    return &subd->creases[stride + edgeID];
+}
+
+CCDEF float
+ccs_CreaseSharpness_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+{
+    return ccs__Crease(subd, edgeID, depth)->sharpness;
+}
+
+CCDEF float
+ccs_CreaseSharpness(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+{
+    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+
+    if (edgeID < creaseCount) {
+        return ccs_CreaseSharpness_Fast(subd, edgeID, depth);
+    } else {
+        return 0.0f;
+    }
+}
+
+CCDEF int32_t
+ccs_CreaseNextID_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+{
+    return ccs__Crease(subd, edgeID, depth)->nextID;
+}
+
+CCDEF int32_t
+ccs_CreaseNextID(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+{
+    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+
+    if (edgeID < creaseCount) {
+        return ccs_CreaseNextID_Fast(subd, edgeID, depth);
+    } else {
+        return edgeID;
+    }
+}
+
+CCDEF int32_t
+ccs_CreasePrevID_Fast(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+{
+    return ccs__Crease(subd, edgeID, depth)->prevID;
+}
+
+CCDEF int32_t
+ccs_CreasePrevID(const cc_Subd *subd, int32_t edgeID, int32_t depth)
+{
+    const int32_t creaseCount = ccm_CreaseCountAtDepth(subd->cage, depth);
+
+    if (edgeID < creaseCount) {
+        return ccs_CreasePrevID_Fast(subd, edgeID, depth);
+    } else {
+        return edgeID;
+    }
+}
+
+
+/*******************************************************************************
+ * Halfedge data accessors
+ *
+ */
+static const cc_Halfedge_SemiRegular *
+ccs__Halfedge(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(subd->cage,
+                                                              depth - 1);
+
+    return &subd->halfedges[stride + halfedgeID];
+}
+
+CCDEF int32_t
+ccs_HalfedgeVertexID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    return ccs__Halfedge(subd, halfedgeID, depth)->vertexID;
+}
+
+CCDEF int32_t
+ccs_HalfedgeTwinID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    return ccs__Halfedge(subd, halfedgeID, depth)->twinID;
+}
+
+CCDEF int32_t
+ccs_HalfedgeNextID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    (void)subd;
+    (void)depth;
+
+    return ccm_HalfedgeNextID_Quad(halfedgeID);
+}
+
+CCDEF int32_t
+ccs_HalfedgePrevID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    (void)subd;
+    (void)depth;
+
+    return ccm_HalfedgePrevID_Quad(halfedgeID);
+}
+
+CCDEF int32_t
+ccs_HalfedgeFaceID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    (void)subd;
+    (void)depth;
+
+    return ccm_HalfedgeFaceID_Quad(halfedgeID);
+}
+
+CCDEF int32_t
+ccs_HalfedgeEdgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    return ccs__Halfedge(subd, halfedgeID, depth)->edgeID;
+}
+
+CCDEF float
+ccs_HalfedgeSharpness(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+
+    return ccs_CreaseSharpness(subd, edgeID, depth);
+}
+
+CCDEF cc_VertexPoint
+ccs_HalfedgeVertexPoint(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
+
+    return ccs_VertexPoint(subd, vertexID, depth);
+}
+
+#ifndef CC_DISABLE_UV
+CCDEF cc_VertexUv
+ccs_HalfedgeVertexUv(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(subd->cage,
+                                                              depth - 1);
+
+    return subd->uvs[stride + halfedgeID];
+}
+#endif
+
+
+/*******************************************************************************
+ * Vertex data accessors
+ *
+ */
+static const uint16_t *
+ccs__PackedVertexPoints(const cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t packedStride =
+            ccs_CumulativeVertexCountAtDepth(cage, subd->packedDepth - 1);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth - 1);
+
+    return &subd->packedVertexPoints[3 * (stride - packedStride)];
+}
+
+static cc_VertexPoint
+ccs__DecodeVertexPoint(const cc_Subd *subd, const uint16_t *packed)
+{
+    cc_VertexPoint vertexPoint;
+
+    if (subd->packedFormat == CC_VERTEX_FORMAT_FP16) {
+        for (int32_t i = 0; i < 3; ++i) {
+            vertexPoint.array[i] = cc__HalfToFloat(packed[i]);
+        }
+    } else {
+        const float *lo = subd->packedBounds[0].array;
+        const float *hi = subd->packedBounds[1].array;
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const float u = (float)packed[i] * (1.0f / 65535.0f);
+
+            vertexPoint.array[i] = lo[i] + u * (hi[i] - lo[i]);
+        }
+    }
+
+    return vertexPoint;
+}
+
+static cc_VertexPoint
+ccs__PackedVertexPoint(const cc_Subd *subd, int32_t vertexID, int32_t depth)
+{
+    const uint16_t *packed = ccs__PackedVertexPoints(subd, depth);
+
+    return ccs__DecodeVertexPoint(subd, &packed[3 * vertexID]);
+}
+
+CCDEF cc_VertexPoint
+ccs_VertexPoint(const cc_Subd *subd, int32_t vertexID, int32_t depth)
+{
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+
+    if (depth >= subd->packedDepth) {
+        return ccs__PackedVertexPoint(subd, vertexID, depth);
+    } else {
+        const int32_t stride = ccs_CumulativeVertexCountAtDepth(subd->cage, depth - 1);
+
+        return subd->vertexPoints[stride + vertexID];
+    }
+}
+
+CCDEF bool ccs_FaceIsHole(const cc_Subd *subd, int32_t faceID, int32_t depth)
+{
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    // the faces at depth d are the halfedges at depth d - 1
+    const int32_t tileID = faceID >> (2 * (depth - 1));
+
+    return ccm_FaceIsHole(subd->cage, ccm_HalfedgeFaceID(subd->cage, tileID));
+}
+
+
+/*******************************************************************************
+ * Vertex halfedge iteration
+ *
+ */
+CCDEF int32_t
+ccs_PrevVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
+
+    return ccs_HalfedgeTwinID(subd, prevID, depth);
+}
+
+CCDEF int32_t
+ccs_NextVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+
+    return ccs_HalfedgeNextID(subd, twinID, depth);
+}
+
+
+/*******************************************************************************
+ * Face to Halfedge Mapping
+ *
+ */
+CCDEF int32_t
+ccs_FaceToHalfedgeID(const cc_Subd *subd, int32_t faceID, int32_t depth)
+{
+    (void)subd;
+    (void)depth;
+
+    return ccm_FaceToHalfedgeID_Quad(faceID);
+}
+
+
+/*******************************************************************************
+ * Edge to Halfedge Mapping
+ *
+ * This procedure returns one of the ID of one of the halfedge that constitutes
+ * the edge. This routine has O(depth) complexity.
+ *
+ */
+static int32_t ccs__EdgeToHalfedgeID_First(const cc_Mesh *cage, int32_t edgeID)
+{
+    const int32_t edgeCount = ccm_EdgeCount(cage);
+
+    if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
+        const int32_t halfedgeID = edgeID - 2 * edgeCount;
+        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+
+        return cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
+
+    } else if /* */ ((edgeID & 1) == 1) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID >> 1);
+        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+
+        return 4 * nextID + 3;
+
+    } else /* */ {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID >> 1);
+
+        return 4 * halfedgeID + 0;
+    }
+}
+
+CCDEF int32_t
+ccs_EdgeToHalfedgeID(
+    const cc_Subd *subd,
+    int32_t edgeID,
+    int32_t depth
+) {
+#if 0 // recursive version
+    if (depth > 1) {
+        int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(subd->cage, depth - 1);
+
+        if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
+            int32_t halfedgeID = edgeID - 2 * edgeCount;
+            int32_t nextID = ccm_NextFaceHalfedgeID_Quad(halfedgeID);
+
+            return cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
+
+        } else if /* [E, 2E) */ (edgeID >= edgeCount) {
+            int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd,
+                                                      edgeID >> 1,
+                                                      depth - 1);
+            int32_t nextID = ccm_NextFaceHalfedgeID_Quad(halfedgeID);
+
+            return 4 * nextID + 3;
+
+        } else /* [0, E) */ {
+            int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID >> 1, depth - 1);
+
+            return 4 * halfedgeID + 0;
+        }
+    } else {
+        return ccs__EdgeToHalfedgeID_First(subd->cage, edgeID);
+    }
+#else // non-recursive version
+    uint32_t heap = 1u;
+    int32_t edgeHalfedgeID = 0;
+    int32_t heapDepth = depth;
+
+    // build heap
+    for (; heapDepth > 1; --heapDepth) {
+        const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(subd->cage,
+                                                            heapDepth - 1);
+
+        if /* [2E, 2E + H) */ (edgeID >= 2 * edgeCount) {
+            const int32_t halfedgeID = edgeID - 2 * edgeCount;
+            const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+
+            edgeHalfedgeID = cc__Max(4 * halfedgeID + 1, 4 * nextID + 2);
+            break;
+        } else {
+            heap = (heap << 1) | (edgeID & 1);
+            edgeID>>= 1;
+        }
+    }
+
+    // initialize root cfg
+    if (heapDepth == 1) {
+        edgeHalfedgeID = ccs__EdgeToHalfedgeID_First(subd->cage, edgeID);
+    }
+
+    // read heap
+    while (heap > 1u) {
+        if ((heap & 1u) == 1u) {
+            const int32_t nextID = ccm_HalfedgeNextID_Quad(edgeHalfedgeID);
+
+            edgeHalfedgeID = 4 * nextID + 3;
+        } else {
+            edgeHalfedgeID = 4 * edgeHalfedgeID + 0;
+        }
+
+        heap>>= 1;
+    }
+
+    return edgeHalfedgeID;
+#endif
+}
+
+
+/*******************************************************************************
+ * Vertex to Halfedge Mapping
+ *
+ * This procedure returns the ID of one of the halfedge that connects a
+ * given vertex. This routine has O(depth) complexity.
+ *
+ */
+static int32_t
+ccs__VertexToHalfedgeID_First(const cc_Mesh *cage, int32_t vertexID)
+{
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+
+    if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
+        const int32_t edgeID = vertexID - vertexCount - faceCount;
+
+        return 4 * ccm_EdgeToHalfedgeID(cage, edgeID) + 1;
+
+    } else if /* [V, V + F) */ (vertexID >= vertexCount) {
+        const int32_t faceID = vertexID - vertexCount;
+
+        return 4 * ccm_FaceToHalfedgeID(cage, faceID) + 2;
+
+    } else /* [0, V) */ {
+
+        return 4 * ccm_VertexToHalfedgeID(cage, vertexID) + 0;
+    }
+}
+
+CCDEF int32_t
+ccs_VertexToHalfedgeID(const cc_Subd *subd, int32_t vertexID, int32_t depth)
+{
+#if 0 // recursive version
+    if (depth > 1) {
+        const cc_Mesh *cage = subd->cage;
+        const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth - 1);
+        const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth - 1);
+
+        if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
+            const int32_t edgeID = vertexID - vertexCount - faceCount;
+
+            return 4 * ccs_EdgeToHalfedgeID(subd, edgeID, depth - 1) + 1;
+
+        } else if /* [V, V + F) */ (vertexID >= vertexCount) {
+            const int32_t faceID = vertexID - vertexCount;
+
+            return 4 * ccm_FaceToHalfedgeID_Quad(faceID) + 2;
+
+        } else /* [0, V) */ {
+
+            return 4 * ccs_VertexToHalfedgeID(subd, vertexID, depth - 1) + 0;
+        }
+    } else {
+
+        return ccs__VertexToHalfedgeID_First(subd->cage, vertexID);
+    }
+#else // non-recursive version
+    const cc_Mesh *cage = subd->cage;
+    int32_t heapDepth = depth;
+    int32_t stride = 0;
+    int32_t halfedgeID;
+
+    // build heap
+    for (; heapDepth > 1; --heapDepth) {
+        const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, heapDepth - 1);
+        const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, heapDepth - 1);
+
+        if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
+            const int32_t edgeID = vertexID - faceCount - vertexCount;
+
+            halfedgeID = 4 * ccs_EdgeToHalfedgeID(subd, edgeID, heapDepth - 1) + 1;
+            break;
+        } else if /* [V, V + F) */ (vertexID >= vertexCount) {
+            const int32_t faceID = vertexID - vertexCount;
+
+            halfedgeID = 4 * ccm_FaceToHalfedgeID_Quad(faceID) + 2;
+            break;
+        } else /* [0, V) */ {
+            stride+= 2;
+        }
+    }
+
+    // initialize root cfg
+    if (heapDepth == 1) {
+        halfedgeID = ccs__VertexToHalfedgeID_First(subd->cage, vertexID);
+    }
+
+    return halfedgeID << stride;
+#endif
+}
+
+
+/*******************************************************************************
+ * SkinnedVertexPoint -- Deforms a cage vertex by its weighted bones
+ *
+ * Linear blend skinning blends the bone matrices before transforming the
+ * vertex. Dual quaternion skinning blends the bone dual quaternions, flipping
+ * those that lie in the opposite hemisphere of the first bone of the vertex,
+ * and transforms the vertex by their normalized blend. The blends run over
+ * fixed-size float arrays so that the compiler may vectorize them.
+ *
+ */
+static cc_VertexPoint
+ccm__LinearSkinnedVertexPoint(const cc_Skin *skin, cc_VertexPoint point, int32_t vertexID)
+{
+    float matrix[12] = {0.0f};
+    cc_VertexPoint newPoint;
+
+    for (int32_t i = skin->offsets[vertexID]; i < skin->offsets[vertexID + 1]; ++i) {
+        const float *bone = &skin->bones[12 * skin->boneIDs[i]];
+        const float weight = skin->weights[i];
+
+        for (int32_t j = 0; j < 12; ++j) {
+            matrix[j]+= weight * bone[j];
+        }
+    }
+
+    for (int32_t i = 0; i < 3; ++i) {
+        const float *row = &matrix[4 * i];
+
+        newPoint.array[i] = row[0] * point.x + row[1] * point.y + row[2] * point.z
+                          + row[3];
+    }
+
+    return newPoint;
+}
+
+static cc_VertexPoint
+ccm__DualQuaternionSkinnedVertexPoint(
+    const cc_Skin *skin,
+    cc_VertexPoint point,
+    int32_t vertexID
+) {
+    const int32_t firstID = skin->offsets[vertexID];
+    const float *pivot = &skin->bones[8 * skin->boneIDs[firstID]];
+    float dq[8] = {0.0f};
+    float rcpNorm, r[4], d[4], tmp[3];
+    cc_VertexPoint newPoint;
+
+    for (int32_t i = firstID; i < skin->offsets[vertexID + 1]; ++i) {
+        const float *bone = &skin->bones[8 * skin->boneIDs[i]];
+        const float dot = pivot[0] * bone[0] + pivot[1] * bone[1]
+                        + pivot[2] * bone[2] + pivot[3] * bone[3];
+        const float weight = dot < 0.0f ? -skin->weights[i] : skin->weights[i];
+
+        for (int32_t j = 0; j < 8; ++j) {
+            dq[j]+= weight * bone[j];
+        }
+    }
+
+    rcpNorm = 1.0f / CC_SQRTF(dq[0] * dq[0] + dq[1] * dq[1]
+                              + dq[2] * dq[2] + dq[3] * dq[3]);
+    cc__Mulfv(4, r, &dq[0], rcpNorm);
+    cc__Mulfv(4, d, &dq[4], rcpNorm);
+
+    // rotation: p + 2 r.xyz x (r.xyz x p + r.w p)
+    tmp[0] = r[1] * point.z - r[2] * point.y + r[3] * point.x;
+    tmp[1] = r[2] * point.x - r[0] * point.z + r[3] * point.y;
+    tmp[2] = r[0] * point.y - r[1] * point.x + r[3] * point.z;
+    newPoint.x = point.x + 2.0f * (r[1] * tmp[2] - r[2] * tmp[1]);
+    newPoint.y = point.y + 2.0f * (r[2] * tmp[0] - r[0] * tmp[2]);
+    newPoint.z = point.z + 2.0f * (r[0] * tmp[1] - r[1] * tmp[0]);
+
+    // translation: 2 (r.w d.xyz - d.w r.xyz + r.xyz x d.xyz)
+    newPoint.x+= 2.0f * (r[3] * d[0] - d[3] * r[0] + r[1] * d[2] - r[2] * d[1]);
+    newPoint.y+= 2.0f * (r[3] * d[1] - d[3] * r[1] + r[2] * d[0] - r[0] * d[2]);
+    newPoint.z+= 2.0f * (r[3] * d[2] - d[3] * r[2] + r[0] * d[1] - r[1] * d[0]);
+
+    return newPoint;
+}
+
+CCDEF cc_VertexPoint
+ccm_SkinnedVertexPoint(const cc_Mesh *mesh, const cc_Skin *skin, int32_t vertexID)
+{
+    const cc_VertexPoint point = ccm_VertexPoint(mesh, vertexID);
+
+    if (skin->offsets[vertexID] == skin->offsets[vertexID + 1]) {
+        return point;
+    } else if (skin->method == CC_SKIN_DUAL_QUATERNION) {
+        return ccm__DualQuaternionSkinnedVertexPoint(skin, point, vertexID);
+    } else {
+        return ccm__LinearSkinnedVertexPoint(skin, point, vertexID);
+    }
+}
+
+// cage points are read through this routine so that a skin may deform them
+static cc_VertexPoint
+ccs__CageVertexPoint(const cc_Mesh *cage, const cc_Skin *skin, int32_t vertexID)
+{
+    if (skin == NULL) {
+        return ccm_VertexPoint(cage, vertexID);
+    } else {
+        return ccm_SkinnedVertexPoint(cage, skin, vertexID);
+    }
+}
+
+static cc_VertexPoint
+ccs__CageHalfedgeVertexPoint(const cc_Mesh *cage, const cc_Skin *skin, int32_t halfedgeID)
+{
+    return ccs__CageVertexPoint(cage, skin, ccm_HalfedgeVertexID(cage, halfedgeID));
+}
+
+
+/*******************************************************************************
+ * HoleTileFlags -- Flags the tiles that the gather routines must refine
+ *
+ * The limit surface of a face only depends on the faces that share a vertex
+ * with it, so the descendants of a hole face are only required if the face
+ * touches a visible one. The returned buffer flags the tiles (i.e., the
+ * halfedges of the cage) of the visible faces and of the faces that touch
+ * them, and is NULL if the cage has no holes. A point is refined if any of
+ * the tiles that touch it is flagged: a face point lies within a single
+ * tile, an edge point is tested from both sides of its edge, and a vertex
+ * point from its whole one-ring. The points of the tiles that are not
+ * flagged copy their parent point instead, so that the rules that weight
+ * an unused neighbor by zero never read uninitialized memory.
+ *
+ */
+static uint8_t *ccs__CreateHoleTileFlags(const cc_Mesh *cage)
+{
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    uint8_t *vertexFlags, *faceFlags, *tileFlags;
+
+    if (cage->faceHoles == NULL) {
+        return NULL;
+    }
+
+    vertexFlags = (uint8_t *)CC_MALLOC(cc__Max(1, vertexCount));
+    faceFlags = (uint8_t *)CC_MALLOC(cc__Max(1, faceCount));
+    tileFlags = (uint8_t *)CC_MALLOC(cc__Max(1, halfedgeCount));
+    CC_MEMSET(vertexFlags, 0, vertexCount);
+    CC_MEMSET(faceFlags, 0, faceCount);
+
+    // vertices of the visible faces
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+
+        if (!ccm_FaceIsHole(cage, faceID)) {
+            vertexFlags[ccm_HalfedgeVertexID(cage, halfedgeID)] = 1;
+        }
+    }
+
+    // faces that touch one of these vertices
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        if (vertexFlags[ccm_HalfedgeVertexID(cage, halfedgeID)]) {
+            faceFlags[ccm_HalfedgeFaceID(cage, halfedgeID)] = 1;
+        }
+    }
+
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        tileFlags[halfedgeID] = faceFlags[ccm_HalfedgeFaceID(cage, halfedgeID)];
+    }
+
+    CC_FREE(vertexFlags);
+    CC_FREE(faceFlags);
+
+    return tileFlags;
+}
+
+static bool
+ccs__IsCageEdgeFlagged(const cc_Mesh *cage, const uint8_t *tileFlags, int32_t edgeID)
+{
+    const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+    const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+
+    return tileFlags[halfedgeID] || (twinID >= 0 && tileFlags[twinID]);
+}
+
+static bool
+ccs__IsCageVertexFlagged(const cc_Mesh *cage, const uint8_t *tileFlags, int32_t vertexID)
+{
+    const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+    int32_t iterator = halfedgeID;
+
+    do {
+        if (tileFlags[iterator]) {
+            return true;
+        }
+
+        iterator = ccm_NextVertexHalfedgeID(cage, iterator);
+    } while (iterator >= 0 && iterator != halfedgeID);
+
+    // boundary vertices are walked in both directions
+    if (iterator >= 0) {
+        return false;
+    }
+
+    for (iterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
+         iterator >= 0;
+         iterator = ccm_PrevVertexHalfedgeID(cage, iterator)) {
+        if (tileFlags[iterator]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool
+ccs__IsEdgeFlagged(
+    const cc_Subd *subd,
+    const uint8_t *tileFlags,
+    int32_t edgeID,
+    int32_t depth
+) {
+    const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
+    const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+
+    return tileFlags[halfedgeID >> (2 * depth)]
+        || (twinID >= 0 && tileFlags[twinID >> (2 * depth)]);
+}
+
+static bool
+ccs__IsVertexFlagged(
+    const cc_Subd *subd,
+    const uint8_t *tileFlags,
+    int32_t vertexID,
+    int32_t depth
+) {
+    const int32_t halfedgeID = ccs_VertexToHalfedgeID(subd, vertexID, depth);
+    int32_t iterator = halfedgeID;
+
+    do {
+        const int32_t twinID = ccs_HalfedgeTwinID(subd, iterator, depth);
+
+        if (tileFlags[iterator >> (2 * depth)]) {
+            return true;
+        }
+
+        iterator = twinID >= 0 ? ccs_HalfedgeNextID(subd, twinID, depth) : -1;
+    } while (iterator >= 0 && iterator != halfedgeID);
+
+    // boundary vertices are walked in both directions
+    if (iterator >= 0) {
+        return false;
+    }
+
+    for (iterator = ccs_PrevVertexHalfedgeID(subd, halfedgeID, depth);
+         iterator >= 0;
+         iterator = ccs_PrevVertexHalfedgeID(subd, iterator, depth)) {
+        if (tileFlags[iterator >> (2 * depth)]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*******************************************************************************
+ * CageFacePoints -- Applies Catmull Clark's face rule on the cage mesh
+ *
+ * The "Gather" routine iterates over each face of the mesh and compute the
+ * resulting face vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the face vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__CageFacePoint_Gather(const cc_Subd *subd, const cc_Skin *skin, int32_t faceID)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+    cc_VertexPoint newFacePoint = ccs__CageHalfedgeVertexPoint(cage, skin, halfedgeID);
+    float faceVertexCount = 1.0f;
+
+    for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
+                 halfedgeIt != halfedgeID;
+                 halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+        const cc_VertexPoint vertexPoint =
+                ccs__CageHalfedgeVertexPoint(cage, skin, halfedgeIt);
+
+        cc__Add3f(newFacePoint.array, newFacePoint.array, vertexPoint.array);
+        ++faceVertexCount;
+    }
+
+    cc__Mul3f(newFacePoint.array, newFacePoint.array, 1.0f / faceVertexCount);
+
+    return newFacePoint;
+}
+
+static void
+ccs__CageFacePoints_Gather(
+    cc_Subd *subd,
+    const cc_Skin *skin,
+    const uint8_t *tileFlags
+) {
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+
+CC_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        const int32_t halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+
+        if (tileFlags != NULL && !tileFlags[halfedgeID]) {
+            newFacePoints[faceID] = ccs__CageHalfedgeVertexPoint(cage, skin, halfedgeID);
+            continue;
+        }
+
+        newFacePoints[faceID] = ccs__CageFacePoint_Gather(subd, skin, faceID);
+    }
+CC_BARRIER
+}
+
+static void ccs__CageFacePoints_Scatter(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const cc_VertexPoint vertexPoint = ccm_HalfedgeVertexPoint(cage, halfedgeID);
+        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        float faceVertexCount = 1.0f;
+        float *newFacePoint = newFacePoints[faceID].array;
+
+        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
+                     halfedgeIt != halfedgeID;
+                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+            ++faceVertexCount;
+        }
+
+        for (int32_t i = 0; i < 3; ++i) {
+CC_ATOMIC
+            newFacePoint[i]+= vertexPoint.array[i] / (float)faceVertexCount;
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * CageEdgePoints -- Applies Catmull Clark's edge rule on the cage mesh
+ *
+ * The "Gather" routine iterates over each edge of the mesh and computes the
+ * resulting edge vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the edge vertex.
+ *
+ */
+static void ccs__CageEdgePoints_Gather(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t edgeCount = ccm_EdgeCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const float edgeWeight = twinID < 0 ? 0.0f : 1.0f;
+        const cc_VertexPoint oldEdgePoints[2] = {
+            ccm_HalfedgeVertexPoint(cage, halfedgeID),
+            ccm_HalfedgeVertexPoint(cage,     nextID)
+        };
+        const cc_VertexPoint newFacePointPair[2] = {
+            newFacePoints[ccm_HalfedgeFaceID(cage, halfedgeID)],
+            newFacePoints[ccm_HalfedgeFaceID(cage, cc__Max(0, twinID))]
+        };
+        float *newEdgePoint = newEdgePoints[edgeID].array;
+        cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
+        float tmp1[3], tmp2[3];
+
+        cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
+        cc__Add3f(tmp2, newFacePointPair[0].array, newFacePointPair[1].array);
+        cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
+        cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
+        cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
+        cc__Lerp3f(newEdgePoint,
+                   sharpEdgePoint.array,
+                   smoothEdgePoint.array,
+                   edgeWeight);
+    }
+CC_BARRIER
+}
+
+static void ccs__CageEdgePoints_Scatter(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        float tmp1[3], tmp2[3], tmp3[3], tmp4[3], atomicWeight[3];
+        float weight = twinID >= 0 ? 0.5f : 1.0f;
+
+        cc__Mul3f(tmp1, newFacePoint.array, 0.5f);
+        cc__Mul3f(tmp2, ccm_HalfedgeVertexPoint(cage, halfedgeID).array, weight);
+        cc__Mul3f(tmp3, ccm_HalfedgeVertexPoint(cage,     nextID).array, weight);
+        cc__Lerp3f(tmp4, tmp2, tmp3, 0.5f);
+        cc__Lerp3f(atomicWeight, tmp1, tmp4, weight);
+
+        for (int32_t i = 0; i < 3; ++i) {
+CC_ATOMIC
+            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * CreasedCageEdgePoints -- Applies DeRole et al.'s edge rule on the cage mesh
+ *
+ * The "Gather" routine iterates over each edge of the mesh and computes the
+ * resulting edge vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the edge vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__CreasedCageEdgePoint_Gather(
+    const cc_Subd *subd,
+    const cc_Skin *skin,
+    const cc_VertexPoint *newFacePoints,
+    int32_t edgeID
+) {
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+    const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+    const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+    const float sharp = ccm_CreaseSharpness(cage, edgeID);
+    const float edgeWeight = cc__Satf(sharp);
+    const cc_VertexPoint oldEdgePoints[2] = {
+        ccs__CageHalfedgeVertexPoint(cage, skin, halfedgeID),
+        ccs__CageHalfedgeVertexPoint(cage, skin,     nextID)
+    };
+    const cc_VertexPoint newAdjacentFacePoints[2] = {
+        newFacePoints[ccm_HalfedgeFaceID(cage, halfedgeID)],
+        newFacePoints[ccm_HalfedgeFaceID(cage, twinID >= 0 ? twinID : halfedgeID)]
+    };
+    cc_VertexPoint newEdgePoint;
+    cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
+    float tmp1[3], tmp2[3];
+
+    cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
+    cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
+    cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
+    cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
+    cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
+    cc__Lerp3f(newEdgePoint.array,
+               smoothEdgePoint.array,
+               sharpEdgePoint.array,
+               edgeWeight);
+
+    return newEdgePoint;
+}
+
+static void
+ccs__CreasedCageEdgePoints_Gather(
+    cc_Subd *subd,
+    const cc_Skin *skin,
+    const uint8_t *tileFlags
+) {
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t edgeCount = ccm_EdgeCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        if (tileFlags != NULL && !ccs__IsCageEdgeFlagged(cage, tileFlags, edgeID)) {
+            const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+
+            newEdgePoints[edgeID] = ccs__CageHalfedgeVertexPoint(cage, skin, halfedgeID);
+            continue;
+        }
+
+        newEdgePoints[edgeID] = ccs__CreasedCageEdgePoint_Gather(subd,
+                                                                 skin,
+                                                                 newFacePoints,
+                                                                 edgeID);
+    }
+CC_BARRIER
+}
+
+static void ccs__CreasedCageEdgePoints_Scatter(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const float sharp = ccm_CreaseSharpness(cage, edgeID);
+        const float edgeWeight = cc__Satf(sharp);
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        const cc_VertexPoint oldEdgePoints[2] = {
+            ccm_HalfedgeVertexPoint(cage, halfedgeID),
+            ccm_HalfedgeVertexPoint(cage,     nextID)
+        };
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint sharpPoint = {0.0f, 0.0f, 0.0f};
+        float tmp[3], atomicWeight[3];
+
+        // sharp point
+        cc__Lerp3f(tmp, oldEdgePoints[0].array, oldEdgePoints[1].array, 0.5f);
+        cc__Mul3f(sharpPoint.array, tmp, twinID < 0 ? 1.0f : 0.5f);
+
+        // smooth point
+        cc__Lerp3f(tmp, oldEdgePoints[0].array, newFacePoint.array, 0.5f);
+        cc__Mul3f(smoothPoint.array, tmp, 0.5f);
+
+        // atomic weight
+        cc__Lerp3f(atomicWeight,
+                   smoothPoint.array,
+                   sharpPoint.array,
+                   edgeWeight);
+
+        for (int32_t i = 0; i < 3; ++i) {
+CC_ATOMIC
+            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * CageVertexPoints -- Applies Catmull Clark's vertex rule on the cage mesh
+ *
+ * The "Gather" routine iterates over each vertex of the mesh and computes the
+ * resulting smooth vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the smooth vertex.
+ *
+ */
+static void ccs__CageVertexPoints_Gather(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+
+CC_PARALLEL_FOR
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        float valence = 1.0f;
+        int32_t iterator;
+        float tmp1[3], tmp2[3];
+
+        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+        for (iterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
+             iterator >= 0 && iterator != halfedgeID;
+             iterator = ccm_PrevVertexHalfedgeID(cage, iterator)) {
+            const int32_t edgeID = ccm_HalfedgeEdgeID(cage, iterator);
+            const int32_t faceID = ccm_HalfedgeFaceID(cage, iterator);
+            const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+            const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+
+            cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+            cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+            ++valence;
+        }
+
+        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+        cc__Mul3f(tmp2, oldVertexPoint.array, 1.0f - 3.0f / valence);
+        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+        cc__Lerp3f(newVertexPoints[vertexID].array,
+                   oldVertexPoint.array,
+                   smoothPoint.array,
+                   iterator != halfedgeID ? 0.0f : 1.0f);
+    }
+CC_BARRIER
+}
+
+static void ccs__CageVertexPoints_Scatter(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
+        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
+        int32_t valence = 1;
+        int32_t forwardIterator, backwardIterator;
+
+        for (forwardIterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
+             forwardIterator >= 0 && forwardIterator != halfedgeID;
+             forwardIterator = ccm_PrevVertexHalfedgeID(cage, forwardIterator)) {
+            ++valence;
+        }
+
+        for (backwardIterator = ccm_NextVertexHalfedgeID(cage, halfedgeID);
+             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+             backwardIterator = ccm_NextVertexHalfedgeID(cage, backwardIterator)) {
+            ++valence;
+        }
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const float w = 1.0f / (float)valence;
+            const float v = oldVertexPoint.array[i];
+            const float f = newFacePoints[faceID].array[i];
+            const float e = newEdgePoints[edgeID].array[i];
+            const float s = forwardIterator < 0 ? 0.0f : 1.0f;
+CC_ATOMIC
+            newVertexPoints[vertexID].array[i]+=
+                w * (v + w * s * (4.0f * e - f - 3.0f * v));
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * CreasedCageVertexPoints -- Applies DeRose et al.'s vertex rule on cage mesh
+ *
+ * The "Gather" routine iterates over each vertex of the mesh and computes the
+ * resulting smooth vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the smooth vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__CreasedCageVertexPoint_Gather(
+    const cc_Subd *subd,
+    const cc_Skin *skin,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    int32_t vertexID
+) {
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+    const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+    const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+    const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+    const int32_t prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
+    const float thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
+    const float prevS = ccm_HalfedgeSharpness(cage,     prevID);
+    const float creaseWeight = cc__Signf(thisS);
+    const float prevCreaseWeight = cc__Signf(prevS);
+    const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+    const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+    const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
+    const cc_VertexPoint oldPoint = ccs__CageVertexPoint(cage, skin, vertexID);
+    cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
+    float avgS = prevS;
+    float creaseCount = prevCreaseWeight;
+    float valence = 1.0f;
+    int32_t forwardIterator;
+    cc_VertexPoint newVertexPoint;
+    float tmp1[3], tmp2[3];
+
+    // smooth contrib
+    cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
+    cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    // crease contrib
+    cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
+    cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+
+    for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
+         forwardIterator >= 0 && forwardIterator != halfedgeID;
+         forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
+        const int32_t prevID = ccm_HalfedgePrevID(cage, forwardIterator);
+        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+        const int32_t prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
+        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+        const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
+        const float prevS = ccm_HalfedgeSharpness(cage, prevID);
+        const float prevCreaseWeight = cc__Signf(prevS);
+
+        // smooth contrib
+        cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+        ++valence;
+
+        // crease contrib
+        cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
+        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        avgS+= prevS;
+        creaseCount+= prevCreaseWeight;
+
+        // next vertex halfedge
+        forwardIterator = prevID;
+    }
+
+    // boundary corrections
+    if (forwardIterator < 0) {
+        cc__Mul3f(tmp1, newEdgePoint.array    , creaseWeight);
+        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        creaseCount+= creaseWeight;
+        ++valence;
+    }
+
+    // smooth point
+    cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+    cc__Mul3f(tmp2, oldPoint.array, 1.0f - 3.0f / valence);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    // crease point
+    cc__Mul3f(tmp1, creasePoint.array, 0.25f);
+    cc__Mul3f(tmp2, oldPoint.array, 0.5f);
+    cc__Add3f(creasePoint.array, tmp1, tmp2);
+
+    // proper vertex rule selection
+    if (creaseCount <= 1.0f) {
+        newVertexPoint = smoothPoint;
+    } else if (creaseCount >= 3.0f || valence == 2.0f) {
+        newVertexPoint = oldPoint;
+    } else {
+        cc__Lerp3f(newVertexPoint.array,
+                   oldPoint.array,
+                   creasePoint.array,
+                   cc__Satf(avgS * 0.5f));
+    }
+
+    return newVertexPoint;
+}
+
+static void
+ccs__CreasedCageVertexPoints_Gather(
+    cc_Subd *subd,
+    const cc_Skin *skin,
+    const uint8_t *tileFlags
+) {
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+
+CC_PARALLEL_FOR
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        if (tileFlags != NULL && !ccs__IsCageVertexFlagged(cage, tileFlags, vertexID)) {
+            newVertexPoints[vertexID] = ccs__CageVertexPoint(cage, skin, vertexID);
+            continue;
+        }
+
+        newVertexPoints[vertexID] =
+                ccs__CreasedCageVertexPoint_Gather(subd,
+                                                   skin,
+                                                   newFacePoints,
+                                                   newEdgePoints,
+                                                   vertexID);
+    }
+CC_BARRIER
+}
+
+
+static void ccs__CreasedCageVertexPoints_Scatter(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    const cc_VertexPoint *oldVertexPoints = cage->vertexPoints;
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
+        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+        const float thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
+        const float prevS = ccm_HalfedgeSharpness(cage,     prevID);
+        const float creaseWeight = cc__Signf(thisS);
+        const float prevCreaseWeight = cc__Signf(prevS);
+        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        const cc_VertexPoint oldPoint = oldVertexPoints[vertexID];
+        cc_VertexPoint cornerPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint atomicWeight = {0.0f, 0.0f, 0.0f};
+        float avgS = prevS;
+        float creaseCount = prevCreaseWeight;
+        float valence = 1.0f;
+        int32_t forwardIterator, backwardIterator;
+        float tmp1[3], tmp2[3];
+
+        for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
+             forwardIterator >= 0 && forwardIterator != halfedgeID;
+             forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
+            const int32_t prevID = ccm_HalfedgePrevID(cage, forwardIterator);
+            const float prevS = ccm_HalfedgeSharpness(cage, prevID);
+            const float prevCreaseWeight = cc__Signf(prevS);
+
+            // valence computation
+            ++valence;
+
+            // crease computation
+            avgS+= prevS;
+            creaseCount+= prevCreaseWeight;
+
+            // next vertex halfedge
+            forwardIterator = prevID;
+        }
+
+        for (backwardIterator = ccm_HalfedgeTwinID(cage, halfedgeID);
+             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+             backwardIterator = ccm_HalfedgeTwinID(cage, backwardIterator)) {
+            const int32_t nextID = ccm_HalfedgeNextID(cage, backwardIterator);
+            const float nextS = ccm_HalfedgeSharpness(cage, nextID);
+            const float nextCreaseWeight = cc__Signf(nextS);
+
+            // valence computation
+            ++valence;
+
+            // crease computation
+            avgS+= nextS;
+            creaseCount+= nextCreaseWeight;
+
+            // next vertex halfedge
+            backwardIterator = nextID;
+        }
+
+        // corner point
+        cc__Mul3f(cornerPoint.array, oldPoint.array, 1.0f / valence);
+
+        // crease computation: V / 4
+        cc__Mul3f(tmp1, oldPoint.array, 0.25f * creaseWeight);
+        cc__Mul3f(tmp2, newEdgePoint.array, 0.25f * creaseWeight);
+        cc__Add3f(creasePoint.array, tmp1, tmp2);
+
+        // smooth computation: (4E - F + (n - 3) V) / N
+        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+        cc__Mul3f(tmp1, oldPoint.array, valence - 3.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Mul3f(smoothPoint.array,
+                  smoothPoint.array,
+                  1.0f / (valence * valence));
+
+        // boundary corrections
+        if (forwardIterator < 0) {
+            creaseCount+= creaseWeight;
+            ++valence;
+
+            cc__Mul3f(tmp1, oldPoint.array, 0.25f * prevCreaseWeight);
+            cc__Mul3f(tmp2, newPrevEdgePoint.array, 0.25f * prevCreaseWeight);
+            cc__Add3f(tmp1, tmp1, tmp2);
+            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        }
+
+        // atomicWeight (TODO: make branchless ?)
+        if (creaseCount <= 1.0f) {
+            atomicWeight = smoothPoint;
+        } else if (creaseCount >= 3.0f || valence == 2.0f) {
+            atomicWeight = cornerPoint;
+        } else {
+            cc__Lerp3f(atomicWeight.array,
+                       cornerPoint.array,
+                       creasePoint.array,
+                       cc__Satf(avgS * 0.5f));
+        }
+
+        for (int32_t i = 0; i < 3; ++i) {
+CC_ATOMIC
+            newVertexPoints[vertexID].array[i]+= atomicWeight.array[i];
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * TilePoints -- Applies Catmull Clark's rules on the regular regions of the subd
+ *
+ * Each face of the subd at depth 1 (i.e., each halfedge of the cage) is a quad
+ * whose descendants form a regular grid of 2^(d-1) x 2^(d-1) quads at depth d,
+ * which we refer to as a tile. Owing to the 4h+k refinement rule, the
+ * halfedges of tile t at depth d are stored contiguously within
+ * [t 4^d, (t + 1) 4^d), and their layout is the same for all tiles. The
+ * vertices and edges that lie strictly inside a tile are regular and never
+ * creased, so they are refined here with the fixed B-spline stencils: the
+ * vertex points of each tile are gathered into a (2^(d-1) + 1)^2 grid through
+ * a lookup table shared by all tiles, and no twin is ever dereferenced.
+ * The vertices and edges that lie on the border of the tiles are left to the
+ * general routines; their IDs span the following ranges at depth d:
+ * - edges: [0, 2^(d-1) E1), where E1 denotes the edge count at depth 1;
+ * - vertices: [0, V1) and [Vk + Fk, Vk + Fk + 2^(k-1) E1) for 0 < k < d.
+ *
+ */
+#define CC__TILE_VERTEX     1   // a vertex stencil is centered on the halfedge
+#define CC__TILE_EDGE_X     2   // an edge stencil runs along the halfedge (x)
+#define CC__TILE_EDGE_Y     4   // an edge stencil runs along the halfedge (y)
+#define CC__TILE_STACK_SIZE 33  // grids up to 33x33 vertices live on the stack
+
+typedef struct {
+    int32_t gridID; // location of the halfedge's vertex within the grid
+    int32_t flags;  // stencils to apply from the halfedge
+} ccs__TileHalfedge;
+
+static int32_t ccs__TileBorderEdgeCount(const cc_Mesh *cage, int32_t depth)
+{
+    return ccm_EdgeCountAtDepth_Fast(cage, 1) << (depth - 1);
+}
+
+static void
+ccs__TileBorderVertexRange(
+    const cc_Mesh *cage,
+    int32_t rangeID,
+    int32_t *begin,
+    int32_t *end
+) {
+    if (rangeID == 0) {
+        *begin = 0;
+        *end = ccm_VertexCountAtDepth_Fast(cage, 1);
+    } else {
+        *begin = ccm_VertexCountAtDepth_Fast(cage, rangeID)
+               + ccm_FaceCountAtDepth_Fast(cage, rangeID);
+        *end = *begin + ccs__TileBorderEdgeCount(cage, rangeID);
+    }
+}
+
+static ccs__TileHalfedge *ccs__CreateTileHalfedges(int32_t depth)
+{
+    const int32_t halfedgeCount = 1 << (2 * depth);
+    const int32_t tileSize = 1 << (depth - 1);
+    const int32_t gridWidth = tileSize + 1;
+    ccs__TileHalfedge *tileHalfedges =
+        (ccs__TileHalfedge *)CC_MALLOC(sizeof(*tileHalfedges) * halfedgeCount);
+
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        int32_t corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+        const int32_t *vertex, *nextVertex;
+        int32_t x, y, dx, dy, flags = 0;
+
+        // descend the 4h+k hierarchy from the depth 1 quad
+        for (int32_t d = depth - 1; d >= 1; --d) {
+            const int32_t k = (halfedgeID >> (2 * d)) & 3;
+            int32_t parent[4][2];
+
+            CC_MEMCPY(parent, corners, sizeof(corners));
+            for (int32_t i = 0; i < 2; ++i) {
+                const int32_t a = parent[k][i];
+
+                corners[0][i] = 2 * a;
+                corners[1][i] = a + parent[(k + 1) & 3][i];
+                corners[2][i] = a + parent[(k + 2) & 3][i];
+                corners[3][i] = a + parent[(k + 3) & 3][i];
+            }
+        }
+
+        vertex = corners[halfedgeID & 3];
+        nextVertex = corners[(halfedgeID + 1) & 3];
+        x = vertex[0];
+        y = vertex[1];
+        dx = nextVertex[0] - x;
+        dy = nextVertex[1] - y;
+
+        if (dx == 1 && 0 < x && x < tileSize && 0 < y && y < tileSize) {
+            flags|= CC__TILE_VERTEX;
+        }
+
+        if (dx == 1 && 0 < y && y < tileSize) {
+            flags|= CC__TILE_EDGE_X;
+        }
+
+        if (dy == 1 && 0 < x && x < tileSize) {
+            flags|= CC__TILE_EDGE_Y;
+        }
+
+        tileHalfedges[halfedgeID].gridID = x + gridWidth * y;
+        tileHalfedges[halfedgeID].flags = flags;
+    }
+
+    return tileHalfedges;
+}
+
+static cc_VertexPoint
+ccs__TileEdgePoint(const cc_VertexPoint *vertex, int32_t along, int32_t across)
+{
+    cc_VertexPoint newEdgePoint;
+
+    for (int32_t i = 0; i < 3; ++i) {
+        const float v = vertex[0].array[i] + vertex[along].array[i];
+        const float w = vertex[-across].array[i]
+                      + vertex[along - across].array[i]
+                      + vertex[across].array[i]
+                      + vertex[along + across].array[i];
+
+        newEdgePoint.array[i] = v * (3.0f / 8.0f) + w * (1.0f / 16.0f);
+    }
+
+    return newEdgePoint;
+}
+
+static cc_VertexPoint
+ccs__TileVertexPoint(const cc_VertexPoint *vertex, int32_t gridWidth)
+{
+    cc_VertexPoint newVertexPoint;
+
+    for (int32_t i = 0; i < 3; ++i) {
+        const float e = vertex[-1].array[i]
+                      + vertex[+1].array[i]
+                      + vertex[-gridWidth].array[i]
+                      + vertex[+gridWidth].array[i];
+        const float f = vertex[-1 - gridWidth].array[i]
+                      + vertex[+1 - gridWidth].array[i]
+                      + vertex[-1 + gridWidth].array[i]
+                      + vertex[+1 + gridWidth].array[i];
+
+        newVertexPoint.array[i] = vertex[0].array[i] * (9.0f / 16.0f)
+                                + e * (3.0f / 32.0f)
+                                + f * (1.0f / 64.0f);
+    }
+
+    return newVertexPoint;
+}
+
+static void
+ccs__TilePoints_Gather(cc_Subd *subd, const uint8_t *tileFlags, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t tileCount = ccm_HalfedgeCount(cage);
+    const int32_t tileHalfedgeCount = 1 << (2 * depth);
+    const int32_t gridWidth = (1 << (depth - 1)) + 1;
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const int32_t oldStride = ccs_CumulativeVertexCountAtDepth(cage, depth - 1);
+    const int32_t halfedgeStride = ccs_CumulativeHalfedgeCountAtDepth(cage, depth - 1);
+    const cc_Halfedge_SemiRegular *halfedges = &subd->halfedges[halfedgeStride];
+    const cc_VertexPoint *oldVertexPoints = &subd->vertexPoints[oldStride];
+    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    ccs__TileHalfedge *tileHalfedges;
+
+    // tiles at depth 1 are single quads
+    if (depth < 2) {
+        return;
+    }
+
+    tileHalfedges = ccs__CreateTileHalfedges(depth);
+
+CC_PARALLEL_FOR
+    for (int32_t tileID = 0; tileID < tileCount; ++tileID) {
+        const cc_Halfedge_SemiRegular *tile = &halfedges[tileID * tileHalfedgeCount];
+        cc_VertexPoint stackGrid[CC__TILE_STACK_SIZE * CC__TILE_STACK_SIZE];
+        cc_VertexPoint *grid = stackGrid;
+
+        // skipped tiles copy the parent points
+        if (tileFlags != NULL && !tileFlags[tileID]) {
+            for (int32_t halfedgeID = 0; halfedgeID < tileHalfedgeCount; ++halfedgeID) {
+                const int32_t flags = tileHalfedges[halfedgeID].flags;
+                const int32_t vertexID = tile[halfedgeID].vertexID;
+
+                if (flags & CC__TILE_VERTEX) {
+                    newVertexPoints[vertexID] = oldVertexPoints[vertexID];
+                }
+
+                if (flags & (CC__TILE_EDGE_X | CC__TILE_EDGE_Y)) {
+                    newEdgePoints[tile[halfedgeID].edgeID] = oldVertexPoints[vertexID];
+                }
+            }
+
+            continue;
+        }
+
+        if (gridWidth > CC__TILE_STACK_SIZE) {
+            const int32_t gridSize = gridWidth * gridWidth;
+
+            grid = (cc_VertexPoint *)CC_MALLOC(sizeof(*grid) * gridSize);
+        }
+
+        for (int32_t halfedgeID = 0; halfedgeID < tileHalfedgeCount; ++halfedgeID) {
+            const int32_t gridID = tileHalfedges[halfedgeID].gridID;
+
+            grid[gridID] = oldVertexPoints[tile[halfedgeID].vertexID];
+        }
+
+        for (int32_t halfedgeID = 0; halfedgeID < tileHalfedgeCount; ++halfedgeID) {
+            const int32_t flags = tileHalfedges[halfedgeID].flags;
+            const cc_VertexPoint *vertex = &grid[tileHalfedges[halfedgeID].gridID];
+
+            if (flags & CC__TILE_VERTEX) {
+                const int32_t vertexID = tile[halfedgeID].vertexID;
+
+                newVertexPoints[vertexID] = ccs__TileVertexPoint(vertex, gridWidth);
+            }
+
+            if (flags & CC__TILE_EDGE_X) {
+                const int32_t edgeID = tile[halfedgeID].edgeID;
+
+                newEdgePoints[edgeID] = ccs__TileEdgePoint(vertex, 1, gridWidth);
+            }
+
+            if (flags & CC__TILE_EDGE_Y) {
+                const int32_t edgeID = tile[halfedgeID].edgeID;
+
+                newEdgePoints[edgeID] = ccs__TileEdgePoint(vertex, gridWidth, 1);
+            }
+        }
+
+        if (grid != stackGrid) {
+            CC_FREE(grid);
+        }
+    }
+CC_BARRIER
+
+    CC_FREE(tileHalfedges);
+}
+
+#undef CC__TILE_VERTEX
+#undef CC__TILE_EDGE_X
+#undef CC__TILE_EDGE_Y
+#undef CC__TILE_STACK_SIZE
+
+
+/*******************************************************************************
+ * FacePoints -- Applies Catmull Clark's face rule on the subd
+ *
+ * The "Gather" routine iterates over each face of the mesh and compute the
+ * resulting face vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the face vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__FacePoint_Gather(const cc_Subd *subd, int32_t faceID, int32_t depth)
+{
+    const int32_t halfedgeID = ccs_FaceToHalfedgeID(subd, faceID, depth);
+    cc_VertexPoint newFacePoint = ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
+
+    for (int32_t halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeID, depth);
+                 halfedgeIt != halfedgeID;
+                 halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeIt, depth)) {
+        const cc_VertexPoint vertexPoint = ccs_HalfedgeVertexPoint(subd, halfedgeIt, depth);
+
+        cc__Add3f(newFacePoint.array, newFacePoint.array, vertexPoint.array);
+    }
+
+    cc__Mul3f(newFacePoint.array, newFacePoint.array, 0.25f);
+
+    return newFacePoint;
+}
+
+static void
+ccs__FacePoints_Gather(cc_Subd *subd, const uint8_t *tileFlags, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+
+CC_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        // the faces at depth d are the halfedges at depth d - 1
+        if (tileFlags != NULL && !tileFlags[faceID >> (2 * (depth - 1))]) {
+            const int32_t halfedgeID = ccs_FaceToHalfedgeID(subd, faceID, depth);
+
+            newFacePoints[faceID] = ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
+            continue;
+        }
+
+        newFacePoints[faceID] = ccs__FacePoint_Gather(subd, faceID, depth);
+    }
+CC_BARRIER
+}
+
+static void ccs__FacePoints_Scatter(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const cc_VertexPoint vertexPoint = ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
+        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
+        float *newFacePoint = newFacePoints[faceID].array;
+
+        for (int32_t i = 0; i < 3; ++i) {
+    CC_ATOMIC
+            newFacePoint[i]+= vertexPoint.array[i] / (float)4.0f;
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * EdgePoints -- Applies Catmull Clark's edge rule on the subd
+ *
+ * The "Gather" routine iterates over each edge on the border of the tiles
+ * (see TilePoints) and computes the resulting edge vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the edge vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__EdgePoint_Gather(
+    const cc_Subd *subd,
+    const cc_VertexPoint *newFacePoints,
+    int32_t edgeID,
+    int32_t depth
+) {
+    const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
+    const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+    const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
+    const float edgeWeight = twinID < 0 ? 0.0f : 1.0f;
+    const cc_VertexPoint oldEdgePoints[2] = {
+        ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
+        ccs_HalfedgeVertexPoint(subd,     nextID, depth)
+    };
+    const cc_VertexPoint newAdjacentFacePoints[2] = {
+        newFacePoints[ccs_HalfedgeFaceID(subd,         halfedgeID, depth)],
+        newFacePoints[ccs_HalfedgeFaceID(subd, cc__Max(0, twinID), depth)]
+    };
+    cc_VertexPoint newEdgePoint;
+    cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
+    float tmp1[3], tmp2[3];
+
+    cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
+    cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
+    cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
+    cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
+    cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
+    cc__Lerp3f(newEdgePoint.array,
+               sharpEdgePoint.array,
+               smoothEdgePoint.array,
+               edgeWeight);
+
+    return newEdgePoint;
+}
+
+static void ccs__EdgePoints_Gather(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t edgeCount = ccs__TileBorderEdgeCount(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        newEdgePoints[edgeID] = ccs__EdgePoint_Gather(subd,
+                                                      newFacePoints,
+                                                      edgeID,
+                                                      depth);
+    }
+CC_BARRIER
+}
+
+static void ccs__EdgePoints_Scatter(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
+        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        float tmp1[3], tmp2[3], tmp3[3], tmp4[3], atomicWeight[3];
+        float weight = twinID >= 0 ? 0.5f : 1.0f;
+
+        cc__Mul3f(tmp1, newFacePoint.array, 0.5f);
+        cc__Mul3f(tmp2, ccs_HalfedgeVertexPoint(subd, halfedgeID, depth).array, weight);
+        cc__Mul3f(tmp3, ccs_HalfedgeVertexPoint(subd,     nextID, depth).array, weight);
+        cc__Lerp3f(tmp4, tmp2, tmp3, 0.5f);
+        cc__Lerp3f(atomicWeight, tmp1, tmp4, weight);
+
+        for (int32_t i = 0; i < 3; ++i) {
+    CC_ATOMIC
+            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
+        }
+    }
+CC_BARRIER
+}
+
+/*******************************************************************************
+ * CreasedEdgePoints -- Applies DeRose et al's edge rule on the subd
+ *
+ * The "Gather" routine iterates over each edge on the border of the tiles
+ * (see TilePoints) and computes the resulting edge vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the edge vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__CreasedEdgePoint_Gather(
+    const cc_Subd *subd,
+    const cc_VertexPoint *newFacePoints,
+    int32_t edgeID,
+    int32_t depth
+) {
+    const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
+    const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+    const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
+    const float sharp = ccs_CreaseSharpness(subd, edgeID, depth);
+    const float edgeWeight = cc__Satf(sharp);
+    const cc_VertexPoint oldEdgePoints[2] = {
+        ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
+        ccs_HalfedgeVertexPoint(subd,     nextID, depth)
+    };
+    const cc_VertexPoint newAdjacentFacePoints[2] = {
+        newFacePoints[ccs_HalfedgeFaceID(subd,         halfedgeID, depth)],
+        newFacePoints[ccs_HalfedgeFaceID(subd, twinID >= 0 ? twinID : halfedgeID, depth)]
+    };
+    cc_VertexPoint newEdgePoint;
+    cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
+    float tmp1[3], tmp2[3];
+
+    cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
+    cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
+    cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
+    cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
+    cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
+    cc__Lerp3f(newEdgePoint.array,
+               smoothEdgePoint.array,
+               sharpEdgePoint.array,
+               edgeWeight);
+
+    return newEdgePoint;
+}
+
+static void
+ccs__CreasedEdgePoints_Gather(cc_Subd *subd, const uint8_t *tileFlags, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t edgeCount = ccs__TileBorderEdgeCount(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        if (tileFlags != NULL && !ccs__IsEdgeFlagged(subd, tileFlags, edgeID, depth)) {
+            const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
+
+            newEdgePoints[edgeID] = ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
+            continue;
+        }
+
+        newEdgePoints[edgeID] = ccs__CreasedEdgePoint_Gather(subd,
+                                                             newFacePoints,
+                                                             edgeID,
+                                                             depth);
+    }
+CC_BARRIER
+}
+
+
+static void ccs__CreasedEdgePoints_Scatter(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
+        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
+        const float sharp = ccs_CreaseSharpness(subd, edgeID, depth);
+        const float edgeWeight = cc__Satf(sharp);
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        const cc_VertexPoint oldEdgePoints[2] = {
+            ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
+            ccs_HalfedgeVertexPoint(subd,     nextID, depth)
+        };
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint sharpPoint = {0.0f, 0.0f, 0.0f};
+        float tmp[3], atomicWeight[3];
+
+        // sharp point
+        cc__Lerp3f(tmp, oldEdgePoints[0].array, oldEdgePoints[1].array, 0.5f);
+        cc__Mul3f(sharpPoint.array, tmp, twinID < 0 ? 1.0f : 0.5f);
+
+        // smooth point
+        cc__Lerp3f(tmp, oldEdgePoints[0].array, newFacePoint.array, 0.5f);
+        cc__Mul3f(smoothPoint.array, tmp, 0.5f);
+
+        // atomic weight
+        cc__Lerp3f(atomicWeight,
+                   smoothPoint.array,
+                   sharpPoint.array,
+                   edgeWeight);
+
+        for (int32_t i = 0; i < 3; ++i) {
+CC_ATOMIC
+            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * VertexPoints -- Applies Catmull Clark's vertex rule on the subd
+ *
+ * The "Gather" routine computes the resulting smooth vertex of a single vertex
+ * of the mesh (see ValenceBuckets).
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the smooth vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__VertexPoint_Gather(
+    const cc_Subd *subd,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    int32_t vertexID,
+    int32_t depth
+) {
+    const int32_t halfedgeID = ccs_VertexToHalfedgeID(subd, vertexID, depth);
+    const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+    const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
+    const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+    const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+    const cc_VertexPoint oldVertexPoint = ccs_VertexPoint(subd, vertexID, depth);
+    cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint newVertexPoint;
+    float valence = 1.0f;
+    int32_t iterator;
+    float tmp1[3], tmp2[3];
+
+    cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+    cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    for (iterator = ccs_PrevVertexHalfedgeID(subd, halfedgeID, depth);
+         iterator >= 0 && iterator != halfedgeID;
+         iterator = ccs_PrevVertexHalfedgeID(subd, iterator, depth)) {
+        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, iterator, depth);
+        const int32_t faceID = ccs_HalfedgeFaceID(subd, iterator, depth);
+        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+
+        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+        ++valence;
+    }
+
+    cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+    cc__Mul3f(tmp2, oldVertexPoint.array, 1.0f - 3.0f / valence);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+    cc__Lerp3f(newVertexPoint.array,
+               oldVertexPoint.array,
+               smoothPoint.array,
+               iterator != halfedgeID ? 0.0f : 1.0f);
+
+    return newVertexPoint;
+}
+
+
+static void ccs__VertexPoints_Scatter(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
+        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
+        const cc_VertexPoint oldVertexPoint = ccs_VertexPoint(subd, vertexID, depth);
+        int32_t valence = 1;
+        int32_t forwardIterator, backwardIterator;
+
+        for (forwardIterator = ccs_PrevVertexHalfedgeID(subd, halfedgeID, depth);
+             forwardIterator >= 0 && forwardIterator != halfedgeID;
+             forwardIterator = ccs_PrevVertexHalfedgeID(subd, forwardIterator, depth)) {
+            ++valence;
+        }
+
+        for (backwardIterator = ccs_NextVertexHalfedgeID(subd, halfedgeID, depth);
+             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+             backwardIterator = ccs_NextVertexHalfedgeID(subd, backwardIterator, depth)) {
+            ++valence;
+        }
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const float w = 1.0f / (float)valence;
+            const float v = oldVertexPoint.array[i];
+            const float f = newFacePoints[faceID].array[i];
+            const float e = newEdgePoints[edgeID].array[i];
+            const float s = forwardIterator < 0 ? 0.0f : 1.0f;
+CC_ATOMIC
+            newVertexPoints[vertexID].array[i]+=
+                w * (v + w * s * (4.0f * e - f - 3.0f * v));
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * ValenceBuckets -- Groups the vertices of the subd by valence
+ *
+ * Catmull Clark refinement preserves the valence of existing vertices, and
+ * inserts regular (valence 4) vertices only. As a result, all the irregular
+ * vertices of the subd have an ID within [0, V1), where V1 denotes the vertex
+ * count at depth 1, and their valence can be determined once from the cage.
+ * The routines below sort these vertices into buckets of valence 3 to 8
+ * (see CC__VALENCE_MAX) so that the vertex rule can be evaluated with a
+ * fixed one-ring trip count and precomputed weights; boundary vertices and
+ * vertices of lower or higher valence go to a generic bucket. Vertices beyond V1
+ * are always processed as regular vertices, and only those that lie on the
+ * border of a tile (see TilePoints) are processed here.
+ * Since the buckets only depend on the topology of the cage, they are built
+ * once and cached in the subd, which releases them.
+ *
+ */
+#define CC__VALENCE_MIN 3
+#define CC__VALENCE_MAX 8
+
+typedef struct {
+    const int32_t *offsets;     // bucket 0 stores generic vertices
+    const int32_t *vertexIDs;
+} ccs__ValenceBuckets;
+
+// smooth vertex weights {1 / n^2, 1 - 3 / n} for a valence n
+static const float ccs__SmoothVertexWeights[CC__VALENCE_MAX + 1][2] = {
+    {0.0f, 0.0f},
+    {0.0f, 0.0f},
+    {0.0f, 0.0f},
+    {1.0f /  9.0f, 1.0f - 3.0f / 3.0f},
+    {1.0f / 16.0f, 1.0f - 3.0f / 4.0f},
+    {1.0f / 25.0f, 1.0f - 3.0f / 5.0f},
+    {1.0f / 36.0f, 1.0f - 3.0f / 6.0f},
+    {1.0f / 49.0f, 1.0f - 3.0f / 7.0f},
+    {1.0f / 64.0f, 1.0f - 3.0f / 8.0f}
+};
+
+static int32_t ccs__BucketID(const cc_Mesh *cage, int32_t vertexID)
+{
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    int32_t valence = 1;
+
+    if /* [V + F, V + F + E) */ (vertexID >= vertexCount + faceCount) {
+        const int32_t edgeID = vertexID - vertexCount - faceCount;
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
+
+        return ccm_HalfedgeTwinID(cage, halfedgeID) < 0 ? 0 : 4;
+
+    } else if /* [V, V + F) */ (vertexID >= vertexCount) {
+        const int32_t faceID = vertexID - vertexCount;
+        const int32_t halfedgeID = ccm_FaceToHalfedgeID(cage, faceID);
+
+        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
+                     halfedgeIt != halfedgeID;
+                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+            ++valence;
+        }
+
+    } else /* [0, V) */ {
+        const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+        int32_t iterator;
+
+        for (iterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
+             iterator >= 0 && iterator != halfedgeID;
+             iterator = ccm_PrevVertexHalfedgeID(cage, iterator)) {
+            ++valence;
+        }
+
+        if (iterator < 0) {
+            return 0;
+        }
+    }
+
+    if (valence < CC__VALENCE_MIN || valence > CC__VALENCE_MAX) {
+        return 0;
+    }
+
+    return valence;
+}
+
+// returns the bucket offsets followed by the sorted vertex IDs
+static int32_t *ccs__CreateValenceBuckets(const cc_Mesh *cage)
+{
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, 1);
+    const int32_t offsetCount = CC__VALENCE_MAX + 2;
+    int32_t *bucketIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * vertexCount);
+    int32_t *buckets = (int32_t *)CC_MALLOC(sizeof(int32_t) * (offsetCount + vertexCount));
+    int32_t *offsets = buckets;
+    int32_t *vertexIDs = &buckets[offsetCount];
+    int32_t counts[CC__VALENCE_MAX + 1] = {0};
+
+CC_PARALLEL_FOR
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        bucketIDs[vertexID] = ccs__BucketID(cage, vertexID);
+    }
+CC_BARRIER
+
+    // counting sort
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        ++counts[bucketIDs[vertexID]];
+    }
+
+    offsets[0] = 0;
+    for (int32_t bucketID = 0; bucketID <= CC__VALENCE_MAX; ++bucketID) {
+        offsets[bucketID + 1] = offsets[bucketID] + counts[bucketID];
+        counts[bucketID] = offsets[bucketID];
+    }
+
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        vertexIDs[counts[bucketIDs[vertexID]]++] = vertexID;
+    }
+
+    CC_FREE(bucketIDs);
+
+    return buckets;
+}
+
+static ccs__ValenceBuckets ccs__GetValenceBuckets(cc_Subd *subd)
+{
+    ccs__ValenceBuckets buckets;
+
+    if (subd->valenceBuckets == NULL) {
+        subd->valenceBuckets = ccs__CreateValenceBuckets(subd->cage);
+    }
+
+    buckets.offsets = subd->valenceBuckets;
+    buckets.vertexIDs = &subd->valenceBuckets[CC__VALENCE_MAX + 2];
+
+    return buckets;
+}
+
+
+/*******************************************************************************
+ * RegularVertexPoints -- Applies Catmull Clark's vertex rule for a fixed valence
+ *
+ * The one-ring of each vertex is walked with a trip count that only depends
+ * on the valence; interior vertices are assumed. The routine is force-inlined
+ * and always called with a literal valence, so that each call site gets its
+ * own unrolled loop with constant weights.
+ *
+ */
+static CC__FORCE_INLINE cc_VertexPoint
+ccs__RegularVertexPoint(
+    const cc_Halfedge_SemiRegular *halfedges,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    const cc_VertexPoint *oldVertexPoint,
+    int32_t halfedgeID,
+    int32_t valence
+) {
+    const float *weights = ccs__SmoothVertexWeights[valence];
+    cc_VertexPoint newVertexPoint;
+    float smoothPoint[3] = {0.0f, 0.0f, 0.0f};
+    float tmp1[3], tmp2[3];
+    int32_t iterator = halfedgeID;
+
+    for (int32_t i = 0; i < valence; ++i) {
+        const int32_t edgeID = halfedges[iterator].edgeID;
+        const int32_t faceID = ccm_HalfedgeFaceID_Quad(iterator);
+        const int32_t prevID = ccm_HalfedgePrevID_Quad(iterator);
+
+        cc__Mul3f(tmp1, newFacePoints[faceID].array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoints[edgeID].array, +4.0f);
+        cc__Add3f(smoothPoint, smoothPoint, tmp1);
+        cc__Add3f(smoothPoint, smoothPoint, tmp2);
+        iterator = halfedges[prevID].twinID;
+    }
+
+    cc__Mul3f(tmp1, smoothPoint, weights[0]);
+    cc__Mul3f(tmp2, oldVertexPoint->array, weights[1]);
+    cc__Add3f(newVertexPoint.array, tmp1, tmp2);
+
+    return newVertexPoint;
+}
+
+// stamps out one bucket kernel per valence
+#define CC__REGULAR_VERTEX_POINTS(valence)                                     \
+static void                                                                    \
+ccs__RegularVertexPoints_Valence##valence(                                     \
+    const cc_Subd *subd,                                                       \
+    const ccs__ValenceBuckets *buckets,                                        \
+    const cc_Halfedge_SemiRegular *halfedges,                                  \
+    const cc_VertexPoint *newFacePoints,                                       \
+    const cc_VertexPoint *newEdgePoints,                                       \
+    const cc_VertexPoint *oldVertexPoints,                                     \
+    cc_VertexPoint *newVertexPoints,                                           \
+    int32_t depth                                                              \
+) {                                                                            \
+    const int32_t begin = buckets->offsets[valence];                           \
+    const int32_t end = buckets->offsets[valence + 1];                         \
+                                                                               \
+CC_PARALLEL_FOR                                                                \
+    for (int32_t bucketIt = begin; bucketIt < end; ++bucketIt) {               \
+        const int32_t vertexID = buckets->vertexIDs[bucketIt];                 \
+        const int32_t halfedgeID =                                             \
+                ccs_VertexToHalfedgeID(subd, vertexID, depth);                 \
+                                                                               \
+        newVertexPoints[vertexID] =                                            \
+                ccs__RegularVertexPoint(halfedges,                             \
+                                        newFacePoints,                         \
+                                        newEdgePoints,                         \
+                                        &oldVertexPoints[vertexID],            \
+                                        halfedgeID,                            \
+                                        valence);                              \
+    }                                                                          \
+CC_BARRIER                                                                     \
+}
+
+CC__REGULAR_VERTEX_POINTS(3)
+CC__REGULAR_VERTEX_POINTS(4)
+CC__REGULAR_VERTEX_POINTS(5)
+CC__REGULAR_VERTEX_POINTS(6)
+CC__REGULAR_VERTEX_POINTS(7)
+CC__REGULAR_VERTEX_POINTS(8)
+
+#undef CC__REGULAR_VERTEX_POINTS
+
+static void
+ccs__VertexPoints_Gather_Valence(
+    cc_Subd *subd,
+    const ccs__ValenceBuckets *buckets,
+    int32_t depth
+) {
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const int32_t oldStride = ccs_CumulativeVertexCountAtDepth(cage, depth - 1);
+    const int32_t halfedgeStride = ccs_CumulativeHalfedgeCountAtDepth(cage, depth - 1);
+    const cc_Halfedge_SemiRegular *halfedges = &subd->halfedges[halfedgeStride];
+    const cc_VertexPoint *oldVertexPoints = &subd->vertexPoints[oldStride];
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+
+    // generic vertices
+    {
+        const int32_t begin = buckets->offsets[0];
+        const int32_t end = buckets->offsets[1];
+
+CC_PARALLEL_FOR
+        for (int32_t bucketIt = begin; bucketIt < end; ++bucketIt) {
+            const int32_t vertexID = buckets->vertexIDs[bucketIt];
+
+            newVertexPoints[vertexID] = ccs__VertexPoint_Gather(subd,
+                                                                newFacePoints,
+                                                                newEdgePoints,
+                                                                vertexID,
+                                                                depth);
+        }
+CC_BARRIER
+    }
+
+    // vertices of valence [3, 8]
+    ccs__RegularVertexPoints_Valence3(subd, buckets, halfedges, newFacePoints, newEdgePoints,
+                                      oldVertexPoints, newVertexPoints, depth);
+    ccs__RegularVertexPoints_Valence4(subd, buckets, halfedges, newFacePoints, newEdgePoints,
+                                      oldVertexPoints, newVertexPoints, depth);
+    ccs__RegularVertexPoints_Valence5(subd, buckets, halfedges, newFacePoints, newEdgePoints,
+                                      oldVertexPoints, newVertexPoints, depth);
+    ccs__RegularVertexPoints_Valence6(subd, buckets, halfedges, newFacePoints, newEdgePoints,
+                                      oldVertexPoints, newVertexPoints, depth);
+    ccs__RegularVertexPoints_Valence7(subd, buckets, halfedges, newFacePoints, newEdgePoints,
+                                      oldVertexPoints, newVertexPoints, depth);
+    ccs__RegularVertexPoints_Valence8(subd, buckets, halfedges, newFacePoints, newEdgePoints,
+                                      oldVertexPoints, newVertexPoints, depth);
+
+    // vertices inserted beyond depth 1 on the border of the tiles
+    // (valence 4, or boundary); the others are processed as tiles
+    for (int32_t rangeID = 1; rangeID < depth; ++rangeID) {
+        int32_t begin, end;
+
+        ccs__TileBorderVertexRange(cage, rangeID, &begin, &end);
+
+CC_PARALLEL_FOR
+        for (int32_t vertexID = begin; vertexID < end; ++vertexID) {
+            const int32_t halfedgeID = ccs_VertexToHalfedgeID(subd, vertexID, depth);
+            const int32_t prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
+
+            // boundary vertices map to the halfedge that follows the boundary
+            if (halfedges[prevID].twinID < 0) {
+                newVertexPoints[vertexID] = oldVertexPoints[vertexID];
+            } else {
+                newVertexPoints[vertexID] = ccs__RegularVertexPoint(halfedges,
+                                                                    newFacePoints,
+                                                                    newEdgePoints,
+                                                                    &oldVertexPoints[vertexID],
+                                                                    halfedgeID,
+                                                                    4);
+            }
+        }
+CC_BARRIER
+    }
+}
+
+#undef CC__VALENCE_MIN
+#undef CC__VALENCE_MAX
+
+
+/*******************************************************************************
+ * CreasedVertexPoints -- Applies DeRose et al.'s vertex rule on the subd
+ *
+ * The "Gather" routine iterates over each vertex on the border of the tiles
+ * (see TilePoints) and computes the resulting smooth vertex.
+ *
+ * The "Scatter" routine iterates over each halfedge of the mesh and atomically
+ * adds its contribution to the computation of the smooth vertex.
+ *
+ */
+static cc_VertexPoint
+ccs__CreasedVertexPoint_Gather(
+    const cc_Subd *subd,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    int32_t vertexID,
+    int32_t depth
+) {
+    const int32_t halfedgeID = ccs_VertexToHalfedgeID(subd, vertexID, depth);
+    const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+    const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
+    const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
+    const int32_t prevFaceID = ccs_HalfedgeFaceID(subd, prevID, depth);
+    const float thisS = ccs_HalfedgeSharpness(subd, halfedgeID, depth);
+    const float prevS = ccs_HalfedgeSharpness(subd,     prevID, depth);
+    const float creaseWeight = cc__Signf(thisS);
+    const float prevCreaseWeight = cc__Signf(prevS);
+    const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+    const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+    const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
+    const cc_VertexPoint oldPoint = ccs_VertexPoint(subd, vertexID, depth);
+    cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+    cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
+    float avgS = prevS;
+    float creaseCount = prevCreaseWeight;
+    float valence = 1.0f;
+    int32_t forwardIterator, backwardIterator;
+    cc_VertexPoint newVertexPoint;
+    float tmp1[3], tmp2[3];
+
+    // smooth contrib
+    cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
+    cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    // crease contrib
+    cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
+    cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+
+    for (forwardIterator = ccs_HalfedgeTwinID(subd, prevID, depth);
+         forwardIterator >= 0 && forwardIterator != halfedgeID;
+         forwardIterator = ccs_HalfedgeTwinID(subd, forwardIterator, depth)) {
+        const int32_t prevID = ccs_HalfedgePrevID(subd, forwardIterator, depth);
+        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
+        const int32_t prevFaceID = ccs_HalfedgeFaceID(subd, prevID, depth);
+        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+        const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
+        const float prevS = ccs_HalfedgeSharpness(subd, prevID, depth);
+        const float prevCreaseWeight = cc__Signf(prevS);
+
+        // smooth contrib
+        cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+        ++valence;
+
+        // crease contrib
+        cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
+        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        avgS+= prevS;
+        creaseCount+= prevCreaseWeight;
+
+        // next vertex halfedge
+        forwardIterator = prevID;
+    }
+
+    for (backwardIterator = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+         forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+         backwardIterator = ccs_HalfedgeTwinID(subd, backwardIterator, depth)) {
+        const int32_t nextID = ccs_HalfedgeNextID(subd, backwardIterator, depth);
+        const int32_t nextEdgeID = ccs_HalfedgeEdgeID(subd, nextID, depth);
+        const int32_t nextFaceID = ccs_HalfedgeFaceID(subd, nextID, depth);
+        const cc_VertexPoint newNextEdgePoint = newEdgePoints[nextEdgeID];
+        const cc_VertexPoint newNextFacePoint = newFacePoints[nextFaceID];
+        const float nextS = ccs_HalfedgeSharpness(subd, nextID, depth);
+        const float nextCreaseWeight = cc__Signf(nextS);
+
+        // smooth contrib
+        cc__Mul3f(tmp1, newNextFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newNextEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
+        ++valence;
+
+        // crease contrib
+        cc__Mul3f(tmp1, newNextEdgePoint.array, nextCreaseWeight);
+        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        avgS+= nextS;
+        creaseCount+= nextCreaseWeight;
+
+        // next vertex halfedge
+        backwardIterator = nextID;
+    }
+
+    // boundary corrections
+    if (forwardIterator < 0) {
+        cc__Mul3f(tmp1, newEdgePoint.array    , creaseWeight);
+        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        creaseCount+= creaseWeight;
+        ++valence;
+    }
+
+    // smooth point
+    cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
+    cc__Mul3f(tmp2, oldPoint.array, 1.0f - 3.0f / valence);
+    cc__Add3f(smoothPoint.array, tmp1, tmp2);
+
+    // crease point
+    cc__Mul3f(tmp1, creasePoint.array, 0.5f / creaseCount);
+    cc__Mul3f(tmp2, oldPoint.array, 0.5f);
+    cc__Add3f(creasePoint.array, tmp1, tmp2);
+
+    // proper vertex rule selection (TODO: make branchless)
+    if (creaseCount <= 1.0f) {
+        newVertexPoint = smoothPoint;
+    } else if (creaseCount >= 3.0f || valence == 2.0f) {
+        newVertexPoint = oldPoint;
+    } else {
+        cc__Lerp3f(newVertexPoint.array,
+                   oldPoint.array,
+                   creasePoint.array,
+                   cc__Satf(avgS * 0.5f));
+    }
+
+    return newVertexPoint;
+}
+
+static void
+ccs__CreasedVertexPoints_Gather(cc_Subd *subd, const uint8_t *tileFlags, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+
+    for (int32_t rangeID = 0; rangeID < depth; ++rangeID) {
+        int32_t begin, end;
+
+        ccs__TileBorderVertexRange(cage, rangeID, &begin, &end);
+
+CC_PARALLEL_FOR
+        for (int32_t vertexID = begin; vertexID < end; ++vertexID) {
+            if (tileFlags != NULL && !ccs__IsVertexFlagged(subd, tileFlags, vertexID, depth)) {
+                newVertexPoints[vertexID] = ccs_VertexPoint(subd, vertexID, depth);
+                continue;
+            }
+
+            newVertexPoints[vertexID] = ccs__CreasedVertexPoint_Gather(subd,
+                                                                       newFacePoints,
+                                                                       newEdgePoints,
+                                                                       vertexID,
+                                                                       depth);
+        }
+CC_BARRIER
+    }
+}
+
+
+static void ccs__CreasedVertexPoints_Scatter(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
+        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
+        const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
+        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
+        const float thisS = ccs_HalfedgeSharpness(subd, halfedgeID, depth);
+        const float prevS = ccs_HalfedgeSharpness(subd,     prevID, depth);
+        const float creaseWeight = cc__Signf(thisS);
+        const float prevCreaseWeight = cc__Signf(prevS);
+        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
+        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
+        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+        const cc_VertexPoint oldPoint = ccs_VertexPoint(subd, vertexID, depth);
+        cc_VertexPoint cornerPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
+        cc_VertexPoint atomicWeight = {0.0f, 0.0f, 0.0f};
+        float avgS = prevS;
+        float creaseCount = prevCreaseWeight;
+        float valence = 1.0f;
+        int32_t forwardIterator, backwardIterator;
+        float tmp1[3], tmp2[3];
+
+        for (forwardIterator = ccs_HalfedgeTwinID(subd, prevID, depth);
+             forwardIterator >= 0 && forwardIterator != halfedgeID;
+             forwardIterator = ccs_HalfedgeTwinID(subd, forwardIterator, depth)) {
+            const int32_t prevID = ccs_HalfedgePrevID(subd, forwardIterator, depth);
+            const float prevS = ccs_HalfedgeSharpness(subd, prevID, depth);
+            const float prevCreaseWeight = cc__Signf(prevS);
+
+            // valence computation
+            ++valence;
+
+            // crease computation
+            avgS+= prevS;
+            creaseCount+= prevCreaseWeight;
+
+            // next vertex halfedge
+            forwardIterator = prevID;
+        }
+
+        for (backwardIterator = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
+             backwardIterator = ccs_HalfedgeTwinID(subd, backwardIterator, depth)) {
+            const int32_t nextID = ccs_HalfedgeNextID(subd, backwardIterator, depth);
+            const float nextS = ccs_HalfedgeSharpness(subd, nextID, depth);
+            const float nextCreaseWeight = cc__Signf(nextS);
+
+            // valence computation
+            ++valence;
+
+            // crease computation
+            avgS+= nextS;
+            creaseCount+= nextCreaseWeight;
+
+            // next vertex halfedge
+            backwardIterator = nextID;
+        }
+
+        // corner point
+        cc__Mul3f(cornerPoint.array, oldPoint.array, 1.0f / valence);
+
+        // crease computation: V / 4
+        cc__Mul3f(tmp1, oldPoint.array, 0.25f * creaseWeight);
+        cc__Mul3f(tmp2, newEdgePoint.array, 0.25f * creaseWeight);
+        cc__Add3f(creasePoint.array, tmp1, tmp2);
+
+        // smooth computation: (4E - F + (n - 3) V) / N
+        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
+        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
+        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+        cc__Mul3f(tmp1, oldPoint.array, valence - 3.0f);
+        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
+        cc__Mul3f(smoothPoint.array,
+                  smoothPoint.array,
+                  1.0f / (valence * valence));
+
+        // boundary corrections
+        if (forwardIterator < 0) {
+            creaseCount+= creaseWeight;
+            ++valence;
+
+            cc__Mul3f(tmp1, oldPoint.array, 0.25f * prevCreaseWeight);
+            cc__Mul3f(tmp2, newPrevEdgePoint.array, 0.25f * prevCreaseWeight);
+            cc__Add3f(tmp1, tmp1, tmp2);
+            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        }
+
+        // atomicWeight (TODO: make branchless ?)
+        if (creaseCount >= 3.0f || valence == 2.0f) {
+            atomicWeight = cornerPoint;
+        } else if (creaseCount <= 1.0f) {
+            atomicWeight = smoothPoint;
+        } else {
+            cc__Lerp3f(atomicWeight.array,
+                       cornerPoint.array,
+                       creasePoint.array,
+                       cc__Satf(avgS * 0.5f));
+        }
+
+        for (int32_t i = 0; i < 3; ++i) {
+CC_ATOMIC
+            newVertexPoints[vertexID].array[i]+= atomicWeight.array[i];
+        }
+    }
+CC_BARRIER
+}
+
+
+
+/*******************************************************************************
+ * RefineVertexPoints -- Computes the result of Catmull Clark subdivision.
+ *
+ * The skinned variant deforms the cage vertices within the cage kernels rather
+ * than in a separate pass, so that the deformed cage is never written back to
+ * memory. Each vertex is skinned once per face, edge, and vertex rule that
+ * reads it, which trades arithmetic for bandwidth.
+ *
+ * The gather variants skip the descendants of the hole faces of the cage
+ * that do not support a visible face (see HoleTileFlags); the corresponding
+ * vertex points hold a copy of their parent point, i.e., a coarse
+ * approximation of the surface that callers should mask with the hole flags
+ * (see ccs_FaceIsHole).
+ *
+ */
+static void ccs__ClearVertexPoints(cc_Subd *subd)
+{
+    const int32_t vertexCount = ccs_CumulativeVertexCount(subd);
+    const size_t vertexByteCount = vertexCount * sizeof(cc_VertexPoint);
+
+    CC_MEMSET(subd->vertexPoints, 0, vertexByteCount);
+}
+
+CCDEF void ccs_RefineVertexPoints_Scatter(cc_Subd *subd)
+{
+    CC_ASSERT(subd->packedDepth > ccs_MaxDepth(subd) && "subd is packed");
+    ccs__ClearVertexPoints(subd);
+    ccs__CageFacePoints_Scatter(subd);
+    ccs__CreasedCageEdgePoints_Scatter(subd);
+    ccs__CreasedCageVertexPoints_Scatter(subd);
+
+    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
+        ccs__FacePoints_Scatter(subd, depth);
+        ccs__CreasedEdgePoints_Scatter(subd, depth);
+        ccs__CreasedVertexPoints_Scatter(subd, depth);
+    }
+}
+
+CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd)
+{
+    CC_ASSERT(subd->packedDepth > ccs_MaxDepth(subd) && "subd is packed");
+    ccs__ClearVertexPoints(subd);
+    ccs__CageFacePoints_Scatter(subd);
+    ccs__CageEdgePoints_Scatter(subd);
+    ccs__CageVertexPoints_Scatter(subd);
+
+    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
+        ccs__FacePoints_Scatter(subd, depth);
+        ccs__EdgePoints_Scatter(subd, depth);
+        ccs__VertexPoints_Scatter(subd, depth);
+    }
+}
+
+static void ccs__RefineVertexPoints_Gather(cc_Subd *subd, const cc_Skin *skin)
+{
+    CC_ASSERT(subd->packedDepth > ccs_MaxDepth(subd) && "subd is packed");
+    uint8_t *tileFlags = ccs__CreateHoleTileFlags(subd->cage);
+
+    ccs__CageFacePoints_Gather(subd, skin, tileFlags);
+    ccs__CreasedCageEdgePoints_Gather(subd, skin, tileFlags);
+    ccs__CreasedCageVertexPoints_Gather(subd, skin, tileFlags);
+
+    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
+        ccs__FacePoints_Gather(subd, tileFlags, depth);
+        ccs__CreasedEdgePoints_Gather(subd, tileFlags, depth);
+        ccs__TilePoints_Gather(subd, tileFlags, depth);
+        ccs__CreasedVertexPoints_Gather(subd, tileFlags, depth);
+    }
+
+    CC_FREE(tileFlags);
+}
+
+CCDEF void ccs_RefineVertexPoints_Gather(cc_Subd *subd)
+{
+    ccs__RefineVertexPoints_Gather(subd, NULL);
+}
+
+CCDEF void ccs_RefineVertexPoints_Skinned_Gather(cc_Subd *subd, const cc_Skin *skin)
+{
+    ccs__RefineVertexPoints_Gather(subd, skin);
+}
+
+CCDEF void ccs_RefineVertexPoints_NoCreases_Gather(cc_Subd *subd)
+{
+    CC_ASSERT(subd->packedDepth > ccs_MaxDepth(subd) && "subd is packed");
+    ccs__CageFacePoints_Gather(subd, NULL, NULL);
+    ccs__CageEdgePoints_Gather(subd);
+    ccs__CageVertexPoints_Gather(subd);
+
+    if (ccs_MaxDepth(subd) > 1) {
+        const ccs__ValenceBuckets buckets = ccs__GetValenceBuckets(subd);
+
+        for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
+            ccs__FacePoints_Gather(subd, NULL, depth);
+            ccs__EdgePoints_Gather(subd, depth);
+            ccs__TilePoints_Gather(subd, NULL, depth);
+            ccs__VertexPoints_Gather_Valence(subd, &buckets, depth);
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * RefineCageHalfedges -- Applies halfedge refinement rules on the cage mesh
+ *
+ * This routine computes the halfedges of the control cage after one subdivision
+ * step and stores them in the subd.
+ *
+ */
+static void ccs__RefineCageHalfedges(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t edgeCount = ccm_EdgeCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    cc_Halfedge_SemiRegular *halfedgesOut = subd->halfedges;
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
+        const int32_t prevTwinID = ccm_HalfedgeTwinID(cage, prevID);
+        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
+        const int32_t twinNextID =
+            twinID >= 0 ? ccm_HalfedgeNextID(cage, twinID) : -1;
+        cc_Halfedge_SemiRegular *newHalfedges[4] = {
+            &halfedgesOut[(4 * halfedgeID + 0)],
+            &halfedgesOut[(4 * halfedgeID + 1)],
+            &halfedgesOut[(4 * halfedgeID + 2)],
+            &halfedgesOut[(4 * halfedgeID + 3)]
+        };
+
+        // twinIDs
+        newHalfedges[0]->twinID = 4 * twinNextID + 3;
+        newHalfedges[1]->twinID = 4 * nextID     + 2;
+        newHalfedges[2]->twinID = 4 * prevID     + 1;
+        newHalfedges[3]->twinID = 4 * prevTwinID + 0;
+
+        // edgeIDs
+        newHalfedges[0]->edgeID = 2 * edgeID + (halfedgeID > twinID ? 0 : 1);
+        newHalfedges[1]->edgeID = 2 * edgeCount + halfedgeID;
+        newHalfedges[2]->edgeID = 2 * edgeCount + prevID;
+        newHalfedges[3]->edgeID = 2 * prevEdgeID + (prevID > prevTwinID ? 1 : 0);
+
+        // vertexIDs
+        newHalfedges[0]->vertexID = vertexID;
+        newHalfedges[1]->vertexID = vertexCount + faceCount + edgeID;
+        newHalfedges[2]->vertexID = vertexCount + faceID;
+        newHalfedges[3]->vertexID = vertexCount + faceCount + prevEdgeID;
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * RefineHalfedges -- Applies halfedge refinement on the subd
+ *
+ * This routine computes the halfedges of the next subd level.
+ *
+ */
+static void ccs__RefineHalfedges(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(cage, depth);
+    cc_Halfedge_SemiRegular *halfedgesOut = &subd->halfedges[stride];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+        const int32_t prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
+        const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+        const int32_t faceID = ccm_HalfedgeFaceID_Quad(halfedgeID);
+        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
+        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
+        const int32_t prevTwinID = ccs_HalfedgeTwinID(subd, prevID, depth);
+        const int32_t twinNextID = ccm_HalfedgeNextID_Quad(twinID);
+        cc_Halfedge_SemiRegular *newHalfedges[4] = {
+            &halfedgesOut[(4 * halfedgeID + 0)],
+            &halfedgesOut[(4 * halfedgeID + 1)],
+            &halfedgesOut[(4 * halfedgeID + 2)],
+            &halfedgesOut[(4 * halfedgeID + 3)]
+        };
+
+        // twinIDs
+        newHalfedges[0]->twinID = 4 * twinNextID + 3;
+        newHalfedges[1]->twinID = 4 * nextID     + 2;
+        newHalfedges[2]->twinID = 4 * prevID     + 1;
+        newHalfedges[3]->twinID = 4 * prevTwinID + 0;
+
+        // edgeIDs
+        newHalfedges[0]->edgeID = 2 * edgeID + (halfedgeID > twinID ? 0 : 1);
+        newHalfedges[1]->edgeID = 2 * edgeCount + halfedgeID;
+        newHalfedges[2]->edgeID = 2 * edgeCount + prevID;
+        newHalfedges[3]->edgeID = 2 * prevEdgeID + (prevID > prevTwinID ? 1 : 0);
+
+        // vertexIDs
+        newHalfedges[0]->vertexID = vertexID;
+        newHalfedges[1]->vertexID = vertexCount + faceCount + edgeID;
+        newHalfedges[2]->vertexID = vertexCount + faceID;
+        newHalfedges[3]->vertexID = vertexCount + faceCount + prevEdgeID;
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * RefineHalfedges
+ *
+ */
+CCDEF void ccs_RefineHalfedges(cc_Subd *subd)
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+
+    ccs__RefineCageHalfedges(subd);
+
+    for (int32_t depth = 1; depth < maxDepth; ++depth) {
+        ccs__RefineHalfedges(subd, depth);
+    }
+}
+
+
+#ifndef CC_DISABLE_UV
+/*******************************************************************************
+ * RefineCageVertexUvs -- Refines UVs of the cage mesh
+ *
+ * This routine computes the UVs of the control cage after one subdivision
+ * step and stores them in the subd. Note that since UVs are not linked to
+ * the topology of the mesh, we store the results of the UV computation
+ * within a dedicated per-halfedge stream.
+ *
+ */
+static void ccs__RefineCageVertexUvs(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    cc_VertexUv *uvsOut = subd->uvs;
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
+        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
+        const cc_VertexUv uv = ccm_HalfedgeVertexUv(cage, halfedgeID);
+        const cc_VertexUv nextUv = ccm_HalfedgeVertexUv(cage, nextID);
+        const cc_VertexUv prevUv = ccm_HalfedgeVertexUv(cage, prevID);
+        cc_VertexUv edgeUv, prevEdgeUv;
+        cc_VertexUv faceUv = uv;
+        int32_t m = 1;
+        cc_VertexUv *newUvs = &uvsOut[4 * halfedgeID];
+
+        cc__Lerp2f(edgeUv.array    , uv.array, nextUv.array, 0.5f);
+        cc__Lerp2f(prevEdgeUv.array, uv.array, prevUv.array, 0.5f);
+
+        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
+                     halfedgeIt != halfedgeID;
+                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
+            const cc_VertexUv uv = ccm_HalfedgeVertexUv(cage, halfedgeIt);
+
+            faceUv.u+= uv.array[0];
+            faceUv.v+= uv.array[1];
+            ++m;
+        }
+        faceUv.u/= (float)m;
+        faceUv.v/= (float)m;
+
+        newUvs[0] = uv;
+        newUvs[1] = edgeUv;
+        newUvs[2] = faceUv;
+        newUvs[3] = prevEdgeUv;
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * RefineVertexUvs -- Applies UV refinement on the subd
+ *
+ * This routine computes the UVs of the next subd level.
+ *
+ */
+static void ccs__RefineVertexUvs(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(cage, depth);
+    cc_VertexUv *uvsOut = &subd->uvs[stride];
+
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
+        const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+        const cc_VertexUv uv = ccs_HalfedgeVertexUv(subd, halfedgeID, depth);
+        const cc_VertexUv nextUv = ccs_HalfedgeVertexUv(subd, nextID, depth);
+        const cc_VertexUv prevUv = ccs_HalfedgeVertexUv(subd, prevID, depth);
+        cc_VertexUv edgeUv, prevEdgeUv;
+        cc_VertexUv faceUv = uv;
+        cc_VertexUv *newUvs = &uvsOut[4 * halfedgeID];
+
+        cc__Lerp2f(edgeUv.array    , uv.array, nextUv.array, 0.5f);
+        cc__Lerp2f(prevEdgeUv.array, uv.array, prevUv.array, 0.5f);
+
+        for (int32_t halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeID, depth);
+                     halfedgeIt != halfedgeID;
+                     halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeIt, depth)) {
+            const cc_VertexUv uv = ccs_HalfedgeVertexUv(subd, halfedgeIt, depth);
+
+            faceUv.u+= uv.array[0];
+            faceUv.v+= uv.array[1];
+        }
+        faceUv.u/= 4.0f;
+        faceUv.v/= 4.0f;
+
+        newUvs[0] = uv;
+        newUvs[1] = edgeUv;
+        newUvs[2] = faceUv;
+        newUvs[3] = prevEdgeUv;
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * RefineUvs
+ *
+ */
+CCDEF void ccs_RefineVertexUvs(cc_Subd *subd)
+{
+    if (ccm_UvCount(subd->cage) > 0) {
+        const int32_t maxDepth = ccs_MaxDepth(subd);
+
+        ccs__RefineCageVertexUvs(subd);
+
+        for (int32_t depth = 1; depth < maxDepth; ++depth) {
+            ccs__RefineVertexUvs(subd, depth);
+        }
+    }
+}
+#endif
+
+
+/*******************************************************************************
+ * RefineCageCreases -- Applies crease subdivision on the cage mesh
+ *
+ * This routine computes the creases of the control cage after one subdivision
+ * step and stores them in the subd.
+ *
+ */
+static void ccs__RefineCageCreases(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t edgeCount = ccm_EdgeCount(cage);
+    cc_Crease *creasesOut = subd->creases;
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t nextID = ccm_CreaseNextID(cage, edgeID);
+        const int32_t prevID = ccm_CreasePrevID(cage, edgeID);
+        const bool t1 = ccm_CreasePrevID(cage, nextID) == edgeID && nextID != edgeID;
+        const bool t2 = ccm_CreaseNextID(cage, prevID) == edgeID && prevID != edgeID;
+        const float thisS = 3.0f * ccm_CreaseSharpness(cage, edgeID);
+        const float nextS = ccm_CreaseSharpness(cage, nextID);
+        const float prevS = ccm_CreaseSharpness(cage, prevID);
+        cc_Crease *newCreases[2] = {
+            &creasesOut[(2 * edgeID + 0)],
+            &creasesOut[(2 * edgeID + 1)]
+        };
+
+        // next rule
+        newCreases[0]->nextID = 2 * edgeID + 1;
+        newCreases[1]->nextID = 2 * nextID + (t1 ? 0 : 1);
+
+        // prev rule
+        newCreases[0]->prevID = 2 * prevID + (t2 ? 1 : 0);
+        newCreases[1]->prevID = 2 * edgeID + 0;
+
+        // sharpness rule
+        newCreases[0]->sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
+        newCreases[1]->sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * RefineCreases -- Applies crease subdivision on the subd
+ *
+ * This routine computes the topology of the next subd level.
+ *
+ */
+static void ccs__RefineCreases(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t creaseCount = ccm_CreaseCountAtDepth(cage, depth);
+    const int32_t stride = ccs_CumulativeCreaseCountAtDepth(cage, depth);
+    cc_Crease *creasesOut = &subd->creases[stride];
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < creaseCount; ++edgeID) {
+        const int32_t nextID = ccs_CreaseNextID_Fast(subd, edgeID, depth);
+        const int32_t prevID = ccs_CreasePrevID_Fast(subd, edgeID, depth);
+        const bool t1 = ccs_CreasePrevID_Fast(subd, nextID, depth) == edgeID && nextID != edgeID;
+        const bool t2 = ccs_CreaseNextID_Fast(subd, prevID, depth) == edgeID && prevID != edgeID;
+        const float thisS = 3.0f * ccs_CreaseSharpness_Fast(subd, edgeID, depth);
+        const float nextS = ccs_CreaseSharpness_Fast(subd, nextID, depth);
+        const float prevS = ccs_CreaseSharpness_Fast(subd, prevID, depth);
+        cc_Crease *newCreases[2] = {
+            &creasesOut[(2 * edgeID + 0)],
+            &creasesOut[(2 * edgeID + 1)]
+        };
+
+        // next rule
+        newCreases[0]->nextID = 2 * edgeID + 1;
+        newCreases[1]->nextID = 2 * nextID + (t1 ? 0 : 1);
+
+        // prev rule
+        newCreases[0]->prevID = 2 * prevID + (t2 ? 1 : 0);
+        newCreases[1]->prevID = 2 * edgeID + 0;
+
+        // sharpness rule
+        newCreases[0]->sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
+        newCreases[1]->sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * RefineCreases
+ *
+ */
+CCDEF void ccs_RefineCreases(cc_Subd *subd)
+{
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+
+    ccs__RefineCageCreases(subd);
+
+    for (int32_t depth = 1; depth < maxDepth; ++depth) {
+        ccs__RefineCreases(subd, depth);
+    }
+}
+
+
+/*******************************************************************************
+ * Refine -- Computes and stores the result of Catmull Clark subdivision.
+ *
+ * The subdivision is computed down to the maxDepth parameter.
+ *
+ */
+static void ccs__RefineTopology(cc_Subd *subd)
+{
+    ccs_RefineHalfedges(subd);
+    ccs_RefineCreases(subd);
+#ifndef CC_DISABLE_UV
+    ccs_RefineVertexUvs(subd);
+#endif
+}
+
+CCDEF void ccs_Refine_Scatter(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_Scatter(subd);
+}
+
+CCDEF void ccs_Refine_Gather(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_Gather(subd);
+}
+
+CCDEF void ccs_Refine_NoCreases_Scatter(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_NoCreases_Scatter(subd);
+}
+
+CCDEF void ccs_Refine_NoCreases_Gather(cc_Subd *subd)
+{
+    ccs__RefineTopology(subd);
+    ccs_RefineVertexPoints_NoCreases_Gather(subd);
+}
+
+
+/*******************************************************************************
+ * RefineCreaseList -- Updates a subd after sharpness edits on the cage
+ *
+ * These routines update a refined subd after the sharpness of a list of cage
+ * edges has changed; the topology of the cage, including its crease
+ * neighbors, must be left as is. The descendants of a cage edge at a given
+ * depth form the crease range [edgeID << depth, (edgeID + 1) << depth), and
+ * a crease is refined from its own sharpness and from that of its two
+ * neighbors, so that only the ranges of the edges that lie at most maxDepth
+ * crease neighbors away from the edited ones can change. The vertex points
+ * that depend on these creases lie within the cage faces that surround the
+ * endpoints of these edges: the tiles of these faces (see TilePoints) are
+ * recomputed level by level with the creased gather rules, and all other
+ * vertex points are left as is.
+ *
+ * ccs_RefineCreaseList must run before ccs_RefineVertexPointList_Gather.
+ *
+ */
+static int32_t
+ccs__CreaseListEdgeIDs(
+    const cc_Subd *subd,
+    const int32_t *editedEdgeIDs,
+    int32_t editedEdgeCount,
+    int32_t **edgeIDs
+) {
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t edgeCount = ccm_EdgeCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    const int32_t cageEdgeCount = ccm_EdgeCount(cage);
+    const int32_t hopCount = ccs_MaxDepth(subd);
+    uint8_t *hops = (uint8_t *)CC_MALLOC(cageEdgeCount);
+    int32_t edgeCount = 0;
 
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const float edgeWeight = twinID < 0 ? 0.0f : 1.0f;
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccm_HalfedgeVertexPoint(cage, halfedgeID),
-            ccm_HalfedgeVertexPoint(cage,     nextID)
-        };
-        const cc_VertexPoint newFacePointPair[2] = {
-            newFacePoints[ccm_HalfedgeFaceID(cage, halfedgeID)],
-            newFacePoints[ccm_HalfedgeFaceID(cage, cc__Max(0, twinID))]
-        };
-        float *newEdgePoint = newEdgePoints[edgeID].array;
-        cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
-        float tmp1[3], tmp2[3];
+    CC_MEMSET(hops, 0, cageEdgeCount);
 
-        cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
-        cc__Add3f(tmp2, newFacePointPair[0].array, newFacePointPair[1].array);
-        cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
-        cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
-        cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
-        cc__Lerp3f(newEdgePoint,
-                   sharpEdgePoint.array,
-                   smoothEdgePoint.array,
-                   edgeWeight);
+    for (int32_t i = 0; i < editedEdgeCount; ++i) {
+        hops[editedEdgeIDs[i]] = 1;
     }
-CC_BARRIER
+
+    // each level reads one more crease neighbor away from the edited edges,
+    // in either direction since neighborhoods need not be symmetric
+    for (int32_t hop = 1; hop <= hopCount; ++hop) {
+        for (int32_t edgeID = 0; edgeID < cageEdgeCount; ++edgeID) {
+            const int32_t nextID = ccm_CreaseNextID(cage, edgeID);
+            const int32_t prevID = ccm_CreasePrevID(cage, edgeID);
+
+            if (hops[edgeID] == hop) {
+                if (hops[nextID] == 0) hops[nextID] = hop + 1;
+                if (hops[prevID] == 0) hops[prevID] = hop + 1;
+            } else if (hops[edgeID] == 0 && (hops[nextID] == hop
+                                          || hops[prevID] == hop)) {
+                hops[edgeID] = hop + 1;
+            }
+        }
+    }
+
+    for (int32_t edgeID = 0; edgeID < cageEdgeCount; ++edgeID) {
+        edgeCount+= hops[edgeID] > 0 ? 1 : 0;
+    }
+
+    (*edgeIDs) = (int32_t *)CC_MALLOC(sizeof(int32_t) * cc__Max(1, edgeCount));
+
+    for (int32_t edgeID = 0, i = 0; edgeID < cageEdgeCount; ++edgeID) {
+        if (hops[edgeID] > 0) {
+            (*edgeIDs)[i++] = edgeID;
+        }
+    }
+
+    CC_FREE(hops);
+
+    return edgeCount;
 }
 
-static void ccs__CageEdgePoints_Scatter(cc_Subd *subd)
+CCDEF void
+ccs_RefineCreaseList(cc_Subd *subd, const int32_t *edgeIDs, int32_t edgeCount)
 {
     const cc_Mesh *cage = subd->cage;
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    int32_t *creaseIDs;
+    const int32_t creaseCount = ccs__CreaseListEdgeIDs(subd,
+                                                       edgeIDs,
+                                                       edgeCount,
+                                                       &creaseIDs);
+    cc_Crease *creasesOut = subd->creases;
 
 CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        float tmp1[3], tmp2[3], tmp3[3], tmp4[3], atomicWeight[3];
-        float weight = twinID >= 0 ? 0.5f : 1.0f;
+    for (int32_t i = 0; i < creaseCount; ++i) {
+        const int32_t edgeID = creaseIDs[i];
+        const int32_t nextID = ccm_CreaseNextID(cage, edgeID);
+        const int32_t prevID = ccm_CreasePrevID(cage, edgeID);
+        const float thisS = 3.0f * ccm_CreaseSharpness(cage, edgeID);
+        const float nextS = ccm_CreaseSharpness(cage, nextID);
+        const float prevS = ccm_CreaseSharpness(cage, prevID);
 
-        cc__Mul3f(tmp1, newFacePoint.array, 0.5f);
-        cc__Mul3f(tmp2, ccm_HalfedgeVertexPoint(cage, halfedgeID).array, weight);
-        cc__Mul3f(tmp3, ccm_HalfedgeVertexPoint(cage,     nextID).array, weight);
-        cc__Lerp3f(tmp4, tmp2, tmp3, 0.5f);
-        cc__Lerp3f(atomicWeight, tmp1, tmp4, weight);
+        creasesOut[2 * edgeID + 0].sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
+        creasesOut[2 * edgeID + 1].sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+    }
+CC_BARRIER
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
+    for (int32_t depth = 1; depth < maxDepth; ++depth) {
+        const int32_t rangeSize = 1 << depth;
+        const int32_t stride = ccs_CumulativeCreaseCountAtDepth(cage, depth);
+
+        creasesOut = &subd->creases[stride];
+
+CC_PARALLEL_FOR
+        for (int32_t i = 0; i < creaseCount * rangeSize; ++i) {
+            const int32_t edgeID = (creaseIDs[i >> depth] << depth) + (i & (rangeSize - 1));
+            const int32_t nextID = ccs_CreaseNextID_Fast(subd, edgeID, depth);
+            const int32_t prevID = ccs_CreasePrevID_Fast(subd, edgeID, depth);
+            const float thisS = 3.0f * ccs_CreaseSharpness_Fast(subd, edgeID, depth);
+            const float nextS = ccs_CreaseSharpness_Fast(subd, nextID, depth);
+            const float prevS = ccs_CreaseSharpness_Fast(subd, prevID, depth);
+
+            creasesOut[2 * edgeID + 0].sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
+            creasesOut[2 * edgeID + 1].sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
         }
-    }
 CC_BARRIER
+    }
+
+    CC_FREE(creaseIDs);
 }
 
 
 /*******************************************************************************
- * CreasedCageEdgePoints -- Applies DeRole et al.'s edge rule on the cage mesh
- *
- * The "Gather" routine iterates over each edge of the mesh and computes the
- * resulting edge vertex.
+ * RefineVertexPointList -- Recomputes the vertex points around edited creases
  *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the edge vertex.
+ * See RefineCreaseList. Each recomputed edge (resp. vertex) point is written
+ * by a single halfedge: the one of largest ID among those of the edge (resp.
+ * outgoing from the vertex) that belong to the recomputed tiles.
  *
  */
-static void ccs__CreasedCageEdgePoints_Gather(cc_Subd *subd)
+static int32_t
+ccs__TileTwinID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t edgeCount = ccm_EdgeCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    if (depth == 0) {
+        return ccm_HalfedgeTwinID(subd->cage, halfedgeID);
+    } else {
+        return ccs_HalfedgeTwinID(subd, halfedgeID, depth);
+    }
+}
 
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const float sharp = ccm_CreaseSharpness(cage, edgeID);
-        const float edgeWeight = cc__Satf(sharp);
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccm_HalfedgeVertexPoint(cage, halfedgeID),
-            ccm_HalfedgeVertexPoint(cage,     nextID)
-        };
-        const cc_VertexPoint newAdjacentFacePoints[2] = {
-            newFacePoints[ccm_HalfedgeFaceID(cage, halfedgeID)],
-            newFacePoints[ccm_HalfedgeFaceID(cage, cc__Max(0, twinID))]
-        };
-        cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
-        float tmp1[3], tmp2[3];
+static int32_t
+ccs__TileNextVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    if (depth == 0) {
+        return ccm_NextVertexHalfedgeID(subd->cage, halfedgeID);
+    } else {
+        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
 
-        cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
-        cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
-        cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
-        cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
-        cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
-        cc__Lerp3f(newEdgePoints[edgeID].array,
-                   smoothEdgePoint.array,
-                   sharpEdgePoint.array,
-                   edgeWeight);
+        return twinID >= 0 ? ccm_HalfedgeNextID_Quad(twinID) : -1;
     }
-CC_BARRIER
 }
 
-static void ccs__CreasedCageEdgePoints_Scatter(cc_Subd *subd)
+static int32_t
+ccs__TilePrevVertexHalfedgeID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t vertexCount = ccm_VertexCount(cage);
+    if (depth == 0) {
+        return ccm_PrevVertexHalfedgeID(subd->cage, halfedgeID);
+    } else {
+        return ccs_PrevVertexHalfedgeID(subd, halfedgeID, depth);
+    }
+}
+
+static bool
+ccs__IsTileEdgeWriter(
+    const cc_Subd *subd,
+    const uint8_t *tileFlags,
+    int32_t halfedgeID,
+    int32_t depth
+) {
+    const int32_t twinID = ccs__TileTwinID(subd, halfedgeID, depth);
+
+    return twinID < halfedgeID || !tileFlags[twinID >> (2 * depth)];
+}
+
+static bool
+ccs__IsTileVertexWriter(
+    const cc_Subd *subd,
+    const uint8_t *tileFlags,
+    int32_t halfedgeID,
+    int32_t depth
+) {
+    int32_t iterator;
+
+    for (iterator = ccs__TileNextVertexHalfedgeID(subd, halfedgeID, depth);
+         iterator >= 0 && iterator != halfedgeID;
+         iterator = ccs__TileNextVertexHalfedgeID(subd, iterator, depth)) {
+        if (iterator > halfedgeID && tileFlags[iterator >> (2 * depth)]) {
+            return false;
+        }
+    }
+
+    if (iterator < 0) {
+        for (iterator = ccs__TilePrevVertexHalfedgeID(subd, halfedgeID, depth);
+             iterator >= 0;
+             iterator = ccs__TilePrevVertexHalfedgeID(subd, iterator, depth)) {
+            if (iterator > halfedgeID && tileFlags[iterator >> (2 * depth)]) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void
+ccs__FlagVertexFaces(const cc_Mesh *cage, int32_t vertexID, uint8_t *tileFlags)
+{
+    const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+    int32_t iterator = halfedgeID;
+
+    // the vertex halfedge of a boundary vertex starts a full backward walk
+    do {
+        int32_t faceIterator = iterator;
+
+        do {
+            tileFlags[faceIterator] = 1;
+            faceIterator = ccm_HalfedgeNextID(cage, faceIterator);
+        } while (faceIterator != iterator);
+
+        iterator = ccm_PrevVertexHalfedgeID(cage, iterator);
+    } while (iterator >= 0 && iterator != halfedgeID);
+}
+
+static int32_t
+ccs__CreaseListTileIDs(
+    const cc_Mesh *cage,
+    const int32_t *edgeIDs,
+    int32_t edgeCount,
+    uint8_t **tileFlags,
+    int32_t **tileIDs
+) {
     const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    int32_t tileCount = 0;
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
+    (*tileFlags) = (uint8_t *)CC_MALLOC(halfedgeCount);
+    CC_MEMSET(*tileFlags, 0, halfedgeCount);
+
+    for (int32_t i = 0; i < edgeCount; ++i) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(cage, edgeIDs[i]);
         const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const float sharp = ccm_CreaseSharpness(cage, edgeID);
-        const float edgeWeight = cc__Satf(sharp);
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccm_HalfedgeVertexPoint(cage, halfedgeID),
-            ccm_HalfedgeVertexPoint(cage,     nextID)
-        };
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint sharpPoint = {0.0f, 0.0f, 0.0f};
-        float tmp[3], atomicWeight[3];
 
-        // sharp point
-        cc__Lerp3f(tmp, oldEdgePoints[0].array, oldEdgePoints[1].array, 0.5f);
-        cc__Mul3f(sharpPoint.array, tmp, twinID < 0 ? 1.0f : 0.5f);
+        ccs__FlagVertexFaces(cage, ccm_HalfedgeVertexID(cage, halfedgeID), *tileFlags);
+        ccs__FlagVertexFaces(cage, ccm_HalfedgeVertexID(cage, nextID), *tileFlags);
+    }
 
-        // smooth point
-        cc__Lerp3f(tmp, oldEdgePoints[0].array, newFacePoint.array, 0.5f);
-        cc__Mul3f(smoothPoint.array, tmp, 0.5f);
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        tileCount+= (*tileFlags)[halfedgeID];
+    }
 
-        // atomic weight
-        cc__Lerp3f(atomicWeight,
-                   smoothPoint.array,
-                   sharpPoint.array,
-                   edgeWeight);
+    (*tileIDs) = (int32_t *)CC_MALLOC(sizeof(int32_t) * cc__Max(1, tileCount));
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
+    for (int32_t halfedgeID = 0, i = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        if ((*tileFlags)[halfedgeID]) {
+            (*tileIDs)[i++] = halfedgeID;
+        }
+    }
+
+    return tileCount;
+}
+
+static void
+ccs__RefineTileVertexPoints_Gather(
+    cc_Subd *subd,
+    const uint8_t *tileFlags,
+    const int32_t *tileIDs,
+    int32_t tileCount
+) {
+    const cc_Mesh *cage = subd->cage;
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+
+    // cage level
+    {
+        const int32_t vertexCount = ccm_VertexCount(cage);
+        const int32_t faceCount = ccm_FaceCount(cage);
+        cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+        cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+        cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+
+CC_PARALLEL_FOR
+        for (int32_t i = 0; i < tileCount; ++i) {
+            const int32_t halfedgeID = tileIDs[i];
+            const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
+
+            if (ccm_FaceToHalfedgeID(cage, faceID) == halfedgeID) {
+                newFacePoints[faceID] = ccs__CageFacePoint_Gather(subd, NULL, faceID);
+            }
+        }
+CC_BARRIER
+
+CC_PARALLEL_FOR
+        for (int32_t i = 0; i < tileCount; ++i) {
+            const int32_t halfedgeID = tileIDs[i];
+
+            if (ccs__IsTileEdgeWriter(subd, tileFlags, halfedgeID, 0)) {
+                const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
+
+                newEdgePoints[edgeID] =
+                        ccs__CreasedCageEdgePoint_Gather(subd,
+                                                         NULL,
+                                                         newFacePoints,
+                                                         edgeID);
+            }
+        }
+CC_BARRIER
+
+CC_PARALLEL_FOR
+        for (int32_t i = 0; i < tileCount; ++i) {
+            const int32_t halfedgeID = tileIDs[i];
+
+            if (ccs__IsTileVertexWriter(subd, tileFlags, halfedgeID, 0)) {
+                const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
+
+                newVertexPoints[vertexID] =
+                        ccs__CreasedCageVertexPoint_Gather(subd,
+                                                           NULL,
+                                                           newFacePoints,
+                                                           newEdgePoints,
+                                                           vertexID);
+            }
+        }
+CC_BARRIER
+    }
+
+    for (int32_t depth = 1; depth < maxDepth; ++depth) {
+        const int32_t tileHalfedgeCount = 1 << (2 * depth);
+        const int32_t halfedgeCount = tileCount * tileHalfedgeCount;
+        const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+        const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+        const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+        cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+        cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+        cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+
+CC_PARALLEL_FOR
+        for (int32_t i = 0; i < halfedgeCount / 4; ++i) {
+            const int32_t tileID = tileIDs[(4 * i) >> (2 * depth)];
+            const int32_t halfedgeID = (tileID << (2 * depth)) + ((4 * i) & (tileHalfedgeCount - 1));
+            const int32_t faceID = ccm_HalfedgeFaceID_Quad(halfedgeID);
+
+            newFacePoints[faceID] = ccs__FacePoint_Gather(subd, faceID, depth);
+        }
+CC_BARRIER
+
+CC_PARALLEL_FOR
+        for (int32_t i = 0; i < halfedgeCount; ++i) {
+            const int32_t tileID = tileIDs[i >> (2 * depth)];
+            const int32_t halfedgeID = (tileID << (2 * depth)) + (i & (tileHalfedgeCount - 1));
+
+            if (ccs__IsTileEdgeWriter(subd, tileFlags, halfedgeID, depth)) {
+                const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
+
+                newEdgePoints[edgeID] = ccs__CreasedEdgePoint_Gather(subd,
+                                                                     newFacePoints,
+                                                                     edgeID,
+                                                                     depth);
+            }
+        }
+CC_BARRIER
+
+CC_PARALLEL_FOR
+        for (int32_t i = 0; i < halfedgeCount; ++i) {
+            const int32_t tileID = tileIDs[i >> (2 * depth)];
+            const int32_t halfedgeID = (tileID << (2 * depth)) + (i & (tileHalfedgeCount - 1));
+
+            if (ccs__IsTileVertexWriter(subd, tileFlags, halfedgeID, depth)) {
+                const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
+
+                newVertexPoints[vertexID] =
+                        ccs__CreasedVertexPoint_Gather(subd,
+                                                       newFacePoints,
+                                                       newEdgePoints,
+                                                       vertexID,
+                                                       depth);
+            }
         }
-    }
 CC_BARRIER
+    }
+}
+
+CCDEF void
+ccs_RefineVertexPointList_Gather(
+    cc_Subd *subd,
+    const int32_t *edgeIDs,
+    int32_t edgeCount
+) {
+    CC_ASSERT(subd->packedDepth > ccs_MaxDepth(subd) && "subd is packed");
+    const cc_Mesh *cage = subd->cage;
+    int32_t *creaseIDs, *tileIDs;
+    uint8_t *tileFlags;
+    const int32_t creaseCount = ccs__CreaseListEdgeIDs(subd,
+                                                       edgeIDs,
+                                                       edgeCount,
+                                                       &creaseIDs);
+    const int32_t tileCount = ccs__CreaseListTileIDs(cage,
+                                                     creaseIDs,
+                                                     creaseCount,
+                                                     &tileFlags,
+                                                     &tileIDs);
+
+    ccs__RefineTileVertexPoints_Gather(subd, tileFlags, tileIDs, tileCount);
+
+    CC_FREE(creaseIDs);
+    CC_FREE(tileIDs);
+    CC_FREE(tileFlags);
 }
 
 
 /*******************************************************************************
- * CageVertexPoints -- Applies Catmull Clark's vertex rule on the cage mesh
- *
- * The "Gather" routine iterates over each vertex of the mesh and computes the
- * resulting smooth vertex.
+ * DisplacedVertexPoints -- Offsets the deepest subd level by a displacement map
  *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the smooth vertex.
+ * The displacement is applied right after the last refinement step and reads
+ * nothing but the level above it, so that no normal or UV buffer is built and
+ * the deepest level is read and written back in a single pass. The pass runs
+ * over the halfedges of the parent level, each of which displaces the face,
+ * edge, and vertex points it is the writer of, sampled at the UV of its child
+ * halfedge in the UDIM tile that contains it. Scalar displacements follow the
+ * geometric normal of the parent level at the vertex, i.e., the normal of its
+ * parent face, or the area-weighted average normal of the faces around its
+ * parent edge or vertex. Only the face normals of the parent level are cached,
+ * which is a quarter of the size of the deepest level.
  *
  */
-static void ccs__CageVertexPoints_Gather(cc_Subd *subd)
+#ifndef CC_DISABLE_UV
+static int32_t cc__Floorf(float x)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+    const int32_t i = (int32_t)x;
 
-CC_PARALLEL_FOR
-    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
-        const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        float valence = 1.0f;
-        int32_t iterator;
-        float tmp1[3], tmp2[3];
+    return i - (x < (float)i ? 1 : 0);
+}
 
-        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+static void
+ccs__SampleDisplacement(
+    const cc_Displacement *displacement,
+    cc_VertexUv uv,
+    float *texel
+) {
+    const int32_t tileU = cc__Floorf(uv.u);
+    const int32_t tileV = cc__Floorf(uv.v);
+    const int32_t tileID = tileU + 10 * tileV;
+    const int32_t width = displacement->width;
+    const int32_t height = displacement->height;
+    const int32_t channelCount = displacement->channelCount;
+    const float *tile;
+    float x, y, tx, ty;
+    int32_t x0, y0, x1, y1;
+
+    for (int32_t i = 0; i < channelCount; ++i) {
+        texel[i] = 0.0f;
+    }
 
-        for (iterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
-             iterator >= 0 && iterator != halfedgeID;
-             iterator = ccm_PrevVertexHalfedgeID(cage, iterator)) {
-            const int32_t edgeID = ccm_HalfedgeEdgeID(cage, iterator);
-            const int32_t faceID = ccm_HalfedgeFaceID(cage, iterator);
-            const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-            const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+    if (tileU < 0 || tileU >= 10 || tileV < 0 || tileID >= displacement->tileCount) {
+        return;
+    }
 
-            cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-            cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
-            ++valence;
-        }
+    tile = displacement->tiles[tileID];
 
-        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
-        cc__Mul3f(tmp2, oldVertexPoint.array, 1.0f - 3.0f / valence);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-        cc__Lerp3f(newVertexPoints[vertexID].array,
-                   oldVertexPoint.array,
-                   smoothPoint.array,
-                   iterator != halfedgeID ? 0.0f : 1.0f);
+    if (tile == NULL) {
+        return;
+    }
+
+    // texel centers lie at half-integer coordinates
+    x = (uv.u - (float)tileU) * (float)width - 0.5f;
+    y = (uv.v - (float)tileV) * (float)height - 0.5f;
+    x0 = cc__Floorf(x);
+    y0 = cc__Floorf(y);
+    tx = x - (float)x0;
+    ty = y - (float)y0;
+    x1 = cc__Min(cc__Max(x0 + 1, 0), width - 1);
+    y1 = cc__Min(cc__Max(y0 + 1, 0), height - 1);
+    x0 = cc__Min(cc__Max(x0, 0), width - 1);
+    y0 = cc__Min(cc__Max(y0, 0), height - 1);
+
+    for (int32_t i = 0; i < channelCount; ++i) {
+        const float t00 = tile[channelCount * (y0 * width + x0) + i];
+        const float t10 = tile[channelCount * (y0 * width + x1) + i];
+        const float t01 = tile[channelCount * (y1 * width + x0) + i];
+        const float t11 = tile[channelCount * (y1 * width + x1) + i];
+        const float t0 = t00 + tx * (t10 - t00);
+        const float t1 = t01 + tx * (t11 - t01);
+
+        texel[i] = t0 + ty * (t1 - t0);
     }
-CC_BARRIER
 }
 
-static void ccs__CageVertexPoints_Scatter(cc_Subd *subd)
+static cc_VertexPoint
+ccs__TileHalfedgeVertexPoint(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    if (depth == 0) {
+        return ccm_HalfedgeVertexPoint(subd->cage, halfedgeID);
+    } else {
+        return ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
+    }
+}
+
+static int32_t
+ccs__TileHalfedgeNextID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    if (depth == 0) {
+        return ccm_HalfedgeNextID(subd->cage, halfedgeID);
+    } else {
+        return ccm_HalfedgeNextID_Quad(halfedgeID);
+    }
+}
+
+// Newell normal of the face of a halfedge (scaled by twice the face area)
+static cc_VertexPoint
+ccs__FaceNormal(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    cc_VertexPoint normal = {{0.0f, 0.0f, 0.0f}};
+    int32_t iterator = halfedgeID;
+
+    do {
+        const int32_t nextID = ccs__TileHalfedgeNextID(subd, iterator, depth);
+        const cc_VertexPoint p = ccs__TileHalfedgeVertexPoint(subd, iterator, depth);
+        const cc_VertexPoint q = ccs__TileHalfedgeVertexPoint(subd, nextID, depth);
+
+        normal.x+= (p.y - q.y) * (p.z + q.z);
+        normal.y+= (p.z - q.z) * (p.x + q.x);
+        normal.z+= (p.x - q.x) * (p.y + q.y);
+        iterator = nextID;
+    } while (iterator != halfedgeID);
+
+    return normal;
+}
+
+static int32_t
+ccs__TileHalfedgeFaceID(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
+{
+    if (depth == 0) {
+        return ccm_HalfedgeFaceID(subd->cage, halfedgeID);
+    } else {
+        return ccm_HalfedgeFaceID_Quad(halfedgeID);
+    }
+}
+
+static void
+ccs__DisplaceVertexPoint(
+    const cc_Subd *subd,
+    const cc_Displacement *displacement,
+    int32_t halfedgeID,
+    const float *normal,
+    float *vertexPoint
+) {
+    const cc_VertexUv uv = ccs_HalfedgeVertexUv(subd, halfedgeID, ccs_MaxDepth(subd));
+    float texel[3];
+
+    ccs__SampleDisplacement(displacement, uv, texel);
+
+    if (displacement->channelCount == 1) {
+        const float norm = CC_SQRTF(normal[0] * normal[0]
+                                    + normal[1] * normal[1]
+                                    + normal[2] * normal[2]);
+
+        cc__Mul3f(texel, normal, norm > 0.0f ? texel[0] / norm : 0.0f);
+    }
+
+    for (int32_t i = 0; i < 3; ++i) {
+        vertexPoint[i]+= displacement->scale * texel[i];
+    }
+}
+
+static void
+ccs__DisplaceVertexPoints(cc_Subd *subd, const cc_Displacement *displacement)
 {
     const cc_Mesh *cage = subd->cage;
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+    const int32_t depth = ccs_MaxDepth(subd);
+    const int32_t parentDepth = depth - 1;
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, parentDepth);
+    const int32_t vertexCount = ccm_VertexCountAtDepth(cage, parentDepth);
+    const int32_t faceCount = ccm_FaceCountAtDepth(cage, parentDepth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, parentDepth);
+    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+    cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    cc_VertexPoint *faceNormals =
+            (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint) * faceCount);
+
+    // the face normals of the parent level are small enough to be cached
+CC_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        const int32_t halfedgeID = parentDepth == 0
+                                 ? ccm_FaceToHalfedgeID(cage, faceID)
+                                 : ccm_FaceToHalfedgeID_Quad(faceID);
+
+        faceNormals[faceID] = ccs__FaceNormal(subd, halfedgeID, parentDepth);
+    }
+CC_BARRIER
 
+    // each parent halfedge displaces the points it is the writer of
 CC_PARALLEL_FOR
     for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const cc_VertexPoint oldVertexPoint = ccm_VertexPoint(cage, vertexID);
-        int32_t valence = 1;
-        int32_t forwardIterator, backwardIterator;
+        const int32_t twinID = ccs__TileTwinID(subd, halfedgeID, parentDepth);
+        const int32_t faceID = ccs__TileHalfedgeFaceID(subd, halfedgeID, parentDepth);
+        const int32_t vertexID = parentDepth == 0
+                               ? ccm_HalfedgeVertexID(cage, halfedgeID)
+                               : ccs_HalfedgeVertexID(subd, halfedgeID, parentDepth);
+        const bool isFaceWriter = parentDepth == 0
+                                ? ccm_FaceToHalfedgeID(cage, faceID) == halfedgeID
+                                : (halfedgeID & 3) == 0;
+        const float *faceNormal = faceNormals[faceID].array;
+        int32_t iterator;
+        float normal[3];
+
+        if /* face point */ (isFaceWriter) {
+            ccs__DisplaceVertexPoint(subd,
+                                     displacement,
+                                     4 * halfedgeID + 2,
+                                     faceNormal,
+                                     newFacePoints[faceID].array);
+        }
 
-        for (forwardIterator = ccm_PrevVertexHalfedgeID(cage, halfedgeID);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccm_PrevVertexHalfedgeID(cage, forwardIterator)) {
-            ++valence;
+        if /* edge point */ (twinID < halfedgeID) {
+            const int32_t edgeID = parentDepth == 0
+                                 ? ccm_HalfedgeEdgeID(cage, halfedgeID)
+                                 : ccs_HalfedgeEdgeID(subd, halfedgeID, parentDepth);
+
+            CC_MEMCPY(normal, faceNormal, sizeof(normal));
+
+            if (twinID >= 0) {
+                const int32_t twinFaceID =
+                        ccs__TileHalfedgeFaceID(subd, twinID, parentDepth);
+
+                cc__Add3f(normal, normal, faceNormals[twinFaceID].array);
+            }
+
+            ccs__DisplaceVertexPoint(subd,
+                                     displacement,
+                                     4 * halfedgeID + 1,
+                                     normal,
+                                     newEdgePoints[edgeID].array);
         }
 
-        for (backwardIterator = ccm_NextVertexHalfedgeID(cage, halfedgeID);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccm_NextVertexHalfedgeID(cage, backwardIterator)) {
-            ++valence;
+        // vertex point (written by the largest halfedge of the ring)
+        CC_MEMCPY(normal, faceNormal, sizeof(normal));
+
+        for (iterator = ccs__TileNextVertexHalfedgeID(subd, halfedgeID, parentDepth);
+             iterator >= 0 && iterator < halfedgeID;
+             iterator = ccs__TileNextVertexHalfedgeID(subd, iterator, parentDepth)) {
+            const int32_t faceID = ccs__TileHalfedgeFaceID(subd, iterator, parentDepth);
+
+            cc__Add3f(normal, normal, faceNormals[faceID].array);
         }
 
-        for (int32_t i = 0; i < 3; ++i) {
-            const float w = 1.0f / (float)valence;
-            const float v = oldVertexPoint.array[i];
-            const float f = newFacePoints[faceID].array[i];
-            const float e = newEdgePoints[edgeID].array[i];
-            const float s = forwardIterator < 0 ? 0.0f : 1.0f;
-CC_ATOMIC
-            newVertexPoints[vertexID].array[i]+=
-                w * (v + w * s * (4.0f * e - f - 3.0f * v));
+        if (iterator > halfedgeID) {
+            continue;
         }
+
+        if (iterator < 0) {
+            for (iterator = ccs__TilePrevVertexHalfedgeID(subd, halfedgeID, parentDepth);
+                 iterator >= 0 && iterator < halfedgeID;
+                 iterator = ccs__TilePrevVertexHalfedgeID(subd, iterator, parentDepth)) {
+                const int32_t faceID = ccs__TileHalfedgeFaceID(subd, iterator, parentDepth);
+
+                cc__Add3f(normal, normal, faceNormals[faceID].array);
+            }
+
+            if (iterator > halfedgeID) {
+                continue;
+            }
+        }
+
+        ccs__DisplaceVertexPoint(subd,
+                                 displacement,
+                                 4 * halfedgeID + 0,
+                                 normal,
+                                 newVertexPoints[vertexID].array);
     }
 CC_BARRIER
+
+    CC_FREE(faceNormals);
+}
+
+CCDEF void
+ccs_RefineVertexPoints_Displaced_Gather(
+    cc_Subd *subd,
+    const cc_Displacement *displacement
+) {
+    CC_ASSERT(ccs_MaxDepth(subd) > 0 && subd->uvs != NULL);
+    CC_ASSERT(displacement->channelCount == 1 || displacement->channelCount == 3);
+    ccs__RefineVertexPoints_Gather(subd, NULL);
+    ccs__DisplaceVertexPoints(subd, displacement);
 }
+#endif
 
 
 /*******************************************************************************
- * CreasedCageVertexPoints -- Applies DeRose et al.'s vertex rule on cage mesh
+ * Grow -- Extends a refined subd to a deeper maximum subdivision depth
  *
- * The "Gather" routine iterates over each vertex of the mesh and computes the
- * resulting smooth vertex.
+ * The buffers of the subd are reallocated (in place when the allocator
+ * allows it) and only the levels (oldMaxDepth, maxDepth] are refined; the
+ * existing levels are preserved as is and must be up to date. New vertex
+ * points are computed with the creased gather rules, i.e., they match those
+ * of ccs_Refine_Gather. A packed subd is unpacked first.
  *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the smooth vertex.
+ * Returns false if the counts at the requested depth do not fit in 32 bits
+ * or if an allocation fails; the subd is left valid at its former depth
+ * in that case.
  *
  */
-static void ccs__CreasedCageVertexPoints_Gather(cc_Subd *subd)
+static bool ccs__CountsFitInt32(const cc_Mesh *cage, int32_t depth)
+{
+    const int64_t H0 = ccm_HalfedgeCount(cage);
+    const int64_t E0 = ccm_EdgeCount(cage);
+    const int64_t H1 = H0 << 2;
+    const int64_t E1 = (E0 << 1) + H0;
+    const int64_t A = ((int64_t)1 << cc__Min(depth, 16)) - 1; // 2^{d} - 1
+
+    if (depth > 15) {
+        return false;
+    }
+
+    // largest intermediates of the cumulative count formulas
+    return H1 * A * (A + 2) <= INT32_MAX
+        && A * (6 * E1 + A * H1 - H1) <= INT32_MAX;
+}
+
+static void *
+ccs__ResizeBuffer(
+    void *buffer,
+    size_t elementByteSize,
+    int32_t oldCount,
+    int32_t newCount
+) {
+    return cc__Realloc(buffer,
+                       elementByteSize * oldCount,
+                       elementByteSize * newCount);
+}
+
+CCDEF bool ccs_Grow(cc_Subd *subd, int32_t maxDepth)
 {
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+    const int32_t oldMaxDepth = ccs_MaxDepth(subd);
+    uint8_t *tileFlags;
+    CC_ASSERT(maxDepth >= oldMaxDepth);
+    CC_ASSERT(subd->mappedData == NULL && "subd is file-backed");
 
-CC_PARALLEL_FOR
-    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
-        const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
-        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
-        const int32_t prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
-        const float thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
-        const float prevS = ccm_HalfedgeSharpness(cage,     prevID);
-        const float creaseWeight = cc__Signf(thisS);
-        const float prevCreaseWeight = cc__Signf(prevS);
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-        const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
-        const cc_VertexPoint oldPoint = ccm_VertexPoint(cage, vertexID);
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
-        float avgS = prevS;
-        float creaseCount = prevCreaseWeight;
-        float valence = 1.0f;
-        int32_t forwardIterator;
-        float tmp1[3], tmp2[3];
+    if (maxDepth == oldMaxDepth) {
+        return true;
+    }
 
-        // smooth contrib
-        cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+    if (!ccs__CountsFitInt32(cage, maxDepth)) {
+        CC_LOG("cc: subd counts overflow at depth %i", maxDepth);
 
-        // crease contrib
-        cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
-        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+        return false;
+    }
 
-        for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
-            const int32_t prevID = ccm_HalfedgePrevID(cage, forwardIterator);
-            const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
-            const int32_t prevFaceID = ccm_HalfedgeFaceID(cage, prevID);
-            const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-            const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
-            const float prevS = ccm_HalfedgeSharpness(cage, prevID);
-            const float prevCreaseWeight = cc__Signf(prevS);
+    ccs_UnpackVertexPoints(subd);
+
+    {
+        const int32_t oldHalfedgeCount =
+                ccs_CumulativeHalfedgeCountAtDepth(cage, oldMaxDepth);
+        const int32_t oldCreaseCount =
+                ccs_CumulativeCreaseCountAtDepth(cage, oldMaxDepth);
+        const int32_t oldVertexCount =
+                ccs_CumulativeVertexCountAtDepth(cage, oldMaxDepth);
+        const int32_t halfedgeCount =
+                ccs_CumulativeHalfedgeCountAtDepth(cage, maxDepth);
+        const int32_t creaseCount =
+                ccs_CumulativeCreaseCountAtDepth(cage, maxDepth);
+        const int32_t vertexCount =
+                ccs_CumulativeVertexCountAtDepth(cage, maxDepth);
+        cc_Halfedge_SemiRegular *halfedges = (cc_Halfedge_SemiRegular *)
+                ccs__ResizeBuffer(subd->halfedges,
+                                  sizeof(cc_Halfedge_SemiRegular),
+                                  oldHalfedgeCount,
+                                  halfedgeCount);
+        cc_Crease *creases = (cc_Crease *)
+                ccs__ResizeBuffer(subd->creases,
+                                  sizeof(cc_Crease),
+                                  oldCreaseCount,
+                                  creaseCount);
+        cc_VertexPoint *vertexPoints = (cc_VertexPoint *)
+                ccs__ResizeBuffer(subd->vertexPoints,
+                                  sizeof(cc_VertexPoint),
+                                  oldVertexCount,
+                                  vertexCount);
+        bool success = halfedges != NULL && creases != NULL && vertexPoints != NULL;
+
+        // buffers that did grow are kept: they remain valid at the old depth
+        if (halfedges != NULL) {
+            subd->halfedges = halfedges;
+        }
+        if (creases != NULL) {
+            subd->creases = creases;
+        }
+        if (vertexPoints != NULL) {
+            subd->vertexPoints = vertexPoints;
+        }
+#ifndef CC_DISABLE_UV
+        if (subd->uvs != NULL) {
+            cc_VertexUv *uvs = (cc_VertexUv *)
+                    ccs__ResizeBuffer(subd->uvs,
+                                      sizeof(cc_VertexUv),
+                                      oldHalfedgeCount,
+                                      halfedgeCount);
+
+            if (uvs != NULL) {
+                subd->uvs = uvs;
+            } else {
+                success = false;
+            }
+        }
+#endif
 
-            // smooth contrib
-            cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
-            cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
-            ++valence;
+        if (!success) {
+            CC_LOG("cc: subd allocation failed");
 
-            // crease contrib
-            cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-            avgS+= prevS;
-            creaseCount+= prevCreaseWeight;
+            return false;
+        }
+    }
+
+    subd->maxDepth = maxDepth;
+    subd->packedDepth = maxDepth + 1;
+
+    // topology
+    if (oldMaxDepth == 0) {
+        ccs__RefineCageHalfedges(subd);
+        ccs__RefineCageCreases(subd);
+#ifndef CC_DISABLE_UV
+        if (subd->uvs != NULL) {
+            ccs__RefineCageVertexUvs(subd);
+        }
+#endif
+    }
+
+    for (int32_t depth = cc__Max(1, oldMaxDepth); depth < maxDepth; ++depth) {
+        ccs__RefineHalfedges(subd, depth);
+        ccs__RefineCreases(subd, depth);
+#ifndef CC_DISABLE_UV
+        if (subd->uvs != NULL) {
+            ccs__RefineVertexUvs(subd, depth);
+        }
+#endif
+    }
+
+    // vertex points
+    tileFlags = ccs__CreateHoleTileFlags(cage);
+
+    if (oldMaxDepth == 0) {
+        ccs__CageFacePoints_Gather(subd, NULL, tileFlags);
+        ccs__CreasedCageEdgePoints_Gather(subd, NULL, tileFlags);
+        ccs__CreasedCageVertexPoints_Gather(subd, NULL, tileFlags);
+    }
+
+    for (int32_t depth = cc__Max(1, oldMaxDepth); depth < maxDepth; ++depth) {
+        ccs__FacePoints_Gather(subd, tileFlags, depth);
+        ccs__CreasedEdgePoints_Gather(subd, tileFlags, depth);
+        ccs__TilePoints_Gather(subd, tileFlags, depth);
+        ccs__CreasedVertexPoints_Gather(subd, tileFlags, depth);
+    }
+
+    CC_FREE(tileFlags);
+
+    return true;
+}
 
-            // next vertex halfedge
-            forwardIterator = prevID;
-        }
 
-        // boundary corrections
-        if (forwardIterator < 0) {
-            cc__Mul3f(tmp1, newEdgePoint.array    , creaseWeight);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-            creaseCount+= creaseWeight;
-            ++valence;
-        }
+/*******************************************************************************
+ * Shrink -- Frees the deepest levels of a subd
+ *
+ * The levels (maxDepth, oldMaxDepth] are dropped and the buffers are shrunk
+ * accordingly. Packed levels that are kept remain packed.
+ *
+ */
+CCDEF void ccs_Shrink(cc_Subd *subd, int32_t maxDepth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t oldMaxDepth = ccs_MaxDepth(subd);
+    CC_ASSERT(maxDepth > 0 && maxDepth <= oldMaxDepth);
+    CC_ASSERT(subd->mappedData == NULL && "subd is file-backed");
 
-        // smooth point
-        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
-        cc__Mul3f(tmp2, oldPoint.array, 1.0f - 3.0f / valence);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+    if (maxDepth == oldMaxDepth) {
+        return;
+    }
 
-        // crease point
-        cc__Mul3f(tmp1, creasePoint.array, 0.25f);
-        cc__Mul3f(tmp2, oldPoint.array, 0.5f);
-        cc__Add3f(creasePoint.array, tmp1, tmp2);
+    {
+        const int32_t oldHalfedgeCount =
+                ccs_CumulativeHalfedgeCountAtDepth(cage, oldMaxDepth);
+        const int32_t oldCreaseCount =
+                ccs_CumulativeCreaseCountAtDepth(cage, oldMaxDepth);
+        const int32_t halfedgeCount =
+                ccs_CumulativeHalfedgeCountAtDepth(cage, maxDepth);
+        const int32_t creaseCount =
+                ccs_CumulativeCreaseCountAtDepth(cage, maxDepth);
+        const int32_t vertexCount =
+                ccs_CumulativeVertexCountAtDepth(cage, maxDepth);
+        cc_Halfedge_SemiRegular *halfedges = (cc_Halfedge_SemiRegular *)
+                ccs__ResizeBuffer(subd->halfedges,
+                                  sizeof(cc_Halfedge_SemiRegular),
+                                  oldHalfedgeCount,
+                                  halfedgeCount);
+        cc_Crease *creases = (cc_Crease *)
+                ccs__ResizeBuffer(subd->creases,
+                                  sizeof(cc_Crease),
+                                  oldCreaseCount,
+                                  creaseCount);
+
+        // a failed shrink leaves the (larger) old buffer in place
+        if (halfedges != NULL) {
+            subd->halfedges = halfedges;
+        }
+        if (creases != NULL) {
+            subd->creases = creases;
+        }
+#ifndef CC_DISABLE_UV
+        if (subd->uvs != NULL) {
+            cc_VertexUv *uvs = (cc_VertexUv *)
+                    ccs__ResizeBuffer(subd->uvs,
+                                      sizeof(cc_VertexUv),
+                                      oldHalfedgeCount,
+                                      halfedgeCount);
+
+            if (uvs != NULL) {
+                subd->uvs = uvs;
+            }
+        }
+#endif
 
-        // proper vertex rule selection
-        if (creaseCount <= 1.0f) {
-            newVertexPoints[vertexID] = smoothPoint;
-        } else if (creaseCount >= 3.0f || valence == 2.0f) {
-            newVertexPoints[vertexID] = oldPoint;
+        if (subd->packedDepth > maxDepth) {
+            // the kept levels are all stored in the fp32 buffer
+            const int32_t oldVertexCount =
+                    ccs_CumulativeVertexCountAtDepth(cage, subd->packedDepth - 1);
+            cc_VertexPoint *vertexPoints = (cc_VertexPoint *)
+                    ccs__ResizeBuffer(subd->vertexPoints,
+                                      sizeof(cc_VertexPoint),
+                                      oldVertexCount,
+                                      vertexCount);
+
+            if (vertexPoints != NULL) {
+                subd->vertexPoints = vertexPoints;
+            }
+            CC_FREE(subd->packedVertexPoints);
+            subd->packedVertexPoints = NULL;
+            subd->packedFormat = CC_VERTEX_FORMAT_FP32;
+            subd->packedDepth = maxDepth + 1;
         } else {
-            cc__Lerp3f(newVertexPoints[vertexID].array,
-                       oldPoint.array,
-                       creasePoint.array,
-                       cc__Satf(avgS * 0.5f));
+            const int32_t keepCount =
+                    ccs_CumulativeVertexCountAtDepth(cage, subd->packedDepth - 1);
+            const int32_t oldVertexCount =
+                    ccs_CumulativeVertexCountAtDepth(cage, oldMaxDepth);
+            uint16_t *packed = (uint16_t *)
+                    ccs__ResizeBuffer(subd->packedVertexPoints,
+                                      3 * sizeof(uint16_t),
+                                      oldVertexCount - keepCount,
+                                      vertexCount - keepCount);
+
+            if (packed != NULL) {
+                subd->packedVertexPoints = packed;
+            }
         }
     }
-CC_BARRIER
-}
 
+    subd->maxDepth = maxDepth;
+}
 
-static void ccs__CreasedCageVertexPoints_Scatter(cc_Subd *subd)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    const cc_VertexPoint *oldVertexPoints = cage->vertexPoints;
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
-        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
-        const float thisS = ccm_HalfedgeSharpness(cage, halfedgeID);
-        const float prevS = ccm_HalfedgeSharpness(cage,     prevID);
-        const float creaseWeight = cc__Signf(thisS);
-        const float prevCreaseWeight = cc__Signf(prevS);
-        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldPoint = oldVertexPoints[vertexID];
-        cc_VertexPoint cornerPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint atomicWeight = {0.0f, 0.0f, 0.0f};
-        float avgS = prevS;
-        float creaseCount = prevCreaseWeight;
-        float valence = 1.0f;
-        int32_t forwardIterator, backwardIterator;
-        float tmp1[3], tmp2[3];
+/*******************************************************************************
+ * PackVertexPoints -- Stores the deepest subd levels in reduced precision
+ *
+ * The vertex points of the levels [minDepth, maxDepth] are converted to 16-bit
+ * per component and moved to a separate buffer; the fp32 buffer is shrunk so
+ * that it only holds the levels [1, minDepth). Packed levels remain readable
+ * through ccs_VertexPoint, which decodes on the fly. The UNORM16 format
+ * quantizes positions relative to the bounding box of the packed levels.
+ *
+ * Vertex refinement reads and writes the fp32 buffer directly, so the subd
+ * must be unpacked with ccs_UnpackVertexPoints before it is refined again.
+ *
+ */
+#define CC__PACK_BATCH_SIZE (3 * 512) // must be a multiple of 3
 
-        for (forwardIterator = ccm_HalfedgeTwinID(cage, prevID);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccm_HalfedgeTwinID(cage, forwardIterator)) {
-            const int32_t prevID = ccm_HalfedgePrevID(cage, forwardIterator);
-            const float prevS = ccm_HalfedgeSharpness(cage, prevID);
-            const float prevCreaseWeight = cc__Signf(prevS);
+static void ccs__ComputePackedBounds(cc_Subd *subd, const float *src, int32_t count)
+{
+    cc_VertexPoint *bounds = subd->packedBounds;
 
-            // valence computation
-            ++valence;
+    for (int32_t i = 0; i < 3; ++i) {
+        bounds[0].array[i] = +3.402823466e+38f;
+        bounds[1].array[i] = -3.402823466e+38f;
+    }
 
-            // crease computation
-            avgS+= prevS;
-            creaseCount+= prevCreaseWeight;
+    for (int32_t vertexID = 0; vertexID < count; ++vertexID) {
+        for (int32_t i = 0; i < 3; ++i) {
+            const float x = src[3 * vertexID + i];
 
-            // next vertex halfedge
-            forwardIterator = prevID;
+            bounds[0].array[i] = cc__Minf(bounds[0].array[i], x);
+            bounds[1].array[i] = cc__Maxf(bounds[1].array[i], x);
         }
+    }
+}
 
-        for (backwardIterator = ccm_HalfedgeTwinID(cage, halfedgeID);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccm_HalfedgeTwinID(cage, backwardIterator)) {
-            const int32_t nextID = ccm_HalfedgeNextID(cage, backwardIterator);
-            const float nextS = ccm_HalfedgeSharpness(cage, nextID);
-            const float nextCreaseWeight = cc__Signf(nextS);
+static void
+ccs__EncodeUnorm16Batch(
+    const cc_Subd *subd,
+    uint16_t *out,
+    const float *in,
+    int32_t count
+) {
+    const float *lo = subd->packedBounds[0].array;
+    const float *hi = subd->packedBounds[1].array;
+    float scale[3];
 
-            // valence computation
-            ++valence;
+    for (int32_t i = 0; i < 3; ++i) {
+        scale[i] = hi[i] > lo[i] ? 65535.0f / (hi[i] - lo[i]) : 0.0f;
+    }
 
-            // crease computation
-            avgS+= nextS;
-            creaseCount+= nextCreaseWeight;
+    for (int32_t j = 0; j < count; ++j) {
+        const int32_t i = j % 3;
+        const float u = cc__Maxf(0.0f, (in[j] - lo[i]) * scale[i]);
 
-            // next vertex halfedge
-            backwardIterator = nextID;
-        }
+        out[j] = (uint16_t)cc__Minf(u + 0.5f, 65535.0f);
+    }
+}
 
-        // corner point
-        cc__Mul3f(cornerPoint.array, oldPoint.array, 1.0f / valence);
+static void
+ccs__DecodeUnorm16Batch(
+    const cc_Subd *subd,
+    float *out,
+    const uint16_t *in,
+    int32_t count
+) {
+    const float *lo = subd->packedBounds[0].array;
+    const float *hi = subd->packedBounds[1].array;
 
-        // crease computation: V / 4
-        cc__Mul3f(tmp1, oldPoint.array, 0.25f * creaseWeight);
-        cc__Mul3f(tmp2, newEdgePoint.array, 0.25f * creaseWeight);
-        cc__Add3f(creasePoint.array, tmp1, tmp2);
+    for (int32_t j = 0; j < count; ++j) {
+        const int32_t i = j % 3;
+        const float u = (float)in[j] * (1.0f / 65535.0f);
 
-        // smooth computation: (4E - F + (n - 3) V) / N
-        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-        cc__Mul3f(tmp1, oldPoint.array, valence - 3.0f);
-        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-        cc__Mul3f(smoothPoint.array,
-                  smoothPoint.array,
-                  1.0f / (valence * valence));
+        out[j] = lo[i] + u * (hi[i] - lo[i]);
+    }
+}
 
-        // boundary corrections
-        if (forwardIterator < 0) {
-            creaseCount+= creaseWeight;
-            ++valence;
+CCDEF void
+ccs_PackVertexPoints(cc_Subd *subd, int32_t minDepth, cc_VertexFormat format)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t maxDepth = ccs_MaxDepth(subd);
+    CC_ASSERT(minDepth > 0 && minDepth <= maxDepth);
+    CC_ASSERT(subd->mappedData == NULL && "subd is file-backed");
 
-            cc__Mul3f(tmp1, oldPoint.array, 0.25f * prevCreaseWeight);
-            cc__Mul3f(tmp2, newPrevEdgePoint.array, 0.25f * prevCreaseWeight);
-            cc__Add3f(tmp1, tmp1, tmp2);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+    if (format == CC_VERTEX_FORMAT_FP32) {
+        ccs_UnpackVertexPoints(subd);
+        return;
+    }
+
+    // start back from a full fp32 buffer if the subd is already packed
+    ccs_UnpackVertexPoints(subd);
+
+    {
+        const int32_t keepCount = ccs_CumulativeVertexCountAtDepth(cage, minDepth - 1);
+        const int32_t packCount = ccs_CumulativeVertexCountAtDepth(cage, maxDepth)
+                                - keepCount;
+        const int32_t componentCount = 3 * packCount;
+        const int32_t batchCount =
+                (componentCount + CC__PACK_BATCH_SIZE - 1) / CC__PACK_BATCH_SIZE;
+        const float *src = subd->vertexPoints[keepCount].array;
+        uint16_t *packed =
+                (uint16_t *)CC_MALLOC(sizeof(uint16_t) * componentCount);
+        cc_VertexPoint *vertexPoints = NULL;
+
+        if (format == CC_VERTEX_FORMAT_UNORM16) {
+            ccs__ComputePackedBounds(subd, src, packCount);
         }
 
-        // atomicWeight (TODO: make branchless ?)
-        if (creaseCount <= 1.0f) {
-            atomicWeight = smoothPoint;
-        } else if (creaseCount >= 3.0f || valence == 2.0f) {
-            atomicWeight = cornerPoint;
-        } else {
-            cc__Lerp3f(atomicWeight.array,
-                       cornerPoint.array,
-                       creasePoint.array,
-                       cc__Satf(avgS * 0.5f));
+CC_PARALLEL_FOR
+        for (int32_t batchID = 0; batchID < batchCount; ++batchID) {
+            const int32_t begin = batchID * CC__PACK_BATCH_SIZE;
+            const int32_t end = cc__Min(begin + CC__PACK_BATCH_SIZE, componentCount);
+
+            if (format == CC_VERTEX_FORMAT_FP16) {
+                cc__FloatToHalfBatch(&packed[begin], &src[begin], end - begin);
+            } else {
+                ccs__EncodeUnorm16Batch(subd, &packed[begin], &src[begin], end - begin);
+            }
         }
+CC_BARRIER
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newVertexPoints[vertexID].array[i]+= atomicWeight.array[i];
+        if (keepCount > 0) {
+            const size_t byteCount = sizeof(cc_VertexPoint) * keepCount;
+
+            vertexPoints = (cc_VertexPoint *)CC_MALLOC(byteCount);
+            CC_MEMCPY(vertexPoints, subd->vertexPoints, byteCount);
         }
+
+        CC_FREE(subd->vertexPoints);
+        subd->vertexPoints = vertexPoints;
+        subd->packedVertexPoints = packed;
+        subd->packedFormat = format;
+        subd->packedDepth = minDepth;
     }
-CC_BARRIER
 }
 
 
 /*******************************************************************************
- * FacePoints -- Applies Catmull Clark's face rule on the subd
- *
- * The "Gather" routine iterates over each face of the mesh and compute the
- * resulting face vertex.
- *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the face vertex.
+ * UnpackVertexPoints -- Restores full-precision storage for all subd levels
  *
  */
-static void ccs__FacePoints_Gather(cc_Subd *subd, int32_t depth)
+CCDEF void ccs_UnpackVertexPoints(cc_Subd *subd)
 {
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-
-CC_PARALLEL_FOR
-    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
-        const int32_t halfedgeID = ccs_FaceToHalfedgeID(subd, faceID, depth);
-        cc_VertexPoint newFacePoint = ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
+    const int32_t maxDepth = ccs_MaxDepth(subd);
 
-        for (int32_t halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeIt, depth)) {
-            const cc_VertexPoint vertexPoint = ccs_HalfedgeVertexPoint(subd, halfedgeIt, depth);
+    if (subd->packedDepth > maxDepth) {
+        return;
+    }
 
-            cc__Add3f(newFacePoint.array, newFacePoint.array, vertexPoint.array);
+    {
+        const int32_t keepCount =
+                ccs_CumulativeVertexCountAtDepth(cage, subd->packedDepth - 1);
+        const int32_t vertexCount = ccs_CumulativeVertexCountAtDepth(cage, maxDepth);
+        const int32_t componentCount = 3 * (vertexCount - keepCount);
+        const int32_t batchCount =
+                (componentCount + CC__PACK_BATCH_SIZE - 1) / CC__PACK_BATCH_SIZE;
+        const size_t byteCount = sizeof(cc_VertexPoint) * vertexCount;
+        const uint16_t *packed = subd->packedVertexPoints;
+        cc_VertexPoint *vertexPoints = (cc_VertexPoint *)CC_MALLOC(byteCount);
+        float *dst = vertexPoints[keepCount].array;
+
+        if (keepCount > 0) {
+            CC_MEMCPY(vertexPoints,
+                      subd->vertexPoints,
+                      sizeof(cc_VertexPoint) * keepCount);
         }
 
-        cc__Mul3f(newFacePoint.array, newFacePoint.array, 0.25f);
+CC_PARALLEL_FOR
+        for (int32_t batchID = 0; batchID < batchCount; ++batchID) {
+            const int32_t begin = batchID * CC__PACK_BATCH_SIZE;
+            const int32_t end = cc__Min(begin + CC__PACK_BATCH_SIZE, componentCount);
+
+            if (subd->packedFormat == CC_VERTEX_FORMAT_FP16) {
+                cc__HalfToFloatBatch(&dst[begin], &packed[begin], end - begin);
+            } else {
+                ccs__DecodeUnorm16Batch(subd, &dst[begin], &packed[begin], end - begin);
+            }
+        }
+CC_BARRIER
 
-        newFacePoints[faceID] = newFacePoint;
+        CC_FREE(subd->vertexPoints);
+        CC_FREE(subd->packedVertexPoints);
+        subd->vertexPoints = vertexPoints;
+        subd->packedVertexPoints = NULL;
+        subd->packedFormat = CC_VERTEX_FORMAT_FP32;
+        subd->packedDepth = maxDepth + 1;
     }
-CC_BARRIER
 }
 
-static void ccs__FacePoints_Scatter(cc_Subd *subd, int32_t depth)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const cc_VertexPoint vertexPoint = ccs_HalfedgeVertexPoint(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        float *newFacePoint = newFacePoints[faceID].array;
+/*******************************************************************************
+ * VertexFormatAtDepth -- Returns the storage format of a given subd level
+ *
+ */
+CCDEF cc_VertexFormat
+ccs_VertexFormatAtDepth(const cc_Subd *subd, int32_t depth)
+{
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
 
-        for (int32_t i = 0; i < 3; ++i) {
-    CC_ATOMIC
-            newFacePoint[i]+= vertexPoint.array[i] / (float)4.0f;
-        }
-    }
-CC_BARRIER
+    return depth >= subd->packedDepth ? subd->packedFormat : CC_VERTEX_FORMAT_FP32;
 }
 
 
 /*******************************************************************************
- * EdgePoints -- Applies Catmull Clark's edge rule on the subd
+ * Bulk data accessors
  *
- * The "Gather" routine iterates over each edge of the mesh and compute the
- * resulting edge vertex.
- *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the edge vertex.
+ * These routines fill an output buffer with the data of a range or a list of
+ * vertices, halfedges, faces, or edges of a given subd level. Strides are
+ * resolved once per call, ranges of contiguous data are copied in one go, and
+ * list lookups prefetch CC__PREFETCH_DISTANCE elements ahead.
  *
  */
-static void ccs__EdgePoints_Gather(cc_Subd *subd, int32_t depth)
+#define CC__PREFETCH_DISTANCE 16
+
+static const cc_Halfedge_SemiRegular *
+ccs__Halfedges(const cc_Subd *subd, int32_t depth)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(subd->cage,
+                                                              depth - 1);
 
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-        const float edgeWeight = twinID < 0 ? 0.0f : 1.0f;
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
-            ccs_HalfedgeVertexPoint(subd,     nextID, depth)
-        };
-        const cc_VertexPoint newAdjacentFacePoints[2] = {
-            newFacePoints[ccs_HalfedgeFaceID(subd,         halfedgeID, depth)],
-            newFacePoints[ccs_HalfedgeFaceID(subd, cc__Max(0, twinID), depth)]
-        };
-        float *newEdgePoint = newEdgePoints[edgeID].array;
-        cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
-        float tmp1[3], tmp2[3];
+    return &subd->halfedges[stride];
+}
 
-        cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
-        cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
-        cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
-        cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
-        cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
-        cc__Lerp3f(newEdgePoint,
-                   sharpEdgePoint.array,
-                   smoothEdgePoint.array,
-                   edgeWeight);
-    }
+CCDEF void
+ccs_GetVertexPoints(
+    const cc_Subd *subd,
+    int32_t depth,
+    int32_t firstVertexID,
+    int32_t vertexCount,
+    cc_VertexPoint *vertexPoints
+) {
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    CC_ASSERT(firstVertexID >= 0 && vertexCount >= 0);
+    CC_ASSERT(firstVertexID + vertexCount
+              <= ccm_VertexCountAtDepth(subd->cage, depth));
+
+    if (depth >= subd->packedDepth) {
+        const uint16_t *packed =
+                &ccs__PackedVertexPoints(subd, depth)[3 * firstVertexID];
+        const int32_t componentCount = 3 * vertexCount;
+        const int32_t batchCount =
+                (componentCount + CC__PACK_BATCH_SIZE - 1) / CC__PACK_BATCH_SIZE;
+        float *dst = (float *)vertexPoints;
+
+CC_PARALLEL_FOR
+        for (int32_t batchID = 0; batchID < batchCount; ++batchID) {
+            const int32_t begin = batchID * CC__PACK_BATCH_SIZE;
+            const int32_t end = cc__Min(begin + CC__PACK_BATCH_SIZE, componentCount);
+
+            if (subd->packedFormat == CC_VERTEX_FORMAT_FP16) {
+                cc__HalfToFloatBatch(&dst[begin], &packed[begin], end - begin);
+            } else {
+                ccs__DecodeUnorm16Batch(subd, &dst[begin], &packed[begin], end - begin);
+            }
+        }
 CC_BARRIER
+    } else {
+        const int32_t stride = ccs_CumulativeVertexCountAtDepth(subd->cage,
+                                                                depth - 1);
+
+        CC_MEMCPY(vertexPoints,
+                  &subd->vertexPoints[stride + firstVertexID],
+                  sizeof(cc_VertexPoint) * vertexCount);
+    }
 }
 
-static void ccs__EdgePoints_Scatter(cc_Subd *subd, int32_t depth)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+CCDEF void
+ccs_GetVertexPointList(
+    const cc_Subd *subd,
+    int32_t depth,
+    const int32_t *vertexIDs,
+    int32_t vertexCount,
+    cc_VertexPoint *vertexPoints
+) {
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+
+    if (depth >= subd->packedDepth) {
+        const uint16_t *packed = ccs__PackedVertexPoints(subd, depth);
 
 CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        float tmp1[3], tmp2[3], tmp3[3], tmp4[3], atomicWeight[3];
-        float weight = twinID >= 0 ? 0.5f : 1.0f;
+        for (int32_t i = 0; i < vertexCount; ++i) {
+            if (i + CC__PREFETCH_DISTANCE < vertexCount) {
+                CC_PREFETCH(&packed[3 * vertexIDs[i + CC__PREFETCH_DISTANCE]]);
+            }
 
-        cc__Mul3f(tmp1, newFacePoint.array, 0.5f);
-        cc__Mul3f(tmp2, ccs_HalfedgeVertexPoint(subd, halfedgeID, depth).array, weight);
-        cc__Mul3f(tmp3, ccs_HalfedgeVertexPoint(subd,     nextID, depth).array, weight);
-        cc__Lerp3f(tmp4, tmp2, tmp3, 0.5f);
-        cc__Lerp3f(atomicWeight, tmp1, tmp4, weight);
+            vertexPoints[i] = ccs__DecodeVertexPoint(subd,
+                                                     &packed[3 * vertexIDs[i]]);
+        }
+CC_BARRIER
+    } else {
+        const int32_t stride = ccs_CumulativeVertexCountAtDepth(subd->cage,
+                                                                depth - 1);
+        const cc_VertexPoint *levelVertexPoints = &subd->vertexPoints[stride];
 
-        for (int32_t i = 0; i < 3; ++i) {
-    CC_ATOMIC
-            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
+CC_PARALLEL_FOR
+        for (int32_t i = 0; i < vertexCount; ++i) {
+            if (i + CC__PREFETCH_DISTANCE < vertexCount) {
+                CC_PREFETCH(&levelVertexPoints[vertexIDs[i + CC__PREFETCH_DISTANCE]]);
+            }
+
+            vertexPoints[i] = levelVertexPoints[vertexIDs[i]];
         }
-    }
 CC_BARRIER
+    }
 }
 
-/*******************************************************************************
- * CreasedEdgePoints -- Applies DeRose et al's edge rule on the subd
- *
- * The "Gather" routine iterates over each edge of the mesh and compute the
- * resulting edge vertex.
- *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the edge vertex.
- *
- */
-static void ccs__CreasedEdgePoints_Gather(cc_Subd *subd, int32_t depth)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride +vertexCount + faceCount];
+#ifndef CC_DISABLE_UV
+CCDEF void
+ccs_GetHalfedgeVertexUvs(
+    const cc_Subd *subd,
+    int32_t depth,
+    int32_t firstHalfedgeID,
+    int32_t halfedgeCount,
+    cc_VertexUv *vertexUvs
+) {
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    CC_ASSERT(firstHalfedgeID >= 0 && halfedgeCount >= 0);
+    CC_ASSERT(firstHalfedgeID + halfedgeCount
+              <= ccm_HalfedgeCountAtDepth(subd->cage, depth));
+    CC_ASSERT(subd->uvs != NULL && "subd has no uvs");
+    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(subd->cage,
+                                                              depth - 1);
+
+    CC_MEMCPY(vertexUvs,
+              &subd->uvs[stride + firstHalfedgeID],
+              sizeof(cc_VertexUv) * halfedgeCount);
+}
+
+CCDEF void
+ccs_GetHalfedgeVertexUvList(
+    const cc_Subd *subd,
+    int32_t depth,
+    const int32_t *halfedgeIDs,
+    int32_t halfedgeCount,
+    cc_VertexUv *vertexUvs
+) {
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    CC_ASSERT(subd->uvs != NULL && "subd has no uvs");
+    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(subd->cage,
+                                                              depth - 1);
+    const cc_VertexUv *levelUvs = &subd->uvs[stride];
 
 CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-        const float sharp = ccs_CreaseSharpness(subd, edgeID, depth);
-        const float edgeWeight = cc__Satf(sharp);
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
-            ccs_HalfedgeVertexPoint(subd,     nextID, depth)
-        };
-        const cc_VertexPoint newAdjacentFacePoints[2] = {
-            newFacePoints[ccs_HalfedgeFaceID(subd,         halfedgeID, depth)],
-            newFacePoints[ccs_HalfedgeFaceID(subd, cc__Max(0, twinID), depth)]
-        };
-        cc_VertexPoint sharpEdgePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothEdgePoint = {0.0f, 0.0f, 0.0f};
-        float tmp1[3], tmp2[3];
+    for (int32_t i = 0; i < halfedgeCount; ++i) {
+        if (i + CC__PREFETCH_DISTANCE < halfedgeCount) {
+            CC_PREFETCH(&levelUvs[halfedgeIDs[i + CC__PREFETCH_DISTANCE]]);
+        }
 
-        cc__Add3f(tmp1, oldEdgePoints[0].array, oldEdgePoints[1].array);
-        cc__Add3f(tmp2, newAdjacentFacePoints[0].array, newAdjacentFacePoints[1].array);
-        cc__Mul3f(sharpEdgePoint.array, tmp1, 0.5f);
-        cc__Add3f(smoothEdgePoint.array, tmp1, tmp2);
-        cc__Mul3f(smoothEdgePoint.array, smoothEdgePoint.array, 0.25f);
-        cc__Lerp3f(newEdgePoints[edgeID].array,
-                   smoothEdgePoint.array,
-                   sharpEdgePoint.array,
-                   edgeWeight);
+        vertexUvs[i] = levelUvs[halfedgeIDs[i]];
     }
 CC_BARRIER
 }
+#endif
 
-
-static void ccs__CreasedEdgePoints_Scatter(cc_Subd *subd, int32_t depth)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+CCDEF void
+ccs_GetFaceVertexIDs(
+    const cc_Subd *subd,
+    int32_t depth,
+    int32_t firstFaceID,
+    int32_t faceCount,
+    int32_t *vertexIDs
+) {
+    CC_ASSERT(firstFaceID >= 0 && faceCount >= 0);
+    CC_ASSERT(firstFaceID + faceCount <= ccm_FaceCountAtDepth(subd->cage, depth));
+    const cc_Halfedge_SemiRegular *halfedges =
+            &ccs__Halfedges(subd, depth)[4 * firstFaceID];
+    const int32_t halfedgeCount = 4 * faceCount;
 
 CC_PARALLEL_FOR
     for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const int32_t nextID = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-        const float sharp = ccs_CreaseSharpness(subd, edgeID, depth);
-        const float edgeWeight = cc__Satf(sharp);
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldEdgePoints[2] = {
-            ccs_HalfedgeVertexPoint(subd, halfedgeID, depth),
-            ccs_HalfedgeVertexPoint(subd,     nextID, depth)
-        };
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint sharpPoint = {0.0f, 0.0f, 0.0f};
-        float tmp[3], atomicWeight[3];
+        vertexIDs[halfedgeID] = halfedges[halfedgeID].vertexID;
+    }
+CC_BARRIER
+}
 
-        // sharp point
-        cc__Lerp3f(tmp, oldEdgePoints[0].array, oldEdgePoints[1].array, 0.5f);
-        cc__Mul3f(sharpPoint.array, tmp, twinID < 0 ? 1.0f : 0.5f);
+CCDEF void
+ccs_GetFaceVertexIDList(
+    const cc_Subd *subd,
+    int32_t depth,
+    const int32_t *faceIDs,
+    int32_t faceCount,
+    int32_t *vertexIDs
+) {
+    const cc_Halfedge_SemiRegular *halfedges = ccs__Halfedges(subd, depth);
 
-        // smooth point
-        cc__Lerp3f(tmp, oldEdgePoints[0].array, newFacePoint.array, 0.5f);
-        cc__Mul3f(smoothPoint.array, tmp, 0.5f);
+CC_PARALLEL_FOR
+    for (int32_t i = 0; i < faceCount; ++i) {
+        const int32_t halfedgeID = ccm_FaceToHalfedgeID_Quad(faceIDs[i]);
 
-        // atomic weight
-        cc__Lerp3f(atomicWeight,
-                   smoothPoint.array,
-                   sharpPoint.array,
-                   edgeWeight);
+        if (i + CC__PREFETCH_DISTANCE < faceCount) {
+            const int32_t faceID = faceIDs[i + CC__PREFETCH_DISTANCE];
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newEdgePoints[edgeID].array[i]+= atomicWeight[i];
+            CC_PREFETCH(&halfedges[ccm_FaceToHalfedgeID_Quad(faceID)]);
         }
+
+        for (int32_t j = 0; j < 4; ++j) {
+            vertexIDs[4 * i + j] = halfedges[halfedgeID + j].vertexID;
+        }
+    }
+CC_BARRIER
+}
+
+static void
+ccs__EdgeVertexIDs(
+    const cc_Subd *subd,
+    const cc_Halfedge_SemiRegular *halfedges,
+    int32_t edgeID,
+    int32_t depth,
+    int32_t *vertexIDs
+) {
+    const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
+    const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+
+    vertexIDs[0] = halfedges[halfedgeID].vertexID;
+    vertexIDs[1] = halfedges[nextID].vertexID;
+}
+
+CCDEF void
+ccs_GetEdgeVertexIDs(
+    const cc_Subd *subd,
+    int32_t depth,
+    int32_t firstEdgeID,
+    int32_t edgeCount,
+    int32_t *vertexIDs
+) {
+    CC_ASSERT(firstEdgeID >= 0 && edgeCount >= 0);
+    CC_ASSERT(firstEdgeID + edgeCount <= ccm_EdgeCountAtDepth(subd->cage, depth));
+    const cc_Halfedge_SemiRegular *halfedges = ccs__Halfedges(subd, depth);
+
+CC_PARALLEL_FOR
+    for (int32_t i = 0; i < edgeCount; ++i) {
+        ccs__EdgeVertexIDs(subd, halfedges, firstEdgeID + i, depth, &vertexIDs[2 * i]);
+    }
+CC_BARRIER
+}
+
+CCDEF void
+ccs_GetEdgeVertexIDList(
+    const cc_Subd *subd,
+    int32_t depth,
+    const int32_t *edgeIDs,
+    int32_t edgeCount,
+    int32_t *vertexIDs
+) {
+    const cc_Halfedge_SemiRegular *halfedges = ccs__Halfedges(subd, depth);
+
+CC_PARALLEL_FOR
+    for (int32_t i = 0; i < edgeCount; ++i) {
+        ccs__EdgeVertexIDs(subd, halfedges, edgeIDs[i], depth, &vertexIDs[2 * i]);
     }
 CC_BARRIER
 }
 
+#undef CC__PREFETCH_DISTANCE
+#undef CC__PACK_BATCH_SIZE
+
 
 /*******************************************************************************
- * VertexPoints -- Applies Catmull Clark's vertex rule on the subd
- *
- * The "Gather" routine iterates over each vertex of the mesh and computes the
- * resulting smooth vertex.
+ * HalfedgeTangents -- Computes tangent frames that follow the UVs of a subd level
  *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the smooth vertex.
+ * Tangents and bitangents are stored per halfedge, like UVs, so that UV seams
+ * get one frame per side. A first pass computes the UV gradient of each quad
+ * from its diagonals, weighted by its area in UV space. A second pass gathers,
+ * for each halfedge, the gradients of the faces around its vertex whose corner
+ * UV matches its own, so that no atomics are needed. Frames are normalized
+ * but not made orthogonal to the surface normal.
  *
  */
-static void ccs__VertexPoints_Gather(cc_Subd *subd, int32_t depth)
+#ifndef CC_DISABLE_UV
+#define CC__TANGENT_UV_EPSILON 1e-5f
+
+static bool cc__UvEqual(cc_VertexUv a, cc_VertexUv b)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+    const float du = a.u - b.u;
+    const float dv = a.v - b.v;
 
-CC_PARALLEL_FOR
-    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
-        const int32_t halfedgeID = ccs_VertexPointToHalfedgeID(subd, vertexID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldVertexPoint = ccs_VertexPoint(subd, vertexID, depth);
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        float valence = 1.0f;
-        int32_t iterator;
-        float tmp1[3], tmp2[3];
+    return du * du + dv * dv <= CC__TANGENT_UV_EPSILON * CC__TANGENT_UV_EPSILON;
+}
 
-        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
+static void cc__Normalize3f(float *x)
+{
+    const float norm = CC_SQRTF(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
 
-        for (iterator = ccs_PrevVertexHalfedgeID(subd, halfedgeID, depth);
-             iterator >= 0 && iterator != halfedgeID;
-             iterator = ccs_PrevVertexHalfedgeID(subd, iterator, depth)) {
-            const int32_t edgeID = ccs_HalfedgeEdgeID(subd, iterator, depth);
-            const int32_t faceID = ccs_HalfedgeFaceID(subd, iterator, depth);
-            const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-            const cc_VertexPoint newFacePoint = newFacePoints[faceID];
+    cc__Mul3f(x, x, norm > 0.0f ? 1.0f / norm : 0.0f);
+}
 
-            cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-            cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
-            ++valence;
-        }
+static void
+ccs__FaceTangents(
+    const cc_Subd *subd,
+    const cc_VertexUv *levelUvs,
+    int32_t faceID,
+    int32_t depth,
+    cc_VertexPoint *faceTangents
+) {
+    const int32_t firstID = ccm_FaceToHalfedgeID_Quad(faceID);
+    cc_VertexPoint points[4];
+    cc_VertexUv uvs[4];
+    float e1[3], e2[3], tmp1[3], tmp2[3], du1, dv1, du2, dv2, sign;
+
+    for (int32_t i = 0; i < 4; ++i) {
+        points[i] = ccs_HalfedgeVertexPoint(subd, firstID + i, depth);
+        uvs[i] = levelUvs[firstID + i];
+    }
 
-        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
-        cc__Mul3f(tmp2, oldVertexPoint.array, 1.0f - 3.0f / valence);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-        cc__Lerp3f(newVertexPoints[vertexID].array,
-                   oldVertexPoint.array,
-                   smoothPoint.array,
-                   iterator != halfedgeID ? 0.0f : 1.0f);
+    for (int32_t i = 0; i < 3; ++i) {
+        e1[i] = points[2].array[i] - points[0].array[i];
+        e2[i] = points[3].array[i] - points[1].array[i];
     }
-CC_BARRIER
+
+    du1 = uvs[2].u - uvs[0].u;
+    dv1 = uvs[2].v - uvs[0].v;
+    du2 = uvs[3].u - uvs[1].u;
+    dv2 = uvs[3].v - uvs[1].v;
+    sign = du1 * dv2 - du2 * dv1 < 0.0f ? -1.0f : 1.0f;
+
+    // tangent
+    cc__Mul3f(tmp1, e1, +sign * dv2);
+    cc__Mul3f(tmp2, e2, -sign * dv1);
+    cc__Add3f(faceTangents[0].array, tmp1, tmp2);
+
+    // bitangent
+    cc__Mul3f(tmp1, e2, +sign * du1);
+    cc__Mul3f(tmp2, e1, -sign * du2);
+    cc__Add3f(faceTangents[1].array, tmp1, tmp2);
 }
 
-static void ccs__VertexPoints_Scatter(cc_Subd *subd, int32_t depth)
-{
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+static void
+ccs__AddFaceTangents(
+    const cc_VertexPoint *faceTangents,
+    int32_t halfedgeID,
+    float *tangent,
+    float *bitangent
+) {
+    const int32_t faceID = ccm_HalfedgeFaceID_Quad(halfedgeID);
+
+    cc__Add3f(tangent, tangent, faceTangents[2 * faceID + 0].array);
+    cc__Add3f(bitangent, bitangent, faceTangents[2 * faceID + 1].array);
+}
+
+CCDEF void
+ccs_ComputeHalfedgeTangents(
+    const cc_Subd *subd,
+    int32_t depth,
+    cc_VertexPoint *tangents,
+    cc_VertexPoint *bitangents
+) {
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    CC_ASSERT(subd->uvs != NULL && "subd has no uvs");
+    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(subd->cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth(subd->cage, depth);
+    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(subd->cage,
+                                                              depth - 1);
+    const cc_VertexUv *levelUvs = &subd->uvs[stride];
+    cc_VertexPoint *faceTangents =
+            (cc_VertexPoint *)CC_MALLOC(2 * sizeof(cc_VertexPoint) * faceCount);
+
+CC_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        ccs__FaceTangents(subd, levelUvs, faceID, depth, &faceTangents[2 * faceID]);
+    }
+CC_BARRIER
 
 CC_PARALLEL_FOR
     for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const cc_VertexPoint oldVertexPoint = ccs_VertexPoint(subd, vertexID, depth);
-        int32_t valence = 1;
-        int32_t forwardIterator, backwardIterator;
+        const cc_VertexUv uv = levelUvs[halfedgeID];
+        float *tangent = tangents[halfedgeID].array;
+        float *bitangent = bitangents[halfedgeID].array;
+        int32_t iterator;
 
-        for (forwardIterator = ccs_PrevVertexHalfedgeID(subd, halfedgeID, depth);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccs_PrevVertexHalfedgeID(subd, forwardIterator, depth)) {
-            ++valence;
-        }
+        tangent[0] = tangent[1] = tangent[2] = 0.0f;
+        bitangent[0] = bitangent[1] = bitangent[2] = 0.0f;
+        ccs__AddFaceTangents(faceTangents, halfedgeID, tangent, bitangent);
 
-        for (backwardIterator = ccs_NextVertexHalfedgeID(subd, halfedgeID, depth);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccs_NextVertexHalfedgeID(subd, backwardIterator, depth)) {
-            ++valence;
+        for (iterator = ccs__TileNextVertexHalfedgeID(subd, halfedgeID, depth);
+             iterator >= 0 && iterator != halfedgeID;
+             iterator = ccs__TileNextVertexHalfedgeID(subd, iterator, depth)) {
+            if (cc__UvEqual(levelUvs[iterator], uv)) {
+                ccs__AddFaceTangents(faceTangents, iterator, tangent, bitangent);
+            }
         }
 
-        for (int32_t i = 0; i < 3; ++i) {
-            const float w = 1.0f / (float)valence;
-            const float v = oldVertexPoint.array[i];
-            const float f = newFacePoints[faceID].array[i];
-            const float e = newEdgePoints[edgeID].array[i];
-            const float s = forwardIterator < 0 ? 0.0f : 1.0f;
-CC_ATOMIC
-            newVertexPoints[vertexID].array[i]+=
-                w * (v + w * s * (4.0f * e - f - 3.0f * v));
+        if (iterator < 0) {
+            for (iterator = ccs__TilePrevVertexHalfedgeID(subd, halfedgeID, depth);
+                 iterator >= 0;
+                 iterator = ccs__TilePrevVertexHalfedgeID(subd, iterator, depth)) {
+                if (cc__UvEqual(levelUvs[iterator], uv)) {
+                    ccs__AddFaceTangents(faceTangents, iterator, tangent, bitangent);
+                }
+            }
         }
+
+        cc__Normalize3f(tangent);
+        cc__Normalize3f(bitangent);
     }
 CC_BARRIER
+
+    CC_FREE(faceTangents);
 }
 
+#undef CC__TANGENT_UV_EPSILON
+#endif
+
 
 /*******************************************************************************
- * CreasedVertexPoints -- Applies DeRose et al.'s vertex rule on the subd
+ * ExtractMesh -- Builds a standalone mesh from a level of a subd
  *
- * The "Gather" routine iterates over each vertex of the mesh and computes the
- * resulting smooth vertex.
- *
- * The "Scatter" routine iterates over each halfedge of the mesh and atomically
- * adds its contribution to the computation of the smooth vertex.
+ * The resulting mesh shares the vertex, halfedge, edge, and face IDs of the
+ * subd level, so it can be saved, edited, or used as the cage of another subd.
+ * Next, prev, and face IDs follow from quad arithmetic and twin, edge, and
+ * vertex IDs are copied (boundary twins being set to -1), so that no twin
+ * search is needed. Edges map to their halfedge of largest ID; vertices map to
+ * the halfedge selected by the subdivision rules (see VertexToHalfedgeID),
+ * except on boundaries, where they map to their outgoing boundary halfedge as
+ * for loaded meshes. Creases are copied, the edges created within faces being
+ * smooth, and UVs are stored per halfedge.
  *
  */
-static void ccs__CreasedVertexPoints_Gather(cc_Subd *subd, int32_t depth)
+static bool
+ccs__IsVertexHalfedge(const cc_Subd *subd, int32_t halfedgeID, int32_t depth)
 {
     const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
-
-CC_PARALLEL_FOR
-    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
-        const int32_t halfedgeID = ccs_VertexPointToHalfedgeID(subd, vertexID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
-        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
-        const int32_t prevFaceID = ccs_HalfedgeFaceID(subd, prevID, depth);
-        const float thisS = ccs_HalfedgeSharpness(subd, halfedgeID, depth);
-        const float prevS = ccs_HalfedgeSharpness(subd,     prevID, depth);
-        const float creaseWeight = cc__Signf(thisS);
-        const float prevCreaseWeight = cc__Signf(prevS);
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-        const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
-        const cc_VertexPoint oldPoint = ccs_VertexPoint(subd, vertexID, depth);
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
-        float avgS = prevS;
-        float creaseCount = prevCreaseWeight;
-        float valence = 1.0f;
-        int32_t forwardIterator, backwardIterator;
-        float tmp1[3], tmp2[3];
-
-        // smooth contrib
-        cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-
-        // crease contrib
-        cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
-        cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-
-        for (forwardIterator = ccs_HalfedgeTwinID(subd, prevID, depth);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccs_HalfedgeTwinID(subd, forwardIterator, depth)) {
-            const int32_t prevID = ccs_HalfedgePrevID(subd, forwardIterator, depth);
-            const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
-            const int32_t prevFaceID = ccs_HalfedgeFaceID(subd, prevID, depth);
-            const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-            const cc_VertexPoint newPrevFacePoint = newFacePoints[prevFaceID];
-            const float prevS = ccs_HalfedgeSharpness(subd, prevID, depth);
-            const float prevCreaseWeight = cc__Signf(prevS);
-
-            // smooth contrib
-            cc__Mul3f(tmp1, newPrevFacePoint.array, -1.0f);
-            cc__Mul3f(tmp2, newPrevEdgePoint.array, +4.0f);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
-            ++valence;
-
-            // crease contrib
-            cc__Mul3f(tmp1, newPrevEdgePoint.array, prevCreaseWeight);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-            avgS+= prevS;
-            creaseCount+= prevCreaseWeight;
+    int32_t parentID;
 
-            // next vertex halfedge
-            forwardIterator = prevID;
-        }
+    // halfedges with local ID 0 inherit the vertex of their parent
+    while (depth > 0 && (halfedgeID & 3) == 0) {
+        halfedgeID>>= 2;
+        --depth;
+    }
 
-        for (backwardIterator = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccs_HalfedgeTwinID(subd, backwardIterator, depth)) {
-            const int32_t nextID = ccs_HalfedgeNextID(subd, backwardIterator, depth);
-            const int32_t nextEdgeID = ccs_HalfedgeEdgeID(subd, nextID, depth);
-            const int32_t nextFaceID = ccs_HalfedgeFaceID(subd, nextID, depth);
-            const cc_VertexPoint newNextEdgePoint = newEdgePoints[nextEdgeID];
-            const cc_VertexPoint newNextFacePoint = newFacePoints[nextFaceID];
-            const float nextS = ccs_HalfedgeSharpness(subd, nextID, depth);
-            const float nextCreaseWeight = cc__Signf(nextS);
+    if (depth == 0) {
+        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
 
-            // smooth contrib
-            cc__Mul3f(tmp1, newNextFacePoint.array, -1.0f);
-            cc__Mul3f(tmp2, newNextEdgePoint.array, +4.0f);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-            cc__Add3f(smoothPoint.array, smoothPoint.array, tmp2);
-            ++valence;
+        return ccm_VertexToHalfedgeID(cage, vertexID) == halfedgeID;
+    }
 
-            // crease contrib
-            cc__Mul3f(tmp1, newNextEdgePoint.array, nextCreaseWeight);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-            avgS+= nextS;
-            creaseCount+= nextCreaseWeight;
+    parentID = halfedgeID >> 2;
+    --depth;
 
-            // next vertex halfedge
-            backwardIterator = nextID;
-        }
+    if /* edge point */ ((halfedgeID & 3) == 1) {
+        if (depth == 0) {
+            const int32_t edgeID = ccm_HalfedgeEdgeID(cage, parentID);
 
-        // boundary corrections
-        if (forwardIterator < 0) {
-            cc__Mul3f(tmp1, newEdgePoint.array    , creaseWeight);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
-            creaseCount+= creaseWeight;
-            ++valence;
+            return ccm_EdgeToHalfedgeID(cage, edgeID) == parentID;
+        } else {
+            return ccs_HalfedgeTwinID(subd, parentID, depth) < parentID;
         }
+    } else if /* face point */ ((halfedgeID & 3) == 2) {
+        if (depth == 0) {
+            const int32_t faceID = ccm_HalfedgeFaceID(cage, parentID);
 
-        // smooth point
-        cc__Mul3f(tmp1, smoothPoint.array, 1.0f / (valence * valence));
-        cc__Mul3f(tmp2, oldPoint.array, 1.0f - 3.0f / valence);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-
-        // crease point
-        cc__Mul3f(tmp1, creasePoint.array, 0.5f / creaseCount);
-        cc__Mul3f(tmp2, oldPoint.array, 0.5f);
-        cc__Add3f(creasePoint.array, tmp1, tmp2);
-
-        // proper vertex rule selection (TODO: make branchless)
-        if (creaseCount <= 1.0f) {
-            newVertexPoints[vertexID] = smoothPoint;
-        } else if (creaseCount >= 3.0f || valence == 2.0f) {
-            newVertexPoints[vertexID] = oldPoint;
+            return ccm_FaceToHalfedgeID(cage, faceID) == parentID;
         } else {
-            cc__Lerp3f(newVertexPoints[vertexID].array,
-                       oldPoint.array,
-                       creasePoint.array,
-                       cc__Satf(avgS * 0.5f));
+            return (parentID & 3) == 0;
         }
+    } else /* edge point of the previous halfedge */ {
+        return false;
     }
-CC_BARRIER
 }
 
-
-static void ccs__CreasedVertexPoints_Scatter(cc_Subd *subd, int32_t depth)
+CCDEF cc_Mesh *ccs_ExtractMesh(const cc_Subd *subd, int32_t depth)
 {
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
     const cc_Mesh *cage = subd->cage;
+    const int32_t vertexCount = ccm_VertexCountAtDepth(cage, depth);
     const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
-    const cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
-    const cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
-    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+    const int32_t edgeCount = ccm_EdgeCountAtDepth(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth(cage, depth);
+    const int32_t creaseCount = ccm_CreaseCountAtDepth(cage, depth);
+    const cc_Halfedge_SemiRegular *halfedges = ccs__Halfedges(subd, depth);
+    const cc_Crease *creases = ccs__Crease(subd, 0, depth);
+#ifndef CC_DISABLE_UV
+    const bool hasUvs = subd->uvs != NULL;
+#else
+    const bool hasUvs = false;
+#endif
+    cc_Mesh *mesh = ccm_Create(vertexCount,
+                               hasUvs ? halfedgeCount : 0,
+                               halfedgeCount,
+                               edgeCount,
+                               faceCount);
+
+    ccs_GetVertexPoints(subd, depth, 0, vertexCount, mesh->vertexPoints);
+#ifndef CC_DISABLE_UV
+    if (hasUvs) {
+        ccs_GetHalfedgeVertexUvs(subd, depth, 0, halfedgeCount, mesh->uvs);
+    }
+#endif
 
 CC_PARALLEL_FOR
     for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t faceID = ccs_HalfedgeFaceID(subd, halfedgeID, depth);
-        const int32_t prevID = ccs_HalfedgePrevID(subd, halfedgeID, depth);
-        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
-        const float thisS = ccs_HalfedgeSharpness(subd, halfedgeID, depth);
-        const float prevS = ccs_HalfedgeSharpness(subd,     prevID, depth);
-        const float creaseWeight = cc__Signf(thisS);
-        const float prevCreaseWeight = cc__Signf(prevS);
-        const cc_VertexPoint newPrevEdgePoint = newEdgePoints[prevEdgeID];
-        const cc_VertexPoint newEdgePoint = newEdgePoints[edgeID];
-        const cc_VertexPoint newFacePoint = newFacePoints[faceID];
-        const cc_VertexPoint oldPoint = ccs_VertexPoint(subd, vertexID, depth);
-        cc_VertexPoint cornerPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint smoothPoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint creasePoint = {0.0f, 0.0f, 0.0f};
-        cc_VertexPoint atomicWeight = {0.0f, 0.0f, 0.0f};
-        float avgS = prevS;
-        float creaseCount = prevCreaseWeight;
-        float valence = 1.0f;
-        int32_t forwardIterator, backwardIterator;
-        float tmp1[3], tmp2[3];
-
-        for (forwardIterator = ccs_HalfedgeTwinID(subd, prevID, depth);
-             forwardIterator >= 0 && forwardIterator != halfedgeID;
-             forwardIterator = ccs_HalfedgeTwinID(subd, forwardIterator, depth)) {
-            const int32_t prevID = ccs_HalfedgePrevID(subd, forwardIterator, depth);
-            const float prevS = ccs_HalfedgeSharpness(subd, prevID, depth);
-            const float prevCreaseWeight = cc__Signf(prevS);
+        const cc_Halfedge_SemiRegular *src = &halfedges[halfedgeID];
+        cc_Halfedge *dst = &mesh->halfedges[halfedgeID];
+
+        dst->twinID = cc__Max(src->twinID, -1);
+        dst->nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
+        dst->prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
+        dst->faceID = ccm_HalfedgeFaceID_Quad(halfedgeID);
+        dst->edgeID = src->edgeID;
+        dst->vertexID = src->vertexID;
+        dst->uvID = hasUvs ? halfedgeID : -1;
+
+        if (src->twinID < halfedgeID) {
+            mesh->edgeToHalfedgeIDs[src->edgeID] = halfedgeID;
+        }
 
-            // valence computation
-            ++valence;
+        if (ccs__IsVertexHalfedge(subd, halfedgeID, depth)) {
+            mesh->vertexToHalfedgeIDs[src->vertexID] = halfedgeID;
+        }
+    }
+CC_BARRIER
 
-            // crease computation
-            avgS+= prevS;
-            creaseCount+= prevCreaseWeight;
+CC_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        if (halfedges[halfedgeID].twinID < 0) {
+            const int32_t vertexID = halfedges[halfedgeID].vertexID;
 
-            // next vertex halfedge
-            forwardIterator = prevID;
+            mesh->vertexToHalfedgeIDs[vertexID] = halfedgeID;
         }
+    }
+CC_BARRIER
 
-        for (backwardIterator = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-             forwardIterator < 0 && backwardIterator >= 0 && backwardIterator != halfedgeID;
-             backwardIterator = ccs_HalfedgeTwinID(subd, backwardIterator, depth)) {
-            const int32_t nextID = ccs_HalfedgeNextID(subd, backwardIterator, depth);
-            const float nextS = ccs_HalfedgeSharpness(subd, nextID, depth);
-            const float nextCreaseWeight = cc__Signf(nextS);
+CC_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        mesh->faceToHalfedgeIDs[faceID] = ccm_FaceToHalfedgeID_Quad(faceID);
+    }
+CC_BARRIER
 
-            // valence computation
-            ++valence;
+    // the faces at depth d are the halfedges at depth d - 1
+    if (cage->faceHoles != NULL) {
+        mesh->faceHoles = (uint8_t *)CC_MALLOC(cc__Max(1, faceCount));
 
-            // crease computation
-            avgS+= nextS;
-            creaseCount+= nextCreaseWeight;
+CC_PARALLEL_FOR
+        for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+            const int32_t tileID = faceID >> (2 * (depth - 1));
 
-            // next vertex halfedge
-            backwardIterator = nextID;
+            mesh->faceHoles[faceID] = cage->faceHoles[ccm_HalfedgeFaceID(cage, tileID)];
         }
+CC_BARRIER
+    }
 
-        // corner point
-        cc__Mul3f(cornerPoint.array, oldPoint.array, 1.0f / valence);
-
-        // crease computation: V / 4
-        cc__Mul3f(tmp1, oldPoint.array, 0.25f * creaseWeight);
-        cc__Mul3f(tmp2, newEdgePoint.array, 0.25f * creaseWeight);
-        cc__Add3f(creasePoint.array, tmp1, tmp2);
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        if (edgeID < creaseCount) {
+            mesh->creases[edgeID] = creases[edgeID];
+        } else {
+            mesh->creases[edgeID].nextID = edgeID;
+            mesh->creases[edgeID].prevID = edgeID;
+            mesh->creases[edgeID].sharpness = 0.0f;
+        }
+    }
+CC_BARRIER
 
-        // smooth computation: (4E - F + (n - 3) V) / N
-        cc__Mul3f(tmp1, newFacePoint.array, -1.0f);
-        cc__Mul3f(tmp2, newEdgePoint.array, +4.0f);
-        cc__Add3f(smoothPoint.array, tmp1, tmp2);
-        cc__Mul3f(tmp1, oldPoint.array, valence - 3.0f);
-        cc__Add3f(smoothPoint.array, smoothPoint.array, tmp1);
-        cc__Mul3f(smoothPoint.array,
-                  smoothPoint.array,
-                  1.0f / (valence * valence));
+    return mesh;
+}
 
-        // boundary corrections
-        if (forwardIterator < 0) {
-            creaseCount+= creaseWeight;
-            ++valence;
 
-            cc__Mul3f(tmp1, oldPoint.array, 0.25f * prevCreaseWeight);
-            cc__Mul3f(tmp2, newPrevEdgePoint.array, 0.25f * prevCreaseWeight);
-            cc__Add3f(tmp1, tmp1, tmp2);
-            cc__Add3f(creasePoint.array, creasePoint.array, tmp1);
+/*******************************************************************************
+ * BlendShapes -- Refines sparse cage deltas once for per-frame blending
+ *
+ * Catmull Clark refinement is linear in the cage vertex points, so the refined
+ * blend of a set of shapes is the blend of their refined deltas. Each delta is
+ * refined over a zeroed scratch copy of the subd, restricted to the tiles of
+ * the faces that touch the 2-ring of its vertices, which bounds the support of
+ * their basis functions. The non-zero points at the target depth are stored
+ * in compressed rows, and ccb_Apply only accumulates them over the refined
+ * rest points.
+ *
+ */
+static void
+ccb__FlagVertexFaces(
+    const cc_Mesh *cage,
+    int32_t vertexID,
+    uint8_t *tileFlags,
+    int32_t *tileIDs,
+    int32_t *tileCount
+) {
+    const int32_t halfedgeID = ccm_VertexToHalfedgeID(cage, vertexID);
+    int32_t iterator = halfedgeID;
+
+    do {
+        int32_t faceIterator = iterator;
+
+        if (!tileFlags[iterator]) {
+            do {
+                tileFlags[faceIterator] = 1;
+                tileIDs[(*tileCount)++] = faceIterator;
+                faceIterator = ccm_HalfedgeNextID(cage, faceIterator);
+            } while (faceIterator != iterator);
         }
 
-        // atomicWeight (TODO: make branchless ?)
-        if (creaseCount >= 3.0f || valence == 2.0f) {
-            atomicWeight = cornerPoint;
-        } else if (creaseCount <= 1.0f) {
-            atomicWeight = smoothPoint;
-        } else {
-            cc__Lerp3f(atomicWeight.array,
-                       cornerPoint.array,
-                       creasePoint.array,
-                       cc__Satf(avgS * 0.5f));
-        }
+        iterator = ccm_PrevVertexHalfedgeID(cage, iterator);
+    } while (iterator >= 0 && iterator != halfedgeID);
+}
+
+static int32_t
+ccb__SupportTileIDs(
+    const cc_Mesh *cage,
+    const int32_t *vertexIDs,
+    int32_t vertexCount,
+    uint8_t *tileFlags,
+    int32_t *ringIDs,
+    int32_t *tileIDs
+) {
+    int32_t ringCount = 0, tileCount = 0;
 
-        for (int32_t i = 0; i < 3; ++i) {
-CC_ATOMIC
-            newVertexPoints[vertexID].array[i]+= atomicWeight.array[i];
-        }
+    for (int32_t i = 0; i < vertexCount; ++i) {
+        ccb__FlagVertexFaces(cage, vertexIDs[i], tileFlags, ringIDs, &ringCount);
     }
-CC_BARRIER
-}
 
+    // the 1-ring faces are flagged again as part of the 2-ring
+    for (int32_t i = 0; i < ringCount; ++i) {
+        tileFlags[ringIDs[i]] = 0;
+    }
 
+    for (int32_t i = 0; i < ringCount; ++i) {
+        const int32_t vertexID = ccm_HalfedgeVertexID(cage, ringIDs[i]);
 
-/*******************************************************************************
- * RefineVertexPoints -- Computes the result of Catmull Clark subdivision.
- *
- */
-static void ccs__ClearVertexPoints(cc_Subd *subd)
-{
-    const int32_t vertexCount = ccs_CumulativeVertexCount(subd);
-    const int32_t vertexByteCount = vertexCount * sizeof(cc_VertexPoint);
+        ccb__FlagVertexFaces(cage, vertexID, tileFlags, tileIDs, &tileCount);
+    }
 
-    CC_MEMSET(subd->vertexPoints, 0, vertexByteCount);
+    return tileCount;
 }
 
-CCDEF void ccs_RefineVertexPoints_Scatter(cc_Subd *subd)
-{
-    ccs__ClearVertexPoints(subd);
-    ccs__CageFacePoints_Scatter(subd);
-    ccs__CreasedCageEdgePoints_Scatter(subd);
-    ccs__CreasedCageVertexPoints_Scatter(subd);
+static void
+ccb__ZeroTileVertexPoints(
+    cc_Subd *subd,
+    const int32_t *tileIDs,
+    int32_t tileCount,
+    int32_t depth
+) {
+    const int32_t tileHalfedgeCount = 1 << (2 * depth);
+    const int32_t halfedgeCount = tileCount * tileHalfedgeCount;
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(subd->cage, depth - 1);
+    cc_VertexPoint *vertexPoints = &subd->vertexPoints[stride];
 
-    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
-        ccs__FacePoints_Scatter(subd, depth);
-        ccs__CreasedEdgePoints_Scatter(subd, depth);
-        ccs__CreasedVertexPoints_Scatter(subd, depth);
+CC_PARALLEL_FOR
+    for (int32_t i = 0; i < halfedgeCount; ++i) {
+        const int32_t tileID = tileIDs[i >> (2 * depth)];
+        const int32_t halfedgeID = (tileID << (2 * depth)) + (i & (tileHalfedgeCount - 1));
+        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
+
+        CC_MEMSET(&vertexPoints[vertexID], 0, sizeof(cc_VertexPoint));
     }
+CC_BARRIER
 }
 
-CCDEF void ccs_RefineVertexPoints_NoCreases_Scatter(cc_Subd *subd)
+static int32_t *
+ccb__GrowIDs(int32_t *buffer, int32_t count, int32_t capacity)
 {
-    ccs__ClearVertexPoints(subd);
-    ccs__CageFacePoints_Scatter(subd);
-    ccs__CageEdgePoints_Scatter(subd);
-    ccs__CageVertexPoints_Scatter(subd);
-
-    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
-        ccs__FacePoints_Scatter(subd, depth);
-        ccs__EdgePoints_Scatter(subd, depth);
-        ccs__VertexPoints_Scatter(subd, depth);
-    }
+    return (int32_t *)cc__Realloc(buffer,
+                                  sizeof(int32_t) * count,
+                                  sizeof(int32_t) * capacity);
 }
 
-CCDEF void ccs_RefineVertexPoints_Gather(cc_Subd *subd)
+static cc_VertexPoint *
+ccb__GrowDeltas(cc_VertexPoint *buffer, int32_t count, int32_t capacity)
 {
-    ccs__CageFacePoints_Gather(subd);
-    ccs__CreasedCageEdgePoints_Gather(subd);
-    ccs__CreasedCageVertexPoints_Gather(subd);
+    return (cc_VertexPoint *)cc__Realloc(buffer,
+                                         sizeof(cc_VertexPoint) * count,
+                                         sizeof(cc_VertexPoint) * capacity);
+}
 
-    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
-        ccs__FacePoints_Gather(subd, depth);
-        ccs__CreasedEdgePoints_Gather(subd, depth);
-        ccs__CreasedVertexPoints_Gather(subd, depth);
+CCDEF cc_BlendShapes *
+ccb_Create(
+    const cc_Subd *subd,
+    int32_t depth,
+    int32_t shapeCount,
+    const int32_t *offsets,
+    const int32_t *vertexIDs,
+    const cc_VertexPoint *deltas
+) {
+    CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+    const cc_Mesh *cage = subd->cage;
+    const int32_t cageVertexCount = ccm_VertexCount(cage);
+    const int32_t cageHalfedgeCount = ccm_HalfedgeCount(cage);
+    const int32_t vertexCount = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth - 1);
+    cc_BlendShapes *shapes = (cc_BlendShapes *)CC_MALLOC(sizeof(*shapes));
+    cc_Mesh deltaCage = *cage;
+    cc_Subd deltaSubd = *subd;
+    uint8_t *tileFlags = (uint8_t *)CC_MALLOC(cageHalfedgeCount);
+    int32_t *tileIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * 2 * cageHalfedgeCount);
+    int32_t capacity = cc__Max(1, offsets[shapeCount]);
+    int32_t deltaCount = 0;
+
+    // scratch subd that refines deltas rather than points
+    deltaCage.vertexPoints =
+            (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint) * cageVertexCount);
+    deltaSubd.cage = &deltaCage;
+    deltaSubd.vertexPoints =
+            (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint) * vertexCount);
+    deltaSubd.packedVertexPoints = NULL;
+    deltaSubd.packedDepth = depth + 1;
+    deltaSubd.maxDepth = depth;
+    deltaSubd.mappedData = NULL;
+    CC_MEMSET(deltaCage.vertexPoints, 0, sizeof(cc_VertexPoint) * cageVertexCount);
+    CC_MEMSET(deltaSubd.vertexPoints, 0, sizeof(cc_VertexPoint) * vertexCount);
+    CC_MEMSET(tileFlags, 0, cageHalfedgeCount);
+
+    shapes->subd = subd;
+    shapes->depth = depth;
+    shapes->shapeCount = shapeCount;
+    shapes->offsets = (int32_t *)CC_MALLOC(sizeof(int32_t) * (shapeCount + 1));
+    shapes->vertexIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * capacity);
+    shapes->deltas = (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint) * capacity);
+
+    for (int32_t shapeID = 0; shapeID < shapeCount; ++shapeID) {
+        const int32_t begin = offsets[shapeID];
+        const int32_t end = offsets[shapeID + 1];
+        const int32_t tileHalfedgeCount = 1 << (2 * depth);
+        cc_VertexPoint *refinedDeltas = &deltaSubd.vertexPoints[stride];
+        int32_t tileCount;
+
+        shapes->offsets[shapeID] = deltaCount;
+
+        for (int32_t i = begin; i < end; ++i) {
+            cc_VertexPoint *delta = &deltaCage.vertexPoints[vertexIDs[i]];
+
+            for (int32_t j = 0; j < 3; ++j) {
+                delta->array[j]+= deltas[i].array[j];
+            }
+        }
+
+        tileCount = ccb__SupportTileIDs(cage,
+                                        &vertexIDs[begin],
+                                        end - begin,
+                                        tileFlags,
+                                        &tileIDs[cageHalfedgeCount],
+                                        tileIDs);
+        ccs__RefineTileVertexPoints_Gather(&deltaSubd, tileFlags, tileIDs, tileCount);
+
+        // gather the non-zero deltas of the target depth and reset them
+        for (int32_t i = 0; i < tileCount * tileHalfedgeCount; ++i) {
+            const int32_t tileID = tileIDs[i >> (2 * depth)];
+            const int32_t halfedgeID = (tileID << (2 * depth)) + (i & (tileHalfedgeCount - 1));
+            const int32_t vertexID = ccs_HalfedgeVertexID(&deltaSubd, halfedgeID, depth);
+            cc_VertexPoint *delta = &refinedDeltas[vertexID];
+
+            if (delta->x != 0.0f || delta->y != 0.0f || delta->z != 0.0f) {
+                if (deltaCount == capacity) {
+                    shapes->vertexIDs = ccb__GrowIDs(shapes->vertexIDs,
+                                                     deltaCount,
+                                                     2 * capacity);
+                    shapes->deltas = ccb__GrowDeltas(shapes->deltas,
+                                                     deltaCount,
+                                                     2 * capacity);
+                    capacity*= 2;
+                }
+
+                shapes->vertexIDs[deltaCount] = vertexID;
+                shapes->deltas[deltaCount] = *delta;
+                CC_MEMSET(delta, 0, sizeof(*delta));
+                ++deltaCount;
+            }
+        }
+
+        // reset the scratch buffers for the next shape
+        for (int32_t d = 1; d < depth; ++d) {
+            ccb__ZeroTileVertexPoints(&deltaSubd, tileIDs, tileCount, d);
+        }
+
+        for (int32_t i = 0; i < tileCount; ++i) {
+            tileFlags[tileIDs[i]] = 0;
+        }
+
+        for (int32_t i = begin; i < end; ++i) {
+            CC_MEMSET(&deltaCage.vertexPoints[vertexIDs[i]], 0, sizeof(cc_VertexPoint));
+        }
     }
+
+    shapes->offsets[shapeCount] = deltaCount;
+
+    CC_FREE(deltaCage.vertexPoints);
+    CC_FREE(deltaSubd.vertexPoints);
+    CC_FREE(tileFlags);
+    CC_FREE(tileIDs);
+
+    return shapes;
 }
 
-CCDEF void ccs_RefineVertexPoints_NoCreases_Gather(cc_Subd *subd)
+CCDEF void ccb_Release(cc_BlendShapes *shapes)
 {
-    ccs__CageFacePoints_Gather(subd);
-    ccs__CageEdgePoints_Gather(subd);
-    ccs__CageVertexPoints_Gather(subd);
-
-    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
-        ccs__FacePoints_Gather(subd, depth);
-        ccs__EdgePoints_Gather(subd, depth);
-        ccs__VertexPoints_Gather(subd, depth);
-    }
+    CC_FREE(shapes->offsets);
+    CC_FREE(shapes->vertexIDs);
+    CC_FREE(shapes->deltas);
+    CC_FREE(shapes);
 }
 
+CCDEF int32_t ccb_ShapeCount(const cc_BlendShapes *shapes)
+{
+    return shapes->shapeCount;
+}
 
-/*******************************************************************************
- * RefineCageHalfedges -- Applies halfedge refinement rules on the cage mesh
- *
- * This routine computes the halfedges of the control cage after one subdivision
- * step and stores them in the subd.
- *
- */
-static void ccs__RefineCageHalfedges(cc_Subd *subd)
+CCDEF int32_t ccb_DeltaCount(const cc_BlendShapes *shapes)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t vertexCount = ccm_VertexCount(cage);
-    const int32_t edgeCount = ccm_EdgeCount(cage);
-    const int32_t faceCount = ccm_FaceCount(cage);
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    cc_Halfedge_SemiRegular *halfedgesOut = subd->halfedges;
+    return shapes->offsets[shapes->shapeCount];
+}
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t twinID = ccm_HalfedgeTwinID(cage, halfedgeID);
-        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID(cage, halfedgeID);
-        const int32_t edgeID = ccm_HalfedgeEdgeID(cage, halfedgeID);
-        const int32_t prevEdgeID = ccm_HalfedgeEdgeID(cage, prevID);
-        const int32_t prevTwinID = ccm_HalfedgeTwinID(cage, prevID);
-        const int32_t vertexID = ccm_HalfedgeVertexID(cage, halfedgeID);
-        const int32_t twinNextID =
-            twinID >= 0 ? ccm_HalfedgeNextID(cage, twinID) : -1;
-        cc_Halfedge_SemiRegular *newHalfedges[4] = {
-            &halfedgesOut[(4 * halfedgeID + 0)],
-            &halfedgesOut[(4 * halfedgeID + 1)],
-            &halfedgesOut[(4 * halfedgeID + 2)],
-            &halfedgesOut[(4 * halfedgeID + 3)]
-        };
+CCDEF void
+ccb_Apply(
+    const cc_BlendShapes *shapes,
+    const float *weights,
+    cc_VertexPoint *vertexPoints
+) {
+    const cc_Subd *subd = shapes->subd;
+    const int32_t depth = shapes->depth;
+    const int32_t vertexCount = ccm_VertexCountAtDepth(subd->cage, depth);
 
-        // twinIDs
-        newHalfedges[0]->twinID = 4 * twinNextID + 3;
-        newHalfedges[1]->twinID = 4 * nextID     + 2;
-        newHalfedges[2]->twinID = 4 * prevID     + 1;
-        newHalfedges[3]->twinID = 4 * prevTwinID + 0;
+    ccs_GetVertexPoints(subd, depth, 0, vertexCount, vertexPoints);
 
-        // edgeIDs
-        newHalfedges[0]->edgeID = 2 * edgeID + (halfedgeID > twinID ? 0 : 1);
-        newHalfedges[1]->edgeID = 2 * edgeCount + halfedgeID;
-        newHalfedges[2]->edgeID = 2 * edgeCount + prevID;
-        newHalfedges[3]->edgeID = 2 * prevEdgeID + (prevID > prevTwinID ? 1 : 0);
+    for (int32_t shapeID = 0; shapeID < shapes->shapeCount; ++shapeID) {
+        const float weight = weights[shapeID];
+        const int32_t begin = shapes->offsets[shapeID];
+        const int32_t end = shapes->offsets[shapeID + 1];
+        const int32_t *vertexIDs = shapes->vertexIDs;
+        const cc_VertexPoint *deltas = shapes->deltas;
 
-        // vertexIDs
-        newHalfedges[0]->vertexID = vertexID;
-        newHalfedges[1]->vertexID = vertexCount + faceCount + edgeID;
-        newHalfedges[2]->vertexID = vertexCount + faceID;
-        newHalfedges[3]->vertexID = vertexCount + faceCount + prevEdgeID;
-    }
+        if (weight == 0.0f) {
+            continue;
+        }
+
+        // the vertex IDs of a shape are unique so its entries never collide
+CC_PARALLEL_FOR
+        for (int32_t i = begin; i < end; ++i) {
+            float *dst = vertexPoints[vertexIDs[i]].array;
+            const float *src = deltas[i].array;
+
+            dst[0]+= weight * src[0];
+            dst[1]+= weight * src[1];
+            dst[2]+= weight * src[2];
+        }
 CC_BARRIER
+    }
 }
 
 
 /*******************************************************************************
- * RefineHalfedges -- Applies halfedge refinement on the subd
+ * Validate -- Checks the consistency of a mesh
  *
- * This routine computes the halfedges of the next subd level.
+ * The refinement routines trust the connectivity of the cage: a twin that is
+ * not symmetric or a next that is not the inverse of a prev leads to
+ * out-of-bounds accesses or to vertex iterations that never terminate. Each
+ * check below tests one element in O(1) and returns the ID of the element
+ * it reports (-1 if the element is valid), so that the checks run as
+ * parallel loops, and the checks that visit the same elements share a single
+ * pass. Once the halfedges and the mappings are known to be valid,
+ * each face cycle, edge, and vertex one-ring is traversed once from its
+ * mapped halfedge and tags the halfedges it visits; a halfedge with a
+ * missing or foreign tag reveals a face made of several cycles, an edge ID
+ * shared by halfedges that are not twins, or a non-manifold vertex. The
+ * smallest failing element of each check is only searched for (serially) if
+ * the check fails.
  *
  */
-static void ccs__RefineHalfedges(cc_Subd *subd, int32_t depth)
+typedef int32_t (*ccm__ElementCheck)(const cc_Mesh *mesh,
+                                     const int32_t *tags,
+                                     int32_t elementID);
+
+static bool ccm__IsInRange(int32_t id, int32_t count)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
-    const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
-    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
-    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(cage, depth);
-    cc_Halfedge_SemiRegular *halfedgesOut = &subd->halfedges[stride];
+    return id >= 0 && id < count;
+}
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t twinID = ccs_HalfedgeTwinID(subd, halfedgeID, depth);
-        const int32_t prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
-        const int32_t faceID = ccm_HalfedgeFaceID_Quad(halfedgeID);
-        const int32_t edgeID = ccs_HalfedgeEdgeID(subd, halfedgeID, depth);
-        const int32_t vertexID = ccs_HalfedgeVertexID(subd, halfedgeID, depth);
-        const int32_t prevEdgeID = ccs_HalfedgeEdgeID(subd, prevID, depth);
-        const int32_t prevTwinID = ccs_HalfedgeTwinID(subd, prevID, depth);
-        const int32_t twinNextID = ccm_HalfedgeNextID_Quad(twinID);
-        cc_Halfedge_SemiRegular *newHalfedges[4] = {
-            &halfedgesOut[(4 * halfedgeID + 0)],
-            &halfedgesOut[(4 * halfedgeID + 1)],
-            &halfedgesOut[(4 * halfedgeID + 2)],
-            &halfedgesOut[(4 * halfedgeID + 3)]
-        };
+// meshes without uvs may use either -1 or 0 as uvID (the converters in
+// the examples write 0 for faces without texture coordinates)
+static int32_t
+ccm__CheckHalfedge(const cc_Mesh *mesh, const int32_t *tags, int32_t halfedgeID)
+{
+    const cc_Halfedge *halfedge = &mesh->halfedges[halfedgeID];
+    (void)tags;
 
-        // twinIDs
-        newHalfedges[0]->twinID = 4 * twinNextID + 3;
-        newHalfedges[1]->twinID = 4 * nextID     + 2;
-        newHalfedges[2]->twinID = 4 * prevID     + 1;
-        newHalfedges[3]->twinID = 4 * prevTwinID + 0;
+    if (ccm__IsInRange(halfedge->faceID, ccm_FaceCount(mesh))
+        && ccm__IsInRange(halfedge->edgeID, ccm_EdgeCount(mesh))
+        && ccm__IsInRange(halfedge->vertexID, ccm_VertexCount(mesh))
+        && halfedge->uvID >= -1 && halfedge->uvID < cc__Max(1, ccm_UvCount(mesh))) {
+        return -1;
+    }
 
-        // edgeIDs
-        newHalfedges[0]->edgeID = 2 * edgeID + (halfedgeID > twinID ? 0 : 1);
-        newHalfedges[1]->edgeID = 2 * edgeCount + halfedgeID;
-        newHalfedges[2]->edgeID = 2 * edgeCount + prevID;
-        newHalfedges[3]->edgeID = 2 * prevEdgeID + (prevID > prevTwinID ? 1 : 0);
+    return halfedgeID;
+}
 
-        // vertexIDs
-        newHalfedges[0]->vertexID = vertexID;
-        newHalfedges[1]->vertexID = vertexCount + faceCount + edgeID;
-        newHalfedges[2]->vertexID = vertexCount + faceID;
-        newHalfedges[3]->vertexID = vertexCount + faceCount + prevEdgeID;
+static int32_t
+ccm__CheckNextPrev(const cc_Mesh *mesh, const int32_t *tags, int32_t halfedgeID)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+    const int32_t prevID = ccm_HalfedgePrevID(mesh, halfedgeID);
+    (void)tags;
+
+    if (ccm__IsInRange(nextID, halfedgeCount)
+        && ccm__IsInRange(prevID, halfedgeCount)
+        && nextID != halfedgeID
+        && ccm_HalfedgePrevID(mesh, nextID) == halfedgeID
+        && ccm_HalfedgeNextID(mesh, prevID) == halfedgeID
+        && ccm_HalfedgeFaceID(mesh, nextID) == ccm_HalfedgeFaceID(mesh, halfedgeID)) {
+        return -1;
     }
-CC_BARRIER
-}
 
+    return halfedgeID;
+}
 
-/*******************************************************************************
- * RefineHalfedges
- *
- */
-CCDEF void ccs_RefineHalfedges(cc_Subd *subd)
+static int32_t
+ccm__CheckTwin(const cc_Mesh *mesh, const int32_t *tags, int32_t halfedgeID)
 {
-    const int32_t maxDepth = ccs_MaxDepth(subd);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+    const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+    (void)tags;
 
-    ccs__RefineCageHalfedges(subd);
+    if (twinID == -1) {
+        return -1;
+    }
 
-    for (int32_t depth = 1; depth < maxDepth; ++depth) {
-        ccs__RefineHalfedges(subd, depth);
+    if (ccm__IsInRange(twinID, halfedgeCount)
+        && ccm__IsInRange(nextID, halfedgeCount)
+        && twinID != halfedgeID
+        && ccm_HalfedgeTwinID(mesh, twinID) == halfedgeID
+        && ccm_HalfedgeEdgeID(mesh, twinID) == ccm_HalfedgeEdgeID(mesh, halfedgeID)
+        && ccm_HalfedgeVertexID(mesh, twinID) == ccm_HalfedgeVertexID(mesh, nextID)) {
+        return -1;
     }
+
+    return halfedgeID;
 }
 
+static int32_t
+ccm__CheckCrease(const cc_Mesh *mesh, const int32_t *tags, int32_t edgeID)
+{
+    const int32_t creaseCount = ccm_CreaseCount(mesh);
+    const int32_t nextID = ccm_CreaseNextID(mesh, edgeID);
+    const int32_t prevID = ccm_CreasePrevID(mesh, edgeID);
+    (void)tags;
+
+    // the comparison also rejects NaN sharpness values
+    if (ccm__IsInRange(nextID, creaseCount)
+        && ccm__IsInRange(prevID, creaseCount)
+        && ccm_CreaseSharpness(mesh, edgeID) >= 0.0f) {
+        return -1;
+    }
 
-#ifndef CC_DISABLE_UV
-/*******************************************************************************
- * RefineCageVertexUvs -- Refines UVs of the cage mesh
- *
- * This routine computes the UVs of the control cage after one subdivision
- * step and stores them in the subd. Note that since UVs are not linked to
- * the topology of the mesh, we store the results of the UV computation
- * within the halfedge buffer.
- *
- */
-static void ccs__RefineCageVertexUvs(cc_Subd *subd)
+    return edgeID;
+}
+
+static int32_t
+ccm__CheckFaceMapping(const cc_Mesh *mesh, const int32_t *tags, int32_t faceID)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
-    cc_Halfedge_SemiRegular *halfedgesOut = subd->halfedges;
+    const int32_t halfedgeID = ccm_FaceToHalfedgeID(mesh, faceID);
+    (void)tags;
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t prevID = ccm_HalfedgePrevID(cage, halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID(cage, halfedgeID);
-        const cc_VertexUv uv = ccm_HalfedgeVertexUv(cage, halfedgeID);
-        const cc_VertexUv nextUv = ccm_HalfedgeVertexUv(cage, nextID);
-        const cc_VertexUv prevUv = ccm_HalfedgeVertexUv(cage, prevID);
-        cc_VertexUv edgeUv, prevEdgeUv;
-        cc_VertexUv faceUv = uv;
-        int32_t m = 1;
-        cc_Halfedge_SemiRegular *newHalfedges[4] = {
-            &halfedgesOut[(4 * halfedgeID + 0)],
-            &halfedgesOut[(4 * halfedgeID + 1)],
-            &halfedgesOut[(4 * halfedgeID + 2)],
-            &halfedgesOut[(4 * halfedgeID + 3)]
-        };
+    if (ccm__IsInRange(halfedgeID, ccm_HalfedgeCount(mesh))
+        && ccm_HalfedgeFaceID(mesh, halfedgeID) == faceID) {
+        return -1;
+    }
 
-        cc__Lerp2f(edgeUv.array    , uv.array, nextUv.array, 0.5f);
-        cc__Lerp2f(prevEdgeUv.array, uv.array, prevUv.array, 0.5f);
+    return faceID;
+}
 
-        for (int32_t halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeID);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccm_HalfedgeNextID(cage, halfedgeIt)) {
-            const cc_VertexUv uv = ccm_HalfedgeVertexUv(cage, halfedgeIt);
+static int32_t
+ccm__CheckEdgeMapping(const cc_Mesh *mesh, const int32_t *tags, int32_t edgeID)
+{
+    const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+    (void)tags;
 
-            faceUv.u+= uv.array[0];
-            faceUv.v+= uv.array[1];
-            ++m;
-        }
-        faceUv.u/= (float)m;
-        faceUv.v/= (float)m;
+    if (ccm__IsInRange(halfedgeID, ccm_HalfedgeCount(mesh))
+        && ccm_HalfedgeEdgeID(mesh, halfedgeID) == edgeID) {
+        return -1;
+    }
+
+    return edgeID;
+}
+
+static int32_t
+ccm__CheckVertexMapping(const cc_Mesh *mesh, const int32_t *tags, int32_t vertexID)
+{
+    const int32_t halfedgeID = ccm_VertexToHalfedgeID(mesh, vertexID);
+    (void)tags;
 
-        newHalfedges[0]->uvID = cc__EncodeUv(uv);
-        newHalfedges[1]->uvID = cc__EncodeUv(edgeUv);
-        newHalfedges[2]->uvID = cc__EncodeUv(faceUv);
-        newHalfedges[3]->uvID = cc__EncodeUv(prevEdgeUv);
+    if (ccm__IsInRange(halfedgeID, ccm_HalfedgeCount(mesh))
+        && ccm_HalfedgeVertexID(mesh, halfedgeID) == vertexID) {
+        return -1;
     }
-CC_BARRIER
-}
 
+    return vertexID;
+}
 
-/*******************************************************************************
- * RefineVertexUvs -- Applies UV refinement on the subd
- *
- * This routine computes the UVs of the next subd level.
- *
- */
-static void ccs__RefineVertexUvs(cc_Subd *subd, int32_t depth)
+static int32_t
+ccm__CheckFaceTag(const cc_Mesh *mesh, const int32_t *tags, int32_t halfedgeID)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
-    const int32_t stride = ccs_CumulativeHalfedgeCountAtDepth(cage, depth);
-    cc_Halfedge_SemiRegular *halfedgesOut = &subd->halfedges[stride];
+    const int32_t faceID = ccm_HalfedgeFaceID(mesh, halfedgeID);
 
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t prevID = ccm_HalfedgePrevID_Quad(halfedgeID);
-        const int32_t nextID = ccm_HalfedgeNextID_Quad(halfedgeID);
-        const cc_VertexUv uv = ccs_HalfedgeVertexUv(subd, halfedgeID, depth);
-        const cc_VertexUv nextUv = ccs_HalfedgeVertexUv(subd, nextID, depth);
-        const cc_VertexUv prevUv = ccs_HalfedgeVertexUv(subd, prevID, depth);
-        cc_VertexUv edgeUv, prevEdgeUv;
-        cc_VertexUv faceUv = uv;
-        cc_Halfedge_SemiRegular *newHalfedges[4] = {
-            &halfedgesOut[(4 * halfedgeID + 0)],
-            &halfedgesOut[(4 * halfedgeID + 1)],
-            &halfedgesOut[(4 * halfedgeID + 2)],
-            &halfedgesOut[(4 * halfedgeID + 3)]
-        };
+    return tags[halfedgeID] == faceID ? -1 : faceID;
+}
 
-        cc__Lerp2f(edgeUv.array    , uv.array, nextUv.array, 0.5f);
-        cc__Lerp2f(prevEdgeUv.array, uv.array, prevUv.array, 0.5f);
+static int32_t
+ccm__CheckEdgeTag(const cc_Mesh *mesh, const int32_t *tags, int32_t halfedgeID)
+{
+    const int32_t edgeID = ccm_HalfedgeEdgeID(mesh, halfedgeID);
 
-        for (int32_t halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeID, depth);
-                     halfedgeIt != halfedgeID;
-                     halfedgeIt = ccs_HalfedgeNextID(subd, halfedgeIt, depth)) {
-            const cc_VertexUv uv = ccs_HalfedgeVertexUv(subd, halfedgeIt, depth);
+    return tags[halfedgeID] == edgeID ? -1 : edgeID;
+}
 
-            faceUv.u+= uv.array[0];
-            faceUv.v+= uv.array[1];
-        }
-        faceUv.u/= 4.0f;
-        faceUv.v/= 4.0f;
+static int32_t
+ccm__CheckVertexTag(const cc_Mesh *mesh, const int32_t *tags, int32_t halfedgeID)
+{
+    const int32_t vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
 
-        newHalfedges[0]->uvID = ccs__HalfedgeVertexUvID(subd, halfedgeID, depth);
-        newHalfedges[1]->uvID = cc__EncodeUv(edgeUv);
-        newHalfedges[2]->uvID = cc__EncodeUv(faceUv);
-        newHalfedges[3]->uvID = cc__EncodeUv(prevEdgeUv);
-    }
-CC_BARRIER
+    return tags[halfedgeID] == vertexID ? -1 : vertexID;
 }
 
-
-/*******************************************************************************
- * RefineUvs
- *
- */
-CCDEF void ccs_RefineVertexUvs(cc_Subd *subd)
+static void ccm__TagFaces(const cc_Mesh *mesh, int32_t *tags)
 {
-    if (ccm_UvCount(subd->cage) > 0) {
-        const int32_t maxDepth = ccs_MaxDepth(subd);
+    const int32_t faceCount = ccm_FaceCount(mesh);
 
-        ccs__RefineCageVertexUvs(subd);
+CC_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        const int32_t halfedgeID = ccm_FaceToHalfedgeID(mesh, faceID);
+        int32_t halfedgeIt = halfedgeID;
 
-        for (int32_t depth = 1; depth < maxDepth; ++depth) {
-            ccs__RefineVertexUvs(subd, depth);
-        }
+        do {
+            tags[halfedgeIt] = faceID;
+            halfedgeIt = ccm_HalfedgeNextID(mesh, halfedgeIt);
+        } while (halfedgeIt != halfedgeID);
     }
+CC_BARRIER
 }
-#endif
 
-
-/*******************************************************************************
- * RefineCageCreases -- Applies crease subdivision on the cage mesh
- *
- * This routine computes the creases of the control cage after one subdivision
- * step and stores them in the subd.
- *
- */
-static void ccs__RefineCageCreases(cc_Subd *subd)
+static void ccm__TagEdges(const cc_Mesh *mesh, int32_t *tags)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t edgeCount = ccm_EdgeCount(cage);
-    cc_Crease *creasesOut = subd->creases;
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
 
 CC_PARALLEL_FOR
     for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t nextID = ccm_CreaseNextID(cage, edgeID);
-        const int32_t prevID = ccm_CreasePrevID(cage, edgeID);
-        const bool t1 = ccm_CreasePrevID(cage, nextID) == edgeID && nextID != edgeID;
-        const bool t2 = ccm_CreaseNextID(cage, prevID) == edgeID && prevID != edgeID;
-        const float thisS = 3.0f * ccm_CreaseSharpness(cage, edgeID);
-        const float nextS = ccm_CreaseSharpness(cage, nextID);
-        const float prevS = ccm_CreaseSharpness(cage, prevID);
-        cc_Crease *newCreases[2] = {
-            &creasesOut[(2 * edgeID + 0)],
-            &creasesOut[(2 * edgeID + 1)]
-        };
-
-        // next rule
-        newCreases[0]->nextID = 2 * edgeID + 1;
-        newCreases[1]->nextID = 2 * nextID + (t1 ? 0 : 1);
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
 
-        // prev rule
-        newCreases[0]->prevID = 2 * prevID + (t2 ? 1 : 0);
-        newCreases[1]->prevID = 2 * edgeID + 0;
+        tags[halfedgeID] = edgeID;
 
-        // sharpness rule
-        newCreases[0]->sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
-        newCreases[1]->sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+        if (twinID >= 0) {
+            tags[twinID] = edgeID;
+        }
     }
 CC_BARRIER
 }
 
-
-/*******************************************************************************
- * RefineCreases -- Applies crease subdivision on the subd
- *
- * This routine computes the topology of the next subd level.
- *
- */
-static void ccs__RefineCreases(cc_Subd *subd, int32_t depth)
+// the prev vertex halfedge map is injective once the twins and the
+// next/prev pointers are valid, so each walk terminates
+static void ccm__TagVertices(const cc_Mesh *mesh, int32_t *tags)
 {
-    const cc_Mesh *cage = subd->cage;
-    const int32_t creaseCount = ccm_CreaseCountAtDepth(cage, depth);
-    const int32_t stride = ccs_CumulativeCreaseCountAtDepth(cage, depth);
-    cc_Crease *creasesOut = &subd->creases[stride];
+    const int32_t vertexCount = ccm_VertexCount(mesh);
 
 CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < creaseCount; ++edgeID) {
-        const int32_t nextID = ccs_CreaseNextID_Fast(subd, edgeID, depth);
-        const int32_t prevID = ccs_CreasePrevID_Fast(subd, edgeID, depth);
-        const bool t1 = ccs_CreasePrevID_Fast(subd, nextID, depth) == edgeID && nextID != edgeID;
-        const bool t2 = ccs_CreaseNextID_Fast(subd, prevID, depth) == edgeID && prevID != edgeID;
-        const float thisS = 3.0f * ccs_CreaseSharpness_Fast(subd, edgeID, depth);
-        const float nextS = ccs_CreaseSharpness_Fast(subd, nextID, depth);
-        const float prevS = ccs_CreaseSharpness_Fast(subd, prevID, depth);
-        cc_Crease *newCreases[2] = {
-            &creasesOut[(2 * edgeID + 0)],
-            &creasesOut[(2 * edgeID + 1)]
-        };
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        const int32_t halfedgeID = ccm_VertexToHalfedgeID(mesh, vertexID);
+        int32_t halfedgeIt = halfedgeID;
 
-        // next rule
-        newCreases[0]->nextID = 2 * edgeID + 1;
-        newCreases[1]->nextID = 2 * nextID + (t1 ? 0 : 1);
+        do {
+            tags[halfedgeIt] = vertexID;
+            halfedgeIt = ccm_PrevVertexHalfedgeID(mesh, halfedgeIt);
+        } while (halfedgeIt >= 0 && halfedgeIt != halfedgeID);
+    }
+CC_BARRIER
+}
 
-        // prev rule
-        newCreases[0]->prevID = 2 * prevID + (t2 ? 1 : 0);
-        newCreases[1]->prevID = 2 * edgeID + 0;
+// runs up to 4 checks over the same elements in a single pass
+static void
+ccm__RunChecks(
+    const cc_Mesh *mesh,
+    const int32_t *tags,
+    const ccm__ElementCheck *checks,
+    const cc_ValidationCheck *checkIDs,
+    int32_t checkCount,
+    int32_t elementCount,
+    cc_Validation *validation
+) {
+    int32_t errorCounts[4] = {0, 0, 0, 0};
 
-        // sharpness rule
-        newCreases[0]->sharpness = cc__Maxf(0.0f, (prevS + thisS) / 4.0f - 1.0f);
-        newCreases[1]->sharpness = cc__Maxf(0.0f, (thisS + nextS) / 4.0f - 1.0f);
+CC_PARALLEL_FOR
+    for (int32_t i = 0; i < elementCount; ++i) {
+        for (int32_t j = 0; j < checkCount; ++j) {
+            if ((*checks[j])(mesh, tags, i) >= 0) {
+CC_ATOMIC
+                errorCounts[j]+= 1;
+            }
+        }
     }
 CC_BARRIER
-}
 
+    for (int32_t j = 0; j < checkCount; ++j) {
+        int32_t elementID = -1;
 
-/*******************************************************************************
- * RefineCreases
- *
- */
-CCDEF void ccs_RefineCreases(cc_Subd *subd)
-{
-    const int32_t maxDepth = ccs_MaxDepth(subd);
+        for (int32_t i = 0; i < elementCount && errorCounts[j] > 0; ++i) {
+            const int32_t failedID = (*checks[j])(mesh, tags, i);
 
-    ccs__RefineCageCreases(subd);
+            if (failedID >= 0 && (elementID < 0 || failedID < elementID)) {
+                elementID = failedID;
+            }
+        }
 
-    for (int32_t depth = 1; depth < maxDepth; ++depth) {
-        ccs__RefineCreases(subd, depth);
+        validation->errorCounts[checkIDs[j]] = errorCounts[j];
+        validation->elementIDs[checkIDs[j]] = elementID;
     }
 }
 
-
-/*******************************************************************************
- * Refine -- Computes and stores the result of Catmull Clark subdivision.
- *
- * The subdivision is computed down to the maxDepth parameter.
- *
- */
-static void ccs__RefineTopology(cc_Subd *subd)
-{
-    ccs_RefineHalfedges(subd);
-    ccs_RefineCreases(subd);
-#ifndef CC_DISABLE_UV
-    ccs_RefineVertexUvs(subd);
-#endif
+static void
+ccm__RunCheck(
+    const cc_Mesh *mesh,
+    const int32_t *tags,
+    ccm__ElementCheck check,
+    cc_ValidationCheck checkID,
+    int32_t elementCount,
+    cc_Validation *validation
+) {
+    ccm__RunChecks(mesh, tags, &check, &checkID, 1, elementCount, validation);
 }
 
-CCDEF void ccs_Refine_Scatter(cc_Subd *subd)
+static bool
+ccm__IsValidationClean(const cc_Validation *validation, int32_t begin, int32_t end)
 {
-    ccs__RefineTopology(subd);
-    ccs_RefineVertexPoints_Scatter(subd);
-}
+    for (int32_t checkID = begin; checkID < end; ++checkID) {
+        if (validation->errorCounts[checkID] > 0) {
+            return false;
+        }
+    }
 
-CCDEF void ccs_Refine_Gather(cc_Subd *subd)
-{
-    ccs__RefineTopology(subd);
-    ccs_RefineVertexPoints_Gather(subd);
+    return true;
 }
 
-CCDEF void ccs_Refine_NoCreases_Scatter(cc_Subd *subd)
+CCDEF bool ccm_Validate(const cc_Mesh *mesh, cc_Validation *validation)
 {
-    ccs__RefineTopology(subd);
-    ccs_RefineVertexPoints_NoCreases_Scatter(subd);
+    const int32_t vertexCount = ccm_VertexCount(mesh);
+    const int32_t uvCount = ccm_UvCount(mesh);
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
+    const int32_t faceCount = ccm_FaceCount(mesh);
+    cc_Validation stackValidation;
+    int32_t *tags;
+
+    if (validation == NULL) {
+        validation = &stackValidation;
+    }
+
+    for (int32_t checkID = 0; checkID < CC_VALIDATION_CHECK_COUNT; ++checkID) {
+        validation->errorCounts[checkID] = 0;
+        validation->elementIDs[checkID] = -1;
+    }
+
+    // each face and each edge owns at least one halfedge
+    if (vertexCount < 0 || uvCount < 0 || halfedgeCount < 0
+        || edgeCount < 0 || edgeCount > halfedgeCount
+        || faceCount < 0 || faceCount > halfedgeCount) {
+        validation->errorCounts[CC_VALIDATION_COUNTS] = 1;
+
+        return false;
+    }
+
+    // local checks
+    {
+        const ccm__ElementCheck halfedgeChecks[] = {
+            &ccm__CheckHalfedge, &ccm__CheckNextPrev, &ccm__CheckTwin
+        };
+        const cc_ValidationCheck halfedgeCheckIDs[] = {
+            CC_VALIDATION_HALFEDGES, CC_VALIDATION_NEXT_PREV, CC_VALIDATION_TWINS
+        };
+        const ccm__ElementCheck edgeChecks[] = {
+            &ccm__CheckEdgeMapping, &ccm__CheckCrease
+        };
+        const cc_ValidationCheck edgeCheckIDs[] = {
+            CC_VALIDATION_EDGES, CC_VALIDATION_CREASES
+        };
+
+        ccm__RunChecks(mesh, NULL, halfedgeChecks, halfedgeCheckIDs, 3,
+                       halfedgeCount, validation);
+        ccm__RunChecks(mesh, NULL, edgeChecks, edgeCheckIDs, 2,
+                       edgeCount, validation);
+        ccm__RunCheck(mesh, NULL, &ccm__CheckFaceMapping,
+                      CC_VALIDATION_FACES, faceCount, validation);
+        ccm__RunCheck(mesh, NULL, &ccm__CheckVertexMapping,
+                      CC_VALIDATION_VERTICES, vertexCount, validation);
+    }
+
+    // traversals (only safe once the local checks pass)
+    if (!ccm__IsValidationClean(validation, 0, CC_VALIDATION_CHECK_COUNT)) {
+        return false;
+    }
+
+    tags = (int32_t *)CC_MALLOC(sizeof(int32_t) * cc__Max(1, halfedgeCount));
+
+    if (tags == NULL) {
+        CC_LOG("cc: validation allocation failed");
+
+        return false;
+    }
+
+    CC_MEMSET(tags, 0xFF, sizeof(int32_t) * halfedgeCount);
+    ccm__TagFaces(mesh, tags);
+    ccm__RunCheck(mesh, tags, &ccm__CheckFaceTag,
+                  CC_VALIDATION_FACES, halfedgeCount, validation);
+
+    CC_MEMSET(tags, 0xFF, sizeof(int32_t) * halfedgeCount);
+    ccm__TagEdges(mesh, tags);
+    ccm__RunCheck(mesh, tags, &ccm__CheckEdgeTag,
+                  CC_VALIDATION_EDGES, halfedgeCount, validation);
+
+    CC_MEMSET(tags, 0xFF, sizeof(int32_t) * halfedgeCount);
+    ccm__TagVertices(mesh, tags);
+    ccm__RunCheck(mesh, tags, &ccm__CheckVertexTag,
+                  CC_VALIDATION_VERTICES, halfedgeCount, validation);
+
+    CC_FREE(tags);
+
+    return ccm__IsValidationClean(validation, 0, CC_VALIDATION_CHECK_COUNT);
 }
 
-CCDEF void ccs_Refine_NoCreases_Gather(cc_Subd *subd)
+CCDEF const char *ccm_ValidationCheckName(cc_ValidationCheck check)
 {
-    ccs__RefineTopology(subd);
-    ccs_RefineVertexPoints_NoCreases_Gather(subd);
+    switch (check) {
+    case CC_VALIDATION_COUNTS: return "counts";
+    case CC_VALIDATION_HALFEDGES: return "halfedges";
+    case CC_VALIDATION_NEXT_PREV: return "next/prev";
+    case CC_VALIDATION_TWINS: return "twins";
+    case CC_VALIDATION_FACES: return "faces";
+    case CC_VALIDATION_EDGES: return "edges";
+    case CC_VALIDATION_VERTICES: return "vertices";
+    case CC_VALIDATION_CREASES: return "creases";
+    default: return "unknown";
+    }
 }
 
 
@@ -3086,15 +8436,16 @@ CCDEF void ccs_Refine_NoCreases_Gather(cc_Subd *subd)
  * Magic -- Generates the magic identifier
  *
  * Each cc_Mesh file starts with 8 Bytes that allow us to check if the file
- * under reading is actually a cc_Mesh file.
+ * under reading is actually a cc_Mesh file. The last Byte holds the version
+ * of the format: version 2 appends one hole flag per face to version 1.
  *
  */
-static int64_t ccm__Magic()
+static int64_t ccm__Magic(int32_t version)
 {
     const union {
         char    string[8];
         int64_t numeric;
-    } magic = {{'c', 'c', '_', 'M', 'e', 's', 'h', '1'}};
+    } magic = {{'c', 'c', '_', 'M', 'e', 's', 'h', (char)('0' + version)}};
 
     return magic.numeric;
 }
@@ -3127,7 +8478,7 @@ typedef struct {
 static ccm__Header ccm__CreateHeader(const cc_Mesh *mesh)
 {
     ccm__Header header = {
-        ccm__Magic(),
+        ccm__Magic(mesh->faceHoles != NULL ? 2 : 1),
         ccm_VertexCount(mesh),
         ccm_UvCount(mesh),
         ccm_HalfedgeCount(mesh),
@@ -3151,7 +8502,7 @@ static bool ccm__ReadHeader(FILE *stream, ccm__Header *header)
         return false;
     }
 
-    return header->magic == ccm__Magic();
+    return header->magic == ccm__Magic(1) || header->magic == ccm__Magic(2);
 }
 
 
@@ -3179,11 +8530,54 @@ static bool ccm__ReadData(cc_Mesh *mesh, FILE *stream)
 }
 
 
+/*******************************************************************************
+ * ReadFaceHoles -- Loads the hole flags of a version 2 file
+ *
+ * The flags are dropped if the caller asked for it, or if no face is a
+ * hole.
+ *
+ */
+static bool ccm__ReadFaceHoles(cc_Mesh *mesh, FILE *stream, int32_t flags)
+{
+    const int32_t faceCount = ccm_FaceCount(mesh);
+    uint8_t *faceHoles = (uint8_t *)CC_MALLOC(cc__Max(1, faceCount));
+    bool hasHoles = false;
+
+    if (fread(faceHoles, sizeof(uint8_t), faceCount, stream) != (size_t)faceCount) {
+        CC_FREE(faceHoles);
+
+        return false;
+    }
+
+    for (int32_t faceID = 0; faceID < faceCount && !hasHoles; ++faceID) {
+        hasHoles = faceHoles[faceID] != 0;
+    }
+
+    if (!(flags & CC_LOAD_NO_HOLES) && hasHoles) {
+        mesh->faceHoles = faceHoles;
+    } else {
+        CC_FREE(faceHoles);
+    }
+
+    return true;
+}
+
+
 /*******************************************************************************
  * Load -- Loads a mesh from a file
  *
+ * The hole flags of the faces are kept unless CC_LOAD_NO_HOLES is set, so
+ * that saving the mesh back preserves them. The mesh is validated (see
+ * Validate) unless CC_LOAD_NO_VALIDATION is set, and a mesh that fails
+ * validation is released rather than returned.
+ *
  */
 CCDEF cc_Mesh *ccm_Load(const char *filename)
+{
+    return ccm_LoadWithFlags(filename, 0);
+}
+
+CCDEF cc_Mesh *ccm_LoadWithFlags(const char *filename, int32_t flags)
 {
     FILE *stream = fopen(filename, "rb");
     ccm__Header header;
@@ -3202,12 +8596,21 @@ CCDEF cc_Mesh *ccm_Load(const char *filename)
         return NULL;
     }
 
+    if (header.vertexCount < 0 || header.uvCount < 0 || header.halfedgeCount < 0
+        || header.edgeCount < 0 || header.faceCount < 0) {
+        CC_LOG("cc: invalid header");
+        fclose(stream);
+
+        return NULL;
+    }
+
     mesh = ccm_Create(header.vertexCount,
                       header.uvCount,
                       header.halfedgeCount,
                       header.edgeCount,
                       header.faceCount);
-    if (!ccm__ReadData(mesh, stream)) {
+    if (!ccm__ReadData(mesh, stream)
+        || (header.magic == ccm__Magic(2) && !ccm__ReadFaceHoles(mesh, stream, flags))) {
         CC_LOG("cc: data reading failed");
         ccm_Release(mesh);
         fclose(stream);
@@ -3216,6 +8619,24 @@ CCDEF cc_Mesh *ccm_Load(const char *filename)
     }
     fclose(stream);
 
+    if (!(flags & CC_LOAD_NO_VALIDATION)) {
+        cc_Validation validation;
+
+        if (!ccm_Validate(mesh, &validation)) {
+            for (int32_t checkID = 0; checkID < CC_VALIDATION_CHECK_COUNT; ++checkID) {
+                if (validation.errorCounts[checkID] > 0) {
+                    CC_LOG("cc: invalid mesh (%s: %i errors, first at %i)",
+                           ccm_ValidationCheckName((cc_ValidationCheck)checkID),
+                           validation.errorCounts[checkID],
+                           validation.elementIDs[checkID]);
+                }
+            }
+            ccm_Release(mesh);
+
+            return NULL;
+        }
+    }
+
     return mesh;
 }
 
@@ -3223,6 +8644,9 @@ CCDEF cc_Mesh *ccm_Load(const char *filename)
 /*******************************************************************************
  * Save -- Save a mesh to a file
  *
+ * Meshes with hole flags are saved to version 2 of the format, and the
+ * others to version 1.
+ *
  */
 CCDEF bool ccm_Save(const cc_Mesh *mesh, const char *filename)
 {
@@ -3256,6 +8680,8 @@ CCDEF bool ccm_Save(const cc_Mesh *mesh, const char *filename)
     ||  fwrite(mesh->uvs                , sizeof(cc_VertexUv)   , uvCount      , stream) != (size_t)uvCount
     ||  fwrite(mesh->creases            , sizeof(cc_Crease)     , creaseCount  , stream) != (size_t)creaseCount
     ||  fwrite(mesh->halfedges          , sizeof(cc_Halfedge)   , halfedgeCount, stream) != (size_t)halfedgeCount
+    || (mesh->faceHoles != NULL &&
+        fwrite(mesh->faceHoles          , sizeof(uint8_t)       , faceCount    , stream) != (size_t)faceCount)
     ) {
         CC_LOG("cc: data dump failed");
         fclose(stream);
@@ -3272,10 +8698,14 @@ CCDEF bool ccm_Save(const cc_Mesh *mesh, const char *filename)
 #undef CC_ASSERT
 #undef CC_LOG
 #undef CC_MALLOC
+#undef CC_REALLOC
 #undef CC_MEMCPY
 #undef CC_MEMSET
+#undef CC_SQRTF
+#undef CC_PREFETCH
 #undef CC_ATOMIC
 #undef CC_PARALLEL_FOR
 #undef CC_BARRIER
+#undef CC__MMAP
 
 #endif //CC_IMPLEMENTATION
@@ -0,0 +1,1083 @@
+/* CatmullClark.hpp - public domain library for Catmull Clark subdivision
+by Jonathan Dupuy
+
+   C++17 layer over CatmullClark.h that generates the Gather refinement
+   kernels from a compile-time traits type. Each trait removes a family of
+   runtime tests from the kernels:
+
+   - Creases    : semi-sharp crease rules (sharpness loads, crease counting)
+   - Boundaries : twinID < 0 tests and boundary vertex corrections
+   - Uvs        : UV refinement pass
+   - QuadCage   : the cage is made of quads laid out as 4 * faceID + k, so
+                  cage next/prev/face queries reduce to arithmetic
+
+   The library still relies on the C implementation for the topology; it
+   must thus be compiled in one C or C++ translation unit using
+
+      #define CC_IMPLEMENTATION
+      #include "CatmullClark.h"
+
+   USAGE
+       Specialized kernels are chosen at runtime from a quick scan of the
+       cage with
+
+       cc::Refine_Gather(subd);
+       cc::Refine_NoCreases_Gather(subd);
+
+       To avoid re-scanning the cage (e.g., for animated vertex points), scan
+       it once and re-use the result
+
+       const cc::MeshFeatures features = cc::ScanMesh(cage);
+       cc::RefineVertexPoints_Gather(subd, features);
+
+       A given instantiation may also be invoked directly
+
+       cc::Refine_Gather<cc::KernelTraits<true, false, false, true>>(subd);
+
+       Note that the specialized kernels drop work that the C kernels perform
+       unconditionally, so results match ccs_Refine_Gather and
+       ccs_Refine_NoCreases_Gather up to floating point rounding.
+
+   RANGES
+       The topology of a cage or of a subd level can be traversed with range
+       types instead of hand-written halfedge loops
+
+       const cc::SubdLevel level(subd, depth);
+
+       for (int32_t faceID : cc::Faces(level)) {
+           for (int32_t halfedgeID : cc::FaceCycle(level, faceID)) {...}
+       }
+
+       for (int32_t halfedgeID : cc::OneRing(level, vertexID)) {...}
+
+       cc::MeshView provides the same interface for a cc_Mesh. One-rings
+       yield the outgoing halfedges of a vertex and handle boundaries. Views
+       are small and copied into the ranges built from them.
+
+   INTERFACING
+   define CC_ASSERT(x) to avoid using assert.h
+*/
+
+#ifndef CC_INCLUDE_CC_HPP
+#define CC_INCLUDE_CC_HPP
+
+#ifndef CC_INCLUDE_CC_H
+#   include "CatmullClark.h"
+#endif
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#ifndef CC_ASSERT
+#   include <cassert>
+#   define CC_ASSERT(x) assert(x)
+#   define CC__UNDEF_ASSERT
+#endif
+
+#ifndef _OPENMP
+#   define CC__PARALLEL_FOR
+#elif defined(_WIN32)
+#   define CC__PARALLEL_FOR __pragma("omp parallel for")
+#else
+#   define CC__PARALLEL_FOR _Pragma("omp parallel for")
+#endif
+
+namespace cc {
+
+// features of a cage mesh that select a kernel instantiation
+struct MeshFeatures {
+    bool hasCreases;
+    bool hasBoundaries;
+    bool hasUvs;
+    bool isQuadCage;
+};
+
+// compile-time kernel configuration
+template <bool Creases, bool Boundaries, bool Uvs, bool QuadCage>
+struct KernelTraits {
+    static constexpr bool hasCreases = Creases;
+    static constexpr bool hasBoundaries = Boundaries;
+    static constexpr bool hasUvs = Uvs;
+    static constexpr bool isQuadCage = QuadCage;
+};
+
+// cage scan
+MeshFeatures ScanMesh(const cc_Mesh *cage);
+
+// specialized refinement
+template <typename Traits> void RefineVertexPoints_Gather(cc_Subd *subd);
+template <typename Traits> void Refine_Gather(cc_Subd *subd);
+
+// refinement with runtime selection of the specialized kernels
+void Refine_Gather(cc_Subd *subd);
+void Refine_NoCreases_Gather(cc_Subd *subd);
+void Refine_Gather(cc_Subd *subd, const MeshFeatures &features);
+void RefineVertexPoints_Gather(cc_Subd *subd, const MeshFeatures &features);
+
+// topology views
+struct MeshView;
+struct SubdLevel;
+
+// topology ranges
+struct IdRange;
+template <typename View> struct OneRingRange;
+template <typename View> struct FaceCycleRange;
+template <typename View> OneRingRange<View> OneRing(const View &view, int32_t vertexID);
+template <typename View> OneRingRange<View> OneRingFrom(const View &view, int32_t halfedgeID);
+FaceCycleRange<MeshView> FaceCycle(const MeshView &view, int32_t faceID);
+IdRange FaceCycle(const SubdLevel &level, int32_t faceID);
+template <typename View> IdRange Vertices(const View &view);
+template <typename View> IdRange Edges(const View &view);
+template <typename View> IdRange Faces(const View &view);
+template <typename View> IdRange Halfedges(const View &view);
+
+
+namespace detail {
+
+/*******************************************************************************
+ * Vector routines
+ *
+ */
+inline cc_VertexPoint Add(const cc_VertexPoint &x, const cc_VertexPoint &y)
+{
+    cc_VertexPoint out;
+
+    for (int32_t i = 0; i < 3; ++i) {
+        out.array[i] = x.array[i] + y.array[i];
+    }
+
+    return out;
+}
+
+inline cc_VertexPoint Mul(const cc_VertexPoint &x, float y)
+{
+    cc_VertexPoint out;
+
+    for (int32_t i = 0; i < 3; ++i) {
+        out.array[i] = x.array[i] * y;
+    }
+
+    return out;
+}
+
+inline cc_VertexPoint
+Lerp(const cc_VertexPoint &x, const cc_VertexPoint &y, float u)
+{
+    cc_VertexPoint out;
+
+    for (int32_t i = 0; i < 3; ++i) {
+        out.array[i] = x.array[i] + u * (y.array[i] - x.array[i]);
+    }
+
+    return out;
+}
+
+inline float Satf(float x)
+{
+    return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+}
+
+inline float Signf(float x)
+{
+    return x < 0.0f ? -1.0f : (x > 0.0f ? +1.0f : 0.0f);
+}
+
+inline int32_t Max(int32_t x, int32_t y)
+{
+    return x > y ? x : y;
+}
+
+
+/*******************************************************************************
+ * Cage accessors
+ *
+ * Direct loads from the cage arrays; the QuadCage trait replaces the
+ * next/prev/face loads with the arithmetic of quad-only meshes.
+ *
+ */
+template <typename Traits>
+struct CageView {
+    const cc_Halfedge *halfedges;
+    const cc_Crease *creases;
+    const cc_VertexPoint *vertexPoints;
+
+    explicit CageView(const cc_Mesh *cage):
+        halfedges(cage->halfedges),
+        creases(cage->creases),
+        vertexPoints(cage->vertexPoints)
+    {}
+
+    int32_t Twin(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].twinID;
+    }
+
+    int32_t Next(int32_t halfedgeID) const
+    {
+        if constexpr (Traits::isQuadCage) {
+            return ccm_HalfedgeNextID_Quad(halfedgeID);
+        } else {
+            return halfedges[halfedgeID].nextID;
+        }
+    }
+
+    int32_t Prev(int32_t halfedgeID) const
+    {
+        if constexpr (Traits::isQuadCage) {
+            return ccm_HalfedgePrevID_Quad(halfedgeID);
+        } else {
+            return halfedges[halfedgeID].prevID;
+        }
+    }
+
+    int32_t Face(int32_t halfedgeID) const
+    {
+        if constexpr (Traits::isQuadCage) {
+            return ccm_HalfedgeFaceID_Quad(halfedgeID);
+        } else {
+            return halfedges[halfedgeID].faceID;
+        }
+    }
+
+    int32_t Edge(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].edgeID;
+    }
+
+    float Sharpness(int32_t halfedgeID) const
+    {
+        return creases[Edge(halfedgeID)].sharpness;
+    }
+
+    const cc_VertexPoint &Point(int32_t halfedgeID) const
+    {
+        return vertexPoints[halfedges[halfedgeID].vertexID];
+    }
+};
+
+
+/*******************************************************************************
+ * Subd accessors
+ *
+ */
+struct LevelView {
+    const cc_Halfedge_SemiRegular *halfedges;
+    const cc_Crease *creases;
+    const cc_VertexPoint *vertexPoints;
+    int32_t creaseCount;
+
+    LevelView(const cc_Subd *subd, int32_t depth)
+    {
+        const cc_Mesh *cage = subd->cage;
+
+        halfedges = &subd->halfedges[ccs_CumulativeHalfedgeCountAtDepth(cage, depth - 1)];
+        creases = &subd->creases[ccs_CumulativeCreaseCountAtDepth(cage, depth - 1)];
+        vertexPoints = &subd->vertexPoints[ccs_CumulativeVertexCountAtDepth(cage, depth - 1)];
+        creaseCount = ccm_CreaseCountAtDepth(cage, depth);
+    }
+
+    int32_t Twin(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].twinID;
+    }
+
+    int32_t Edge(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].edgeID;
+    }
+
+    float EdgeSharpness(int32_t edgeID) const
+    {
+        return edgeID < creaseCount ? creases[edgeID].sharpness : 0.0f;
+    }
+
+    float Sharpness(int32_t halfedgeID) const
+    {
+        return EdgeSharpness(Edge(halfedgeID));
+    }
+
+    const cc_VertexPoint &Point(int32_t halfedgeID) const
+    {
+        return vertexPoints[halfedges[halfedgeID].vertexID];
+    }
+
+    static int32_t Next(int32_t halfedgeID)
+    {
+        return ccm_HalfedgeNextID_Quad(halfedgeID);
+    }
+
+    static int32_t Prev(int32_t halfedgeID)
+    {
+        return ccm_HalfedgePrevID_Quad(halfedgeID);
+    }
+
+    static int32_t Face(int32_t halfedgeID)
+    {
+        return ccm_HalfedgeFaceID_Quad(halfedgeID);
+    }
+};
+
+
+/*******************************************************************************
+ * EdgePoint -- Catmull Clark's edge rule
+ *
+ */
+template <typename Traits, typename View>
+cc_VertexPoint
+EdgePoint(
+    const View &view,
+    const cc_VertexPoint *newFacePoints,
+    int32_t halfedgeID,
+    float sharpness
+) {
+    const int32_t twinID = view.Twin(halfedgeID);
+    const cc_VertexPoint tmp1 = Add(view.Point(halfedgeID),
+                                    view.Point(view.Next(halfedgeID)));
+
+    if constexpr (Traits::hasCreases) {
+        const cc_VertexPoint tmp2 = Add(newFacePoints[view.Face(halfedgeID)],
+                                        newFacePoints[view.Face(Max(0, twinID))]);
+        const cc_VertexPoint sharpPoint = Mul(tmp1, 0.5f);
+        const cc_VertexPoint smoothPoint = Mul(Add(tmp1, tmp2), 0.25f);
+
+        return Lerp(smoothPoint, sharpPoint, Satf(sharpness));
+    } else if constexpr (Traits::hasBoundaries) {
+        (void)sharpness;
+        if (twinID < 0) {
+            return Mul(tmp1, 0.5f);
+        } else {
+            const cc_VertexPoint tmp2 = Add(newFacePoints[view.Face(halfedgeID)],
+                                            newFacePoints[view.Face(twinID)]);
+
+            return Mul(Add(tmp1, tmp2), 0.25f);
+        }
+    } else {
+        (void)sharpness;
+        const cc_VertexPoint tmp2 = Add(newFacePoints[view.Face(halfedgeID)],
+                                        newFacePoints[view.Face(twinID)]);
+
+        return Mul(Add(tmp1, tmp2), 0.25f);
+    }
+}
+
+
+/*******************************************************************************
+ * SmoothVertexPoint -- Catmull Clark's vertex rule
+ *
+ */
+template <typename Traits, typename View>
+cc_VertexPoint
+SmoothVertexPoint(
+    const View &view,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    const cc_VertexPoint &oldPoint,
+    int32_t halfedgeID
+) {
+    cc_VertexPoint smoothPoint =
+        Add(Mul(newFacePoints[view.Face(halfedgeID)], -1.0f),
+            Mul(newEdgePoints[view.Edge(halfedgeID)], +4.0f));
+    float valence = 1.0f;
+    int32_t iterator;
+
+    for (iterator = view.Twin(view.Prev(halfedgeID));
+         (!Traits::hasBoundaries || iterator >= 0) && iterator != halfedgeID;
+         iterator = view.Twin(view.Prev(iterator))) {
+        smoothPoint = Add(smoothPoint, Mul(newFacePoints[view.Face(iterator)], -1.0f));
+        smoothPoint = Add(smoothPoint, Mul(newEdgePoints[view.Edge(iterator)], +4.0f));
+        ++valence;
+    }
+
+    if constexpr (Traits::hasBoundaries) {
+        if (iterator != halfedgeID) {
+            return oldPoint;
+        }
+    }
+
+    return Add(Mul(smoothPoint, 1.0f / (valence * valence)),
+               Mul(oldPoint, 1.0f - 3.0f / valence));
+}
+
+
+/*******************************************************************************
+ * CreasedVertexPoint -- DeRose et al.'s vertex rule
+ *
+ * The IsCage flag reproduces the cage-level rule of the C library, which
+ * relies on boundary vertices mapping to their boundary halfedge.
+ *
+ */
+template <typename Traits, bool IsCage, typename View>
+cc_VertexPoint
+CreasedVertexPoint(
+    const View &view,
+    const cc_VertexPoint *newFacePoints,
+    const cc_VertexPoint *newEdgePoints,
+    const cc_VertexPoint &oldPoint,
+    int32_t halfedgeID
+) {
+    const int32_t prevID = view.Prev(halfedgeID);
+    const float prevS = view.Sharpness(prevID);
+    const float prevCreaseWeight = Signf(prevS);
+    const cc_VertexPoint &newPrevEdgePoint = newEdgePoints[view.Edge(prevID)];
+    cc_VertexPoint smoothPoint =
+        Add(Mul(newFacePoints[view.Face(prevID)], -1.0f),
+            Mul(newPrevEdgePoint, +4.0f));
+    cc_VertexPoint creasePoint = Mul(newPrevEdgePoint, prevCreaseWeight);
+    float avgS = prevS;
+    float creaseCount = prevCreaseWeight;
+    float valence = 1.0f;
+    int32_t forwardIterator;
+
+    for (forwardIterator = view.Twin(prevID);
+         (!Traits::hasBoundaries || forwardIterator >= 0)
+         && forwardIterator != halfedgeID;
+         forwardIterator = view.Twin(forwardIterator)) {
+        const int32_t prevID = view.Prev(forwardIterator);
+        const cc_VertexPoint &newPrevEdgePoint = newEdgePoints[view.Edge(prevID)];
+        const float prevS = view.Sharpness(prevID);
+        const float prevCreaseWeight = Signf(prevS);
+
+        smoothPoint = Add(smoothPoint, Mul(newFacePoints[view.Face(prevID)], -1.0f));
+        smoothPoint = Add(smoothPoint, Mul(newPrevEdgePoint, +4.0f));
+        ++valence;
+        creasePoint = Add(creasePoint, Mul(newPrevEdgePoint, prevCreaseWeight));
+        avgS+= prevS;
+        creaseCount+= prevCreaseWeight;
+        forwardIterator = prevID;
+    }
+
+    if constexpr (Traits::hasBoundaries) {
+        if constexpr (!IsCage) {
+            for (int32_t backwardIterator = view.Twin(halfedgeID);
+                 forwardIterator < 0 && backwardIterator >= 0
+                 && backwardIterator != halfedgeID;
+                 backwardIterator = view.Twin(backwardIterator)) {
+                const int32_t nextID = view.Next(backwardIterator);
+                const cc_VertexPoint &newNextEdgePoint = newEdgePoints[view.Edge(nextID)];
+                const float nextS = view.Sharpness(nextID);
+                const float nextCreaseWeight = Signf(nextS);
+
+                smoothPoint = Add(smoothPoint, Mul(newFacePoints[view.Face(nextID)], -1.0f));
+                smoothPoint = Add(smoothPoint, Mul(newNextEdgePoint, +4.0f));
+                ++valence;
+                creasePoint = Add(creasePoint, Mul(newNextEdgePoint, nextCreaseWeight));
+                avgS+= nextS;
+                creaseCount+= nextCreaseWeight;
+                backwardIterator = nextID;
+            }
+        }
+
+        if (forwardIterator < 0) {
+            const float creaseWeight = Signf(view.Sharpness(halfedgeID));
+            const cc_VertexPoint &newEdgePoint = newEdgePoints[view.Edge(halfedgeID)];
+
+            creasePoint = Add(creasePoint, Mul(newEdgePoint, creaseWeight));
+            creaseCount+= creaseWeight;
+            ++valence;
+        }
+    }
+
+    if (creaseCount <= 1.0f) {
+        return Add(Mul(smoothPoint, 1.0f / (valence * valence)),
+                   Mul(oldPoint, 1.0f - 3.0f / valence));
+    } else if (creaseCount >= 3.0f || valence == 2.0f) {
+        return oldPoint;
+    } else {
+        const float creaseScale = IsCage ? 0.25f : 0.5f / creaseCount;
+
+        creasePoint = Add(Mul(creasePoint, creaseScale), Mul(oldPoint, 0.5f));
+
+        return Lerp(oldPoint, creasePoint, Satf(avgS * 0.5f));
+    }
+}
+
+
+/*******************************************************************************
+ * CagePoints -- Applies the Catmull Clark rules on the cage mesh
+ *
+ */
+template <typename Traits>
+void CagePoints(cc_Subd *subd)
+{
+    const cc_Mesh *cage = subd->cage;
+    const CageView<Traits> view(cage);
+    const int32_t vertexCount = ccm_VertexCount(cage);
+    const int32_t faceCount = ccm_FaceCount(cage);
+    const int32_t edgeCount = ccm_EdgeCount(cage);
+    cc_VertexPoint *newFacePoints = &subd->vertexPoints[vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = subd->vertexPoints;
+
+CC__PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        if constexpr (Traits::isQuadCage) {
+            const int32_t halfedgeID = ccm_FaceToHalfedgeID_Quad(faceID);
+            cc_VertexPoint newFacePoint = view.Point(halfedgeID);
+
+            for (int32_t i = 1; i < 4; ++i) {
+                newFacePoint = Add(newFacePoint, view.Point(halfedgeID + i));
+            }
+
+            newFacePoints[faceID] = Mul(newFacePoint, 0.25f);
+        } else {
+            const int32_t halfedgeID = cage->faceToHalfedgeIDs[faceID];
+            cc_VertexPoint newFacePoint = view.Point(halfedgeID);
+            float faceVertexCount = 1.0f;
+
+            for (int32_t halfedgeIt = view.Next(halfedgeID);
+                         halfedgeIt != halfedgeID;
+                         halfedgeIt = view.Next(halfedgeIt)) {
+                newFacePoint = Add(newFacePoint, view.Point(halfedgeIt));
+                ++faceVertexCount;
+            }
+
+            newFacePoints[faceID] = Mul(newFacePoint, 1.0f / faceVertexCount);
+        }
+    }
+
+CC__PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t halfedgeID = cage->edgeToHalfedgeIDs[edgeID];
+        const float sharpness =
+            Traits::hasCreases ? cage->creases[edgeID].sharpness : 0.0f;
+
+        newEdgePoints[edgeID] = EdgePoint<Traits>(view,
+                                                  newFacePoints,
+                                                  halfedgeID,
+                                                  sharpness);
+    }
+
+CC__PARALLEL_FOR
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        const int32_t halfedgeID = cage->vertexToHalfedgeIDs[vertexID];
+        const cc_VertexPoint &oldPoint = cage->vertexPoints[vertexID];
+
+        if constexpr (Traits::hasCreases) {
+            newVertexPoints[vertexID] =
+                CreasedVertexPoint<Traits, true>(view,
+                                                 newFacePoints,
+                                                 newEdgePoints,
+                                                 oldPoint,
+                                                 halfedgeID);
+        } else {
+            newVertexPoints[vertexID] =
+                SmoothVertexPoint<Traits>(view,
+                                          newFacePoints,
+                                          newEdgePoints,
+                                          oldPoint,
+                                          halfedgeID);
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * Points -- Applies the Catmull Clark rules on the subd
+ *
+ */
+template <typename Traits>
+void Points(cc_Subd *subd, int32_t depth)
+{
+    const cc_Mesh *cage = subd->cage;
+    const LevelView view(subd, depth);
+    const int32_t vertexCount = ccm_VertexCountAtDepth_Fast(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth_Fast(cage, depth);
+    const int32_t edgeCount = ccm_EdgeCountAtDepth_Fast(cage, depth);
+    const int32_t stride = ccs_CumulativeVertexCountAtDepth(cage, depth);
+    cc_VertexPoint *newFacePoints = &subd->vertexPoints[stride + vertexCount];
+    cc_VertexPoint *newEdgePoints = &subd->vertexPoints[stride + vertexCount + faceCount];
+    cc_VertexPoint *newVertexPoints = &subd->vertexPoints[stride];
+
+CC__PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        const int32_t halfedgeID = ccm_FaceToHalfedgeID_Quad(faceID);
+        cc_VertexPoint newFacePoint = view.Point(halfedgeID);
+
+        for (int32_t i = 1; i < 4; ++i) {
+            newFacePoint = Add(newFacePoint, view.Point(halfedgeID + i));
+        }
+
+        newFacePoints[faceID] = Mul(newFacePoint, 0.25f);
+    }
+
+CC__PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t halfedgeID = ccs_EdgeToHalfedgeID(subd, edgeID, depth);
+        const float sharpness =
+            Traits::hasCreases ? view.EdgeSharpness(edgeID) : 0.0f;
+
+        newEdgePoints[edgeID] = EdgePoint<Traits>(view,
+                                                  newFacePoints,
+                                                  halfedgeID,
+                                                  sharpness);
+    }
+
+CC__PARALLEL_FOR
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        const int32_t halfedgeID = ccs_VertexToHalfedgeID(subd, vertexID, depth);
+        const cc_VertexPoint &oldPoint = view.vertexPoints[vertexID];
+
+        if constexpr (Traits::hasCreases) {
+            newVertexPoints[vertexID] =
+                CreasedVertexPoint<Traits, false>(view,
+                                                  newFacePoints,
+                                                  newEdgePoints,
+                                                  oldPoint,
+                                                  halfedgeID);
+        } else {
+            newVertexPoints[vertexID] =
+                SmoothVertexPoint<Traits>(view,
+                                          newFacePoints,
+                                          newEdgePoints,
+                                          oldPoint,
+                                          halfedgeID);
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * Dispatch tables
+ *
+ * Instantiations are indexed by a 4-bit mask built from the traits.
+ *
+ */
+typedef void (*RefineRoutine)(cc_Subd *subd);
+
+inline uint32_t FeatureMask(const MeshFeatures &features)
+{
+    return (features.hasCreases    ? 1u : 0u)
+         | (features.hasBoundaries ? 2u : 0u)
+         | (features.hasUvs        ? 4u : 0u)
+         | (features.isQuadCage    ? 8u : 0u);
+}
+
+template <uint32_t Mask>
+using MaskTraits = KernelTraits<(Mask & 1u) != 0u,
+                                (Mask & 2u) != 0u,
+                                (Mask & 4u) != 0u,
+                                (Mask & 8u) != 0u>;
+
+template <size_t... Masks>
+constexpr std::array<RefineRoutine, sizeof...(Masks)>
+RefineTable(std::index_sequence<Masks...>)
+{
+    return {{&cc::Refine_Gather<MaskTraits<Masks>>...}};
+}
+
+template <size_t... Masks>
+constexpr std::array<RefineRoutine, sizeof...(Masks)>
+RefineVertexPointsTable(std::index_sequence<Masks...>)
+{
+    return {{&cc::RefineVertexPoints_Gather<MaskTraits<Masks>>...}};
+}
+
+} // namespace detail
+
+
+/*******************************************************************************
+ * ScanMesh -- Determines which kernel features a cage requires
+ *
+ * Boundaries are reported as creases, since the creased rules are the ones
+ * that give boundary edges their expected behavior (see obj_to_ccm.c).
+ *
+ */
+inline MeshFeatures ScanMesh(const cc_Mesh *cage)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(cage);
+    const int32_t creaseCount = ccm_CreaseCount(cage);
+    MeshFeatures features = {false, false, false, true};
+
+    for (int32_t edgeID = 0; edgeID < creaseCount; ++edgeID) {
+        features.hasCreases|= ccm_CreaseSharpness(cage, edgeID) != 0.0f;
+    }
+
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const cc_Halfedge &halfedge = cage->halfedges[halfedgeID];
+
+        features.hasBoundaries|= halfedge.twinID < 0;
+        features.isQuadCage&=
+                halfedge.nextID == ccm_HalfedgeNextID_Quad(halfedgeID)
+             && halfedge.faceID == ccm_HalfedgeFaceID_Quad(halfedgeID);
+    }
+
+    features.hasCreases|= features.hasBoundaries;
+    features.isQuadCage&= halfedgeCount == 4 * ccm_FaceCount(cage);
+#ifndef CC_DISABLE_UV
+    features.hasUvs = ccm_UvCount(cage) > 0;
+#endif
+
+    return features;
+}
+
+
+/*******************************************************************************
+ * Refine -- Computes Catmull Clark subdivision with specialized kernels
+ *
+ */
+template <typename Traits>
+void RefineVertexPoints_Gather(cc_Subd *subd)
+{
+    CC_ASSERT(subd->packedDepth > ccs_MaxDepth(subd) && "subd is packed");
+
+    detail::CagePoints<Traits>(subd);
+
+    for (int32_t depth = 1; depth < ccs_MaxDepth(subd); ++depth) {
+        detail::Points<Traits>(subd, depth);
+    }
+}
+
+template <typename Traits>
+void Refine_Gather(cc_Subd *subd)
+{
+    ccs_RefineHalfedges(subd);
+
+    if constexpr (Traits::hasCreases) {
+        ccs_RefineCreases(subd);
+    }
+
+#ifndef CC_DISABLE_UV
+    if constexpr (Traits::hasUvs) {
+        ccs_RefineVertexUvs(subd);
+    }
+#endif
+
+    RefineVertexPoints_Gather<Traits>(subd);
+}
+
+inline void Refine_Gather(cc_Subd *subd, const MeshFeatures &features)
+{
+    static constexpr auto table =
+            detail::RefineTable(std::make_index_sequence<16>());
+
+    table[detail::FeatureMask(features)](subd);
+}
+
+inline void
+RefineVertexPoints_Gather(cc_Subd *subd, const MeshFeatures &features)
+{
+    static constexpr auto table =
+            detail::RefineVertexPointsTable(std::make_index_sequence<16>());
+
+    table[detail::FeatureMask(features)](subd);
+}
+
+inline void Refine_Gather(cc_Subd *subd)
+{
+    Refine_Gather(subd, ScanMesh(subd->cage));
+}
+
+inline void Refine_NoCreases_Gather(cc_Subd *subd)
+{
+    MeshFeatures features = ScanMesh(subd->cage);
+
+    features.hasCreases = false;
+    Refine_Gather(subd, features);
+}
+
+
+/*******************************************************************************
+ * Topology views -- Halfedge queries with strides resolved once
+ *
+ * MeshView reads the arrays of a cc_Mesh; SubdLevel reads a single level of
+ * a subd, whose next, prev, and face queries reduce to quad arithmetic.
+ * Note that SubdLevel::VertexToHalfedge has O(depth) complexity (see
+ * ccs_VertexToHalfedgeID).
+ *
+ */
+struct MeshView {
+    const cc_Mesh *mesh;
+    const cc_Halfedge *halfedges;
+
+    explicit MeshView(const cc_Mesh *mesh):
+        mesh(mesh),
+        halfedges(mesh->halfedges)
+    {}
+
+    int32_t Twin(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].twinID;
+    }
+
+    int32_t Next(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].nextID;
+    }
+
+    int32_t Prev(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].prevID;
+    }
+
+    int32_t Face(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].faceID;
+    }
+
+    int32_t Edge(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].edgeID;
+    }
+
+    int32_t Vertex(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].vertexID;
+    }
+
+    int32_t VertexToHalfedge(int32_t vertexID) const
+    {
+        return mesh->vertexToHalfedgeIDs[vertexID];
+    }
+
+    int32_t FaceToHalfedge(int32_t faceID) const
+    {
+        return mesh->faceToHalfedgeIDs[faceID];
+    }
+
+    const cc_VertexPoint &VertexPoint(int32_t vertexID) const
+    {
+        return mesh->vertexPoints[vertexID];
+    }
+
+    int32_t VertexCount() const   {return ccm_VertexCount(mesh);}
+    int32_t EdgeCount() const     {return ccm_EdgeCount(mesh);}
+    int32_t FaceCount() const     {return ccm_FaceCount(mesh);}
+    int32_t HalfedgeCount() const {return ccm_HalfedgeCount(mesh);}
+};
+
+struct SubdLevel {
+    const cc_Subd *subd;
+    const cc_Halfedge_SemiRegular *halfedges;
+    const cc_VertexPoint *vertexPoints; // nullptr for packed levels
+    int32_t depth;
+
+    SubdLevel(const cc_Subd *subd, int32_t depth):
+        subd(subd),
+        halfedges(nullptr),
+        vertexPoints(nullptr),
+        depth(depth)
+    {
+        const cc_Mesh *cage = subd->cage;
+        CC_ASSERT(depth <= ccs_MaxDepth(subd) && depth > 0);
+
+        halfedges = &subd->halfedges[ccs_CumulativeHalfedgeCountAtDepth(cage, depth - 1)];
+
+        if (depth < subd->packedDepth) {
+            vertexPoints = &subd->vertexPoints[ccs_CumulativeVertexCountAtDepth(cage, depth - 1)];
+        }
+    }
+
+    int32_t Twin(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].twinID;
+    }
+
+    static int32_t Next(int32_t halfedgeID)
+    {
+        return ccm_HalfedgeNextID_Quad(halfedgeID);
+    }
+
+    static int32_t Prev(int32_t halfedgeID)
+    {
+        return ccm_HalfedgePrevID_Quad(halfedgeID);
+    }
+
+    static int32_t Face(int32_t halfedgeID)
+    {
+        return ccm_HalfedgeFaceID_Quad(halfedgeID);
+    }
+
+    int32_t Edge(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].edgeID;
+    }
+
+    int32_t Vertex(int32_t halfedgeID) const
+    {
+        return halfedges[halfedgeID].vertexID;
+    }
+
+    int32_t VertexToHalfedge(int32_t vertexID) const
+    {
+        return ccs_VertexToHalfedgeID(subd, vertexID, depth);
+    }
+
+    static int32_t FaceToHalfedge(int32_t faceID)
+    {
+        return ccm_FaceToHalfedgeID_Quad(faceID);
+    }
+
+    cc_VertexPoint VertexPoint(int32_t vertexID) const
+    {
+        if (vertexPoints) {
+            return vertexPoints[vertexID];
+        } else {
+            return ccs_VertexPoint(subd, vertexID, depth);
+        }
+    }
+
+    int32_t VertexCount() const   {return ccm_VertexCountAtDepth(subd->cage, depth);}
+    int32_t EdgeCount() const     {return ccm_EdgeCountAtDepth(subd->cage, depth);}
+    int32_t FaceCount() const     {return ccm_FaceCountAtDepth(subd->cage, depth);}
+    int32_t HalfedgeCount() const {return ccm_HalfedgeCountAtDepth(subd->cage, depth);}
+};
+
+
+/*******************************************************************************
+ * Topology ranges -- Iteration over IDs, one-rings, and face cycles
+ *
+ * One-rings walk the outgoing halfedges of a vertex with the prev-twin
+ * rotation; when a boundary is reached, the remaining halfedges are walked
+ * from the first one with the twin-next rotation, as the C kernels do.
+ * Each halfedge is thus visited once, and a negative ID terminates the
+ * iteration, so the loops reduce to the hand-written ones.
+ *
+ */
+struct IdRange {
+    struct Iterator {
+        int32_t id;
+
+        int32_t operator*() const {return id;}
+        Iterator &operator++() {++id; return *this;}
+        bool operator!=(const Iterator &it) const {return id != it.id;}
+    };
+
+    int32_t first, last;
+
+    Iterator begin() const {return {first};}
+    Iterator end() const   {return {last};}
+    int32_t size() const   {return last - first;}
+};
+
+struct RangeSentinel {};
+
+template <typename View>
+struct OneRingRange {
+    struct Iterator {
+        View view;
+        int32_t startID;
+        int32_t halfedgeID;
+        bool backward;
+
+        int32_t operator*() const {return halfedgeID;}
+        bool operator!=(RangeSentinel) const {return halfedgeID >= 0;}
+
+        int32_t NextVertexHalfedge(int32_t id) const
+        {
+            const int32_t twinID = view.Twin(id);
+
+            return twinID >= 0 ? view.Next(twinID) : -1;
+        }
+
+        Iterator &operator++()
+        {
+            if (!backward) {
+                halfedgeID = view.Twin(view.Prev(halfedgeID));
+
+                if (halfedgeID < 0) {
+                    backward = true;
+                    halfedgeID = NextVertexHalfedge(startID);
+                } else if (halfedgeID == startID) {
+                    halfedgeID = -1;
+                }
+            } else {
+                halfedgeID = NextVertexHalfedge(halfedgeID);
+            }
+
+            return *this;
+        }
+    };
+
+    View view;
+    int32_t startID;
+
+    Iterator begin() const {return {view, startID, startID, false};}
+    RangeSentinel end() const {return {};}
+};
+
+template <typename View>
+struct FaceCycleRange {
+    struct Iterator {
+        View view;
+        int32_t startID;
+        int32_t halfedgeID;
+
+        int32_t operator*() const {return halfedgeID;}
+        bool operator!=(RangeSentinel) const {return halfedgeID >= 0;}
+
+        Iterator &operator++()
+        {
+            const int32_t nextID = view.Next(halfedgeID);
+
+            halfedgeID = nextID != startID ? nextID : -1;
+
+            return *this;
+        }
+    };
+
+    View view;
+    int32_t startID;
+
+    Iterator begin() const {return {view, startID, startID};}
+    RangeSentinel end() const {return {};}
+};
+
+template <typename View>
+inline OneRingRange<View> OneRingFrom(const View &view, int32_t halfedgeID)
+{
+    return {view, halfedgeID};
+}
+
+template <typename View>
+inline OneRingRange<View> OneRing(const View &view, int32_t vertexID)
+{
+    return OneRingFrom(view, view.VertexToHalfedge(vertexID));
+}
+
+inline FaceCycleRange<MeshView> FaceCycle(const MeshView &view, int32_t faceID)
+{
+    return {view, view.FaceToHalfedge(faceID)};
+}
+
+inline IdRange FaceCycle(const SubdLevel &level, int32_t faceID)
+{
+    (void)level;
+    const int32_t halfedgeID = SubdLevel::FaceToHalfedge(faceID);
+
+    return {halfedgeID, halfedgeID + 4};
+}
+
+template <typename View>
+inline IdRange Vertices(const View &view)
+{
+    return {0, view.VertexCount()};
+}
+
+template <typename View>
+inline IdRange Edges(const View &view)
+{
+    return {0, view.EdgeCount()};
+}
+
+template <typename View>
+inline IdRange Faces(const View &view)
+{
+    return {0, view.FaceCount()};
+}
+
+template <typename View>
+inline IdRange Halfedges(const View &view)
+{
+    return {0, view.HalfedgeCount()};
+}
+
+} // namespace cc
+
+#undef CC__PARALLEL_FOR
+#ifdef CC__UNDEF_ASSERT
+#   undef CC_ASSERT
+#   undef CC__UNDEF_ASSERT
+#endif
+
+#endif // CC_INCLUDE_CC_HPP
@@ -18,6 +18,7 @@ by Jonathan Dupuy
    define CBF_FREE(x) to use your own memory deallocator
    define CBF_MEMCPY(dst, src, num) to use your own memcpy routine
    define CBF_MEMSET(ptr, value, num) to use your own memset routine
+   define CBF_BARRIER to override the barrier that follows parallel loops
 */
 
 #ifndef CBF_INCLUDE_CBF_H
@@ -54,6 +55,12 @@ CBFDEF int64_t cbf_EncodeBit(const cbf_BitField *cbf, int64_t bitID);
 CBFDEF void cbf_Clear(cbf_BitField *cbf);
 CBFDEF uint64_t cbf_GetBit(const cbf_BitField *cbf, int64_t bitID);
 CBFDEF void cbf_SetBit(cbf_BitField *cbf, int64_t bitID, uint64_t bitValue);
+typedef uint64_t (*cbf_BitPredicate)(int64_t bitID, const void *userData);
+CBFDEF void cbf_SetBits(cbf_BitField *cbf,
+                        int64_t beginID,
+                        int64_t endID,
+                        cbf_BitPredicate predicate,
+                        const void *userData);
 CBFDEF void cbf_Reduce(cbf_BitField *cbf);
 typedef void (*cbf_UpdateCallback)(cbf_BitField *cbf,
                                    const int64_t bitID,
@@ -107,18 +114,36 @@ CBFDEF void cbf_SetHeap(cbf_BitField *tree, const char *heapToCopy);
 #endif
 
 #ifndef _OPENMP
-#   define CBF_ATOMIC
-#   define CBF_PARALLEL_FOR
-#   define CBF_BARRIER
+#   ifndef CBF_ATOMIC
+#       define CBF_ATOMIC
+#   endif
+#   ifndef CBF_PARALLEL_FOR
+#       define CBF_PARALLEL_FOR
+#   endif
+#   ifndef CBF_BARRIER
+#       define CBF_BARRIER
+#   endif
 #else
 #   if defined(_WIN32)
-#       define CBF_ATOMIC          __pragma("omp atomic" )
-#       define CBF_PARALLEL_FOR    __pragma("omp parallel for")
-#       define CBF_BARRIER         __pragma("omp barrier")
+#       ifndef CBF_ATOMIC
+#           define CBF_ATOMIC          __pragma("omp atomic" )
+#       endif
+#       ifndef CBF_PARALLEL_FOR
+#           define CBF_PARALLEL_FOR    __pragma("omp parallel for")
+#       endif
+#       ifndef CBF_BARRIER
+#           define CBF_BARRIER         __pragma("omp barrier")
+#       endif
 #   else
-#       define CBF_ATOMIC          _Pragma("omp atomic" )
-#       define CBF_PARALLEL_FOR    _Pragma("omp parallel for")
-#       define CBF_BARRIER         _Pragma("omp barrier")
+#       ifndef CBF_ATOMIC
+#           define CBF_ATOMIC          _Pragma("omp atomic" )
+#       endif
+#       ifndef CBF_PARALLEL_FOR
+#           define CBF_PARALLEL_FOR    _Pragma("omp parallel for")
+#       endif
+#       ifndef CBF_BARRIER
+#           define CBF_BARRIER         _Pragma("omp barrier")
+#       endif
 #   endif
 #endif
 
@@ -177,6 +202,20 @@ static inline int64_t cbf__FindMSB(uint64_t x)
 }
 
 
+/*******************************************************************************
+ * BitCount64 -- Returns the number of bits set to one in a 64-bit word
+ *
+ */
+static inline int64_t cbf__BitCount64(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+    return (int64_t)((x * 0x0101010101010101ULL) >> 56);
+}
+
+
 /*******************************************************************************
  * MinValue -- Returns the minimum value between two inputs
  *
@@ -257,6 +296,7 @@ cbf__BitFieldExtract(
  */
 struct cbf_BitField {
     uint64_t *heap;
+    uint64_t *dirtyWords;   // one bit per 64-bit word of the bitfield
 };
 
 
@@ -341,6 +381,40 @@ static int64_t cbf__BitFieldUint64Index(const cbf_BitField *cbf)
 }
 
 
+/*******************************************************************************
+ * BitFieldUint64Size -- Computes the number of uints that store the bitfield
+ *
+ */
+static inline int64_t cbf__BitFieldUint64Size(int64_t heapMaxDepth)
+{
+    return 1LL << (heapMaxDepth - 6);
+}
+
+
+/*******************************************************************************
+ * DirtyUint64Size -- Computes the number of uints that track dirty words
+ *
+ */
+static inline int64_t cbf__DirtyUint64Size(int64_t heapMaxDepth)
+{
+    return heapMaxDepth < 12 ? 1LL : 1LL << (heapMaxDepth - 12);
+}
+
+
+/*******************************************************************************
+ * MarkDirty -- Flags a 64-bit word of the bitfield for the next reduction
+ *
+ */
+static inline void cbf__MarkDirty(cbf_BitField *cbf, int64_t wordID)
+{
+    uint64_t *dirtyWord = &cbf->dirtyWords[wordID >> 6];
+    const uint64_t dirtyBit = 1ULL << (wordID & 63);
+
+CBF_ATOMIC
+    (*dirtyWord)|= dirtyBit;
+}
+
+
 /*******************************************************************************
  * NodeBitID -- Returns the bit index that stores data associated with a given node
  *
@@ -482,7 +556,60 @@ CBFDEF void cbf_SetBit(cbf_BitField *cbf, int64_t bitID, uint64_t bitValue)
 {
     uint64_t *bitField = &cbf->heap[cbf__BitFieldUint64Index(cbf)];
 
-    cbf__SetBitValue(&bitField[bitID >> 6], bitID & 63, bitValue);
+    if (cbf__GetBitValue(&bitField[bitID >> 6], bitID & 63) != bitValue) {
+        cbf__SetBitValue(&bitField[bitID >> 6], bitID & 63, bitValue);
+        cbf__MarkDirty(cbf, bitID >> 6);
+    }
+}
+
+
+/*******************************************************************************
+ * SetBits -- Sets the bits in range [beginID, endID) from a predicate
+ *
+ * The predicate returns the value (0 or 1) of each bit. Each 64-bit word
+ * of the bitfield is assembled locally by a single thread and stored with
+ * a plain write, so no atomics are required. Bits outside the range retain
+ * their value. Note that this procedure should not run concurrently with
+ * other writes to the bitfield.
+ *
+ */
+CBFDEF void
+cbf_SetBits(
+    cbf_BitField *cbf,
+    int64_t beginID,
+    int64_t endID,
+    cbf_BitPredicate predicate,
+    const void *userData
+) {
+    uint64_t *bitField = &cbf->heap[cbf__BitFieldUint64Index(cbf)];
+    const int64_t beginWordID = beginID >> 6;
+    const int64_t endWordID = (endID + 63) >> 6;
+
+    CBF_ASSERT(beginID >= 0 && endID <= cbf_Size(cbf) && "invalid bit range");
+
+CBF_PARALLEL_FOR
+    for (int64_t wordID = beginWordID; wordID < endWordID; ++wordID) {
+        const int64_t minBitID = wordID << 6;
+        const int64_t firstBitID = minBitID > beginID ? minBitID : beginID;
+        const int64_t lastBitID = minBitID + 64 < endID ? minBitID + 64 : endID;
+        uint64_t bitMask = 0u;
+        uint64_t bitData = 0u;
+
+        for (int64_t bitID = firstBitID; bitID < lastBitID; ++bitID) {
+            const uint64_t bitValue = predicate(bitID, userData) & 1u;
+
+            bitMask|= 1ULL << (bitID & 63);
+            bitData|= bitValue << (bitID & 63);
+        }
+
+        bitData|= bitField[wordID] & ~bitMask;
+
+        if (bitField[wordID] != bitData) {
+            bitField[wordID] = bitData;
+            cbf__MarkDirty(cbf, wordID);
+        }
+    }
+CBF_BARRIER
 }
 
 
@@ -507,6 +634,9 @@ CBFDEF void cbf_Clear(cbf_BitField *cbf)
     int64_t heapDepth = cbf_HeapMaxDepth(cbf);
 
     CBF_MEMSET(cbf->heap, 0, cbf_HeapByteSize(cbf));
+    CBF_MEMSET(cbf->dirtyWords,
+               0,
+               sizeof(uint64_t) * cbf__DirtyUint64Size(heapDepth));
     cbf->heap[0] = 1ULL << heapDepth;
 }
 
@@ -524,10 +654,18 @@ CBFDEF const char *cbf_GetHeap(const cbf_BitField *tree)
 /*******************************************************************************
  * SetHeap -- Sets the heap memory from a read-only buffer
  *
+ * All the words of the bitfield are flagged as dirty so that the next
+ * reduction rebuilds the entire sum tree.
+ *
  */
 CBFDEF void cbf_SetHeap(cbf_BitField *tree, const char *buffer)
 {
+    const int64_t heapDepth = cbf_HeapMaxDepth(tree);
+
     CBF_MEMCPY(tree->heap, buffer, cbf_HeapByteSize(tree));
+    CBF_MEMSET(tree->dirtyWords,
+               0xFF,
+               sizeof(uint64_t) * cbf__DirtyUint64Size(heapDepth));
 }
 
 
@@ -544,8 +682,95 @@ CBFDEF int64_t cbf_HeapByteSize(const cbf_BitField *tree)
 /*******************************************************************************
  * Reduce -- Sums the 2 elements below the current slot
  *
+ * The sum tree is updated incrementally: only the ancestors of the 64-bit
+ * words that changed since the last reduction (see MarkDirty) are
+ * recomputed. When more than 1 / 2^CBF__DIRTY_RATIO_LOG2 of the words
+ * changed, the entire tree is rebuilt instead.
+ *
  */
-CBFDEF void cbf_Reduce(cbf_BitField *tree)
+#define CBF__DIRTY_RATIO_LOG2 3
+
+static void
+cbf__ReducePrepass(cbf_BitField *tree, uint64_t nodeID, int64_t depth)
+{
+    const uint64_t minNodeID = (1ULL << depth);
+    cbf__Node heapNode = cbf__CreateNode(nodeID, depth);
+    int64_t alignedBitOffset = cbf__NodeBitID(tree, heapNode);
+    uint64_t bitField = tree->heap[alignedBitOffset >> 6];
+    uint64_t bitData = 0u;
+
+    // 2-bits
+    bitField = (bitField & 0x5555555555555555ULL)
+             + ((bitField >>  1) & 0x5555555555555555ULL);
+    bitData = bitField;
+    tree->heap[(alignedBitOffset - minNodeID) >> 6] = bitData;
+
+    // 3-bits
+    bitField = (bitField & 0x3333333333333333ULL)
+             + ((bitField >>  2) & 0x3333333333333333ULL);
+    bitData = ((bitField >>  0) & (7ULL <<  0))
+            | ((bitField >>  1) & (7ULL <<  3))
+            | ((bitField >>  2) & (7ULL <<  6))
+            | ((bitField >>  3) & (7ULL <<  9))
+            | ((bitField >>  4) & (7ULL << 12))
+            | ((bitField >>  5) & (7ULL << 15))
+            | ((bitField >>  6) & (7ULL << 18))
+            | ((bitField >>  7) & (7ULL << 21))
+            | ((bitField >>  8) & (7ULL << 24))
+            | ((bitField >>  9) & (7ULL << 27))
+            | ((bitField >> 10) & (7ULL << 30))
+            | ((bitField >> 11) & (7ULL << 33))
+            | ((bitField >> 12) & (7ULL << 36))
+            | ((bitField >> 13) & (7ULL << 39))
+            | ((bitField >> 14) & (7ULL << 42))
+            | ((bitField >> 15) & (7ULL << 45));
+    cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 2, depth - 2), 48ULL, bitData);
+
+    // 4-bits
+    bitField = (bitField & 0x0F0F0F0F0F0F0F0FULL)
+             + ((bitField >>  4) & 0x0F0F0F0F0F0F0F0FULL);
+    bitData = ((bitField >>  0) & (15ULL <<  0))
+            | ((bitField >>  4) & (15ULL <<  4))
+            | ((bitField >>  8) & (15ULL <<  8))
+            | ((bitField >> 12) & (15ULL << 12))
+            | ((bitField >> 16) & (15ULL << 16))
+            | ((bitField >> 20) & (15ULL << 20))
+            | ((bitField >> 24) & (15ULL << 24))
+            | ((bitField >> 28) & (15ULL << 28));
+    cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 3, depth - 3), 32ULL, bitData);
+
+    // 5-bits
+    bitField = (bitField & 0x00FF00FF00FF00FFULL)
+             + ((bitField >>  8) & 0x00FF00FF00FF00FFULL);
+    bitData = ((bitField >>  0) & (31ULL <<  0))
+            | ((bitField >> 11) & (31ULL <<  5))
+            | ((bitField >> 22) & (31ULL << 10))
+            | ((bitField >> 33) & (31ULL << 15));
+    cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 4, depth - 4), 20ULL, bitData);
+
+    // 6-bits
+    bitField = (bitField & 0x0000FFFF0000FFFFULL)
+             + ((bitField >> 16) & 0x0000FFFF0000FFFFULL);
+    bitData = ((bitField >>  0) & (63ULL << 0))
+            | ((bitField >> 26) & (63ULL << 6));
+    cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 5, depth - 5), 12ULL, bitData);
+
+    // 7-bits
+    bitField = (bitField & 0x00000000FFFFFFFFULL)
+             + ((bitField >> 32) & 0x00000000FFFFFFFFULL);
+    bitData = bitField;
+    cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 6, depth - 6),  7ULL, bitData);
+}
+
+static void cbf__ReduceNode(cbf_BitField *tree, uint64_t nodeID, int64_t depth)
+{
+    uint64_t x0 = cbf__HeapRead(tree, cbf__CreateNode(nodeID << 1    , depth + 1));
+    uint64_t x1 = cbf__HeapRead(tree, cbf__CreateNode(nodeID << 1 | 1, depth + 1));
+
+    cbf__HeapWrite(tree, cbf__CreateNode(nodeID, depth), x0 + x1);
+}
+
+static void cbf__ReduceAll(cbf_BitField *tree)
 {
     int64_t depth = cbf_HeapMaxDepth(tree);
     uint64_t minNodeID = (1ULL << depth);
@@ -554,72 +779,7 @@ CBFDEF void cbf_Reduce(cbf_BitField *tree)
     // prepass: processes deepest levels in parallel
 CBF_PARALLEL_FOR
     for (uint64_t nodeID = minNodeID; nodeID < maxNodeID; nodeID+= 64u) {
-        cbf__Node heapNode = cbf__CreateNode(nodeID, depth);
-        int64_t alignedBitOffset = cbf__NodeBitID(tree, heapNode);
-        uint64_t bitField = tree->heap[alignedBitOffset >> 6];
-        uint64_t bitData = 0u;
-
-        // 2-bits
-        bitField = (bitField & 0x5555555555555555ULL)
-                 + ((bitField >>  1) & 0x5555555555555555ULL);
-        bitData = bitField;
-        tree->heap[(alignedBitOffset - minNodeID) >> 6] = bitData;
-
-        // 3-bits
-        bitField = (bitField & 0x3333333333333333ULL)
-                 + ((bitField >>  2) & 0x3333333333333333ULL);
-        bitData = ((bitField >>  0) & (7ULL <<  0))
-                | ((bitField >>  1) & (7ULL <<  3))
-                | ((bitField >>  2) & (7ULL <<  6))
-                | ((bitField >>  3) & (7ULL <<  9))
-                | ((bitField >>  4) & (7ULL << 12))
-                | ((bitField >>  5) & (7ULL << 15))
-                | ((bitField >>  6) & (7ULL << 18))
-                | ((bitField >>  7) & (7ULL << 21))
-                | ((bitField >>  8) & (7ULL << 24))
-                | ((bitField >>  9) & (7ULL << 27))
-                | ((bitField >> 10) & (7ULL << 30))
-                | ((bitField >> 11) & (7ULL << 33))
-                | ((bitField >> 12) & (7ULL << 36))
-                | ((bitField >> 13) & (7ULL << 39))
-                | ((bitField >> 14) & (7ULL << 42))
-                | ((bitField >> 15) & (7ULL << 45));
-        cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 2, depth - 2), 48ULL, bitData);
-
-        // 4-bits
-        bitField = (bitField & 0x0F0F0F0F0F0F0F0FULL)
-                 + ((bitField >>  4) & 0x0F0F0F0F0F0F0F0FULL);
-        bitData = ((bitField >>  0) & (15ULL <<  0))
-                | ((bitField >>  4) & (15ULL <<  4))
-                | ((bitField >>  8) & (15ULL <<  8))
-                | ((bitField >> 12) & (15ULL << 12))
-                | ((bitField >> 16) & (15ULL << 16))
-                | ((bitField >> 20) & (15ULL << 20))
-                | ((bitField >> 24) & (15ULL << 24))
-                | ((bitField >> 28) & (15ULL << 28));
-        cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 3, depth - 3), 32ULL, bitData);
-
-        // 5-bits
-        bitField = (bitField & 0x00FF00FF00FF00FFULL)
-                 + ((bitField >>  8) & 0x00FF00FF00FF00FFULL);
-        bitData = ((bitField >>  0) & (31ULL <<  0))
-                | ((bitField >> 11) & (31ULL <<  5))
-                | ((bitField >> 22) & (31ULL << 10))
-                | ((bitField >> 33) & (31ULL << 15));
-        cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 4, depth - 4), 20ULL, bitData);
-
-        // 6-bits
-        bitField = (bitField & 0x0000FFFF0000FFFFULL)
-                 + ((bitField >> 16) & 0x0000FFFF0000FFFFULL);
-        bitData = ((bitField >>  0) & (63ULL << 0))
-                | ((bitField >> 26) & (63ULL << 6));
-        cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 5, depth - 5), 12ULL, bitData);
-
-        // 7-bits
-        bitField = (bitField & 0x00000000FFFFFFFFULL)
-                 + ((bitField >> 32) & 0x00000000FFFFFFFFULL);
-        bitData = bitField;
-        cbf__HeapWriteExplicit(tree, cbf__CreateNode(nodeID >> 6, depth - 6),  7ULL, bitData);
+        cbf__ReducePrepass(tree, nodeID, depth);
     }
 CBF_BARRIER
     depth-= 6;
@@ -631,15 +791,87 @@ CBF_BARRIER
 
 CBF_PARALLEL_FOR
         for (uint64_t j = minNodeID; j < maxNodeID; ++j) {
-            uint64_t x0 = cbf__HeapRead(tree, cbf__CreateNode(j << 1    , depth + 1));
-            uint64_t x1 = cbf__HeapRead(tree, cbf__CreateNode(j << 1 | 1, depth + 1));
+            cbf__ReduceNode(tree, j, depth);
+        }
+CBF_BARRIER
+    }
+}
 
-            cbf__HeapWrite(tree, cbf__CreateNode(j, depth), x0 + x1);
+static void cbf__ReduceDirty(cbf_BitField *tree, int64_t dirtyWordCount)
+{
+    int64_t depth = cbf_HeapMaxDepth(tree);
+    const uint64_t minNodeID = (1ULL << depth);
+    const int64_t dirtySize = cbf__DirtyUint64Size(depth);
+    uint64_t *nodeIDs = (uint64_t *)CBF_MALLOC(sizeof(uint64_t) * dirtyWordCount);
+    int64_t nodeCount = 0;
+
+    // gather the dirty words in increasing order
+    for (int64_t dirtyID = 0; dirtyID < dirtySize; ++dirtyID) {
+        uint64_t dirtyWord = tree->dirtyWords[dirtyID];
+
+        while (dirtyWord != 0u) {
+            nodeIDs[nodeCount++] = (dirtyID << 6) + cbf__FindLSB(dirtyWord);
+            dirtyWord&= dirtyWord - 1u;
+        }
+    }
+
+    // prepass: processes deepest levels of the dirty words in parallel
+CBF_PARALLEL_FOR
+    for (int64_t nodeIt = 0; nodeIt < nodeCount; ++nodeIt) {
+        cbf__ReducePrepass(tree, minNodeID + (nodeIDs[nodeIt] << 6), depth);
+    }
+CBF_BARRIER
+    depth-= 6;
+
+    for (int64_t nodeIt = 0; nodeIt < nodeCount; ++nodeIt) {
+        nodeIDs[nodeIt]+= 1ULL << depth;
+    }
+
+    // iterate over the ancestors of the dirty words
+    while (--depth >= 0) {
+        int64_t parentCount = 0;
+
+        for (int64_t nodeIt = 0; nodeIt < nodeCount; ++nodeIt) {
+            const uint64_t parentID = nodeIDs[nodeIt] >> 1;
+
+            if (parentCount == 0 || nodeIDs[parentCount - 1] != parentID) {
+                nodeIDs[parentCount++] = parentID;
+            }
+        }
+        nodeCount = parentCount;
+
+CBF_PARALLEL_FOR
+        for (int64_t nodeIt = 0; nodeIt < nodeCount; ++nodeIt) {
+            cbf__ReduceNode(tree, nodeIDs[nodeIt], depth);
         }
 CBF_BARRIER
     }
+
+    CBF_FREE(nodeIDs);
+}
+
+CBFDEF void cbf_Reduce(cbf_BitField *tree)
+{
+    const int64_t heapDepth = cbf_HeapMaxDepth(tree);
+    const int64_t wordCount = cbf__BitFieldUint64Size(heapDepth);
+    const int64_t dirtySize = cbf__DirtyUint64Size(heapDepth);
+    int64_t dirtyWordCount = 0;
+
+    for (int64_t dirtyID = 0; dirtyID < dirtySize; ++dirtyID) {
+        dirtyWordCount+= cbf__BitCount64(tree->dirtyWords[dirtyID]);
+    }
+
+    if (dirtyWordCount > (wordCount >> CBF__DIRTY_RATIO_LOG2)) {
+        cbf__ReduceAll(tree);
+    } else if (dirtyWordCount > 0) {
+        cbf__ReduceDirty(tree, dirtyWordCount);
+    }
+
+    CBF_MEMSET(tree->dirtyWords, 0, sizeof(uint64_t) * dirtySize);
 }
 
+#undef CBF__DIRTY_RATIO_LOG2
+
 
 /*******************************************************************************
  * Bitfield Ctor
@@ -654,6 +886,8 @@ CBFDEF cbf_BitField *cbf_Create(int64_t size)
     if (heapDepth < 6) heapDepth = 6;
 
     cbf->heap = (uint64_t *)CBF_MALLOC(cbf__HeapByteSize(heapDepth));
+    cbf->dirtyWords = (uint64_t *)CBF_MALLOC(sizeof(uint64_t)
+                                             * cbf__DirtyUint64Size(heapDepth));
     cbf->heap[0] = 1ULL << heapDepth;
 
     cbf_Clear(cbf);
@@ -669,6 +903,7 @@ CBFDEF cbf_BitField *cbf_Create(int64_t size)
 CBFDEF void cbf_Release(cbf_BitField *cbf)
 {
     CBF_FREE(cbf->heap);
+    CBF_FREE(cbf->dirtyWords);
     CBF_FREE(cbf);
 }
 
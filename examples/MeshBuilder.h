@@ -0,0 +1,539 @@
+/* mb.h - public domain routines for building halfedge meshes in parallel
+by Jonathan Dupuy
+
+   This file builds the connectivity of a cc_Mesh from its per-halfedge
+   vertex and uv indices. It is shared by the programs of this folder that
+   produce .ccm files.
+
+   Do this:
+      #define MB_IMPLEMENTATION
+   before you include this file in *one* C or C++ file to create the implementation.
+
+   // i.e. it should look like this:
+   #include "CatmullClark.h"
+   #include "ConcurrentBitField.h"
+   #define MB_IMPLEMENTATION
+   #include "MeshBuilder.h"
+
+   USAGE
+       Fill the vertexPoints, uvs, and the vertexID / uvID of each halfedge
+       of a mesh, then call
+
+       mb_LoadFaceMappings(mesh, faceIterator); // or set next / prev / face IDs
+       mb_ComputeTwins(mesh);
+       mb_LoadEdgeMappings(mesh);
+       mb_LoadVertexHalfedges(mesh);
+       mb_CreateCreases(mesh);
+       // ... set crease sharpness values ...
+       mb_MakeBoundariesSharp(mesh);
+       mb_ComputeCreaseNeighbors(mesh);
+
+   INTERFACING
+   define MB_ASSERT(x) to avoid using assert.h
+   define MB_MALLOC(x) to use your own memory allocator
+   define MB_FREE(x) to use your own memory deallocator
+   define MB_BARRIER to override the barrier that follows parallel loops
+*/
+
+#ifndef MB_INCLUDE_MB_H
+#define MB_INCLUDE_MB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef MB_STATIC
+#define MBDEF static
+#else
+#define MBDEF extern
+#endif
+
+// face mappings from a bitfield that flags the first halfedge of each face
+MBDEF void mb_LoadFaceMappings(cc_Mesh *mesh, const cbf_BitField *faceIterator);
+
+// halfedge connectivity
+MBDEF void mb_ComputeTwins(cc_Mesh *mesh);
+MBDEF void mb_LoadEdgeMappings(cc_Mesh *mesh);
+MBDEF void mb_LoadVertexHalfedges(cc_Mesh *mesh);
+
+// creases
+MBDEF void mb_CreateCreases(cc_Mesh *mesh);
+MBDEF void mb_MakeBoundariesSharp(cc_Mesh *mesh);
+MBDEF void mb_ComputeCreaseNeighbors(cc_Mesh *mesh);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+//
+//
+//// end header file ///////////////////////////////////////////////////////////
+#endif // MB_INCLUDE_MB_H
+
+#ifdef MB_IMPLEMENTATION
+
+#ifndef MB_ASSERT
+#    include <assert.h>
+#    define MB_ASSERT(x) assert(x)
+#endif
+
+#ifndef MB_MALLOC
+#    include <stdlib.h>
+#    define MB_MALLOC(x) (malloc(x))
+#    define MB_FREE(x) (free(x))
+#else
+#    ifndef MB_FREE
+#        error MB_MALLOC defined without MB_FREE
+#    endif
+#endif
+
+#ifndef _OPENMP
+#   ifndef MB_ATOMIC
+#       define MB_ATOMIC
+#   endif
+#   ifndef MB_PARALLEL_FOR
+#       define MB_PARALLEL_FOR
+#   endif
+#   ifndef MB_BARRIER
+#       define MB_BARRIER
+#   endif
+#else
+#   if defined(_WIN32)
+#       ifndef MB_ATOMIC
+#           define MB_ATOMIC          __pragma("omp atomic" )
+#       endif
+#       ifndef MB_PARALLEL_FOR
+#           define MB_PARALLEL_FOR    __pragma("omp parallel for")
+#       endif
+#       ifndef MB_BARRIER
+#           define MB_BARRIER         __pragma("omp barrier")
+#       endif
+#   else
+#       ifndef MB_ATOMIC
+#           define MB_ATOMIC          _Pragma("omp atomic" )
+#       endif
+#       ifndef MB_PARALLEL_FOR
+#           define MB_PARALLEL_FOR    _Pragma("omp parallel for")
+#       endif
+#       ifndef MB_BARRIER
+#           define MB_BARRIER         _Pragma("omp barrier")
+#       endif
+#   endif
+#endif
+
+
+/*******************************************************************************
+ * Max -- Returns the maximum value between two integers
+ *
+ */
+static int32_t mb__Max(int32_t x, int32_t y)
+{
+    return x > y ? x : y;
+}
+
+
+/*******************************************************************************
+ * LoadFaceMappings -- Computes the mappings for the faces of the mesh
+ *
+ * The face iterator has one more bit than there are halfedges in the mesh;
+ * it flags the first halfedge of each face, as well as the last bit.
+ *
+ */
+static int32_t mb__FaceScroll(int32_t id, int32_t direction, int32_t maxValue)
+{
+    const int32_t n = maxValue - 1;
+    const int32_t d = direction;
+    const int32_t u = (d + 1) >> 1; // in [0, 1]
+    const int32_t un = u * n; // precomputation
+
+    return (id == un) ? (n - un) : (id + d);
+}
+
+static int32_t
+mb__ScrollFaceHalfedgeID(
+    int32_t halfedgeID,
+    int32_t halfedgeFaceBeginID,
+    int32_t halfedgeFaceEndID,
+    int32_t direction
+) {
+    const int32_t faceHalfedgeCount = halfedgeFaceEndID - halfedgeFaceBeginID;
+    const int32_t localHalfedgeID = halfedgeID - halfedgeFaceBeginID;
+    const int32_t nextHalfedgeID = mb__FaceScroll(localHalfedgeID,
+                                                  direction,
+                                                  faceHalfedgeCount);
+
+    return halfedgeFaceBeginID + nextHalfedgeID;
+}
+
+MBDEF void mb_LoadFaceMappings(cc_Mesh *mesh, const cbf_BitField *faceIterator)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t faceCount = cbf_BitCount(faceIterator) - 1;
+
+    mesh->faceToHalfedgeIDs = (int32_t *)MB_MALLOC(sizeof(int32_t) * faceCount);
+    mesh->faceCount = faceCount;
+
+MB_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
+        const int32_t tmp = cbf_EncodeBit(faceIterator, halfedgeID);
+        const int32_t faceID = tmp - (cbf_GetBit(faceIterator, halfedgeID) ^ 1);
+
+        mesh->halfedges[halfedgeID].faceID = faceID;
+    }
+MB_BARRIER
+
+MB_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        mesh->faceToHalfedgeIDs[faceID] = cbf_DecodeBit(faceIterator, faceID);
+    }
+MB_BARRIER
+
+
+MB_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
+        const int32_t faceID = mesh->halfedges[halfedgeID].faceID;
+        const int32_t beginID = cbf_DecodeBit(faceIterator, faceID);
+        const int32_t endID = cbf_DecodeBit(faceIterator, faceID + 1);
+        const int32_t nextID = mb__ScrollFaceHalfedgeID(halfedgeID, beginID, endID, +1);
+        const int32_t prevID = mb__ScrollFaceHalfedgeID(halfedgeID, beginID, endID, -1);
+
+        mesh->halfedges[halfedgeID].nextID = nextID;
+        mesh->halfedges[halfedgeID].prevID = prevID;
+    }
+MB_BARRIER
+}
+
+
+/*******************************************************************************
+ * ComputeTwins -- Computes the twin of each half edge
+ *
+ * This routine is what effectively converts a traditional "indexed mesh"
+ * into a halfedge mesh (in the case where all the primitives are the same).
+ *
+ */
+typedef struct {
+    int32_t halfedgeID;
+    uint64_t hashID;
+} mb__TwinComputationData;
+
+static int32_t
+mb__BinarySearch(
+    const mb__TwinComputationData *array,
+    int32_t arraySize,
+    uint64_t hashID
+) {
+    int32_t a = 0, b = arraySize - 1;
+
+    while (a <= b) {
+        const int32_t c = (a + b) / 2;
+
+        if (array[c].hashID < hashID) {
+            a = c + 1;
+        } else {
+            b = c - 1;
+        }
+    }
+
+    return (array[a].hashID == hashID) ? array[a].halfedgeID : -1;
+}
+
+static void
+mb__SortTwinComputationData(mb__TwinComputationData *array, uint32_t arraySize)
+{
+    for (uint32_t d2 = 1u; d2 < arraySize; d2*= 2u) {
+        for (uint32_t d1 = d2; d1 >= 1u; d1/= 2u) {
+            const uint32_t mask = (0xFFFFFFFEu * d1);
+
+MB_PARALLEL_FOR
+            for (uint32_t i = 0; i < (arraySize / 2); ++i) {
+                const uint32_t i1 = ((i << 1) & mask) | (i & ~(mask >> 1));
+                const uint32_t i2 = i1 | d1;
+                const mb__TwinComputationData t1 = array[i1];
+                const mb__TwinComputationData t2 = array[i2];
+                const mb__TwinComputationData min = t1.hashID < t2.hashID ? t1 : t2;
+                const mb__TwinComputationData max = t1.hashID < t2.hashID ? t2 : t1;
+
+                if ((i & d2) == 0) {
+                    array[i1] = min;
+                    array[i2] = max;
+                } else {
+                    array[i1] = max;
+                    array[i2] = min;
+                }
+            }
+MB_BARRIER
+        }
+    }
+}
+
+static int32_t mb__RoundUpToPowerOfTwo(int32_t x)
+{
+    x--;
+    x|= x >>  1;
+    x|= x >>  2;
+    x|= x >>  4;
+    x|= x >>  8;
+    x|= x >> 16;
+    x++;
+
+    return x;
+}
+
+MBDEF void mb_ComputeTwins(cc_Mesh *mesh)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t vertexCount = ccm_VertexCount(mesh);
+    const int32_t tableSize = mb__RoundUpToPowerOfTwo(halfedgeCount);
+    mb__TwinComputationData *table =
+        (mb__TwinComputationData *)MB_MALLOC(tableSize * sizeof(*table));
+
+MB_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+        const int32_t v0 = ccm_HalfedgeVertexID(mesh, halfedgeID);
+        const int32_t v1 = ccm_HalfedgeVertexID(mesh, nextID);
+
+        table[halfedgeID].halfedgeID = halfedgeID;
+        table[halfedgeID].hashID = (uint64_t)v0 + (uint64_t)vertexCount * v1;
+    }
+MB_BARRIER
+
+MB_PARALLEL_FOR
+    for (int32_t halfedgeID = halfedgeCount; halfedgeID < tableSize; ++halfedgeID) {
+        table[halfedgeID].hashID = ~0ULL;
+    }
+MB_BARRIER
+
+    mb__SortTwinComputationData(table, tableSize);
+
+MB_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+        const int32_t v0 = ccm_HalfedgeVertexID(mesh, halfedgeID);
+        const int32_t v1 = ccm_HalfedgeVertexID(mesh, nextID);
+        const uint64_t hashID = (uint64_t)v1 + (uint64_t)vertexCount * v0;
+        const int32_t twinID = mb__BinarySearch(table, halfedgeCount - 1, hashID);
+
+        mesh->halfedges[halfedgeID].twinID = twinID;
+    }
+MB_BARRIER
+
+    MB_FREE(table);
+}
+
+
+/*******************************************************************************
+ * LoadEdgeMappings -- Computes the mappings for the edges of the mesh
+ *
+ * Catmull-Clark subdivision requires access to the edges of an input mesh.
+ * Since we are dealing with a halfedge representation, we virtually
+ * have to iterate the halfedges in a sparse way (an edge is a pair of
+ * neighboring halfedges in the general case, except for boundary edges
+ * where it only consists of a single halfedge).
+ * This function builds a data-structure that allows to do just that:
+ * for each halfedge pair, we only consider the one that has the largest
+ * halfedgeID. This allows to treat boundary and regular edges seamlessly.
+ *
+ */
+static uint64_t mb__IsEdgeHalfedge(int64_t halfedgeID, const void *userData)
+{
+    const cc_Mesh *mesh = (const cc_Mesh *)userData;
+    const int32_t twinID = ccm_HalfedgeTwinID(mesh, (int32_t)halfedgeID);
+
+    return halfedgeID > twinID ? 1u : 0u;
+}
+
+MBDEF void mb_LoadEdgeMappings(cc_Mesh *mesh)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    cc_Halfedge *halfedges = mesh->halfedges;
+    cbf_BitField *edgeIterator = cbf_Create(halfedgeCount);
+    int32_t edgeCount;
+
+    cbf_SetBits(edgeIterator, 0, halfedgeCount, &mb__IsEdgeHalfedge, mesh);
+    cbf_Reduce(edgeIterator);
+    edgeCount = cbf_BitCount(edgeIterator);
+
+    mesh->edgeToHalfedgeIDs = (int32_t *)MB_MALLOC(sizeof(int32_t) * edgeCount);
+    mesh->edgeCount = edgeCount;
+
+MB_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+        const int32_t bitID = mb__Max(halfedgeID, twinID);
+
+        halfedges[halfedgeID].edgeID = cbf_EncodeBit(edgeIterator, bitID);
+    }
+MB_BARRIER
+
+MB_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        mesh->edgeToHalfedgeIDs[edgeID] = cbf_DecodeBit(edgeIterator, edgeID);
+    }
+MB_BARRIER
+
+    cbf_Release(edgeIterator);
+}
+
+
+/*******************************************************************************
+ * LoadVertexHalfedges -- Computes an iterator over one halfedge per vertex
+ *
+ * Catmull-Clark subdivision requires access to the halfedges that surround
+ * the vertices of an input mesh.
+ * This function determines a halfedge ID that starts from a
+ * given vertex within that vertex. We distinguish two cases:
+ * 1- If the vertex is a lying on a boundary, we stored the halfedge that
+ * allows for iteration in the forward sense.
+ * 2- Otherwise we store the largest halfedge ID.
+ *
+ */
+MBDEF void mb_LoadVertexHalfedges(cc_Mesh *mesh)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t vertexCount = ccm_VertexCount(mesh);
+
+    mesh->vertexToHalfedgeIDs = (int32_t *)MB_MALLOC(sizeof(int32_t) * vertexCount);
+
+MB_PARALLEL_FOR
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
+        int32_t maxHalfedgeID = halfedgeID;
+        int32_t boundaryHalfedgeID = halfedgeID;
+        int32_t iterator;
+
+        for (iterator = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
+             iterator >= 0 && iterator != halfedgeID;
+             iterator = ccm_NextVertexHalfedgeID(mesh, iterator)) {
+            maxHalfedgeID = mb__Max(maxHalfedgeID, iterator);
+            boundaryHalfedgeID = iterator;
+        }
+
+        // affect max halfedge ID to vertex
+        if /*boundary involved*/ (iterator < 0) {
+            if (halfedgeID == boundaryHalfedgeID) {
+                mesh->vertexToHalfedgeIDs[vertexID] = boundaryHalfedgeID;
+            }
+        } else {
+            if (halfedgeID == maxHalfedgeID) {
+                mesh->vertexToHalfedgeIDs[vertexID] = maxHalfedgeID;
+            }
+        }
+    }
+MB_BARRIER
+}
+
+
+/*******************************************************************************
+ * CreateCreases -- Allocates one smooth crease per edge of the mesh
+ *
+ */
+MBDEF void mb_CreateCreases(cc_Mesh *mesh)
+{
+    const int32_t creaseCount = ccm_EdgeCount(mesh);
+
+    mesh->creases = (cc_Crease *)MB_MALLOC(sizeof(cc_Crease) * creaseCount);
+
+MB_PARALLEL_FOR
+    for (int32_t creaseID = 0; creaseID < creaseCount; ++creaseID) {
+        mesh->creases[creaseID].nextID = creaseID;
+        mesh->creases[creaseID].prevID = creaseID;
+        mesh->creases[creaseID].sharpness = 0.0f;
+    }
+MB_BARRIER
+}
+
+
+/*******************************************************************************
+ * MakeBoundariesSharp -- Tags boundary edges as sharp
+ *
+ * Following the Pixar standard, we tag boundary halfedges as sharp.
+ * See "Subdivision Surfaces in Character Animation" by DeRose et al.
+ * Note that we tag the sharpness value to 16 as subdivision can't go deeper
+ * without overflowing 32-bit integers.
+ *
+ */
+MBDEF void mb_MakeBoundariesSharp(cc_Mesh *mesh)
+{
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
+
+MB_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
+
+        if (twinID < 0) {
+            mesh->creases[edgeID].sharpness = 16.0f;
+        }
+    }
+MB_BARRIER
+}
+
+
+/*******************************************************************************
+ * ComputeCreaseNeighbors -- Computes the neighbors of each crease
+ *
+ */
+MBDEF void mb_ComputeCreaseNeighbors(cc_Mesh *mesh)
+{
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
+
+MB_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const float sharpness = ccm_CreaseSharpness(mesh, edgeID);
+
+        if (sharpness > 0.0f) {
+            const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+            const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+            int32_t prevCreaseCount = 0;
+            int32_t prevCreaseID = -1;
+            int32_t nextCreaseCount = 0;
+            int32_t nextCreaseID = -1;
+            int32_t halfedgeIt;
+
+            for (halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
+                 halfedgeIt != halfedgeID && halfedgeIt >= 0;
+                 halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeIt)) {
+                const float s = ccm_HalfedgeSharpness(mesh, halfedgeIt);
+
+                if (s > 0.0f) {
+                    prevCreaseID = ccm_HalfedgeEdgeID(mesh, halfedgeIt);
+                    ++prevCreaseCount;
+                }
+            }
+
+            if (prevCreaseCount == 1 && halfedgeIt == halfedgeID) {
+                mesh->creases[edgeID].prevID = prevCreaseID;
+            }
+
+            if (ccm_HalfedgeSharpness(mesh, nextID) > 0.0f) {
+                nextCreaseID = ccm_HalfedgeEdgeID(mesh, nextID);
+                ++nextCreaseCount;
+            }
+
+            for (halfedgeIt = ccm_NextVertexHalfedgeID(mesh, nextID);
+                 halfedgeIt != nextID && halfedgeIt >= 0;
+                 halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeIt)) {
+                const float s = ccm_HalfedgeSharpness(mesh, halfedgeIt);
+                const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeIt);
+
+                // twin check is to avoid counting for halfedgeID
+                if (s > 0.0f && twinID != halfedgeID) {
+                    nextCreaseID = ccm_HalfedgeEdgeID(mesh, halfedgeIt);
+                    ++nextCreaseCount;
+                }
+            }
+
+            if (nextCreaseCount == 1 && halfedgeIt == nextID) {
+                mesh->creases[edgeID].nextID = nextCreaseID;
+            }
+        }
+    }
+MB_BARRIER
+}
+
+
+#undef MB_ATOMIC
+#undef MB_PARALLEL_FOR
+#undef MB_BARRIER
+#endif
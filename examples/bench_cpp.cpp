@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define LOG(fmt, ...) fprintf(stdout, fmt "\n", ##__VA_ARGS__); fflush(stdout);
+
+#define CC_IMPLEMENTATION
+#include "CatmullClark.h"
+#include "CatmullClark.hpp"
+
+
+/*******************************************************************************
+ * Bench -- Returns the median time (in seconds) of a refinement routine
+ *
+ */
+template <typename Callback>
+static double Bench(Callback callback, int32_t runCount)
+{
+    std::vector<double> times(runCount);
+
+    for (int32_t runID = 0; runID < runCount; ++runID) {
+        const auto startTime = std::chrono::steady_clock::now();
+
+        callback();
+
+        const auto stopTime = std::chrono::steady_clock::now();
+
+        times[runID] = std::chrono::duration<double>(stopTime - startTime).count();
+    }
+
+    std::sort(times.begin(), times.end());
+
+    return times[runCount / 2];
+}
+
+
+/*******************************************************************************
+ * MaxDistance -- Returns the max distance between two sets of vertex points
+ *
+ */
+static float
+MaxDistance(const cc_Subd *subd, const std::vector<cc_VertexPoint> &points)
+{
+    float distance = 0.0f;
+
+    for (size_t vertexID = 0; vertexID < points.size(); ++vertexID) {
+        for (int32_t i = 0; i < 3; ++i) {
+            const float x = subd->vertexPoints[vertexID].array[i];
+            const float y = points[vertexID].array[i];
+
+            distance = std::max(distance, std::abs(x - y));
+        }
+    }
+
+    return distance;
+}
+
+int main(int argc, char **argv)
+{
+    const char *filename = "./Kitchen_PUP.ccm";
+    int32_t maxDepth = 4;
+    int32_t runCount = 20;
+    cc_Mesh *cage = NULL;
+    cc_Subd *subd = NULL;
+
+    if (argc > 1) {
+        filename = argv[1];
+    }
+
+    if (argc > 2) {
+        maxDepth = atoi(argv[2]);
+    }
+
+    if (argc > 3) {
+        runCount = std::max(1, atoi(argv[3]));
+    }
+
+    cage = ccm_Load(filename);
+
+    if (!cage) {
+        return -1;
+    }
+
+    subd = ccs_Create(cage, maxDepth);
+
+    if (!subd) {
+        ccm_Release(cage);
+
+        return -1;
+    }
+
+    const cc::MeshFeatures features = cc::ScanMesh(cage);
+    const int32_t vertexCount = ccs_CumulativeVertexCount(subd);
+
+    LOG("Features -- creases: %i, boundaries: %i, uvs: %i, quad cage: %i",
+        features.hasCreases,
+        features.hasBoundaries,
+        features.hasUvs,
+        features.isQuadCage);
+
+    ccs_Refine_Gather(subd);
+    const std::vector<cc_VertexPoint> points(subd->vertexPoints,
+                                             subd->vertexPoints + vertexCount);
+
+    LOG("Refining...");
+    {
+        const double cTime = Bench([&] {
+            ccs_RefineVertexPoints_Gather(subd);
+        }, runCount);
+        const double cppTime = Bench([&] {
+            cc::RefineVertexPoints_Gather(subd, features);
+        }, runCount);
+
+        LOG("VertexPoints -- C / C++ median (ms): %f / %f (max distance: %e)",
+            cTime * 1e3,
+            cppTime * 1e3,
+            MaxDistance(subd, points));
+    }
+
+    LOG("All done!");
+
+    ccs_Release(subd);
+    ccm_Release(cage);
+
+    return 0;
+}
@@ -0,0 +1,264 @@
+#define CC_IMPLEMENTATION
+#include "CatmullClark.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define LOG(fmt, ...) fprintf(stdout, fmt "\n", ##__VA_ARGS__); fflush(stdout);
+
+
+/*******************************************************************************
+ * Edit parameters
+ *
+ */
+typedef enum {
+    EDIT_EXTRUDE,
+    EDIT_LOOP,
+    EDIT_DELETE,
+
+    EDIT_COUNT
+} Edit;
+
+typedef struct {
+    int32_t counts[EDIT_COUNT];
+    float extrudeDistance;
+    uint32_t seed;
+} EditParameters;
+
+static const char *EditName(Edit edit)
+{
+    switch (edit) {
+    case EDIT_EXTRUDE: return "extrude face";
+    case EDIT_LOOP: return "insert edge loop";
+    case EDIT_DELETE: return "delete face";
+    default: return "unknown";
+    }
+}
+
+static void Usage(const char *appname)
+{
+    LOG("usage -- %s [options] input.ccm output.ccm", appname);
+    LOG("  -extrude count distance        random face extrusions (default: 64 0.1)");
+    LOG("  -loops count                   random edge loop insertions (default: 64)");
+    LOG("  -delete count                  random face deletions (default: 64)");
+    LOG("  -seed value                    random seed (default: 0)");
+}
+
+
+/*******************************************************************************
+ * Utility functions
+ *
+ */
+static double Time(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+// xorshift32
+static uint32_t RandomBits(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x^= x << 13;
+    x^= x >> 17;
+    x^= x << 5;
+
+    return *state = x;
+}
+
+static int32_t RandomID(uint32_t *state, int32_t count)
+{
+    return (int32_t)(RandomBits(state) % (uint32_t)count);
+}
+
+// Newell normal scaled to a given length
+static cc_VertexPoint FaceOffset(const cc_Mesh *mesh, int32_t faceID, float distance)
+{
+    const int32_t firstID = ccm_FaceToHalfedgeID(mesh, faceID);
+    cc_VertexPoint normal = {{0.0f, 0.0f, 0.0f}};
+    int32_t halfedgeID = firstID;
+    float norm;
+
+    do {
+        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+        const cc_VertexPoint p = ccm_HalfedgeVertexPoint(mesh, halfedgeID);
+        const cc_VertexPoint q = ccm_HalfedgeVertexPoint(mesh, nextID);
+
+        normal.x+= (p.y - q.y) * (p.z + q.z);
+        normal.y+= (p.z - q.z) * (p.x + q.x);
+        normal.z+= (p.x - q.x) * (p.y + q.y);
+        halfedgeID = nextID;
+    } while (halfedgeID != firstID);
+
+    norm = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+    for (int32_t i = 0; i < 3; ++i) {
+        normal.array[i]*= norm > 0.0f ? distance / norm : 0.0f;
+    }
+
+    return normal;
+}
+
+static void LogMeshCounts(const char *label, const cc_Mesh *mesh)
+{
+    LOG("%-8s -- vertices: %i, faces: %i, edges: %i, halfedges: %i, uvs: %i",
+        label,
+        ccm_VertexCount(mesh),
+        ccm_FaceCount(mesh),
+        ccm_EdgeCount(mesh),
+        ccm_HalfedgeCount(mesh),
+        ccm_UvCount(mesh));
+}
+
+
+/*******************************************************************************
+ * RunEdits -- Applies random edits to a mesh and times them
+ *
+ * Edits are interleaved so that each operator runs on an already edited
+ * mesh. Face deletions that would leave a non-manifold vertex are rejected
+ * by the editor and counted separately.
+ *
+ */
+static void RunEdits(cc_MeshEditor *editor, const EditParameters *params)
+{
+    const cc_Mesh *mesh = editor->mesh;
+    int32_t remaining[EDIT_COUNT];
+    int32_t rejectedCount[EDIT_COUNT] = {0};
+    double times[EDIT_COUNT] = {0.0};
+    uint32_t state = params->seed * 0x9E3779B9u + 1u;
+    int32_t editCount = 0;
+
+    for (int32_t edit = 0; edit < EDIT_COUNT; ++edit) {
+        remaining[edit] = params->counts[edit];
+        editCount+= params->counts[edit];
+    }
+
+    while (editCount > 0) {
+        int32_t edit = RandomID(&state, EDIT_COUNT);
+        double startTime;
+        bool success = true;
+
+        while (remaining[edit] == 0) {
+            edit = (edit + 1) % EDIT_COUNT;
+        }
+
+        if (ccm_FaceCount(mesh) == 0) {
+            break;
+        }
+
+        switch (edit) {
+        case EDIT_EXTRUDE: {
+            const int32_t faceID = RandomID(&state, ccm_FaceCount(mesh));
+            const cc_VertexPoint offset =
+                    FaceOffset(mesh, faceID, params->extrudeDistance);
+
+            startTime = Time();
+            success = cce_ExtrudeFace(editor, faceID, offset) >= 0;
+        } break;
+        case EDIT_LOOP: {
+            const int32_t halfedgeID = RandomID(&state, ccm_HalfedgeCount(mesh));
+
+            startTime = Time();
+            success = cce_InsertEdgeLoop(editor, halfedgeID, 0.5f) > 0;
+        } break;
+        default: {
+            const int32_t faceID = RandomID(&state, ccm_FaceCount(mesh));
+
+            startTime = Time();
+            success = cce_DeleteFace(editor, faceID);
+        } break;
+        }
+
+        times[edit]+= Time() - startTime;
+        rejectedCount[edit]+= success ? 0 : 1;
+        --remaining[edit];
+        --editCount;
+    }
+
+    for (int32_t edit = 0; edit < EDIT_COUNT; ++edit) {
+        if (params->counts[edit] > 0) {
+            LOG("%-16s -- %i edits (%i rejected), %.3f ms per edit",
+                EditName(edit),
+                params->counts[edit],
+                rejectedCount[edit],
+                times[edit] * 1e3 / params->counts[edit]);
+        }
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    EditParameters params = {{64, 64, 64}, 0.1f, 0u};
+    const char *inputFile = NULL;
+    const char *outputFile = NULL;
+    cc_MeshEditor *editor;
+    cc_Mesh *mesh;
+    double startTime;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const int32_t argLeft = argc - i - 1;
+
+        if (!strcmp(arg, "-extrude") && argLeft >= 2) {
+            params.counts[EDIT_EXTRUDE] = atoi(argv[++i]);
+            params.extrudeDistance = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "-loops") && argLeft >= 1) {
+            params.counts[EDIT_LOOP] = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-delete") && argLeft >= 1) {
+            params.counts[EDIT_DELETE] = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-seed") && argLeft >= 1) {
+            params.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (arg[0] != '-' && inputFile == NULL) {
+            inputFile = arg;
+        } else if (arg[0] != '-' && outputFile == NULL) {
+            outputFile = arg;
+        } else {
+            Usage(argv[0]);
+
+            return -1;
+        }
+    }
+
+    if (outputFile == NULL) {
+        Usage(argv[0]);
+
+        return -1;
+    }
+
+    mesh = ccm_Load(inputFile);
+
+    if (!mesh) {
+        return -1;
+    }
+
+    LogMeshCounts("Input", mesh);
+    editor = cce_Create(mesh);
+    RunEdits(editor, &params);
+    LogMeshCounts("Edited", mesh);
+
+    startTime = Time();
+    cce_Compact(editor);
+    LOG("Compaction -- %.3f ms", (Time() - startTime) * 1e3);
+    cce_Release(editor);
+
+    LOG("Output file: %s", outputFile);
+
+    if (!ccm_Save(mesh, outputFile)) {
+        ccm_Release(mesh);
+
+        return -1;
+    }
+
+    ccm_Release(mesh);
+
+    return 0;
+}
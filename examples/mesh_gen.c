@@ -0,0 +1,856 @@
+#define CC_IMPLEMENTATION
+#include "CatmullClark.h"
+
+#define CBF_IMPLEMENTATION
+#include "ConcurrentBitField.h"
+
+#define MB_IMPLEMENTATION
+#include "MeshBuilder.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef CC_LOG
+#    include <stdio.h>
+#    define CC_LOG(format, ...) do { fprintf(stdout, format "\n", ##__VA_ARGS__); fflush(stdout); } while(0)
+#endif
+
+#ifndef CC_MALLOC
+#    include <stdlib.h>
+#    define CC_MALLOC(x) (malloc(x))
+#    define CC_FREE(x) (free(x))
+#else
+#    ifndef CC_FREE
+#        error CC_MALLOC defined without CC_FREE
+#    endif
+#endif
+
+#ifndef _OPENMP
+#   ifndef CC_PARALLEL_FOR
+#       define CC_PARALLEL_FOR
+#   endif
+#   ifndef CC_BARRIER
+#       define CC_BARRIER
+#   endif
+#else
+#   if defined(_WIN32)
+#       ifndef CC_PARALLEL_FOR
+#           define CC_PARALLEL_FOR    __pragma("omp parallel for")
+#       endif
+#       ifndef CC_BARRIER
+#           define CC_BARRIER         __pragma("omp barrier")
+#       endif
+#   else
+#       ifndef CC_PARALLEL_FOR
+#           define CC_PARALLEL_FOR    _Pragma("omp parallel for")
+#       endif
+#       ifndef CC_BARRIER
+#           define CC_BARRIER         _Pragma("omp barrier")
+#       endif
+#   endif
+#endif
+
+#define PI 3.14159265358979323846
+
+
+/*******************************************************************************
+ * Generator parameters
+ *
+ * Cages are built from a (u, v) grid of quads, which is open for grids,
+ * closed in u and v for tori, and closed in u and capped with triangle
+ * fans for spheres (the poles are then extraordinary vertices of valence
+ * equal to the column count). The topology of the grid is then perturbed:
+ * - holes remove isolated interior quads, which creates boundaries;
+ * - triangles split quads along a diagonal, which raises the valence
+ *   of two of their vertices;
+ * - n-gons merge rows of consecutive quads into a single face, which creates
+ *   valence 3 vertices along the merged edges;
+ * - creases tag entire grid lines with a semi-sharp value, which creates
+ *   crease chains.
+ * Every random decision is a hash of the seed and of a cell ID so that
+ * meshes are reproducible and can be generated in parallel.
+ *
+ */
+typedef enum {
+    SHAPE_GRID,
+    SHAPE_TORUS,
+    SHAPE_SPHERE
+} Shape;
+
+typedef struct {
+    Shape shape;
+    int32_t columnCount;        // faces along u
+    int32_t rowCount;           // faces along v
+    float holeRate;             // in [0, 1]: probability to remove a hole candidate
+    float triangleRate;         // in [0, 1]: probability to split a quad
+    float ngonRate;             // in [0, 1]: probability to merge a run of quads
+    int32_t ngonMaxQuadCount;   // max number of quads merged into an n-gon
+    float creaseRate;           // in [0, 1]: probability to tag a grid line
+    float creaseMaxSharpness;   // sharpness values lie in (0, creaseMaxSharpness]
+    uint32_t seed;
+} GeneratorParameters;
+
+typedef enum {
+    CELL_QUAD,
+    CELL_TRIANGLES,
+    CELL_NGON,
+    CELL_MERGED,
+    CELL_HOLE,
+    CELL_FAN_SOUTH,
+    CELL_FAN_NORTH
+} CellType;
+
+typedef struct {
+    CellType type;
+    int32_t quadCount;          // number of merged quads (n-gons only)
+} Cell;
+
+typedef struct {
+    const GeneratorParameters *params;
+    int32_t ringVertexCount;    // vertices per row of the grid
+    int32_t ringCount;          // rows of vertices
+    int32_t quadRowCount;       // rows of quad cells
+    int32_t uvRowCount;         // rows of uvs (uvs never wrap around)
+    int32_t quadCellCount;
+    int32_t cellCount;          // quad cells followed by pole cells
+    int32_t vertexCount;
+    int32_t uvCount;
+    int32_t poleVertexID;       // south pole, north pole is next
+    int32_t poleUvID;           // south pole uvs, north pole uvs follow
+} Layout;
+
+enum {
+    SALT_HOLE = 1,
+    SALT_TRIANGLE,
+    SALT_DIAGONAL,
+    SALT_NGON,
+    SALT_NGON_SIZE,
+    SALT_CREASE_ROW,
+    SALT_CREASE_COLUMN,
+    SALT_SHARPNESS_ROW,
+    SALT_SHARPNESS_COLUMN
+};
+
+
+/*******************************************************************************
+ * Hash -- Integer hash with good avalanche properties
+ *
+ */
+static uint32_t Hash(uint32_t x)
+{
+    x^= x >> 16;
+    x*= 0x7FEB352Du;
+    x^= x >> 15;
+    x*= 0x846CA68Bu;
+    x^= x >> 16;
+
+    return x;
+}
+
+static uint32_t RandomBits(uint32_t seed, uint32_t salt, int32_t id)
+{
+    return Hash(seed ^ Hash(salt ^ Hash((uint32_t)id)));
+}
+
+static float Random(uint32_t seed, uint32_t salt, int32_t id)
+{
+    return (float)(RandomBits(seed, salt, id) >> 8) * (1.0f / 16777216.0f);
+}
+
+
+/*******************************************************************************
+ * CreateLayout -- Computes the vertex and cell counts of a generated cage
+ *
+ */
+static bool CreateLayout(const GeneratorParameters *params, Layout *layout)
+{
+    const int32_t columnCount = params->columnCount;
+    const int32_t rowCount = params->rowCount;
+
+    layout->params = params;
+
+    switch (params->shape) {
+    case SHAPE_GRID:
+        if (columnCount < 1 || rowCount < 1) return false;
+
+        layout->ringVertexCount = columnCount + 1;
+        layout->ringCount = rowCount + 1;
+        layout->quadRowCount = rowCount;
+        layout->uvRowCount = rowCount + 1;
+        break;
+    case SHAPE_TORUS:
+        if (columnCount < 3 || rowCount < 3) return false;
+
+        layout->ringVertexCount = columnCount;
+        layout->ringCount = rowCount;
+        layout->quadRowCount = rowCount;
+        layout->uvRowCount = rowCount + 1;
+        break;
+    case SHAPE_SPHERE:
+        if (columnCount < 3 || rowCount < 2) return false;
+
+        layout->ringVertexCount = columnCount;
+        layout->ringCount = rowCount - 1;
+        layout->quadRowCount = rowCount - 2;
+        layout->uvRowCount = rowCount - 1;
+        break;
+    default:
+        return false;
+    }
+
+    layout->quadCellCount = columnCount * layout->quadRowCount;
+    layout->cellCount = layout->quadCellCount;
+    layout->vertexCount = layout->ringVertexCount * layout->ringCount;
+    layout->uvCount = (columnCount + 1) * layout->uvRowCount;
+    layout->poleVertexID = layout->vertexCount;
+    layout->poleUvID = layout->uvCount;
+
+    if (params->shape == SHAPE_SPHERE) {
+        layout->cellCount+= 2 * columnCount;
+        layout->vertexCount+= 2;
+        layout->uvCount+= 2 * columnCount;
+    }
+
+    // cells produce at most 6 halfedges, and twin computation sorts
+    // a power-of-two table of halfedges indexed by 32-bit integers
+    return (int64_t)layout->cellCount * 6 <= (int64_t)1 << 30;
+}
+
+
+/*******************************************************************************
+ * ClassifyCell -- Determines the faces produced by a cell of the grid
+ *
+ * Runs of quads are merged within fixed segments of even rows so that two
+ * runs never share a vertex along v, which guarantees valence >= 3.
+ * Holes are interior quads at even (column, row) positions, so that two
+ * holes never share a vertex, which guarantees manifold boundaries.
+ *
+ */
+static Cell ClassifyCell(const Layout *layout, int32_t cellID)
+{
+    const GeneratorParameters *params = layout->params;
+    const int32_t columnCount = params->columnCount;
+    const int32_t segmentSize = params->ngonMaxQuadCount;
+    Cell cell = {CELL_QUAD, 1};
+
+    if (cellID >= layout->quadCellCount) {
+        const int32_t poleCellID = cellID - layout->quadCellCount;
+
+        cell.type = poleCellID < columnCount ? CELL_FAN_SOUTH : CELL_FAN_NORTH;
+
+        return cell;
+    }
+
+    const int32_t i = cellID % columnCount;
+    const int32_t j = cellID / columnCount;
+
+    if (segmentSize >= 2 && (j & 1) == 0 && j + 1 < layout->quadRowCount) {
+        const int32_t segmentBegin = (i / segmentSize) * segmentSize;
+        const int32_t segmentID = j * columnCount + segmentBegin;
+
+        if (segmentBegin + segmentSize < columnCount
+            && Random(params->seed, SALT_NGON, segmentID) < params->ngonRate) {
+            const uint32_t bits = RandomBits(params->seed, SALT_NGON_SIZE, segmentID);
+            const int32_t quadCount = 2 + (int32_t)(bits % (uint32_t)(segmentSize - 1));
+
+            if (i == segmentBegin) {
+                cell.type = CELL_NGON;
+                cell.quadCount = quadCount;
+
+                return cell;
+            } else if (i < segmentBegin + quadCount) {
+                cell.type = CELL_MERGED;
+                cell.quadCount = 0;
+
+                return cell;
+            }
+        }
+    }
+
+    if ((i & 1) == 0 && (j & 1) == 0
+        && i >= 1 && i + 2 <= columnCount
+        && j >= 1 && j + 2 <= layout->quadRowCount
+        && Random(params->seed, SALT_HOLE, cellID) < params->holeRate) {
+        cell.type = CELL_HOLE;
+        cell.quadCount = 0;
+
+        return cell;
+    }
+
+    if (Random(params->seed, SALT_TRIANGLE, cellID) < params->triangleRate) {
+        cell.type = CELL_TRIANGLES;
+    }
+
+    return cell;
+}
+
+static int32_t CellHalfedgeCount(const Cell cell)
+{
+    switch (cell.type) {
+    case CELL_QUAD: return 4;
+    case CELL_TRIANGLES: return 6;
+    case CELL_NGON: return 2 * cell.quadCount + 2;
+    case CELL_FAN_SOUTH: return 3;
+    case CELL_FAN_NORTH: return 3;
+    default: return 0;
+    }
+}
+
+static int32_t CellFaceCount(const Cell cell)
+{
+    switch (cell.type) {
+    case CELL_QUAD: return 1;
+    case CELL_TRIANGLES: return 2;
+    case CELL_NGON: return 1;
+    case CELL_FAN_SOUTH: return 1;
+    case CELL_FAN_NORTH: return 1;
+    default: return 0;
+    }
+}
+
+
+/*******************************************************************************
+ * ExclusiveScan -- Computes the exclusive prefix sum of an array in place
+ *
+ * The array is processed in blocks: each block is summed in parallel, then
+ * the block offsets are accumulated serially, and each block is finally
+ * scanned in parallel. Returns the sum of all elements.
+ *
+ */
+static int32_t ExclusiveScan(int32_t *array, int32_t count)
+{
+    const int32_t blockSize = 1 << 16;
+    const int32_t blockCount = (count + blockSize - 1) / blockSize;
+    int32_t *blockOffsets = (int32_t *)CC_MALLOC(sizeof(int32_t) * (blockCount + 1));
+    int32_t sum = 0;
+
+CC_PARALLEL_FOR
+    for (int32_t blockID = 0; blockID < blockCount; ++blockID) {
+        const int32_t beginID = blockID * blockSize;
+        const int32_t endID = beginID + blockSize < count ? beginID + blockSize : count;
+        int32_t blockSum = 0;
+
+        for (int32_t i = beginID; i < endID; ++i) {
+            blockSum+= array[i];
+        }
+
+        blockOffsets[blockID] = blockSum;
+    }
+CC_BARRIER
+
+    for (int32_t blockID = 0; blockID < blockCount; ++blockID) {
+        const int32_t blockSum = blockOffsets[blockID];
+
+        blockOffsets[blockID] = sum;
+        sum+= blockSum;
+    }
+
+CC_PARALLEL_FOR
+    for (int32_t blockID = 0; blockID < blockCount; ++blockID) {
+        const int32_t beginID = blockID * blockSize;
+        const int32_t endID = beginID + blockSize < count ? beginID + blockSize : count;
+        int32_t offset = blockOffsets[blockID];
+
+        for (int32_t i = beginID; i < endID; ++i) {
+            const int32_t value = array[i];
+
+            array[i] = offset;
+            offset+= value;
+        }
+    }
+CC_BARRIER
+
+    CC_FREE(blockOffsets);
+
+    return sum;
+}
+
+
+/*******************************************************************************
+ * GridVertexID / GridUvID -- Maps grid coordinates to vertex and uv IDs
+ *
+ * Vertex IDs wrap around for closed shapes while uv IDs never do, so that
+ * closed shapes get uv seams.
+ *
+ */
+static int32_t GridVertexID(const Layout *layout, int32_t i, int32_t j)
+{
+    const int32_t x = i % layout->ringVertexCount;
+    const int32_t y = j % layout->ringCount;
+
+    return y * layout->ringVertexCount + x;
+}
+
+static int32_t GridUvID(const Layout *layout, int32_t i, int32_t j)
+{
+    return j * (layout->params->columnCount + 1) + i;
+}
+
+
+/*******************************************************************************
+ * WriteFace -- Writes a face whose halfedges are contiguous in memory
+ *
+ */
+static void
+WriteFace(
+    cc_Mesh *mesh,
+    int32_t halfedgeID,
+    int32_t faceID,
+    const int32_t *vertexIDs,
+    const int32_t *uvIDs,
+    int32_t vertexCount
+) {
+    for (int32_t i = 0; i < vertexCount; ++i) {
+        cc_Halfedge *halfedge = &mesh->halfedges[halfedgeID + i];
+
+        halfedge->twinID = -1;
+        halfedge->nextID = halfedgeID + (i + 1) % vertexCount;
+        halfedge->prevID = halfedgeID + (i + vertexCount - 1) % vertexCount;
+        halfedge->faceID = faceID;
+        halfedge->edgeID = -1;
+        halfedge->vertexID = vertexIDs[i];
+        halfedge->uvID = uvIDs[i];
+    }
+
+    mesh->faceToHalfedgeIDs[faceID] = halfedgeID;
+}
+
+
+/*******************************************************************************
+ * WriteCell -- Writes the faces of a cell of the grid
+ *
+ */
+static void
+WriteCell(
+    const Layout *layout,
+    int32_t cellID,
+    int32_t halfedgeID,
+    int32_t faceID,
+    cc_Mesh *mesh
+) {
+    const Cell cell = ClassifyCell(layout, cellID);
+    const int32_t columnCount = layout->params->columnCount;
+    int32_t vertexIDs[64];
+    int32_t uvIDs[64];
+
+    if (cell.type == CELL_FAN_SOUTH || cell.type == CELL_FAN_NORTH) {
+        const int32_t poleCellID = cellID - layout->quadCellCount;
+        const int32_t i = poleCellID % columnCount;
+
+        if (cell.type == CELL_FAN_SOUTH) {
+            vertexIDs[0] = layout->poleVertexID;
+            vertexIDs[1] = GridVertexID(layout, i + 1, 0);
+            vertexIDs[2] = GridVertexID(layout, i    , 0);
+            uvIDs[0] = layout->poleUvID + i;
+            uvIDs[1] = GridUvID(layout, i + 1, 0);
+            uvIDs[2] = GridUvID(layout, i    , 0);
+        } else {
+            const int32_t j = layout->ringCount - 1;
+
+            vertexIDs[0] = GridVertexID(layout, i    , j);
+            vertexIDs[1] = GridVertexID(layout, i + 1, j);
+            vertexIDs[2] = layout->poleVertexID + 1;
+            uvIDs[0] = GridUvID(layout, i    , j);
+            uvIDs[1] = GridUvID(layout, i + 1, j);
+            uvIDs[2] = layout->poleUvID + columnCount + i;
+        }
+
+        WriteFace(mesh, halfedgeID, faceID, vertexIDs, uvIDs, 3);
+    } else if (cell.type == CELL_NGON) {
+        const int32_t i = cellID % columnCount;
+        const int32_t j = cellID / columnCount;
+        const int32_t n = cell.quadCount;
+        int32_t vertexCount = 0;
+
+        for (int32_t k = 0; k <= n; ++k, ++vertexCount) {
+            vertexIDs[vertexCount] = GridVertexID(layout, i + k, j);
+            uvIDs[vertexCount] = GridUvID(layout, i + k, j);
+        }
+
+        for (int32_t k = n; k >= 0; --k, ++vertexCount) {
+            vertexIDs[vertexCount] = GridVertexID(layout, i + k, j + 1);
+            uvIDs[vertexCount] = GridUvID(layout, i + k, j + 1);
+        }
+
+        WriteFace(mesh, halfedgeID, faceID, vertexIDs, uvIDs, vertexCount);
+    } else if (cell.type == CELL_QUAD || cell.type == CELL_TRIANGLES) {
+        const int32_t i = cellID % columnCount;
+        const int32_t j = cellID / columnCount;
+        const int32_t quadVertexIDs[4] = {
+            GridVertexID(layout, i    , j    ),
+            GridVertexID(layout, i + 1, j    ),
+            GridVertexID(layout, i + 1, j + 1),
+            GridVertexID(layout, i    , j + 1)
+        };
+        const int32_t quadUvIDs[4] = {
+            GridUvID(layout, i    , j    ),
+            GridUvID(layout, i + 1, j    ),
+            GridUvID(layout, i + 1, j + 1),
+            GridUvID(layout, i    , j + 1)
+        };
+
+        if (cell.type == CELL_QUAD) {
+            WriteFace(mesh, halfedgeID, faceID, quadVertexIDs, quadUvIDs, 4);
+        } else {
+            const uint32_t diagonal =
+                RandomBits(layout->params->seed, SALT_DIAGONAL, cellID) & 1u;
+            const int32_t triangles[2][2][3] = {
+                {{0, 1, 2}, {0, 2, 3}},
+                {{0, 1, 3}, {1, 2, 3}}
+            };
+
+            for (int32_t t = 0; t < 2; ++t) {
+                for (int32_t k = 0; k < 3; ++k) {
+                    const int32_t cornerID = triangles[diagonal][t][k];
+
+                    vertexIDs[k] = quadVertexIDs[cornerID];
+                    uvIDs[k] = quadUvIDs[cornerID];
+                }
+
+                WriteFace(mesh, halfedgeID + 3 * t, faceID + t, vertexIDs, uvIDs, 3);
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * WriteVertexPoints -- Computes the vertex points and uvs of the cage
+ *
+ */
+static void WriteVertexPoints(const Layout *layout, cc_Mesh *mesh)
+{
+    const GeneratorParameters *params = layout->params;
+    const int32_t columnCount = params->columnCount;
+    const int32_t rowCount = params->rowCount;
+    const int32_t gridVertexCount = layout->ringVertexCount * layout->ringCount;
+    const int32_t gridUvCount = (columnCount + 1) * layout->uvRowCount;
+    const float gridScale = 1.0f / (float)(columnCount > rowCount ? columnCount
+                                                                  : rowCount);
+
+CC_PARALLEL_FOR
+    for (int32_t vertexID = 0; vertexID < gridVertexCount; ++vertexID) {
+        const int32_t i = vertexID % layout->ringVertexCount;
+        const int32_t j = vertexID / layout->ringVertexCount;
+        const double u = (double)i / columnCount;
+        float *p = mesh->vertexPoints[vertexID].array;
+
+        if (params->shape == SHAPE_GRID) {
+            p[0] = ((float)i - 0.5f * columnCount) * gridScale;
+            p[1] = ((float)j - 0.5f * rowCount) * gridScale;
+            p[2] = 0.0f;
+        } else if (params->shape == SHAPE_TORUS) {
+            const double theta = 2.0 * PI * u;
+            const double phi = 2.0 * PI * (double)j / rowCount;
+            const double r = 1.0 + 0.35 * cos(phi);
+
+            p[0] = (float)(r * cos(theta));
+            p[1] = (float)(r * sin(theta));
+            p[2] = (float)(0.35 * sin(phi));
+        } else {
+            const double theta = 2.0 * PI * u;
+            const double phi = PI * ((double)(j + 1) / rowCount - 0.5);
+
+            p[0] = (float)(cos(phi) * cos(theta));
+            p[1] = (float)(cos(phi) * sin(theta));
+            p[2] = (float)sin(phi);
+        }
+    }
+CC_BARRIER
+
+    if (params->shape == SHAPE_SPHERE) {
+        const cc_VertexPoint south = {{0.0f, 0.0f, -1.0f}};
+        const cc_VertexPoint north = {{0.0f, 0.0f, +1.0f}};
+
+        mesh->vertexPoints[layout->poleVertexID    ] = south;
+        mesh->vertexPoints[layout->poleVertexID + 1] = north;
+    }
+
+CC_PARALLEL_FOR
+    for (int32_t uvID = 0; uvID < gridUvCount; ++uvID) {
+        const int32_t i = uvID % (columnCount + 1);
+        const int32_t j = uvID / (columnCount + 1);
+        const float v = params->shape == SHAPE_SPHERE
+                      ? (float)(j + 1) / rowCount
+                      : (float)j / rowCount;
+
+        mesh->uvs[uvID].u = (float)i / columnCount;
+        mesh->uvs[uvID].v = v;
+    }
+CC_BARRIER
+
+CC_PARALLEL_FOR
+    for (int32_t uvID = gridUvCount; uvID < layout->uvCount; ++uvID) {
+        const int32_t poleUvID = uvID - gridUvCount;
+        const int32_t i = poleUvID % columnCount;
+
+        mesh->uvs[uvID].u = ((float)i + 0.5f) / columnCount;
+        mesh->uvs[uvID].v = poleUvID < columnCount ? 0.0f : 1.0f;
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * WriteCreases -- Tags the edges of randomly selected grid lines as creases
+ *
+ * Edges that connect to a pole or that cut through a quad are left smooth.
+ *
+ */
+static void WriteCreases(const Layout *layout, cc_Mesh *mesh)
+{
+    const GeneratorParameters *params = layout->params;
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
+    const int32_t gridVertexCount = layout->ringVertexCount * layout->ringCount;
+
+    if (params->creaseRate <= 0.0f || params->creaseMaxSharpness <= 0.0f) {
+        return;
+    }
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+        const int32_t v0 = ccm_HalfedgeVertexID(mesh, halfedgeID);
+        const int32_t v1 = ccm_HalfedgeVertexID(mesh, nextID);
+        const int32_t i0 = v0 % layout->ringVertexCount;
+        const int32_t j0 = v0 / layout->ringVertexCount;
+        const int32_t i1 = v1 % layout->ringVertexCount;
+        const int32_t j1 = v1 / layout->ringVertexCount;
+        float sharpness = 0.0f;
+
+        if (v0 >= gridVertexCount || v1 >= gridVertexCount) {
+            continue;
+        }
+
+        if (j0 == j1) {
+            if (Random(params->seed, SALT_CREASE_ROW, j0) < params->creaseRate) {
+                sharpness = 1.0f - Random(params->seed, SALT_SHARPNESS_ROW, j0);
+            }
+        } else if (i0 == i1) {
+            if (Random(params->seed, SALT_CREASE_COLUMN, i0) < params->creaseRate) {
+                sharpness = 1.0f - Random(params->seed, SALT_SHARPNESS_COLUMN, i0);
+            }
+        }
+
+        mesh->creases[edgeID].sharpness = sharpness * params->creaseMaxSharpness;
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * GenerateMesh -- Creates a synthetic cage
+ *
+ * Returns NULL on failure.
+ *
+ */
+static cc_Mesh *GenerateMesh(const GeneratorParameters *params)
+{
+    Layout layout;
+    int32_t *halfedgeOffsets, *faceOffsets;
+    int32_t halfedgeCount, faceCount;
+    cc_Mesh *mesh;
+
+    if (!CreateLayout(params, &layout)) {
+        CC_LOG("cc: invalid generator parameters");
+
+        return NULL;
+    }
+
+    CC_LOG("Classifying cells...");
+    halfedgeOffsets = (int32_t *)CC_MALLOC(sizeof(int32_t) * layout.cellCount);
+    faceOffsets = (int32_t *)CC_MALLOC(sizeof(int32_t) * layout.cellCount);
+
+CC_PARALLEL_FOR
+    for (int32_t cellID = 0; cellID < layout.cellCount; ++cellID) {
+        const Cell cell = ClassifyCell(&layout, cellID);
+
+        halfedgeOffsets[cellID] = CellHalfedgeCount(cell);
+        faceOffsets[cellID] = CellFaceCount(cell);
+    }
+CC_BARRIER
+
+    halfedgeCount = ExclusiveScan(halfedgeOffsets, layout.cellCount);
+    faceCount = ExclusiveScan(faceOffsets, layout.cellCount);
+
+    CC_LOG("Allocating mesh...");
+    mesh = (cc_Mesh *)CC_MALLOC(sizeof(*mesh));
+    mesh->vertexCount = layout.vertexCount;
+    mesh->uvCount = layout.uvCount;
+    mesh->halfedgeCount = halfedgeCount;
+    mesh->faceCount = faceCount;
+    mesh->vertexPoints = (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint) * layout.vertexCount);
+    mesh->uvs = (cc_VertexUv *)CC_MALLOC(sizeof(cc_VertexUv) * layout.uvCount);
+    mesh->halfedges = (cc_Halfedge *)CC_MALLOC(sizeof(cc_Halfedge) * halfedgeCount);
+    mesh->faceToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * faceCount);
+    mesh->faceHoles = NULL;
+
+    CC_LOG("Generating mesh data...");
+    WriteVertexPoints(&layout, mesh);
+
+CC_PARALLEL_FOR
+    for (int32_t cellID = 0; cellID < layout.cellCount; ++cellID) {
+        WriteCell(&layout,
+                  cellID,
+                  halfedgeOffsets[cellID],
+                  faceOffsets[cellID],
+                  mesh);
+    }
+CC_BARRIER
+
+    CC_FREE(halfedgeOffsets);
+    CC_FREE(faceOffsets);
+
+    CC_LOG("Computing twins...");
+    mb_ComputeTwins(mesh);
+    CC_LOG("Computing edge mappings...");
+    mb_LoadEdgeMappings(mesh);
+    CC_LOG("Computing vertex mappings...");
+    mb_LoadVertexHalfedges(mesh);
+
+    CC_LOG("Generating creases...");
+    mb_CreateCreases(mesh);
+    WriteCreases(&layout, mesh);
+    mb_MakeBoundariesSharp(mesh);
+
+    CC_LOG("Computing crease neighbors...");
+    mb_ComputeCreaseNeighbors(mesh);
+
+    return mesh;
+}
+
+
+/*******************************************************************************
+ * LogMeshStats -- Displays the element counts of a generated cage
+ *
+ */
+static void LogMeshStats(const cc_Mesh *mesh)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
+    const int32_t faceCount = ccm_FaceCount(mesh);
+    int32_t boundaryCount = 0;
+    int32_t creaseCount = 0;
+    int32_t nonQuadCount = 0;
+
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+
+        if (ccm_HalfedgeTwinID(mesh, halfedgeID) < 0) {
+            ++boundaryCount;
+        } else if (ccm_CreaseSharpness(mesh, edgeID) > 0.0f) {
+            ++creaseCount;
+        }
+    }
+
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        const int32_t beginID = ccm_FaceToHalfedgeID(mesh, faceID);
+        const int32_t endID = faceID + 1 < faceCount
+                            ? ccm_FaceToHalfedgeID(mesh, faceID + 1)
+                            : halfedgeCount;
+
+        nonQuadCount+= (endID - beginID) != 4 ? 1 : 0;
+    }
+
+    CC_LOG("V: %i", ccm_VertexCount(mesh));
+    CC_LOG("U: %i", ccm_UvCount(mesh));
+    CC_LOG("H: %i", halfedgeCount);
+    CC_LOG("C: %i", ccm_CreaseCount(mesh));
+    CC_LOG("E: %i (boundaries: %i, semi-sharp creases: %i)",
+           edgeCount, boundaryCount, creaseCount);
+    CC_LOG("F: %i (non-quads: %i)", faceCount, nonQuadCount);
+}
+
+
+static void Usage(const char *appname)
+{
+    CC_LOG("usage -- %s [options] output.ccm", appname);
+    CC_LOG("  -shape grid|torus|sphere       base shape (default: torus)");
+    CC_LOG("  -size columns rows             grid resolution (default: 256 256)");
+    CC_LOG("  -holes rate                    boundary density in [0, 1]");
+    CC_LOG("  -triangles rate                quad splits in [0, 1]");
+    CC_LOG("  -ngons rate maxQuads           quad merges in [0, 1]");
+    CC_LOG("  -creases rate maxSharpness     crease line density in [0, 1]");
+    CC_LOG("  -seed value                    random seed (default: 0)");
+}
+
+
+int main(int argc, char **argv)
+{
+    GeneratorParameters params = {
+        SHAPE_TORUS, 256, 256, 0.0f, 0.0f, 0.0f, 3, 0.0f, 0.0f, 0u
+    };
+    const char *outputFile = NULL;
+    cc_Mesh *mesh;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const int32_t argLeft = argc - i - 1;
+
+        if (!strcmp(arg, "-shape") && argLeft >= 1) {
+            const char *shape = argv[++i];
+
+            if (!strcmp(shape, "grid")) {
+                params.shape = SHAPE_GRID;
+            } else if (!strcmp(shape, "torus")) {
+                params.shape = SHAPE_TORUS;
+            } else if (!strcmp(shape, "sphere")) {
+                params.shape = SHAPE_SPHERE;
+            } else {
+                Usage(argv[0]);
+
+                return -1;
+            }
+        } else if (!strcmp(arg, "-size") && argLeft >= 2) {
+            params.columnCount = atoi(argv[++i]);
+            params.rowCount = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-holes") && argLeft >= 1) {
+            params.holeRate = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "-triangles") && argLeft >= 1) {
+            params.triangleRate = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "-ngons") && argLeft >= 2) {
+            params.ngonRate = (float)atof(argv[++i]);
+            params.ngonMaxQuadCount = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-creases") && argLeft >= 2) {
+            params.creaseRate = (float)atof(argv[++i]);
+            params.creaseMaxSharpness = (float)atof(argv[++i]);
+        } else if (!strcmp(arg, "-seed") && argLeft >= 1) {
+            params.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (arg[0] != '-' && outputFile == NULL) {
+            outputFile = arg;
+        } else {
+            Usage(argv[0]);
+
+            return -1;
+        }
+    }
+
+    if (outputFile == NULL || params.ngonMaxQuadCount > 31) {
+        Usage(argv[0]);
+
+        return -1;
+    }
+
+    mesh = GenerateMesh(&params);
+
+    if (!mesh) {
+        return -1;
+    }
+
+    LogMeshStats(mesh);
+    CC_LOG("Output file: %s", outputFile);
+
+    if (!ccm_Save(mesh, outputFile)) {
+        ccm_Release(mesh);
+
+        return -1;
+    }
+
+    ccm_Release(mesh);
+
+    return 0;
+}
@@ -1,6 +1,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <omp.h>
 
@@ -15,7 +16,7 @@
 
 static void usage(const char *appname)
 {
-    LOG("usage: %s path_to_ccm maxDepth", appname);
+    LOG("usage: %s path_to_ccm maxDepth [-calibrate file] [-predict file]", appname);
 }
 
 double ByteToGiByte(int64_t size)
@@ -23,24 +24,85 @@ double ByteToGiByte(int64_t size)
     return (double)size / (1 << 30);
 }
 
-int main(int argc, char **argv)
+double ByteToMiByte(int64_t size)
 {
-    int32_t maxDepth;
-    cc_Mesh *mesh;
-    int32_t nonQuadCount = 0;
-    int32_t creaseCount = 0;
-    int32_t boundaryCount = 0;
+    return (double)size / (1 << 20);
+}
 
-    if (argc < 3) {
-        usage(argv[0]);
-        return 0;
+
+/*******************************************************************************
+ * Topology statistics
+ *
+ * The valence of a vertex is its number of incident edges. Interior
+ * vertices are regular if their valence is 4, and boundary vertices
+ * if their valence is 3 (or 2 for corners).
+ *
+ */
+#define VALENCE_BIN_COUNT 16
+#define SHARPNESS_BIN_COUNT 17
+
+typedef struct {
+    int32_t valenceHistogram[VALENCE_BIN_COUNT];    // last bin is open-ended
+    int32_t sharpnessHistogram[SHARPNESS_BIN_COUNT];// bins of ceil(sharpness)
+    int32_t boundaryVertexCount;
+    int32_t extraordinaryVertexCount;
+    int32_t nonQuadCount;
+    int32_t boundaryCount;
+    int32_t creaseCount;
+    int32_t semiSharpCreaseCount;   // creases with non-integer sharpness
+} TopologyStats;
+
+static int32_t VertexValence(const cc_Mesh *mesh, int32_t vertexID, bool *onBoundary)
+{
+    const int32_t startID = ccm_VertexToHalfedgeID(mesh, vertexID);
+    int32_t halfedgeID = startID;
+    int32_t faceCount = 0;
+
+    do {
+        ++faceCount;
+        halfedgeID = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
+    } while (halfedgeID >= 0 && halfedgeID != startID);
+
+    (*onBoundary) = halfedgeID < 0;
+
+    if (halfedgeID < 0) {
+        for (halfedgeID = ccm_PrevVertexHalfedgeID(mesh, startID);
+             halfedgeID >= 0;
+             halfedgeID = ccm_PrevVertexHalfedgeID(mesh, halfedgeID)) {
+            ++faceCount;
+        }
+
+        return faceCount + 1;
     }
 
-    mesh = ccm_Load(argv[1]);
-    maxDepth = atoi(argv[2]);
+    return faceCount;
+}
+
+static TopologyStats ComputeTopologyStats(const cc_Mesh *mesh)
+{
+    TopologyStats stats;
+
+    memset(&stats, 0, sizeof(stats));
 
     // boundaries
-    boundaryCount = 2 * ccm_EdgeCount(mesh) - ccm_HalfedgeCount(mesh);
+    stats.boundaryCount = 2 * ccm_EdgeCount(mesh) - ccm_HalfedgeCount(mesh);
+
+    // valences
+    for (int32_t vertexID = 0; vertexID < ccm_VertexCount(mesh); ++vertexID) {
+        bool onBoundary;
+        const int32_t valence = VertexValence(mesh, vertexID, &onBoundary);
+        const int32_t binID = valence < VALENCE_BIN_COUNT ? valence
+                                                          : VALENCE_BIN_COUNT - 1;
+
+        ++stats.valenceHistogram[binID];
+
+        if (onBoundary) {
+            ++stats.boundaryVertexCount;
+            stats.extraordinaryVertexCount+= (valence != 2 && valence != 3);
+        } else {
+            stats.extraordinaryVertexCount+= (valence != 4);
+        }
+    }
 
     // count non quads
     for (int32_t faceID = 0; faceID < ccm_FaceCount(mesh); ++faceID) {
@@ -54,23 +116,450 @@ int main(int argc, char **argv)
         }
 
         if (cycleLength != 4)
-            ++nonQuadCount;
+            ++stats.nonQuadCount;
     }
 
-    // creases
+    // creases (boundaries excluded)
     for (int32_t edgeID = 0; edgeID < ccm_EdgeCount(mesh); ++edgeID) {
-        if (ccm_CreaseSharpness(mesh, edgeID)) {
-            ++creaseCount;
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+        const float sharpness = ccm_CreaseSharpness(mesh, edgeID);
+
+        if (sharpness > 0.0f && ccm_HalfedgeTwinID(mesh, halfedgeID) >= 0) {
+            const int32_t floorValue = (int32_t)cc__Minf(sharpness, 1024.0f);
+            const bool isInteger = (float)floorValue == sharpness;
+            const int32_t binID = floorValue + (isInteger ? 0 : 1);
+
+            ++stats.creaseCount;
+            ++stats.sharpnessHistogram[binID < SHARPNESS_BIN_COUNT
+                                       ? binID : SHARPNESS_BIN_COUNT - 1];
+            stats.semiSharpCreaseCount+= !isInteger;
         }
     }
-    creaseCount-= boundaryCount;
+
+    return stats;
+}
+
+static void LogTopologyStats(const cc_Mesh *mesh, const TopologyStats *stats)
+{
+    const int32_t vertexCount = ccm_VertexCount(mesh);
+    const int32_t faceCount = ccm_FaceCount(mesh);
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
 
     LOG("(non Quads: %i; boundaries: %i; creases: %i)",
-        nonQuadCount,
-        boundaryCount,
-        creaseCount);
+        stats->nonQuadCount,
+        stats->boundaryCount,
+        stats->creaseCount);
     LOG("(UVs: %i)", ccm_UvCount(mesh));
 
+    LOG("-- topology");
+    LOG("non-quad faces: %.2f%% (%i / %i)",
+        100.0 * stats->nonQuadCount / faceCount, stats->nonQuadCount, faceCount);
+    LOG("extraordinary vertices: %.2f%% (%i / %i)",
+        100.0 * stats->extraordinaryVertexCount / vertexCount,
+        stats->extraordinaryVertexCount,
+        vertexCount);
+    LOG("boundary vertices: %.2f%% (%i / %i)",
+        100.0 * stats->boundaryVertexCount / vertexCount,
+        stats->boundaryVertexCount,
+        vertexCount);
+    LOG("valence histogram:");
+    for (int32_t binID = 0; binID < VALENCE_BIN_COUNT; ++binID) {
+        if (stats->valenceHistogram[binID] > 0) {
+            LOG("  %2i%s: %i (%.2f%%)",
+                binID,
+                binID == VALENCE_BIN_COUNT - 1 ? "+" : " ",
+                stats->valenceHistogram[binID],
+                100.0 * stats->valenceHistogram[binID] / vertexCount);
+        }
+    }
+
+    LOG("-- creases");
+    LOG("creased edges: %.2f%% (%i / %i, semi-sharp: %i)",
+        100.0 * stats->creaseCount / edgeCount,
+        stats->creaseCount,
+        edgeCount,
+        stats->semiSharpCreaseCount);
+    if (stats->creaseCount > 0) {
+        LOG("sharpness histogram:");
+    }
+    for (int32_t binID = 1; binID < SHARPNESS_BIN_COUNT; ++binID) {
+        if (stats->sharpnessHistogram[binID] > 0) {
+            if (binID == SHARPNESS_BIN_COUNT - 1) {
+                LOG("  (%2i, inf): %i", binID - 1, stats->sharpnessHistogram[binID]);
+            } else {
+                LOG("  (%2i, %2i]: %i", binID - 1, binID, stats->sharpnessHistogram[binID]);
+            }
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * MaxSafeDepth -- Returns the deepest level the int32 count formulas support
+ *
+ * This replicates the cumulative count formulas of the library in 64-bit
+ * arithmetic, and checks that none of their intermediate products exceed
+ * the range of 32-bit integers.
+ *
+ */
+static bool FitsInt32(int64_t x)
+{
+    return x >= -(int64_t)INT32_MAX && x <= (int64_t)INT32_MAX;
+}
+
+static bool CountsFitInt32(const cc_Mesh *cage, int32_t depth)
+{
+    const int64_t V0 = ccm_VertexCount(cage);
+    const int64_t F0 = ccm_FaceCount(cage);
+    const int64_t E0 = ccm_EdgeCount(cage);
+    const int64_t H0 = ccm_HalfedgeCount(cage);
+    const int64_t C0 = ccm_CreaseCount(cage);
+    const int64_t H1 = H0 << 2;
+    const int64_t E1 = (E0 << 1) + H0;
+    const int64_t F1 = H0;
+    const int64_t V1 = V0 + E0 + F0;
+    const int64_t C1 = C0 << 1;
+    const int64_t A = ((int64_t)1 << depth) - 1;            //  2^{d} - 1
+    const int64_t B = (((int64_t)1 << (2 * depth)) - 1);    //  4^{d} - 1
+
+    return FitsInt32(H1 * B)                                // halfedges
+        && FitsInt32(A * (6 * E1 + A * H1 - H1))            // edges
+        && FitsInt32(C1 * A)                                // creases
+        && FitsInt32(A * (E1 - (F1 << 1)))                  // vertices
+        && FitsInt32(B / 3 * F1)
+        && FitsInt32(A * (E1 - (F1 << 1)) + B / 3 * F1 + depth * (F1 - E1 + V1));
+}
+
+static int32_t MaxSafeDepth(const cc_Mesh *cage)
+{
+    int32_t depth = 0;
+
+    while (depth < 30 && CountsFitInt32(cage, depth + 1)) {
+        ++depth;
+    }
+
+    return depth;
+}
+
+
+/*******************************************************************************
+ * Memory footprint
+ *
+ * Byte counts of the arrays allocated by ccs_Create for each subd level,
+ * and of each storage configuration of the vertex points. Allocator
+ * overhead is not accounted for.
+ *
+ */
+typedef struct {
+    int64_t halfedges;
+    int64_t creases;
+    int64_t vertexPoints;       // fp32 storage
+    int64_t packedVertexPoints; // fp16 / unorm16 storage
+    int64_t uvs;
+} LevelFootprint;
+
+static LevelFootprint LevelFootprintAtDepth(const cc_Mesh *cage, int32_t depth)
+{
+    const int64_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+    const int64_t creaseCount = ccm_CreaseCountAtDepth(cage, depth);
+    const int64_t vertexCount = ccm_VertexCountAtDepth(cage, depth);
+    LevelFootprint footprint;
+
+    footprint.halfedges = halfedgeCount * sizeof(cc_Halfedge_SemiRegular);
+    footprint.creases = creaseCount * sizeof(cc_Crease);
+    footprint.vertexPoints = vertexCount * sizeof(cc_VertexPoint);
+    footprint.packedVertexPoints = vertexCount * 3 * sizeof(uint16_t);
+    footprint.uvs = ccm_UvCount(cage) > 0 ? halfedgeCount * sizeof(cc_VertexUv) : 0;
+
+    return footprint;
+}
+
+static void LogMemoryFootprint(const cc_Mesh *cage, int32_t maxDepth)
+{
+    LevelFootprint total = {0, 0, 0, 0, 0};
+    int64_t packedTotals[32];
+
+    LOG("-- memory footprint of ccs_Create(cage, %i) (MiB)", maxDepth);
+    LOG("depth | halfedges | creases | points fp32 | points 16-bit | uvs");
+    for (int32_t depth = 1; depth <= maxDepth; ++depth) {
+        const LevelFootprint level = LevelFootprintAtDepth(cage, depth);
+
+        LOG("%5i | %9.2f | %7.2f | %11.2f | %13.2f | %.2f",
+            depth,
+            ByteToMiByte(level.halfedges),
+            ByteToMiByte(level.creases),
+            ByteToMiByte(level.vertexPoints),
+            ByteToMiByte(level.packedVertexPoints),
+            ByteToMiByte(level.uvs));
+
+        total.halfedges+= level.halfedges;
+        total.creases+= level.creases;
+        total.vertexPoints+= level.vertexPoints;
+        total.packedVertexPoints+= level.packedVertexPoints;
+        total.uvs+= level.uvs;
+        packedTotals[depth] = 0;
+    }
+
+    // packing levels [minDepth, maxDepth]
+    for (int32_t minDepth = 1; minDepth <= maxDepth; ++minDepth) {
+        for (int32_t depth = 1; depth <= maxDepth; ++depth) {
+            const LevelFootprint level = LevelFootprintAtDepth(cage, depth);
+
+            packedTotals[minDepth]+= depth < minDepth ? level.vertexPoints
+                                                      : level.packedVertexPoints;
+        }
+    }
+
+    {
+        const int64_t topology = sizeof(cc_Subd) + total.halfedges + total.creases;
+
+        LOG("total (bytes): halfedges= %lld creases= %lld points= %lld uvs= %lld",
+            (long long)total.halfedges,
+            (long long)total.creases,
+            (long long)total.vertexPoints,
+            (long long)total.uvs);
+        LOG("configurations (GiB):");
+        LOG("  fp32 points          : %.3f (without uvs: %.3f)",
+            ByteToGiByte(topology + total.vertexPoints + total.uvs),
+            ByteToGiByte(topology + total.vertexPoints));
+
+        for (int32_t minDepth = 1; minDepth <= maxDepth; ++minDepth) {
+            LOG("  16-bit points >= d%-2i : %.3f (without uvs: %.3f)",
+                minDepth,
+                ByteToGiByte(topology + packedTotals[minDepth] + total.uvs),
+                ByteToGiByte(topology + packedTotals[minDepth]));
+        }
+    }
+}
+
+
+/*******************************************************************************
+ * Throughput calibration
+ *
+ * Each kernel is timed on the input mesh and its cost is saved as a number
+ * of nanoseconds per element, where elements are the cumulative creases for
+ * the crease kernel and the cumulative halfedges for the other kernels.
+ * Predictions scale these costs to the element counts of another mesh.
+ * Costs depend on the thread count, which is saved along with them.
+ *
+ */
+typedef enum {
+    KERNEL_CREASES,
+    KERNEL_HALFEDGES,
+    KERNEL_VERTEX_UVS,
+    KERNEL_VERTEX_POINTS_GATHER,
+    KERNEL_VERTEX_POINTS_SCATTER,
+
+    KERNEL_COUNT
+} Kernel;
+
+static const char *KernelName(Kernel kernel)
+{
+    const char *names[KERNEL_COUNT] = {
+        "creases",
+        "halfedges",
+        "vertex_uvs",
+        "vertex_points_gather",
+        "vertex_points_scatter"
+    };
+
+    return names[kernel];
+}
+
+static void RunKernel(Kernel kernel, cc_Subd *subd)
+{
+    switch (kernel) {
+    case KERNEL_CREASES: ccs_RefineCreases(subd); break;
+    case KERNEL_HALFEDGES: ccs_RefineHalfedges(subd); break;
+    case KERNEL_VERTEX_UVS: ccs_RefineVertexUvs(subd); break;
+    case KERNEL_VERTEX_POINTS_GATHER: ccs_RefineVertexPoints_Gather(subd); break;
+    case KERNEL_VERTEX_POINTS_SCATTER: ccs_RefineVertexPoints_Scatter(subd); break;
+    default: break;
+    }
+}
+
+static int64_t KernelElementCount(Kernel kernel, const cc_Mesh *cage, int32_t maxDepth)
+{
+    if (kernel == KERNEL_CREASES) {
+        return ccs_CumulativeCreaseCountAtDepth(cage, maxDepth);
+    } else if (kernel == KERNEL_VERTEX_UVS && ccm_UvCount(cage) == 0) {
+        return 0;
+    }
+
+    return ccs_CumulativeHalfedgeCountAtDepth(cage, maxDepth);
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static bool Calibrate(const cc_Mesh *cage, int32_t maxDepth, const char *filename)
+{
+    const int32_t runCount = 9;
+    cc_Subd *subd = ccs_Create(cage, maxDepth);
+    FILE *stream;
+
+    if (!subd) {
+        return false;
+    }
+
+    stream = fopen(filename, "w");
+    if (!stream) {
+        LOG("mesh_info: fopen failed");
+        ccs_Release(subd);
+
+        return false;
+    }
+
+    LOG("-- calibration (%i threads)", omp_get_max_threads());
+    fprintf(stream, "threads %i\n", omp_get_max_threads());
+
+    // topology must be up to date before the vertex kernels run
+    ccs_RefineHalfedges(subd);
+    ccs_RefineCreases(subd);
+
+    for (int32_t kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+        const int64_t elementCount = KernelElementCount(kernel, cage, maxDepth);
+        double times[9];
+        double nsPerElement;
+
+        if (elementCount == 0) {
+            continue;
+        }
+
+        for (int32_t runID = 0; runID < runCount; ++runID) {
+            const double startTime = omp_get_wtime();
+
+            RunKernel(kernel, subd);
+            times[runID] = omp_get_wtime() - startTime;
+        }
+
+        qsort(times, runCount, sizeof(times[0]), &CompareDoubles);
+        nsPerElement = times[runCount / 2] * 1e9 / elementCount;
+
+        LOG("%-22s: %.3f ns/element (median: %.3f ms)",
+            KernelName(kernel), nsPerElement, times[runCount / 2] * 1e3);
+        fprintf(stream, "%s %.6f\n", KernelName(kernel), nsPerElement);
+    }
+
+    fclose(stream);
+    ccs_Release(subd);
+
+    return true;
+}
+
+static bool Predict(const cc_Mesh *cage, int32_t maxDepth, const char *filename)
+{
+    double nsPerElement[KERNEL_COUNT];
+    int32_t threadCount = 0;
+    char name[64];
+    double value;
+    FILE *stream = fopen(filename, "r");
+
+    if (!stream) {
+        LOG("mesh_info: fopen failed");
+
+        return false;
+    }
+
+    for (int32_t kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+        nsPerElement[kernel] = -1.0;
+    }
+
+    while (fscanf(stream, "%63s %lf", name, &value) == 2) {
+        if (!strcmp(name, "threads")) {
+            threadCount = (int32_t)value;
+        }
+
+        for (int32_t kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+            if (!strcmp(name, KernelName(kernel))) {
+                nsPerElement[kernel] = value;
+            }
+        }
+    }
+    fclose(stream);
+
+    LOG("-- predicted refinement time at depth %i (ms)", maxDepth);
+    if (threadCount != omp_get_max_threads()) {
+        LOG("warning: calibrated with %i threads, running with %i",
+            threadCount, omp_get_max_threads());
+    }
+
+    {
+        double times[KERNEL_COUNT];
+
+        for (int32_t kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+            const int64_t elementCount = KernelElementCount(kernel, cage, maxDepth);
+
+            times[kernel] = 0.0;
+
+            if (elementCount > 0 && nsPerElement[kernel] < 0.0) {
+                LOG("%-22s: not calibrated", KernelName(kernel));
+            } else if (elementCount > 0) {
+                times[kernel] = nsPerElement[kernel] * elementCount * 1e-6;
+                LOG("%-22s: %.3f", KernelName(kernel), times[kernel]);
+            }
+        }
+
+        LOG("ccs_Refine_Gather     : %.3f",
+            times[KERNEL_CREASES] + times[KERNEL_HALFEDGES]
+            + times[KERNEL_VERTEX_UVS] + times[KERNEL_VERTEX_POINTS_GATHER]);
+        LOG("ccs_Refine_Scatter    : %.3f",
+            times[KERNEL_CREASES] + times[KERNEL_HALFEDGES]
+            + times[KERNEL_VERTEX_UVS] + times[KERNEL_VERTEX_POINTS_SCATTER]);
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int32_t maxDepth, safeDepth;
+    const char *calibrationFile = NULL;
+    const char *predictionFile = NULL;
+    TopologyStats stats;
+    cc_Mesh *mesh;
+
+    if (argc < 3) {
+        usage(argv[0]);
+        return 0;
+    }
+
+    for (int32_t i = 3; i + 1 < argc; i+= 2) {
+        if (!strcmp(argv[i], "-calibrate")) {
+            calibrationFile = argv[i + 1];
+        } else if (!strcmp(argv[i], "-predict")) {
+            predictionFile = argv[i + 1];
+        } else {
+            usage(argv[0]);
+            return 0;
+        }
+    }
+
+    mesh = ccm_Load(argv[1]);
+    maxDepth = atoi(argv[2]);
+
+    if (!mesh) {
+        return 0;
+    }
+
+    stats = ComputeTopologyStats(mesh);
+    LogTopologyStats(mesh, &stats);
+
+    safeDepth = MaxSafeDepth(mesh);
+    LOG("-- int32 overflow");
+    LOG("max safe depth: %i (counts overflow at depth %i)", safeDepth, safeDepth + 1);
+
+    if (maxDepth > safeDepth) {
+        LOG("warning: clamping maxDepth from %i to %i", maxDepth, safeDepth);
+        maxDepth = safeDepth;
+    }
+
+    LOG("-- counts");
     for (int32_t depth = 0; depth <= maxDepth; ++depth) {
         LOG("depth %i: H= %i F= %i E= %i V= %i C= %i",
             depth,
@@ -110,6 +599,18 @@ int main(int argc, char **argv)
             Cref);
     }
 
+    if (maxDepth > 0) {
+        LogMemoryFootprint(mesh, maxDepth);
+
+        if (calibrationFile) {
+            Calibrate(mesh, maxDepth, calibrationFile);
+        }
+
+        if (predictionFile) {
+            Predict(mesh, maxDepth, predictionFile);
+        }
+    }
+
     ccm_Release(mesh);
 
     return 1;
@@ -1,12 +1,27 @@
+// Small files are converted concurrently by the threads of a parallel loop,
+// where orphaned barriers would bind to that loop; the implicit barrier
+// that ends each parallel loop of the libraries is sufficient.
+#define CC_BARRIER
+#define CBF_BARRIER
+#define MB_BARRIER
+
 #define CC_IMPLEMENTATION
 #include "CatmullClark.h"
 
 #define CBF_IMPLEMENTATION
 #include "ConcurrentBitField.h"
 
+#define MB_IMPLEMENTATION
+#include "MeshBuilder.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
 
 #ifndef CC_ASSERT
 #    include <assert.h>
@@ -38,417 +53,6 @@
 #    define CC_MEMSET(ptr, value, num) memset(ptr, value, num)
 #endif
 
-#ifndef _OPENMP
-#   ifndef CC_ATOMIC
-#       define CC_ATOMIC
-#   endif
-#   ifndef CC_PARALLEL_FOR
-#       define CC_PARALLEL_FOR
-#   endif
-#   ifndef CC_BARRIER
-#       define CC_BARRIER
-#   endif
-#else
-#   if defined(_WIN32)
-#       ifndef CC_ATOMIC
-#           define CC_ATOMIC          __pragma("omp atomic" )
-#       endif
-#       ifndef CC_PARALLEL_FOR
-#           define CC_PARALLEL_FOR    __pragma("omp parallel for")
-#       endif
-#       ifndef CC_BARRIER
-#           define CC_BARRIER         __pragma("omp barrier")
-#       endif
-#   else
-#       ifndef CC_ATOMIC
-#           define CC_ATOMIC          _Pragma("omp atomic" )
-#       endif
-#       ifndef CC_PARALLEL_FOR
-#           define CC_PARALLEL_FOR    _Pragma("omp parallel for")
-#       endif
-#       ifndef CC_BARRIER
-#           define CC_BARRIER         _Pragma("omp barrier")
-#       endif
-#   endif
-#endif
-
-
-/*******************************************************************************
- * ComputeTwins -- Computes the twin of each half edge
- *
- * This routine is what effectively converts a traditional "indexed mesh"
- * into a halfedge mesh (in the case where all the primitives are the same).
- *
- */
-typedef struct {
-    int32_t halfedgeID;
-    uint64_t hashID;
-} TwinComputationData;
-
-static int32_t
-BinarySearch(
-    const TwinComputationData *array,
-    int32_t arraySize,
-    uint64_t hashID
-) {
-    int32_t a = 0, b = arraySize - 1;
-
-    while (a <= b) {
-        const int32_t c = (a + b) / 2;
-
-        if (array[c].hashID < hashID) {
-            a = c + 1;
-        } else {
-            b = c - 1;
-        }
-    }
-
-    return (array[a].hashID == hashID) ? array[a].halfedgeID : -1;
-}
-
-static void
-SortTwinComputationData(TwinComputationData *array, uint32_t arraySize)
-{
-    for (uint32_t d2 = 1u; d2 < arraySize; d2*= 2u) {
-        for (uint32_t d1 = d2; d1 >= 1u; d1/= 2u) {
-            const uint32_t mask = (0xFFFFFFFEu * d1);
-
-CC_PARALLEL_FOR
-            for (uint32_t i = 0; i < (arraySize / 2); ++i) {
-                const uint32_t i1 = ((i << 1) & mask) | (i & ~(mask >> 1));
-                const uint32_t i2 = i1 | d1;
-                const TwinComputationData t1 = array[i1];
-                const TwinComputationData t2 = array[i2];
-                const TwinComputationData min = t1.hashID < t2.hashID ? t1 : t2;
-                const TwinComputationData max = t1.hashID < t2.hashID ? t2 : t1;
-
-                if ((i & d2) == 0) {
-                    array[i1] = min;
-                    array[i2] = max;
-                } else {
-                    array[i1] = max;
-                    array[i2] = min;
-                }
-            }
-CC_BARRIER
-        }
-    }
-}
-
-static int32_t RoundUpToPowerOfTwo(int32_t x)
-{
-    x--;
-    x|= x >>  1;
-    x|= x >>  2;
-    x|= x >>  4;
-    x|= x >>  8;
-    x|= x >> 16;
-    x++;
-
-    return x;
-}
-
-static void ComputeTwins(cc_Mesh *mesh)
-{
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
-    const int32_t vertexCount = ccm_VertexCount(mesh);
-    const int32_t tableSize = RoundUpToPowerOfTwo(halfedgeCount);
-    TwinComputationData *table = (TwinComputationData *)CC_MALLOC(tableSize * sizeof(*table));
-
-    CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
-        const int32_t v0 = ccm_HalfedgeVertexID(mesh, halfedgeID);
-        const int32_t v1 = ccm_HalfedgeVertexID(mesh, nextID);
-
-        table[halfedgeID].halfedgeID = halfedgeID;
-        table[halfedgeID].hashID = (uint64_t)v0 + (uint64_t)vertexCount * v1;
-    }
-    CC_BARRIER
-
-    CC_PARALLEL_FOR
-    for (int32_t halfedgeID = halfedgeCount; halfedgeID < tableSize; ++halfedgeID) {
-        table[halfedgeID].hashID = ~0ULL;
-    }
-    CC_BARRIER
-
-    SortTwinComputationData(table, tableSize);
-
-    CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
-        const int32_t v0 = ccm_HalfedgeVertexID(mesh, halfedgeID);
-        const int32_t v1 = ccm_HalfedgeVertexID(mesh, nextID);
-        const uint64_t hashID = (uint64_t)v1 + (uint64_t)vertexCount * v0;
-        const int32_t twinID = BinarySearch(table, halfedgeCount - 1, hashID);
-
-        mesh->halfedges[halfedgeID].twinID = twinID;
-    }
-    CC_BARRIER
-
-    CC_FREE(table);
-}
-
-
-/*******************************************************************************
- * ComputeCreaseNeighbors -- Computes the neighbors of each crease
- *
- */
-static void ComputeCreaseNeighbors(cc_Mesh *mesh)
-{
-    const int32_t edgeCount = ccm_EdgeCount(mesh);
-
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const float sharpness = ccm_CreaseSharpness(mesh, edgeID);
-
-        if (sharpness > 0.0f) {
-            const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
-            const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
-            int32_t prevCreaseCount = 0;
-            int32_t prevCreaseID = -1;
-            int32_t nextCreaseCount = 0;
-            int32_t nextCreaseID = -1;
-            int32_t halfedgeIt;
-
-            for (halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
-                 halfedgeIt != halfedgeID && halfedgeIt >= 0;
-                 halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeIt)) {
-                const float s = ccm_HalfedgeSharpness(mesh, halfedgeIt);
-
-                if (s > 0.0f) {
-                    prevCreaseID = ccm_HalfedgeEdgeID(mesh, halfedgeIt);
-                    ++prevCreaseCount;
-                }
-            }
-
-            if (prevCreaseCount == 1 && halfedgeIt == halfedgeID) {
-                mesh->creases[edgeID].prevID = prevCreaseID;
-            }
-
-            if (ccm_HalfedgeSharpness(mesh, nextID) > 0.0f) {
-                nextCreaseID = ccm_HalfedgeEdgeID(mesh, nextID);
-                ++nextCreaseCount;
-            }
-
-            for (halfedgeIt = ccm_NextVertexHalfedgeID(mesh, nextID);
-                 halfedgeIt != nextID && halfedgeIt >= 0;
-                 halfedgeIt = ccm_NextVertexHalfedgeID(mesh, halfedgeIt)) {
-                const float s = ccm_HalfedgeSharpness(mesh, halfedgeIt);
-                const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeIt);
-
-                // twin check is to avoid counting for halfedgeID
-                if (s > 0.0f && twinID != halfedgeID) {
-                    nextCreaseID = ccm_HalfedgeEdgeID(mesh, halfedgeIt);
-                    ++nextCreaseCount;
-                }
-            }
-
-            if (nextCreaseCount == 1 && halfedgeIt == nextID) {
-                mesh->creases[edgeID].nextID = nextCreaseID;
-            }
-        }
-    }
-CC_BARRIER
-}
-
-
-/*******************************************************************************
- * MakeBoundariesSharp -- Tags boundary edges as sharp
- *
- * Following the Pixar standard, we tag boundary halfedges as sharp.
- * See "Subdivision Surfaces in Character Animation" by DeRose et al.
- * Note that we tag the sharpness value to 16 as subdivision can't go deeper
- * without overflowing 32-bit integers.
- *
- */
-static void MakeBoundariesSharp(cc_Mesh *mesh)
-{
-    const int32_t edgeCount = ccm_EdgeCount(mesh);
-
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
-        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
-
-        if (twinID < 0) {
-            mesh->creases[edgeID].sharpness = 16.0f;
-        }
-    }
-CC_BARRIER
-}
-
-
-/*******************************************************************************
- * LoadFaceMappings -- Computes the mappings for the faces of the mesh
- *
- */
-static int32_t FaceScroll(int32_t id, int32_t direction, int32_t maxValue)
-{
-    const int32_t n = maxValue - 1;
-    const int32_t d = direction;
-    const int32_t u = (d + 1) >> 1; // in [0, 1]
-    const int32_t un = u * n; // precomputation
-
-    return (id == un) ? (n - un) : (id + d);
-}
-
-static int32_t
-ScrollFaceHalfedgeID(
-    int32_t halfedgeID,
-    int32_t halfedgeFaceBeginID,
-    int32_t halfedgeFaceEndID,
-    int32_t direction
-) {
-    const int32_t faceHalfedgeCount = halfedgeFaceEndID - halfedgeFaceBeginID;
-    const int32_t localHalfedgeID = halfedgeID - halfedgeFaceBeginID;
-    const int32_t nextHalfedgeID = FaceScroll(localHalfedgeID,
-                                              direction,
-                                              faceHalfedgeCount);
-
-    return halfedgeFaceBeginID + nextHalfedgeID;
-}
-
-static void LoadFaceMappings(cc_Mesh *mesh, const cbf_BitField *faceIterator)
-{
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
-    const int32_t faceCount = cbf_BitCount(faceIterator) - 1;
-
-    mesh->faceToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * faceCount);
-    mesh->faceCount = faceCount;
-
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
-        const int32_t tmp = cbf_EncodeBit(faceIterator, halfedgeID);
-        const int32_t faceID = tmp - (cbf_GetBit(faceIterator, halfedgeID) ^ 1);
-
-        mesh->halfedges[halfedgeID].faceID = faceID;
-    }
-CC_BARRIER
-
-CC_PARALLEL_FOR
-    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
-        mesh->faceToHalfedgeIDs[faceID] = cbf_DecodeBit(faceIterator, faceID);
-    }
-CC_BARRIER
-
-
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
-        const int32_t faceID = mesh->halfedges[halfedgeID].faceID;
-        const int32_t beginID = cbf_DecodeBit(faceIterator, faceID);
-        const int32_t endID = cbf_DecodeBit(faceIterator, faceID + 1);
-        const int32_t nextID = ScrollFaceHalfedgeID(halfedgeID, beginID, endID, +1);
-        const int32_t prevID = ScrollFaceHalfedgeID(halfedgeID, beginID, endID, -1);
-
-        mesh->halfedges[halfedgeID].nextID = nextID;
-        mesh->halfedges[halfedgeID].prevID = prevID;
-    }
-CC_BARRIER
-}
-
-
-/*******************************************************************************
- * LoadEdgeMappings -- Computes the mappings for the edges of the mesh
- *
- * Catmull-Clark subdivision requires access to the edges of an input mesh.
- * Since we are dealing with a halfedge representation, we virtually
- * have to iterate the halfedges in a sparse way (an edge is a pair of
- * neighboring halfedges in the general case, except for boundary edges
- * where it only consists of a single halfedge).
- * This function builds a data-structure that allows to do just that:
- * for each halfedge pair, we only consider the one that has the largest
- * halfedgeID. This allows to treat boundary and regular edges seamlessly.
- *
- */
-static void LoadEdgeMappings(cc_Mesh *mesh)
-{
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
-    cc_Halfedge *halfedges = mesh->halfedges;
-    cbf_BitField *edgeIterator = cbf_Create(halfedgeCount);
-    int32_t edgeCount;
-
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
-        int32_t bitValue = halfedgeID > twinID ? 1 : 0;
-
-        cbf_SetBit(edgeIterator, halfedgeID, bitValue);
-    }
-CC_BARRIER
-
-    cbf_Reduce(edgeIterator);
-    edgeCount = cbf_BitCount(edgeIterator);
-
-    mesh->edgeToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * edgeCount);
-    mesh->edgeCount = edgeCount;
-
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID  < halfedgeCount; ++halfedgeID) {
-        const int32_t twinID = ccm_HalfedgeTwinID(mesh, halfedgeID);
-        const int32_t bitID = cc__Max(halfedgeID, twinID);
-
-        halfedges[halfedgeID].edgeID = cbf_EncodeBit(edgeIterator, bitID);
-    }
-CC_BARRIER
-
-CC_PARALLEL_FOR
-    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
-        mesh->edgeToHalfedgeIDs[edgeID] = cbf_DecodeBit(edgeIterator, edgeID);
-    }
-CC_BARRIER
-
-    cbf_Release(edgeIterator);
-}
-
-
-/*******************************************************************************
- * LoadVertexHalfedges -- Computes an iterator over one halfedge per vertex
- *
- * Catmull-Clark subdivision requires access to the halfedges that surround
- * the vertices of an input mesh.
- * This function determines a halfedge ID that starts from a
- * given vertex within that vertex. We distinguish two cases:
- * 1- If the vertex is a lying on a boundary, we stored the halfedge that
- * allows for iteration in the forward sense.
- * 2- Otherwise we store the largest halfedge ID.
- *
- */
-static void LoadVertexHalfedges(cc_Mesh *mesh)
-{
-    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
-    const int32_t vertexCount = ccm_VertexCount(mesh);
-
-    mesh->vertexToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * vertexCount);
-
-CC_PARALLEL_FOR
-    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
-        const int32_t vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
-        int32_t maxHalfedgeID = halfedgeID;
-        int32_t boundaryHalfedgeID = halfedgeID;
-        int32_t iterator;
-
-        for (iterator = ccm_NextVertexHalfedgeID(mesh, halfedgeID);
-             iterator >= 0 && iterator != halfedgeID;
-             iterator = ccm_NextVertexHalfedgeID(mesh, iterator)) {
-            maxHalfedgeID = cc__Max(maxHalfedgeID, iterator);
-            boundaryHalfedgeID = iterator;
-        }
-
-        // affect max halfedge ID to vertex
-        if /*boundary involved*/ (iterator < 0) {
-            if (halfedgeID == boundaryHalfedgeID) {
-                mesh->vertexToHalfedgeIDs[vertexID] = boundaryHalfedgeID;
-            }
-        } else {
-            if (halfedgeID == maxHalfedgeID) {
-                mesh->vertexToHalfedgeIDs[vertexID] = maxHalfedgeID;
-            }
-        }
-    }
-CC_BARRIER
-}
-
 
 /*******************************************************************************
  * ObjReadFace -- Reads an OBJ face
@@ -598,7 +202,7 @@ ObjLoadMeshData(FILE *stream, cc_Mesh *mesh, cbf_BitField *faceIterator)
     }
 
     cbf_Reduce(faceIterator);
-    LoadFaceMappings(mesh, faceIterator);
+    mb_LoadFaceMappings(mesh, faceIterator);
 
     return true;
 }
@@ -658,12 +262,14 @@ ObjReadMeshSize(
 
 
 /*******************************************************************************
- * ObjReadVertex -- Reads an OBJ file
+ * LoadObj -- Reads an OBJ file
  *
- * Returns NULL on failure.
+ * Progress is only logged if verbose is true. Returns NULL on failure.
  *
  */
-CCDEF cc_Mesh *LoadObj(const char *filename)
+#define OBJ_LOG_PROGRESS(verbose, message) do { if (verbose) CC_LOG(message); } while(0)
+
+CCDEF cc_Mesh *LoadObj(const char *filename, bool verbose)
 {
     int32_t halfedgeCount, vertexCount, uvCount;
     cbf_BitField *faceIterator;
@@ -677,7 +283,7 @@ CCDEF cc_Mesh *LoadObj(const char *filename)
         return NULL;
     }
 
-    CC_LOG("Parsing OBJ...");
+    OBJ_LOG_PROGRESS(verbose, "Parsing OBJ...");
     if (!ObjReadMeshSize(stream, &halfedgeCount, &vertexCount, &uvCount)) {
         CC_LOG("cc: invalid OBJ file");
         fclose(stream);
@@ -685,7 +291,7 @@ CCDEF cc_Mesh *LoadObj(const char *filename)
         return NULL;
     }
 
-    CC_LOG("Allocating mesh...");
+    OBJ_LOG_PROGRESS(verbose, "Allocating mesh...");
     mesh = (cc_Mesh *)CC_MALLOC(sizeof(*mesh));
     mesh->halfedgeCount = halfedgeCount;
     mesh->halfedges = (cc_Halfedge *)CC_MALLOC(sizeof(cc_Halfedge) * halfedgeCount);
@@ -693,111 +299,304 @@ CCDEF cc_Mesh *LoadObj(const char *filename)
     mesh->vertexPoints = (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint) * vertexCount);
     mesh->uvCount = uvCount;
     mesh->uvs = (cc_VertexUv *)CC_MALLOC(sizeof(cc_VertexUv) * uvCount);
+    mesh->faceHoles = NULL;
     faceIterator = cbf_Create(halfedgeCount + 1);
     rewind(stream);
 
-    CC_LOG("Loading mesh data...");
+    OBJ_LOG_PROGRESS(verbose, "Loading mesh data...");
     if (!ObjLoadMeshData(stream, mesh, faceIterator)) {
         CC_LOG("cc: failed to read OBJ data");
         CC_FREE(mesh->halfedges);
         CC_FREE(mesh->vertexPoints);
         CC_FREE(mesh->uvs);
         CC_FREE(mesh);
-
+        cbf_Release(faceIterator);
         fclose(stream);
 
         return NULL;
     }
 
-    CC_LOG("Computing twins...");
-    ComputeTwins(mesh);
-    CC_LOG("Computing edge mappings...");
-    LoadEdgeMappings(mesh);
-    CC_LOG("Computing vertex mappings...");
-    LoadVertexHalfedges(mesh);
+    OBJ_LOG_PROGRESS(verbose, "Computing twins...");
+    mb_ComputeTwins(mesh);
+    OBJ_LOG_PROGRESS(verbose, "Computing edge mappings...");
+    mb_LoadEdgeMappings(mesh);
+    OBJ_LOG_PROGRESS(verbose, "Computing vertex mappings...");
+    mb_LoadVertexHalfedges(mesh);
 
-    CC_LOG("Loading creases...");
+    OBJ_LOG_PROGRESS(verbose, "Loading creases...");
     if (true) {
-        const int32_t creaseCount = ccm_EdgeCount(mesh);
-
-        mesh->creases = (cc_Crease *)CC_MALLOC(sizeof(cc_Crease) * creaseCount);
+        mb_CreateCreases(mesh);
         rewind(stream);
 
-CC_PARALLEL_FOR
-        for (int32_t creaseID = 0; creaseID < creaseCount; ++creaseID) {
-            mesh->creases[creaseID].nextID = creaseID;
-            mesh->creases[creaseID].prevID = creaseID;
-            mesh->creases[creaseID].sharpness = 0.0f;
-        }
-CC_BARRIER
-
         if (!ObjLoadCreaseData(stream, mesh)) {
             CC_LOG("cc: failed to read OBJ crease data");
             ccm_Release(mesh);
+            cbf_Release(faceIterator);
             fclose(stream);
 
             return NULL;
         }
 
-        MakeBoundariesSharp(mesh);
+        mb_MakeBoundariesSharp(mesh);
     }
 
     fclose(stream);
     cbf_Release(faceIterator);
 
-    CC_LOG("Computing crease neighbors...");
-    ComputeCreaseNeighbors(mesh);
+    OBJ_LOG_PROGRESS(verbose, "Computing crease neighbors...");
+    mb_ComputeCreaseNeighbors(mesh);
 
     return mesh;
 }
 
+#undef OBJ_LOG_PROGRESS
+
+
+/*******************************************************************************
+ * Conversion -- Converts an OBJ file into a .ccm file
+ *
+ * The .ccm file is written to the working directory, under the base name of
+ * the OBJ file. If verify is true, the .ccm file is loaded back and its
+ * element counts are compared against those of the converted mesh.
+ *
+ */
+typedef struct {
+    const char *inputFile;
+    char outputFile[1024];
+    int64_t inputByteCount;
+    int64_t outputByteCount;
+    int32_t counts[6]; // V, U, H, C, E, F
+    double time;
+    bool success;
+} Conversion;
+
+static int64_t FileByteCount(const char *filename)
+{
+    FILE *stream = fopen(filename, "rb");
+    int64_t byteCount;
+
+    if (!stream) {
+        return -1;
+    }
+
+    fseek(stream, 0, SEEK_END);
+    byteCount = (int64_t)ftell(stream);
+    fclose(stream);
+
+    return byteCount;
+}
+
+static void MeshCounts(const cc_Mesh *mesh, int32_t counts[6])
+{
+    counts[0] = ccm_VertexCount(mesh);
+    counts[1] = ccm_UvCount(mesh);
+    counts[2] = ccm_HalfedgeCount(mesh);
+    counts[3] = ccm_CreaseCount(mesh);
+    counts[4] = ccm_EdgeCount(mesh);
+    counts[5] = ccm_FaceCount(mesh);
+}
+
+static void SetOutputFile(Conversion *conversion)
+{
+    const char *file = conversion->inputFile;
+    const char *baseName = strrchr(file, '/');
+    char *postFix;
+
+    snprintf(conversion->outputFile,
+             sizeof(conversion->outputFile),
+             "%s",
+             baseName != NULL ? baseName + 1 : file);
+    postFix = strrchr(conversion->outputFile, '.');
+
+    if (postFix != NULL) {
+        *postFix = '\0';
+    }
+
+    strncat(conversion->outputFile,
+            ".ccm",
+            sizeof(conversion->outputFile) - strlen(conversion->outputFile) - 1);
+}
+
+static double Time(void)
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static void Convert(Conversion *conversion, bool verbose, bool verify)
+{
+    const double startTime = Time();
+    cc_Mesh *mesh = LoadObj(conversion->inputFile, verbose);
+
+    conversion->success = false;
+
+    if (!mesh) {
+        return;
+    }
+
+    MeshCounts(mesh, conversion->counts);
+    conversion->success = ccm_Save(mesh, conversion->outputFile);
+    ccm_Release(mesh);
+    conversion->time = Time() - startTime;
+    conversion->outputByteCount = FileByteCount(conversion->outputFile);
+
+    if (conversion->success && verify) {
+        cc_Mesh *savedMesh = ccm_Load(conversion->outputFile);
+        int32_t savedCounts[6];
+
+        if (savedMesh != NULL) {
+            MeshCounts(savedMesh, savedCounts);
+            conversion->success = !memcmp(savedCounts,
+                                          conversion->counts,
+                                          sizeof(savedCounts));
+            ccm_Release(savedMesh);
+        } else {
+            conversion->success = false;
+        }
+
+        if (!conversion->success) {
+            CC_LOG("cc: verification failed for %s", conversion->outputFile);
+        }
+    }
+}
+
+static void LogConversion(const Conversion *conversion)
+{
+    const int32_t *counts = conversion->counts;
+
+    if (!conversion->success) {
+        CC_LOG("%s: FAILED", conversion->inputFile);
+
+        return;
+    }
+
+    CC_LOG("%s -> %s: %.1f ms, %.2f MiB -> %.2f MiB (%.1f MiB/s)",
+           conversion->inputFile,
+           conversion->outputFile,
+           conversion->time * 1e3,
+           conversion->inputByteCount / 1048576.0,
+           conversion->outputByteCount / 1048576.0,
+           conversion->inputByteCount / 1048576.0 / conversion->time);
+    CC_LOG("  V: %i U: %i H: %i C: %i E: %i F: %i",
+           counts[0], counts[1], counts[2], counts[3], counts[4], counts[5]);
+}
+
+static int CompareConversions(const void *a, const void *b)
+{
+    const int64_t sizeA = ((const Conversion *)a)->inputByteCount;
+    const int64_t sizeB = ((const Conversion *)b)->inputByteCount;
+
+    return sizeA < sizeB ? 1 : (sizeA > sizeB ? -1 : 0);
+}
+
+
 static void Usage(const char *appname)
 {
-    CC_LOG("usage -- %s file1 file2 ...", appname);
+    CC_LOG("usage -- %s [options] file1 file2 ...", appname);
+    CC_LOG("  -threads count                 global thread budget (default: all)");
+    CC_LOG("  -large size                    size in MiB above which a file gets");
+    CC_LOG("                                 all threads to itself (default: 64)");
+    CC_LOG("  -verify                        reload each .ccm file and check its counts");
 }
 
 
+/*******************************************************************************
+ * Conversion scheduling
+ *
+ * Files are sorted by decreasing size. Large files are converted one after
+ * the other, each with the whole thread budget for the parallel loops of
+ * the mesh builder. The remaining files are then converted concurrently,
+ * one file per thread, since their parallel loops are too short to keep
+ * all threads busy.
+ *
+ */
 int main(int argc, char **argv)
 {
-    const int32_t meshCount = argc - 1;
-    char buffer[1024];
+#ifdef _OPENMP
+    int32_t threadCount = omp_get_max_threads();
+#else
+    int32_t threadCount = 1;
+#endif
+    int64_t largeByteCount = (int64_t)64 << 20;
+    bool verify = false;
+    Conversion *conversions = (Conversion *)CC_MALLOC(sizeof(Conversion) * argc);
+    int32_t conversionCount = 0, largeCount = 0, failedCount = 0;
+    double startTime;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const int32_t argLeft = argc - i - 1;
+
+        if (!strcmp(arg, "-threads") && argLeft >= 1) {
+            threadCount = atoi(argv[++i]);
+        } else if (!strcmp(arg, "-large") && argLeft >= 1) {
+            largeByteCount = (int64_t)(atof(argv[++i]) * 1048576.0);
+        } else if (!strcmp(arg, "-verify")) {
+            verify = true;
+        } else if (arg[0] != '-') {
+            Conversion *conversion = &conversions[conversionCount++];
+
+            memset(conversion, 0, sizeof(*conversion));
+            conversion->inputFile = arg;
+            conversion->inputByteCount = FileByteCount(arg);
+            SetOutputFile(conversion);
+        } else {
+            conversionCount = 0;
+            break;
+        }
+    }
 
-    if (meshCount == 0) {
+    if (conversionCount == 0 || threadCount < 1) {
         Usage(argv[0]);
+        CC_FREE(conversions);
+
+        return -1;
     }
 
-    for (int32_t meshID = 0; meshID < meshCount; ++meshID) {
-        const char *file = argv[meshID + 1];
-        CC_LOG("Loading: %s", file);
-        cc_Mesh *mesh = LoadObj(file);
-        char *preFix, *postFix;
+    qsort(conversions, conversionCount, sizeof(Conversion), &CompareConversions);
 
-        memset(buffer, 0, sizeof(buffer));
-        memcpy(buffer, file, strlen(file));
-        preFix = strrchr(buffer, '/');
-        postFix = strrchr(buffer, '.');
+    while (largeCount < conversionCount
+           && conversions[largeCount].inputByteCount >= largeByteCount) {
+        ++largeCount;
+    }
 
-        if (postFix != NULL) {
-            *postFix = '\0';
-        }
+    startTime = Time();
+#ifdef _OPENMP
+    omp_set_max_active_levels(1);
+    omp_set_num_threads(threadCount);
+#endif
 
-        if (preFix != NULL) {
-            sprintf(buffer, "%s.ccm", preFix + 1);
-        } else {
-            sprintf(buffer, "%s.ccm", buffer);
-        }
-        CC_LOG("Output file: %s", buffer);
-
-        ccm_Save(mesh, buffer);
-        ccm_Release(mesh);
-
-        mesh = ccm_Load(buffer);
-        CC_LOG("V: %i", ccm_VertexCount(mesh));
-        CC_LOG("U: %i", ccm_UvCount(mesh));
-        CC_LOG("H: %i", ccm_HalfedgeCount(mesh));
-        CC_LOG("C: %i", ccm_CreaseCount(mesh));
-        CC_LOG("E: %i", ccm_EdgeCount(mesh));
-        CC_LOG("F: %i", ccm_FaceCount(mesh));
-        ccm_Release(mesh);
+    for (int32_t i = 0; i < largeCount; ++i) {
+        CC_LOG("Loading: %s", conversions[i].inputFile);
+        Convert(&conversions[i], true, verify);
+        LogConversion(&conversions[i]);
     }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (int32_t i = largeCount; i < conversionCount; ++i) {
+        Convert(&conversions[i], false, verify);
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        LogConversion(&conversions[i]);
+    }
+
+    for (int32_t i = 0; i < conversionCount; ++i) {
+        failedCount+= conversions[i].success ? 0 : 1;
+    }
+
+    CC_LOG("Converted %i files (%i large, %i failed) with %i threads in %.1f ms",
+           conversionCount - failedCount,
+           largeCount,
+           failedCount,
+           threadCount,
+           (Time() - startTime) * 1e3);
+    CC_FREE(conversions);
+
+    return failedCount > 0 ? -1 : 0;
 }
@@ -0,0 +1,1053 @@
+#define CC_IMPLEMENTATION
+#include "CatmullClark.h"
+
+#define CBF_IMPLEMENTATION
+#include "ConcurrentBitField.h"
+
+#define MB_IMPLEMENTATION
+#include "MeshBuilder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#ifndef CC_LOG
+#    include <stdio.h>
+#    define CC_LOG(format, ...) do { fprintf(stdout, format "\n", ##__VA_ARGS__); fflush(stdout); } while(0)
+#endif
+
+#ifndef CC_MALLOC
+#    include <stdlib.h>
+#    define CC_MALLOC(x) (malloc(x))
+#    define CC_FREE(x) (free(x))
+#else
+#    ifndef CC_FREE
+#        error CC_MALLOC defined without CC_FREE
+#    endif
+#endif
+
+#ifndef _OPENMP
+#   ifndef CC_PARALLEL_FOR
+#       define CC_PARALLEL_FOR
+#   endif
+#   ifndef CC_BARRIER
+#       define CC_BARRIER
+#   endif
+#else
+#   if defined(_WIN32)
+#       ifndef CC_PARALLEL_FOR
+#           define CC_PARALLEL_FOR    __pragma("omp parallel for")
+#       endif
+#       ifndef CC_BARRIER
+#           define CC_BARRIER         __pragma("omp barrier")
+#       endif
+#   else
+#       ifndef CC_PARALLEL_FOR
+#           define CC_PARALLEL_FOR    _Pragma("omp parallel for")
+#       endif
+#       ifndef CC_BARRIER
+#           define CC_BARRIER         _Pragma("omp barrier")
+#       endif
+#   endif
+#endif
+
+#define PLY_MAX_NAME_LENGTH 64
+#define PLY_MAX_PROPERTY_COUNT 32
+#define PLY_MAX_ELEMENT_COUNT 16
+
+
+/*******************************************************************************
+ * PLY data structures
+ *
+ * A PLY file is a text header that declares a list of elements, each with a
+ * record count and a list of (scalar or list) properties, followed by the
+ * records of each element in declaration order. Only binary files are
+ * supported; the records are decoded straight from a memory mapping of the
+ * file, swapping bytes when the file and host endianness differ.
+ *
+ */
+typedef enum {
+    PLY_TYPE_INT8,
+    PLY_TYPE_UINT8,
+    PLY_TYPE_INT16,
+    PLY_TYPE_UINT16,
+    PLY_TYPE_INT32,
+    PLY_TYPE_UINT32,
+    PLY_TYPE_FLOAT32,
+    PLY_TYPE_FLOAT64,
+
+    PLY_TYPE_INVALID
+} PlyType;
+
+typedef struct {
+    char name[PLY_MAX_NAME_LENGTH];
+    PlyType type;           // item type for list properties
+    PlyType countType;      // PLY_TYPE_INVALID for scalar properties
+} PlyProperty;
+
+typedef struct {
+    char name[PLY_MAX_NAME_LENGTH];
+    PlyProperty properties[PLY_MAX_PROPERTY_COUNT];
+    int32_t propertyCount;
+    int32_t count;
+    const uint8_t *data;    // first record
+} PlyElement;
+
+typedef struct {
+    const uint8_t *data;
+    const uint8_t *end;
+    void *mapping;
+    size_t byteCount;
+    bool swapBytes;
+    PlyElement elements[PLY_MAX_ELEMENT_COUNT];
+    int32_t elementCount;
+} PlyFile;
+
+// byte offset of a scalar property within the records of an element
+typedef struct {
+    int32_t offset;
+    PlyType type;
+} PlyField;
+
+
+/*******************************************************************************
+ * PlyTypeSize / PlyParseType -- PLY scalar types
+ *
+ */
+static int32_t PlyTypeSize(PlyType type)
+{
+    switch (type) {
+    case PLY_TYPE_INT8: case PLY_TYPE_UINT8: return 1;
+    case PLY_TYPE_INT16: case PLY_TYPE_UINT16: return 2;
+    case PLY_TYPE_INT32: case PLY_TYPE_UINT32: case PLY_TYPE_FLOAT32: return 4;
+    case PLY_TYPE_FLOAT64: return 8;
+    default: return 0;
+    }
+}
+
+static PlyType PlyParseType(const char *name)
+{
+    const struct {
+        const char *name;
+        PlyType type;
+    } types[] = {
+        {"char", PLY_TYPE_INT8}, {"int8", PLY_TYPE_INT8},
+        {"uchar", PLY_TYPE_UINT8}, {"uint8", PLY_TYPE_UINT8},
+        {"short", PLY_TYPE_INT16}, {"int16", PLY_TYPE_INT16},
+        {"ushort", PLY_TYPE_UINT16}, {"uint16", PLY_TYPE_UINT16},
+        {"int", PLY_TYPE_INT32}, {"int32", PLY_TYPE_INT32},
+        {"uint", PLY_TYPE_UINT32}, {"uint32", PLY_TYPE_UINT32},
+        {"float", PLY_TYPE_FLOAT32}, {"float32", PLY_TYPE_FLOAT32},
+        {"double", PLY_TYPE_FLOAT64}, {"float64", PLY_TYPE_FLOAT64}
+    };
+
+    for (int32_t i = 0; i < (int32_t)(sizeof(types) / sizeof(types[0])); ++i) {
+        if (!strcmp(name, types[i].name)) {
+            return types[i].type;
+        }
+    }
+
+    return PLY_TYPE_INVALID;
+}
+
+
+/*******************************************************************************
+ * PlyReadScalar -- Decodes a binary scalar value
+ *
+ * Values are returned as doubles, which represent all PLY integer types
+ * exactly.
+ *
+ */
+static double PlyReadScalar(const uint8_t *ptr, PlyType type, bool swapBytes)
+{
+    const int32_t size = PlyTypeSize(type);
+    uint8_t bytes[8];
+
+    for (int32_t i = 0; i < size; ++i) {
+        bytes[i] = swapBytes ? ptr[size - 1 - i] : ptr[i];
+    }
+
+    switch (type) {
+    case PLY_TYPE_INT8: return (double)(int8_t)bytes[0];
+    case PLY_TYPE_UINT8: return (double)bytes[0];
+    case PLY_TYPE_INT16: {
+        int16_t x; memcpy(&x, bytes, sizeof(x)); return (double)x;
+    }
+    case PLY_TYPE_UINT16: {
+        uint16_t x; memcpy(&x, bytes, sizeof(x)); return (double)x;
+    }
+    case PLY_TYPE_INT32: {
+        int32_t x; memcpy(&x, bytes, sizeof(x)); return (double)x;
+    }
+    case PLY_TYPE_UINT32: {
+        uint32_t x; memcpy(&x, bytes, sizeof(x)); return (double)x;
+    }
+    case PLY_TYPE_FLOAT32: {
+        float x; memcpy(&x, bytes, sizeof(x)); return (double)x;
+    }
+    case PLY_TYPE_FLOAT64: {
+        double x; memcpy(&x, bytes, sizeof(x)); return x;
+    }
+    default: return 0.0;
+    }
+}
+
+
+/*******************************************************************************
+ * PlyMapFile / PlyUnmapFile -- Maps the content of a file in memory
+ *
+ * Files are memory-mapped read-only on POSIX systems and read into memory
+ * otherwise.
+ *
+ */
+static bool PlyMapFile(PlyFile *ply, const char *filename)
+{
+#ifdef _WIN32
+    FILE *stream = fopen(filename, "rb");
+    long byteCount;
+
+    if (!stream) {
+        CC_LOG("cc: fopen failed");
+
+        return false;
+    }
+
+    fseek(stream, 0, SEEK_END);
+    byteCount = ftell(stream);
+    rewind(stream);
+    ply->mapping = CC_MALLOC(byteCount > 0 ? byteCount : 1);
+    ply->byteCount = (size_t)byteCount;
+
+    if (fread(ply->mapping, 1, ply->byteCount, stream) != ply->byteCount) {
+        CC_LOG("cc: fread failed");
+        CC_FREE(ply->mapping);
+        fclose(stream);
+
+        return false;
+    }
+
+    fclose(stream);
+#else
+    const int fd = open(filename, O_RDONLY);
+    struct stat info;
+
+    if (fd < 0) {
+        CC_LOG("cc: open failed");
+
+        return false;
+    }
+
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        CC_LOG("cc: empty file");
+        close(fd);
+
+        return false;
+    }
+
+    ply->byteCount = (size_t)info.st_size;
+    ply->mapping = mmap(NULL, ply->byteCount, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (ply->mapping == MAP_FAILED) {
+        CC_LOG("cc: mmap failed");
+
+        return false;
+    }
+#endif
+    ply->data = (const uint8_t *)ply->mapping;
+    ply->end = ply->data + ply->byteCount;
+
+    return true;
+}
+
+static void PlyUnmapFile(PlyFile *ply)
+{
+#ifdef _WIN32
+    CC_FREE(ply->mapping);
+#else
+    munmap(ply->mapping, ply->byteCount);
+#endif
+}
+
+
+/*******************************************************************************
+ * PlyReadHeader -- Parses the header of a binary PLY file
+ *
+ * Returns a pointer to the first byte of the body, or NULL on failure.
+ *
+ */
+static const uint8_t *PlyReadHeader(PlyFile *ply)
+{
+    const uint16_t endianness = 1u;
+    const bool hostBigEndian = *(const uint8_t *)&endianness == 0u;
+    const uint8_t *ptr = ply->data;
+    PlyElement *element = NULL;
+    bool hasFormat = false;
+
+    ply->elementCount = 0;
+
+    while (ptr < ply->end) {
+        const uint8_t *lineEnd = (const uint8_t *)memchr(ptr, '\n', ply->end - ptr);
+        char line[256], keyword[PLY_MAX_NAME_LENGTH];
+        size_t lineLength;
+
+        if (lineEnd == NULL) {
+            return NULL;
+        }
+
+        lineLength = (size_t)(lineEnd - ptr);
+        lineLength = lineLength < sizeof(line) - 1 ? lineLength : sizeof(line) - 1;
+        memcpy(line, ptr, lineLength);
+        line[lineLength] = '\0';
+        ptr = lineEnd + 1;
+
+        if (sscanf(line, "%63s", keyword) != 1) {
+            continue;
+        }
+
+        if (!strcmp(keyword, "format")) {
+            char format[PLY_MAX_NAME_LENGTH];
+
+            if (sscanf(line, "format %63s", format) != 1) {
+                return NULL;
+            }
+
+            if (!strcmp(format, "binary_little_endian")) {
+                ply->swapBytes = hostBigEndian;
+            } else if (!strcmp(format, "binary_big_endian")) {
+                ply->swapBytes = !hostBigEndian;
+            } else {
+                CC_LOG("cc: unsupported PLY format '%s'", format);
+
+                return NULL;
+            }
+
+            hasFormat = true;
+        } else if (!strcmp(keyword, "element")) {
+            if (ply->elementCount == PLY_MAX_ELEMENT_COUNT) {
+                return NULL;
+            }
+
+            element = &ply->elements[ply->elementCount++];
+            element->propertyCount = 0;
+            element->data = NULL;
+
+            if (sscanf(line, "element %63s %d", element->name, &element->count) != 2
+                || element->count < 0) {
+                return NULL;
+            }
+        } else if (!strcmp(keyword, "property")) {
+            char type1[PLY_MAX_NAME_LENGTH], type2[PLY_MAX_NAME_LENGTH];
+            PlyProperty *property;
+
+            if (element == NULL || element->propertyCount == PLY_MAX_PROPERTY_COUNT) {
+                return NULL;
+            }
+
+            property = &element->properties[element->propertyCount++];
+
+            if (sscanf(line, "property list %63s %63s %63s",
+                       type1, type2, property->name) == 3) {
+                property->countType = PlyParseType(type1);
+                property->type = PlyParseType(type2);
+
+                if (property->countType == PLY_TYPE_INVALID
+                    || property->countType == PLY_TYPE_FLOAT32
+                    || property->countType == PLY_TYPE_FLOAT64) {
+                    return NULL;
+                }
+            } else if (sscanf(line, "property %63s %63s", type1, property->name) == 2) {
+                property->countType = PLY_TYPE_INVALID;
+                property->type = PlyParseType(type1);
+            } else {
+                return NULL;
+            }
+
+            if (property->type == PLY_TYPE_INVALID) {
+                return NULL;
+            }
+        } else if (!strcmp(keyword, "end_header")) {
+            return hasFormat ? ptr : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+
+/*******************************************************************************
+ * PlyRecordStride -- Returns the byte size of the records of an element
+ *
+ * Returns -1 if the element has list properties, in which case its records
+ * have a variable size.
+ *
+ */
+static int32_t PlyRecordStride(const PlyElement *element)
+{
+    int32_t stride = 0;
+
+    for (int32_t i = 0; i < element->propertyCount; ++i) {
+        const PlyProperty *property = &element->properties[i];
+
+        if (property->countType != PLY_TYPE_INVALID) {
+            return -1;
+        }
+
+        stride+= PlyTypeSize(property->type);
+    }
+
+    return stride;
+}
+
+
+/*******************************************************************************
+ * PlySkipRecord -- Returns a pointer past a variable-size record
+ *
+ * If listSizes is not NULL, it receives the item count of each property.
+ * Returns NULL if the record overflows the file.
+ *
+ */
+static const uint8_t *
+PlySkipRecord(
+    const PlyFile *ply,
+    const PlyElement *element,
+    const uint8_t *ptr,
+    int32_t *listSizes
+) {
+    for (int32_t i = 0; i < element->propertyCount; ++i) {
+        const PlyProperty *property = &element->properties[i];
+        const int32_t itemSize = PlyTypeSize(property->type);
+        int32_t itemCount = 1;
+
+        if (property->countType != PLY_TYPE_INVALID) {
+            const int32_t countSize = PlyTypeSize(property->countType);
+            double count;
+
+            if (ply->end - ptr < countSize) {
+                return NULL;
+            }
+
+            count = PlyReadScalar(ptr, property->countType, ply->swapBytes);
+
+            if (count < 0.0 || count > 65536.0) {
+                return NULL;
+            }
+
+            itemCount = (int32_t)count;
+            ptr+= countSize;
+        }
+
+        if (listSizes != NULL) {
+            listSizes[i] = itemCount;
+        }
+
+        if ((int64_t)(ply->end - ptr) < (int64_t)itemCount * itemSize) {
+            return NULL;
+        }
+
+        ptr+= itemCount * itemSize;
+    }
+
+    return ptr;
+}
+
+
+/*******************************************************************************
+ * PlyFindElement / PlyFindProperty / PlyFindField -- Header queries
+ *
+ */
+static const PlyElement *PlyFindElement(const PlyFile *ply, const char *name)
+{
+    for (int32_t i = 0; i < ply->elementCount; ++i) {
+        if (!strcmp(ply->elements[i].name, name)) {
+            return &ply->elements[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int32_t PlyFindProperty(const PlyElement *element, const char *name)
+{
+    for (int32_t i = 0; i < element->propertyCount; ++i) {
+        if (!strcmp(element->properties[i].name, name)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// returns false if the element has no scalar property with the given name
+static bool PlyFindField(const PlyElement *element, const char *name, PlyField *field)
+{
+    const int32_t propertyID = PlyFindProperty(element, name);
+
+    field->offset = 0;
+
+    if (propertyID < 0 || element->properties[propertyID].countType != PLY_TYPE_INVALID) {
+        return false;
+    }
+
+    for (int32_t i = 0; i < propertyID; ++i) {
+        field->offset+= PlyTypeSize(element->properties[i].type);
+    }
+
+    field->type = element->properties[propertyID].type;
+
+    return true;
+}
+
+
+/*******************************************************************************
+ * PlyLocateElements -- Computes the location of the records of each element
+ *
+ * The records of the element called 'face' are scanned to retrieve the byte
+ * offset and the vertex count of each face, which are used to decode the
+ * faces in parallel. Other variable-size elements are skipped.
+ *
+ */
+typedef struct {
+    int32_t indexPropertyID;    // vertex_indices list
+    int32_t uvPropertyID;       // optional texcoord list
+    int32_t *recordOffsets;     // byte offset of each face
+    int32_t *halfedgeOffsets;   // first halfedge of each face
+    int32_t halfedgeCount;
+} PlyFaces;
+
+static bool
+PlyScanFaces(
+    const PlyFile *ply,
+    const PlyElement *element,
+    const uint8_t **ptr,
+    PlyFaces *faces
+) {
+    const int32_t faceCount = element->count;
+    int32_t listSizes[PLY_MAX_PROPERTY_COUNT];
+    int64_t halfedgeCount = 0;
+
+    faces->recordOffsets = (int32_t *)CC_MALLOC(sizeof(int32_t) * faceCount);
+    faces->halfedgeOffsets = (int32_t *)CC_MALLOC(sizeof(int32_t) * faceCount);
+
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        const int64_t recordOffset = *ptr - element->data;
+
+        if (recordOffset > INT32_MAX) {
+            CC_LOG("cc: face data exceeds 2GiB");
+
+            return false;
+        }
+
+        faces->recordOffsets[faceID] = (int32_t)recordOffset;
+        faces->halfedgeOffsets[faceID] = (int32_t)halfedgeCount;
+        *ptr = PlySkipRecord(ply, element, *ptr, listSizes);
+
+        if (*ptr == NULL) {
+            CC_LOG("cc: truncated face data");
+
+            return false;
+        }
+
+        if (listSizes[faces->indexPropertyID] < 3
+            || (faces->uvPropertyID >= 0
+                && listSizes[faces->uvPropertyID] != 2 * listSizes[faces->indexPropertyID])) {
+            CC_LOG("cc: invalid face %i", faceID);
+
+            return false;
+        }
+
+        halfedgeCount+= listSizes[faces->indexPropertyID];
+
+        if (halfedgeCount > INT32_MAX) {
+            CC_LOG("cc: halfedge count exceeds 32 bits");
+
+            return false;
+        }
+    }
+
+    faces->halfedgeCount = (int32_t)halfedgeCount;
+
+    return true;
+}
+
+static bool PlyLocateElements(PlyFile *ply, const uint8_t *body, PlyFaces *faces)
+{
+    const uint8_t *ptr = body;
+
+    for (int32_t elementID = 0; elementID < ply->elementCount; ++elementID) {
+        PlyElement *element = &ply->elements[elementID];
+        const int32_t stride = PlyRecordStride(element);
+
+        element->data = ptr;
+
+        if (!strcmp(element->name, "face")) {
+            if (!PlyScanFaces(ply, element, &ptr, faces)) {
+                return false;
+            }
+        } else if (stride >= 0) {
+            if ((int64_t)(ply->end - ptr) < (int64_t)stride * element->count) {
+                CC_LOG("cc: truncated %s data", element->name);
+
+                return false;
+            }
+
+            ptr+= (size_t)stride * element->count;
+        } else {
+            for (int32_t i = 0; i < element->count && ptr != NULL; ++i) {
+                ptr = PlySkipRecord(ply, element, ptr, NULL);
+            }
+
+            if (ptr == NULL) {
+                CC_LOG("cc: truncated %s data", element->name);
+
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+ * PlyLoadVertexPoints -- Decodes the vertex positions and UVs
+ *
+ * Per-vertex UVs are looked up under the names (u, v), (s, t),
+ * (texture_u, texture_v), and (texture_s, texture_t). They are only used
+ * if the faces do not provide per-corner texcoords.
+ *
+ */
+static bool PlyFindUvFields(const PlyElement *vertices, PlyField uvFields[2])
+{
+    const char *names[][2] = {
+        {"u", "v"}, {"s", "t"}, {"texture_u", "texture_v"}, {"texture_s", "texture_t"}
+    };
+
+    for (int32_t i = 0; i < 4; ++i) {
+        if (PlyFindField(vertices, names[i][0], &uvFields[0])
+            && PlyFindField(vertices, names[i][1], &uvFields[1])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+PlyLoadVertexPoints(
+    const PlyFile *ply,
+    const PlyElement *vertices,
+    const PlyField positionFields[3],
+    const PlyField *uvFields,
+    cc_Mesh *mesh
+) {
+    const int32_t stride = PlyRecordStride(vertices);
+    const int32_t vertexCount = vertices->count;
+
+CC_PARALLEL_FOR
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        const uint8_t *record = vertices->data + (size_t)stride * vertexID;
+
+        for (int32_t i = 0; i < 3; ++i) {
+            const PlyField field = positionFields[i];
+
+            mesh->vertexPoints[vertexID].array[i] =
+                    (float)PlyReadScalar(record + field.offset, field.type, ply->swapBytes);
+        }
+
+        if (uvFields != NULL) {
+            for (int32_t i = 0; i < 2; ++i) {
+                const PlyField field = uvFields[i];
+
+                mesh->uvs[vertexID].array[i] =
+                        (float)PlyReadScalar(record + field.offset, field.type, ply->swapBytes);
+            }
+        }
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * PlyLoadFaces -- Decodes the faces into halfedges
+ *
+ * Each face is decoded independently from its record offset; the halfedges
+ * of a face are stored contiguously so that their next, prev, and face IDs
+ * follow from the face offsets. Per-corner texcoords produce one UV per
+ * halfedge; per-vertex UVs are shared by the halfedges of each vertex.
+ *
+ */
+static void
+PlyLoadFaces(
+    const PlyFile *ply,
+    const PlyElement *element,
+    const PlyFaces *faces,
+    cc_Mesh *mesh
+) {
+    const int32_t faceCount = element->count;
+    const bool hasVertexUvs = ccm_UvCount(mesh) > 0 && faces->uvPropertyID < 0;
+
+CC_PARALLEL_FOR
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        const int32_t beginID = faces->halfedgeOffsets[faceID];
+        const int32_t endID = faceID + 1 < faceCount
+                            ? faces->halfedgeOffsets[faceID + 1]
+                            : ccm_HalfedgeCount(mesh);
+        const uint8_t *ptr = element->data + faces->recordOffsets[faceID];
+
+        for (int32_t i = 0; i < element->propertyCount; ++i) {
+            const PlyProperty *property = &element->properties[i];
+            const int32_t itemSize = PlyTypeSize(property->type);
+            int32_t itemCount = 1;
+
+            if (property->countType != PLY_TYPE_INVALID) {
+                itemCount = (int32_t)PlyReadScalar(ptr,
+                                                   property->countType,
+                                                   ply->swapBytes);
+                ptr+= PlyTypeSize(property->countType);
+            }
+
+            if (i == faces->indexPropertyID) {
+                for (int32_t j = 0; j < itemCount; ++j) {
+                    const double vertexID = PlyReadScalar(ptr + j * itemSize,
+                                                          property->type,
+                                                          ply->swapBytes);
+                    cc_Halfedge *halfedge = &mesh->halfedges[beginID + j];
+
+                    halfedge->vertexID = (int32_t)vertexID;
+                    halfedge->uvID = hasVertexUvs ? halfedge->vertexID : 0;
+                }
+            } else if (i == faces->uvPropertyID) {
+                for (int32_t j = 0; j < itemCount; ++j) {
+                    const double uv = PlyReadScalar(ptr + j * itemSize,
+                                                    property->type,
+                                                    ply->swapBytes);
+
+                    mesh->uvs[beginID + j / 2].array[j & 1] = (float)uv;
+                }
+            }
+
+            ptr+= itemCount * itemSize;
+        }
+
+        for (int32_t halfedgeID = beginID; halfedgeID < endID; ++halfedgeID) {
+            cc_Halfedge *halfedge = &mesh->halfedges[halfedgeID];
+
+            halfedge->twinID = -1;
+            halfedge->edgeID = -1;
+            halfedge->faceID = faceID;
+            halfedge->nextID = halfedgeID + 1 < endID ? halfedgeID + 1 : beginID;
+            halfedge->prevID = halfedgeID > beginID ? halfedgeID - 1 : endID - 1;
+
+            if (faces->uvPropertyID >= 0) {
+                halfedge->uvID = halfedgeID;
+            }
+        }
+
+        mesh->faceToHalfedgeIDs[faceID] = beginID;
+    }
+CC_BARRIER
+}
+
+
+/*******************************************************************************
+ * PlyLoadCreases -- Sets the sharpness of the edges listed in the file
+ *
+ * Creases are read from an element called 'edge' with the scalar properties
+ * vertex1, vertex2, and crease (or sharpness). They are sorted by vertex
+ * pair so that each mesh edge retrieves its sharpness with a binary search.
+ *
+ */
+typedef struct {
+    uint64_t key;
+    float sharpness;
+} PlyCrease;
+
+static uint64_t PlyEdgeKey(int32_t vertexID1, int32_t vertexID2)
+{
+    const uint64_t v1 = (uint64_t)(uint32_t)(vertexID1 < vertexID2 ? vertexID1 : vertexID2);
+    const uint64_t v2 = (uint64_t)(uint32_t)(vertexID1 < vertexID2 ? vertexID2 : vertexID1);
+
+    return (v1 << 32) | v2;
+}
+
+static int PlyCompareCreases(const void *a, const void *b)
+{
+    const uint64_t keyA = ((const PlyCrease *)a)->key;
+    const uint64_t keyB = ((const PlyCrease *)b)->key;
+
+    return keyA < keyB ? -1 : (keyA > keyB ? 1 : 0);
+}
+
+static void PlyLoadCreases(const PlyFile *ply, const PlyElement *element, cc_Mesh *mesh)
+{
+    const int32_t stride = PlyRecordStride(element);
+    const int32_t creaseCount = element->count;
+    const int32_t edgeCount = ccm_EdgeCount(mesh);
+    PlyField fields[3];
+    PlyCrease *creases;
+
+    if (stride < 0
+        || !PlyFindField(element, "vertex1", &fields[0])
+        || !PlyFindField(element, "vertex2", &fields[1])
+        || (!PlyFindField(element, "crease", &fields[2])
+            && !PlyFindField(element, "sharpness", &fields[2]))) {
+        CC_LOG("cc: ignoring unsupported edge element");
+
+        return;
+    }
+
+    creases = (PlyCrease *)CC_MALLOC(sizeof(PlyCrease) * (creaseCount + 1));
+
+CC_PARALLEL_FOR
+    for (int32_t creaseID = 0; creaseID < creaseCount; ++creaseID) {
+        const uint8_t *record = element->data + (size_t)stride * creaseID;
+        int32_t vertexIDs[2];
+
+        for (int32_t i = 0; i < 2; ++i) {
+            vertexIDs[i] = (int32_t)PlyReadScalar(record + fields[i].offset,
+                                                  fields[i].type,
+                                                  ply->swapBytes);
+        }
+
+        creases[creaseID].key = PlyEdgeKey(vertexIDs[0], vertexIDs[1]);
+        creases[creaseID].sharpness = (float)PlyReadScalar(record + fields[2].offset,
+                                                           fields[2].type,
+                                                           ply->swapBytes);
+    }
+CC_BARRIER
+
+    qsort(creases, creaseCount, sizeof(PlyCrease), &PlyCompareCreases);
+
+CC_PARALLEL_FOR
+    for (int32_t edgeID = 0; edgeID < edgeCount; ++edgeID) {
+        const int32_t halfedgeID = ccm_EdgeToHalfedgeID(mesh, edgeID);
+        const int32_t nextID = ccm_HalfedgeNextID(mesh, halfedgeID);
+        PlyCrease key;
+        const PlyCrease *crease;
+
+        key.key = PlyEdgeKey(ccm_HalfedgeVertexID(mesh, halfedgeID),
+                             ccm_HalfedgeVertexID(mesh, nextID));
+        crease = (const PlyCrease *)bsearch(&key,
+                                            creases,
+                                            creaseCount,
+                                            sizeof(PlyCrease),
+                                            &PlyCompareCreases);
+
+        if (crease != NULL) {
+            mesh->creases[edgeID].sharpness = crease->sharpness;
+        }
+    }
+CC_BARRIER
+
+    CC_FREE(creases);
+}
+
+
+/*******************************************************************************
+ * PlyValidateFaces -- Checks that each halfedge points to an existing vertex
+ *
+ */
+static bool PlyValidateFaces(const cc_Mesh *mesh)
+{
+    const int32_t halfedgeCount = ccm_HalfedgeCount(mesh);
+    const int32_t vertexCount = ccm_VertexCount(mesh);
+
+    for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+        const int32_t vertexID = ccm_HalfedgeVertexID(mesh, halfedgeID);
+
+        if (vertexID < 0 || vertexID >= vertexCount) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+ * LoadPly -- Reads a binary PLY file
+ *
+ * Returns NULL on failure.
+ *
+ */
+static cc_Mesh *LoadPly(const char *filename)
+{
+    PlyFile ply;
+    PlyFaces faces = {-1, -1, NULL, NULL, 0};
+    PlyField positionFields[3], uvFields[2];
+    const PlyElement *vertices, *faceElement, *edges;
+    const uint8_t *body;
+    bool hasVertexUvs;
+    cc_Mesh *mesh = NULL;
+
+    if (!PlyMapFile(&ply, filename)) {
+        return NULL;
+    }
+
+    CC_LOG("Parsing PLY header...");
+    body = PlyReadHeader(&ply);
+    vertices = PlyFindElement(&ply, "vertex");
+    faceElement = PlyFindElement(&ply, "face");
+
+    if (body == NULL || vertices == NULL || faceElement == NULL
+        || !PlyFindField(vertices, "x", &positionFields[0])
+        || !PlyFindField(vertices, "y", &positionFields[1])
+        || !PlyFindField(vertices, "z", &positionFields[2])
+        || PlyRecordStride(vertices) < 0) {
+        CC_LOG("cc: invalid PLY file");
+        PlyUnmapFile(&ply);
+
+        return NULL;
+    }
+
+    faces.indexPropertyID = PlyFindProperty(faceElement, "vertex_indices");
+
+    if (faces.indexPropertyID < 0) {
+        faces.indexPropertyID = PlyFindProperty(faceElement, "vertex_index");
+    }
+
+    faces.uvPropertyID = PlyFindProperty(faceElement, "texcoord");
+
+    if (faces.indexPropertyID < 0
+        || faceElement->properties[faces.indexPropertyID].countType == PLY_TYPE_INVALID
+        || (faces.uvPropertyID >= 0
+            && faceElement->properties[faces.uvPropertyID].countType == PLY_TYPE_INVALID)) {
+        CC_LOG("cc: invalid PLY face element");
+        PlyUnmapFile(&ply);
+
+        return NULL;
+    }
+
+    CC_LOG("Scanning faces...");
+    if (!PlyLocateElements(&ply, body, &faces)) {
+        CC_FREE(faces.recordOffsets);
+        CC_FREE(faces.halfedgeOffsets);
+        PlyUnmapFile(&ply);
+
+        return NULL;
+    }
+
+    hasVertexUvs = faces.uvPropertyID < 0 && PlyFindUvFields(vertices, uvFields);
+
+    CC_LOG("Allocating mesh...");
+    mesh = (cc_Mesh *)CC_MALLOC(sizeof(*mesh));
+    mesh->vertexCount = vertices->count;
+    mesh->uvCount = faces.uvPropertyID >= 0 ? faces.halfedgeCount
+                  : (hasVertexUvs ? vertices->count : 0);
+    mesh->halfedgeCount = faces.halfedgeCount;
+    mesh->faceCount = faceElement->count;
+    mesh->vertexPoints = (cc_VertexPoint *)CC_MALLOC(sizeof(cc_VertexPoint) * mesh->vertexCount);
+    mesh->uvs = (cc_VertexUv *)CC_MALLOC(sizeof(cc_VertexUv) * mesh->uvCount);
+    mesh->halfedges = (cc_Halfedge *)CC_MALLOC(sizeof(cc_Halfedge) * mesh->halfedgeCount);
+    mesh->faceToHalfedgeIDs = (int32_t *)CC_MALLOC(sizeof(int32_t) * mesh->faceCount);
+    mesh->faceHoles = NULL;
+
+    CC_LOG("Loading mesh data...");
+    PlyLoadVertexPoints(&ply, vertices, positionFields, hasVertexUvs ? uvFields : NULL, mesh);
+    PlyLoadFaces(&ply, faceElement, &faces, mesh);
+    CC_FREE(faces.recordOffsets);
+    CC_FREE(faces.halfedgeOffsets);
+
+    if (!PlyValidateFaces(mesh)) {
+        CC_LOG("cc: invalid vertex index");
+        CC_FREE(mesh->vertexPoints);
+        CC_FREE(mesh->uvs);
+        CC_FREE(mesh->halfedges);
+        CC_FREE(mesh->faceToHalfedgeIDs);
+        CC_FREE(mesh);
+        PlyUnmapFile(&ply);
+
+        return NULL;
+    }
+
+    CC_LOG("Computing twins...");
+    mb_ComputeTwins(mesh);
+    CC_LOG("Computing edge mappings...");
+    mb_LoadEdgeMappings(mesh);
+    CC_LOG("Computing vertex mappings...");
+    mb_LoadVertexHalfedges(mesh);
+
+    CC_LOG("Loading creases...");
+    mb_CreateCreases(mesh);
+    edges = PlyFindElement(&ply, "edge");
+
+    if (edges != NULL) {
+        PlyLoadCreases(&ply, edges, mesh);
+    }
+
+    mb_MakeBoundariesSharp(mesh);
+    PlyUnmapFile(&ply);
+
+    CC_LOG("Computing crease neighbors...");
+    mb_ComputeCreaseNeighbors(mesh);
+
+    return mesh;
+}
+
+
+static void Usage(const char *appname)
+{
+    CC_LOG("usage -- %s file1 file2 ...", appname);
+}
+
+
+int main(int argc, char **argv)
+{
+    const int32_t meshCount = argc - 1;
+    char buffer[1024];
+
+    if (meshCount == 0) {
+        Usage(argv[0]);
+
+        return -1;
+    }
+
+    for (int32_t meshID = 0; meshID < meshCount; ++meshID) {
+        const char *file = argv[meshID + 1];
+        const char *baseName = strrchr(file, '/');
+        char *postFix;
+        cc_Mesh *mesh;
+
+        CC_LOG("Loading: %s", file);
+        mesh = LoadPly(file);
+
+        if (!mesh) {
+            return -1;
+        }
+
+        snprintf(buffer, sizeof(buffer), "%s", baseName != NULL ? baseName + 1 : file);
+        postFix = strrchr(buffer, '.');
+
+        if (postFix != NULL) {
+            *postFix = '\0';
+        }
+
+        strncat(buffer, ".ccm", sizeof(buffer) - strlen(buffer) - 1);
+        CC_LOG("Output file: %s", buffer);
+
+        if (!ccm_Save(mesh, buffer)) {
+            ccm_Release(mesh);
+
+            return -1;
+        }
+
+        CC_LOG("V: %i", ccm_VertexCount(mesh));
+        CC_LOG("U: %i", ccm_UvCount(mesh));
+        CC_LOG("H: %i", ccm_HalfedgeCount(mesh));
+        CC_LOG("C: %i", ccm_CreaseCount(mesh));
+        CC_LOG("E: %i", ccm_EdgeCount(mesh));
+        CC_LOG("F: %i", ccm_FaceCount(mesh));
+        ccm_Release(mesh);
+    }
+
+    return 0;
+}
@@ -0,0 +1,637 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define LOG(fmt, ...) fprintf(stdout, fmt "\n", ##__VA_ARGS__); fflush(stdout);
+
+// The refinement kernels run nested inside the parallel region of the
+// pipeline, where an orphaned barrier would bind to the pipeline threads;
+// the implicit barrier that ends each parallel loop is sufficient.
+#define CC_BARRIER
+#define CC_IMPLEMENTATION
+#include "CatmullClark.h"
+
+#define QUEUE_CAPACITY_MAX 64
+#define EXPORT_BATCH_SIZE 1024
+
+
+/*******************************************************************************
+ * Batch data structures
+ *
+ * Each manifest entry is an asset that flows through three stages: load,
+ * refine, and export. Stages communicate through bounded queues; a stage
+ * that finds its output queue full stalls until the next stage catches up
+ * (back-pressure), which bounds the number of assets held in memory to
+ * the queue capacities plus one asset per worker.
+ *
+ */
+typedef struct {
+    char inputFile[512];
+    char outputFile[512];
+    int32_t maxDepth;
+    cc_Mesh *cage;
+    cc_Subd *subd;
+    double times[3]; // load, refine, export
+    bool failed;
+} Asset;
+
+typedef enum {
+    STAGE_LOAD,
+    STAGE_REFINE,
+    STAGE_EXPORT,
+
+    STAGE_COUNT
+} Stage;
+
+#ifdef _OPENMP
+typedef struct {
+    Asset *assets[QUEUE_CAPACITY_MAX];
+    int32_t capacity;
+    int32_t head;
+    int32_t count;
+    bool closed;
+    omp_lock_t lock;
+} AssetQueue;
+#endif
+
+typedef struct {
+    int32_t threadCounts[STAGE_COUNT];
+    int32_t queueCapacity;
+} BatchParameters;
+
+typedef struct {
+    Asset *assets;
+    int32_t assetCount;
+#ifdef _OPENMP
+    int32_t nextAssetID;        // next asset to load
+    int32_t activeLoaderCount;
+    AssetQueue loadedQueue;     // load -> refine
+    AssetQueue refinedQueue;    // refine -> export
+#endif
+    double busyTimes[STAGE_COUNT];
+    double stallTimes[STAGE_COUNT];
+} Batch;
+
+
+/*******************************************************************************
+ * Utility functions
+ *
+ */
+static double Time(void)
+{
+#ifdef _OPENMP
+    return omp_get_wtime();
+#elif defined(_WIN32)
+    return GetTickCount() / 1e3;
+#else
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+#endif
+}
+
+static const char *StageName(Stage stage)
+{
+    switch (stage) {
+    case STAGE_LOAD: return "load";
+    case STAGE_REFINE: return "refine";
+    case STAGE_EXPORT: return "export";
+    default: return "unknown";
+    }
+}
+
+
+#ifdef _OPENMP
+/*******************************************************************************
+ * Bounded queue
+ *
+ * OpenMP provides locks but no condition variables, so blocked pushes and
+ * pops poll the queue with a short sleep; the polling period is negligible
+ * compared to the duration of each stage.
+ *
+ */
+static void Yield(void)
+{
+#ifdef _WIN32
+    Sleep(0);
+#else
+    const struct timespec duration = {0, 50000};
+
+    nanosleep(&duration, NULL);
+#endif
+}
+
+static void QueueCreate(AssetQueue *queue, int32_t capacity)
+{
+    queue->capacity = capacity;
+    queue->head = 0;
+    queue->count = 0;
+    queue->closed = false;
+    omp_init_lock(&queue->lock);
+}
+
+static void QueueRelease(AssetQueue *queue)
+{
+    omp_destroy_lock(&queue->lock);
+}
+
+// blocks while the queue is full
+static void QueuePush(AssetQueue *queue, Asset *asset)
+{
+    for (;;) {
+        omp_set_lock(&queue->lock);
+
+        if (queue->count < queue->capacity) {
+            const int32_t slot = (queue->head + queue->count) % queue->capacity;
+
+            queue->assets[slot] = asset;
+            ++queue->count;
+            omp_unset_lock(&queue->lock);
+
+            return;
+        }
+
+        omp_unset_lock(&queue->lock);
+        Yield();
+    }
+}
+
+// blocks while the queue is empty; returns NULL once it is closed and empty
+static Asset *QueuePop(AssetQueue *queue)
+{
+    for (;;) {
+        omp_set_lock(&queue->lock);
+
+        if (queue->count > 0) {
+            Asset *asset = queue->assets[queue->head];
+
+            queue->head = (queue->head + 1) % queue->capacity;
+            --queue->count;
+            omp_unset_lock(&queue->lock);
+
+            return asset;
+        } else if (queue->closed) {
+            omp_unset_lock(&queue->lock);
+
+            return NULL;
+        }
+
+        omp_unset_lock(&queue->lock);
+        Yield();
+    }
+}
+
+static void QueueClose(AssetQueue *queue)
+{
+    omp_set_lock(&queue->lock);
+    queue->closed = true;
+    omp_unset_lock(&queue->lock);
+}
+#endif
+
+
+/*******************************************************************************
+ * LoadManifest -- Reads the list of assets to process
+ *
+ * Each non-empty line that does not start with '#' has the form
+ *  input.ccm maxDepth output.obj
+ * where maxDepth is at least 1.
+ *
+ */
+static Asset *LoadManifest(const char *filename, int32_t *assetCount)
+{
+    FILE *stream = fopen(filename, "r");
+    Asset *assets = NULL;
+    int32_t capacity = 0;
+    char buffer[1280];
+
+    *assetCount = 0;
+
+    if (!stream) {
+        LOG("cc: fopen failed");
+
+        return NULL;
+    }
+
+    while (fgets(buffer, sizeof(buffer), stream) != NULL) {
+        Asset asset;
+
+        memset(&asset, 0, sizeof(asset));
+
+        if (buffer[0] == '#'
+            || sscanf(buffer, "%511s %i %511s",
+                      asset.inputFile,
+                      &asset.maxDepth,
+                      asset.outputFile) != 3) {
+            continue;
+        }
+
+        if (asset.maxDepth < 1) {
+            LOG("cc: skipping %s (maxDepth must be positive)", asset.inputFile);
+            continue;
+        }
+
+        if (*assetCount == capacity) {
+            capacity = capacity > 0 ? 2 * capacity : 16;
+            assets = (Asset *)realloc(assets, sizeof(Asset) * capacity);
+        }
+
+        assets[(*assetCount)++] = asset;
+    }
+
+    fclose(stream);
+
+    return assets;
+}
+
+
+/*******************************************************************************
+ * ExportToObj -- Exports the deepest level of a subd to the OBJ file format
+ *
+ * Vertex points and face vertex IDs are retrieved in batches with the bulk
+ * subd accessors. The descendants of the hole faces of the cage are not
+ * exported.
+ *
+ */
+static bool ExportToObj(const cc_Subd *subd, const char *filename)
+{
+    const cc_Mesh *cage = subd->cage;
+    const int32_t depth = ccs_MaxDepth(subd);
+    const int32_t vertexCount = ccm_VertexCountAtDepth(cage, depth);
+    const int32_t faceCount = ccm_FaceCountAtDepth(cage, depth);
+    const bool hasUvs = ccm_UvCount(cage) > 0;
+    cc_VertexPoint vertexPoints[EXPORT_BATCH_SIZE];
+    int32_t vertexIDs[4 * EXPORT_BATCH_SIZE];
+    FILE *pf = fopen(filename, "w");
+
+    if (!pf) {
+        LOG("cc: fopen failed");
+
+        return false;
+    }
+
+    for (int32_t firstID = 0; firstID < vertexCount; firstID+= EXPORT_BATCH_SIZE) {
+        const int32_t count = cc__Min(EXPORT_BATCH_SIZE, vertexCount - firstID);
+
+        ccs_GetVertexPoints(subd, depth, firstID, count, vertexPoints);
+
+        for (int32_t i = 0; i < count; ++i) {
+            const float *v = vertexPoints[i].array;
+
+            fprintf(pf, "v %f %f %f\n", v[0], v[1], v[2]);
+        }
+    }
+
+#ifndef CC_DISABLE_UV
+    if (hasUvs) {
+        const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+        cc_VertexUv uvs[EXPORT_BATCH_SIZE];
+
+        for (int32_t firstID = 0; firstID < halfedgeCount; firstID+= EXPORT_BATCH_SIZE) {
+            const int32_t count = cc__Min(EXPORT_BATCH_SIZE, halfedgeCount - firstID);
+
+            ccs_GetHalfedgeVertexUvs(subd, depth, firstID, count, uvs);
+
+            for (int32_t i = 0; i < count; ++i) {
+                fprintf(pf, "vt %f %f\n", uvs[i].u, uvs[i].v);
+            }
+        }
+    }
+#endif
+
+    for (int32_t firstID = 0; firstID < faceCount; firstID+= EXPORT_BATCH_SIZE) {
+        const int32_t count = cc__Min(EXPORT_BATCH_SIZE, faceCount - firstID);
+
+        ccs_GetFaceVertexIDs(subd, depth, firstID, count, vertexIDs);
+
+        for (int32_t i = 0; i < count; ++i) {
+            const int32_t *ids = &vertexIDs[4 * i];
+            const int32_t uvID = 4 * (firstID + i) + 1;
+
+            if (ccs_FaceIsHole(subd, firstID + i, depth)) {
+                continue;
+            }
+
+            if (hasUvs) {
+                fprintf(pf, "f %i/%i %i/%i %i/%i %i/%i\n",
+                        ids[0] + 1, uvID + 0, ids[1] + 1, uvID + 1,
+                        ids[2] + 1, uvID + 2, ids[3] + 1, uvID + 3);
+            } else {
+                fprintf(pf, "f %i %i %i %i\n",
+                        ids[0] + 1, ids[1] + 1, ids[2] + 1, ids[3] + 1);
+            }
+        }
+    }
+
+    fclose(pf);
+
+    return true;
+}
+
+
+/*******************************************************************************
+ * LoadAsset / RefineAsset / ExportAsset -- Stages of the pipeline
+ *
+ * Each stage records its duration; assets that fail to load or export are
+ * flagged and skipped by the next stages.
+ *
+ */
+static void LoadAsset(Asset *asset)
+{
+    const double startTime = Time();
+
+    asset->cage = ccm_Load(asset->inputFile);
+    asset->failed = (asset->cage == NULL);
+    asset->times[STAGE_LOAD] = Time() - startTime;
+}
+
+static void RefineAsset(Asset *asset)
+{
+    const double startTime = Time();
+
+    if (!asset->failed) {
+        asset->subd = ccs_Create(asset->cage, asset->maxDepth);
+        ccs_Refine_Gather(asset->subd);
+    }
+
+    asset->times[STAGE_REFINE] = Time() - startTime;
+}
+
+static void ExportAsset(Asset *asset)
+{
+    const double startTime = Time();
+
+    if (!asset->failed) {
+        asset->failed = !ExportToObj(asset->subd, asset->outputFile);
+        ccs_Release(asset->subd);
+        ccm_Release(asset->cage);
+        asset->subd = NULL;
+        asset->cage = NULL;
+    }
+
+    asset->times[STAGE_EXPORT] = Time() - startTime;
+
+    LOG("%s -> %s: %s (load %.1f ms, refine %.1f ms, export %.1f ms)",
+        asset->inputFile,
+        asset->outputFile,
+        asset->failed ? "FAILED" : "done",
+        asset->times[STAGE_LOAD] * 1e3,
+        asset->times[STAGE_REFINE] * 1e3,
+        asset->times[STAGE_EXPORT] * 1e3);
+}
+
+
+#ifdef _OPENMP
+/*******************************************************************************
+ * Stage workers
+ *
+ * Loaders claim manifest entries in order, so that assets reach the refine
+ * stage roughly in manifest order. The refine stage is a single worker that
+ * spends its thread budget inside the (nested) parallel refinement kernels;
+ * exporters write the assets in the order they leave the refine stage.
+ * The last worker of a stage closes its output queue.
+ *
+ */
+static void RunLoader(Batch *batch)
+{
+    for (;;) {
+        int32_t assetID, activeLoaderCount;
+        double startTime;
+
+#pragma omp atomic capture
+        assetID = batch->nextAssetID++;
+
+        if (assetID >= batch->assetCount) {
+#pragma omp atomic capture
+            activeLoaderCount = --batch->activeLoaderCount;
+
+            if (activeLoaderCount == 0) {
+                QueueClose(&batch->loadedQueue);
+            }
+
+            return;
+        }
+
+        LoadAsset(&batch->assets[assetID]);
+        startTime = Time();
+        QueuePush(&batch->loadedQueue, &batch->assets[assetID]);
+
+#pragma omp atomic
+        batch->stallTimes[STAGE_LOAD]+= Time() - startTime;
+#pragma omp atomic
+        batch->busyTimes[STAGE_LOAD]+= batch->assets[assetID].times[STAGE_LOAD];
+    }
+}
+
+static void RunRefiner(Batch *batch, int32_t threadCount)
+{
+    omp_set_num_threads(threadCount);
+
+    for (;;) {
+        double startTime = Time();
+        Asset *asset = QueuePop(&batch->loadedQueue);
+
+        batch->stallTimes[STAGE_REFINE]+= Time() - startTime;
+
+        if (asset == NULL) {
+            QueueClose(&batch->refinedQueue);
+
+            return;
+        }
+
+        RefineAsset(asset);
+        batch->busyTimes[STAGE_REFINE]+= asset->times[STAGE_REFINE];
+
+        startTime = Time();
+        QueuePush(&batch->refinedQueue, asset);
+        batch->stallTimes[STAGE_REFINE]+= Time() - startTime;
+    }
+}
+
+static void RunExporter(Batch *batch)
+{
+    for (;;) {
+        const double startTime = Time();
+        Asset *asset = QueuePop(&batch->refinedQueue);
+
+#pragma omp atomic
+        batch->stallTimes[STAGE_EXPORT]+= Time() - startTime;
+
+        if (asset == NULL) {
+            return;
+        }
+
+        ExportAsset(asset);
+#pragma omp atomic
+        batch->busyTimes[STAGE_EXPORT]+= asset->times[STAGE_EXPORT];
+    }
+}
+#endif
+
+
+/*******************************************************************************
+ * RunBatch -- Processes all assets of a batch
+ *
+ * Each thread of the outer parallel region runs the worker of one stage,
+ * according to the thread budget of each stage. Without OpenMP, the stages
+ * run one after the other for each asset.
+ *
+ */
+static void RunBatch(Batch *batch, const BatchParameters *params)
+{
+    for (int32_t stage = 0; stage < STAGE_COUNT; ++stage) {
+        batch->busyTimes[stage] = 0.0;
+        batch->stallTimes[stage] = 0.0;
+    }
+
+#ifdef _OPENMP
+    {
+        const int32_t loaderCount = params->threadCounts[STAGE_LOAD];
+        const int32_t exporterCount = params->threadCounts[STAGE_EXPORT];
+
+        batch->nextAssetID = 0;
+        batch->activeLoaderCount = loaderCount;
+        QueueCreate(&batch->loadedQueue, params->queueCapacity);
+        QueueCreate(&batch->refinedQueue, params->queueCapacity);
+        omp_set_max_active_levels(2);
+        omp_set_dynamic(0);
+
+#pragma omp parallel num_threads(loaderCount + 1 + exporterCount)
+        {
+            const int32_t threadID = omp_get_thread_num();
+
+            if (threadID < loaderCount) {
+                RunLoader(batch);
+            } else if (threadID == loaderCount) {
+                RunRefiner(batch, params->threadCounts[STAGE_REFINE]);
+            } else {
+                RunExporter(batch);
+            }
+        }
+
+        QueueRelease(&batch->loadedQueue);
+        QueueRelease(&batch->refinedQueue);
+    }
+#else
+    (void)params;
+
+    for (int32_t assetID = 0; assetID < batch->assetCount; ++assetID) {
+        Asset *asset = &batch->assets[assetID];
+
+        LoadAsset(asset);
+        RefineAsset(asset);
+        ExportAsset(asset);
+
+        for (int32_t stage = 0; stage < STAGE_COUNT; ++stage) {
+            batch->busyTimes[stage]+= asset->times[stage];
+        }
+    }
+#endif
+}
+
+
+static void Usage(const char *appname)
+{
+    LOG("usage -- %s [options] manifest.txt", appname);
+    LOG("  -threads load refine export    thread budget of each stage (default: 1 N-2 1)");
+    LOG("  -queue capacity                assets per queue (default: 2)");
+    LOG("manifest lines -- input.ccm maxDepth output.obj");
+}
+
+
+int main(int argc, char **argv)
+{
+#ifdef _OPENMP
+    const int32_t threadCount = omp_get_max_threads();
+#else
+    const int32_t threadCount = 1;
+#endif
+    BatchParameters params = {{1, cc__Max(1, threadCount - 2), 1}, 2};
+    const char *manifestFile = NULL;
+    Batch batch;
+    double startTime, wallTime;
+    int32_t failedCount = 0;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const int32_t argLeft = argc - i - 1;
+
+        if (!strcmp(arg, "-threads") && argLeft >= 3) {
+            for (int32_t stage = 0; stage < STAGE_COUNT; ++stage) {
+                params.threadCounts[stage] = atoi(argv[++i]);
+            }
+        } else if (!strcmp(arg, "-queue") && argLeft >= 1) {
+            params.queueCapacity = atoi(argv[++i]);
+        } else if (arg[0] != '-' && manifestFile == NULL) {
+            manifestFile = arg;
+        } else {
+            Usage(argv[0]);
+
+            return -1;
+        }
+    }
+
+    if (manifestFile == NULL
+        || params.threadCounts[STAGE_LOAD] < 1
+        || params.threadCounts[STAGE_REFINE] < 1
+        || params.threadCounts[STAGE_EXPORT] < 1
+        || params.queueCapacity < 1
+        || params.queueCapacity > QUEUE_CAPACITY_MAX) {
+        Usage(argv[0]);
+
+        return -1;
+    }
+
+    batch.assets = LoadManifest(manifestFile, &batch.assetCount);
+
+    if (batch.assetCount == 0) {
+        LOG("cc: empty manifest");
+        free(batch.assets);
+
+        return -1;
+    }
+
+    LOG("Processing %i assets (threads: load %i, refine %i, export %i; queue capacity: %i)",
+        batch.assetCount,
+        params.threadCounts[STAGE_LOAD],
+        params.threadCounts[STAGE_REFINE],
+        params.threadCounts[STAGE_EXPORT],
+        params.queueCapacity);
+
+    startTime = Time();
+    RunBatch(&batch, &params);
+    wallTime = Time() - startTime;
+
+    for (int32_t assetID = 0; assetID < batch.assetCount; ++assetID) {
+        failedCount+= batch.assets[assetID].failed ? 1 : 0;
+    }
+
+    for (int32_t stage = 0; stage < STAGE_COUNT; ++stage) {
+        LOG("%-6s -- busy %.1f ms, stalled %.1f ms",
+            StageName(stage),
+            batch.busyTimes[stage] * 1e3,
+            batch.stallTimes[stage] * 1e3);
+    }
+
+    // the pipeline cannot run faster than its refine stage
+    LOG("Total  -- %.1f ms for %i assets (%i failed), %.0f%% of the refine-bound throughput",
+        wallTime * 1e3,
+        batch.assetCount,
+        failedCount,
+        100.0 * batch.busyTimes[STAGE_REFINE] / wallTime);
+
+    free(batch.assets);
+
+    return failedCount > 0 ? -1 : 0;
+}
@@ -0,0 +1,338 @@
+#define CC_IMPLEMENTATION
+#include "CatmullClark.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LOG(fmt, ...) fprintf(stdout, fmt "\n", ##__VA_ARGS__); fflush(stdout);
+
+// relative tolerance on the distance between two refinements
+#define TOLERANCE 1e-4f
+
+
+static void Usage(const char *appname)
+{
+    LOG("usage -- %s [-depth value] [input.ccm ...]", appname);
+    LOG("  -depth value                   subdivision depth (default: 4)");
+    LOG("Checks that the smooth Gather and Scatter kernels refine each input to");
+    LOG("the same vertex points, and that hole faces leave the vertex points of");
+    LOG("the visible faces unchanged; without inputs, a built-in cage is checked");
+}
+
+
+/*******************************************************************************
+ * Pillow -- Two quads glued along their four edges
+ *
+ * Each vertex of this closed cage is an interior vertex of valence 2, which
+ * the specialized vertex rules do not cover. The cage has no uvs, and its
+ * halfedges use uvID 0 like the faces without texture coordinates that
+ * obj_to_ccm and ply_to_ccm convert.
+ *
+ */
+static cc_Mesh *CreatePillow(void)
+{
+    const cc_VertexPoint vertexPoints[4] = {
+        {{-1.0f, -1.0f, 0.0f}},
+        {{+1.0f, -1.0f, 0.0f}},
+        {{+1.0f, +1.0f, 0.5f}},
+        {{-1.0f, +1.0f, 0.0f}}
+    };
+    // {twinID, nextID, prevID, faceID, edgeID, vertexID, uvID}
+    const cc_Halfedge halfedges[8] = {
+        {7, 1, 3, 0, 0, 0, 0},
+        {6, 2, 0, 0, 1, 1, 0},
+        {5, 3, 1, 0, 2, 2, 0},
+        {4, 0, 2, 0, 3, 3, 0},
+        {3, 5, 7, 1, 3, 0, 0},
+        {2, 6, 4, 1, 2, 3, 0},
+        {1, 7, 5, 1, 1, 2, 0},
+        {0, 4, 6, 1, 0, 1, 0}
+    };
+    const int32_t vertexToHalfedgeIDs[4] = {4, 7, 6, 5};
+    const int32_t edgeToHalfedgeIDs[4] = {7, 6, 5, 4};
+    const int32_t faceToHalfedgeIDs[2] = {0, 4};
+    cc_Mesh *mesh = ccm_Create(4, 0, 8, 4, 2);
+
+    memcpy(mesh->vertexPoints, vertexPoints, sizeof(vertexPoints));
+    memcpy(mesh->halfedges, halfedges, sizeof(halfedges));
+    memcpy(mesh->vertexToHalfedgeIDs, vertexToHalfedgeIDs, sizeof(vertexToHalfedgeIDs));
+    memcpy(mesh->edgeToHalfedgeIDs, edgeToHalfedgeIDs, sizeof(edgeToHalfedgeIDs));
+    memcpy(mesh->faceToHalfedgeIDs, faceToHalfedgeIDs, sizeof(faceToHalfedgeIDs));
+
+    for (int32_t edgeID = 0; edgeID < 4; ++edgeID) {
+        mesh->creases[edgeID].nextID = edgeID;
+        mesh->creases[edgeID].prevID = edgeID;
+        mesh->creases[edgeID].sharpness = 0.0f;
+    }
+
+    return mesh;
+}
+
+
+/*******************************************************************************
+ * Utility functions
+ *
+ */
+static float BoundingBoxDiagonal(const cc_Mesh *cage)
+{
+    float bounds[2][3] = {{+1e30f, +1e30f, +1e30f}, {-1e30f, -1e30f, -1e30f}};
+    float diagonal = 0.0f;
+
+    for (int32_t vertexID = 0; vertexID < ccm_VertexCount(cage); ++vertexID) {
+        const cc_VertexPoint vertexPoint = ccm_VertexPoint(cage, vertexID);
+
+        for (int32_t i = 0; i < 3; ++i) {
+            bounds[0][i] = fminf(bounds[0][i], vertexPoint.array[i]);
+            bounds[1][i] = fmaxf(bounds[1][i], vertexPoint.array[i]);
+        }
+    }
+
+    for (int32_t i = 0; i < 3; ++i) {
+        const float extent = bounds[1][i] - bounds[0][i];
+
+        diagonal+= extent * extent;
+    }
+
+    return sqrtf(diagonal);
+}
+
+// number of vertex points of the deepest level that differ
+static int32_t
+CountMismatches(const cc_Subd *subd1, const cc_Subd *subd2, float tolerance)
+{
+    const int32_t depth = ccs_MaxDepth(subd1);
+    const int32_t vertexCount = ccm_VertexCountAtDepth(subd1->cage, depth);
+    int32_t mismatchCount = 0;
+
+    for (int32_t vertexID = 0; vertexID < vertexCount; ++vertexID) {
+        const cc_VertexPoint p = ccs_VertexPoint(subd1, vertexID, depth);
+        const cc_VertexPoint q = ccs_VertexPoint(subd2, vertexID, depth);
+        float distance = 0.0f;
+
+        for (int32_t i = 0; i < 3; ++i) {
+            distance+= (p.array[i] - q.array[i]) * (p.array[i] - q.array[i]);
+        }
+
+        if (!(sqrtf(distance) <= tolerance)) {
+            ++mismatchCount;
+        }
+    }
+
+    return mismatchCount;
+}
+
+
+/*******************************************************************************
+ * Check -- Compares the Gather and Scatter smooth refinements of a cage
+ *
+ * The Gather kernel specializes the vertex rule by valence (see
+ * ValenceBuckets) and refines the interior of the tiles with fixed stencils,
+ * whereas the Scatter kernel applies the generic rules everywhere.
+ * Each refinement runs on a fresh subd whose vertex points are set to NaN
+ * beforehand, so that the points a kernel fails to write are reported.
+ *
+ */
+static int32_t
+CompareRefinements(
+    const cc_Mesh *cage,
+    int32_t depth,
+    void (*refine1)(cc_Subd *),
+    void (*refine2)(cc_Subd *)
+) {
+    const float tolerance = TOLERANCE * BoundingBoxDiagonal(cage);
+    cc_Subd *subd1 = ccs_Create(cage, depth);
+    cc_Subd *subd2 = ccs_Create(cage, depth);
+    int32_t mismatchCount = -1;
+
+    if (subd1 != NULL && subd2 != NULL) {
+        const size_t byteCount = sizeof(cc_VertexPoint) * ccs_CumulativeVertexCount(subd1);
+
+        // NaNs flag the vertex points that a kernel fails to write
+        memset(subd1->vertexPoints, 0xFF, byteCount);
+        memset(subd2->vertexPoints, 0xFF, byteCount);
+        (*refine1)(subd1);
+        (*refine2)(subd2);
+        mismatchCount = CountMismatches(subd1, subd2, tolerance);
+    }
+
+    if (subd1 != NULL) ccs_Release(subd1);
+    if (subd2 != NULL) ccs_Release(subd2);
+
+    return mismatchCount;
+}
+
+static bool Check(const char *name, const cc_Mesh *cage, int32_t depth)
+{
+    const int32_t mismatchCount = CompareRefinements(cage,
+                                                     depth,
+                                                     &ccs_Refine_NoCreases_Gather,
+                                                     &ccs_Refine_NoCreases_Scatter);
+
+    LOG("%s -- depth %i: %i mismatches", name, depth, mismatchCount);
+
+    return mismatchCount == 0;
+}
+
+
+/*******************************************************************************
+ * CheckHoles -- Compares the visible faces of a cage with holes
+ *
+ * The Gather kernel skips the descendants of the hole faces that do not
+ * support a visible face, so the corners of the visible faces at the deepest
+ * level must match a refinement of the cage without holes exactly. Nine
+ * faces out of ten (all but the last one) are marked as holes, and the
+ * vertex points are set to NaN beforehand as in CompareRefinements.
+ *
+ */
+static cc_Subd *CreateRefinedSubd(const cc_Mesh *cage, int32_t depth)
+{
+    cc_Subd *subd = ccs_Create(cage, depth);
+
+    if (subd != NULL) {
+        const size_t byteCount = sizeof(cc_VertexPoint) * ccs_CumulativeVertexCount(subd);
+
+        memset(subd->vertexPoints, 0xFF, byteCount);
+        ccs_Refine_Gather(subd);
+    }
+
+    return subd;
+}
+
+static bool CheckHoles(const char *name, cc_Mesh *cage, int32_t depth)
+{
+    const int32_t faceCount = ccm_FaceCount(cage);
+    uint8_t *faceHoles = cage->faceHoles;
+    uint8_t *testHoles = (uint8_t *)malloc(faceCount > 0 ? faceCount : 1);
+    cc_Subd *subd1, *subd2;
+    int32_t mismatchCount = -1;
+
+    srand(1);
+    for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+        testHoles[faceID] = faceID < faceCount - 1 && rand() % 10 != 0;
+    }
+
+    cage->faceHoles = NULL;
+    subd1 = CreateRefinedSubd(cage, depth);
+    cage->faceHoles = testHoles;
+    subd2 = CreateRefinedSubd(cage, depth);
+    cage->faceHoles = faceHoles;
+
+    if (subd1 != NULL && subd2 != NULL) {
+        const int32_t halfedgeCount = ccm_HalfedgeCountAtDepth(cage, depth);
+
+        mismatchCount = 0;
+
+        for (int32_t halfedgeID = 0; halfedgeID < halfedgeCount; ++halfedgeID) {
+            const int32_t tileID = halfedgeID >> (2 * depth);
+            const int32_t vertexID = ccs_HalfedgeVertexID(subd1, halfedgeID, depth);
+            const cc_VertexPoint p = ccs_VertexPoint(subd1, vertexID, depth);
+            const cc_VertexPoint q = ccs_VertexPoint(subd2, vertexID, depth);
+
+            if (testHoles[ccm_HalfedgeFaceID(cage, tileID)]) {
+                continue;
+            }
+
+            for (int32_t i = 0; i < 3; ++i) {
+                if (!(p.array[i] == q.array[i])) {
+                    ++mismatchCount;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (subd1 != NULL) ccs_Release(subd1);
+    if (subd2 != NULL) ccs_Release(subd2);
+    free(testHoles);
+
+    LOG("%s -- depth %i, holes: %i mismatches", name, depth, mismatchCount);
+
+    return mismatchCount == 0;
+}
+
+
+/*******************************************************************************
+ * CheckLoad -- Saves a cage to a file and loads it back
+ *
+ */
+static bool CheckLoad(const char *name, const cc_Mesh *cage)
+{
+    const char *filename = "subd_check.ccm";
+    bool success = ccm_Save(cage, filename);
+
+    if (success) {
+        cc_Mesh *mesh = ccm_Load(filename);
+
+        success = mesh != NULL
+               && ccm_HalfedgeCount(mesh) == ccm_HalfedgeCount(cage)
+               && ccm_UvCount(mesh) == ccm_UvCount(cage);
+
+        if (mesh != NULL) {
+            ccm_Release(mesh);
+        }
+    }
+
+    remove(filename);
+    LOG("%s -- save and load: %s", name, success ? "OK" : "FAILED");
+
+    return success;
+}
+
+
+int main(int argc, char **argv)
+{
+    int32_t depth = 4;
+    int32_t inputCount = 0;
+    bool success = true;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-depth") && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            Usage(argv[0]);
+
+            return -1;
+        }
+    }
+
+    if (depth < 1) {
+        Usage(argv[0]);
+
+        return -1;
+    }
+
+    for (int32_t i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-depth")) {
+            ++i;
+        } else {
+            cc_Mesh *cage = ccm_Load(argv[i]);
+
+            success = cage != NULL
+                   && Check(argv[i], cage, depth)
+                   && CheckHoles(argv[i], cage, depth)
+                   && success;
+            ++inputCount;
+
+            if (cage != NULL) {
+                ccm_Release(cage);
+            }
+        }
+    }
+
+    if (inputCount == 0) {
+        cc_Mesh *cage = CreatePillow();
+
+        success = ccm_Validate(cage, NULL)
+               && CheckLoad("pillow", cage)
+               && Check("pillow", cage, depth)
+               && CheckHoles("pillow", cage, depth);
+        ccm_Release(cage);
+    }
+
+    LOG("%s", success ? "OK" : "FAILED");
+
+    return success ? 0 : -1;
+}
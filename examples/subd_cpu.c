@@ -71,6 +71,10 @@ ExportToObj(
         for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
             const int32_t halfEdgeID = ccm_FaceToHalfedgeID(cage, faceID);
 
+            if (ccm_FaceIsHole(cage, faceID)) {
+                continue;
+            }
+
             fprintf(pf,
                     "f %i/%i",
                     ccm_HalfedgeVertexID(cage, halfEdgeID) + 1,
@@ -88,6 +92,10 @@ ExportToObj(
         }
     } else {
         for (int32_t faceID = 0; faceID < faceCount; ++faceID) {
+            if (ccs_FaceIsHole(subd, faceID, depth)) {
+                continue;
+            }
+
 #ifndef CC_DISABLE_UV
             fprintf(pf,
                     "f %i/%i %i/%i %i/%i %i/%i\n",
@@ -188,6 +196,7 @@ int main(int argc, char **argv)
 #else
     int32_t exportToObj = 1;
 #endif
+    const char *mappedFilename = NULL;
     cc_Mesh *cage = NULL;
     cc_Subd *subd = NULL;
 
@@ -203,13 +212,21 @@ int main(int argc, char **argv)
         exportToObj = atoi(argv[3]);
     }
 
+    if (argc > 4) {
+        mappedFilename = argv[4];
+    }
+
     cage = ccm_Load(filename);
 
     if (!cage) {
         return -1;
     }
 
-    subd = ccs_Create(cage, maxDepth);
+    if (mappedFilename != NULL) {
+        subd = ccs_CreateMapped(cage, maxDepth, mappedFilename);
+    } else {
+        subd = ccs_Create(cage, maxDepth);
+    }
 
     if (!subd) {
         ccm_Release(cage);
@@ -239,7 +256,10 @@ int main(int argc, char **argv)
     }
 
     {
-        const BenchStats stats = Bench(&ccs_RefineVertexPoints_Scatter, subd);
+        // the gather kernels stream through file-backed subds
+        const BenchStats stats = mappedFilename != NULL
+                ? Bench(&ccs_RefineVertexPoints_Gather, subd)
+                : Bench(&ccs_RefineVertexPoints_Scatter, subd);
 
         LOG("VertexPoints -- median/mean/min/max (ms): %f / %f / %f / %f",
             stats.median * 1e3,
@@ -46,6 +46,7 @@ enum {
     BUFFER_SUBD_HALFEDGES,
     BUFFER_SUBD_CREASES,
     BUFFER_SUBD_VERTEX_POINTS,
+    BUFFER_SUBD_VERTEX_UVS,
 
     BUFFER_COUNT
 };
@@ -88,7 +89,8 @@ LoadCatmullClarkLibrary(
     djg_program *djgp,
     bool halfedgeWrite,
     bool creaseWrite,
-    bool vertexWrite
+    bool vertexWrite,
+    bool uvWrite
 ) {
     djgp_push_string(djgp, "#extension GL_NV_shader_atomic_float: require\n");
     djgp_push_string(djgp, "#extension GL_NV_shader_thread_shuffle: require\n");
@@ -105,6 +107,9 @@ LoadCatmullClarkLibrary(
     if (vertexWrite) {
         djgp_push_string(djgp, "#define CCS_VERTEX_WRITE\n");
     }
+    if (uvWrite) {
+        djgp_push_string(djgp, "#define CCS_UV_WRITE\n");
+    }
 
     djgp_push_string(djgp,
                      "#define CC_LOCAL_SIZE_X %i\n",
@@ -145,6 +150,9 @@ LoadCatmullClarkLibrary(
     djgp_push_string(djgp,
                      "#define CC_BUFFER_BINDING_SUBD_VERTEX_POINT %i\n",
                      BUFFER_SUBD_VERTEX_POINTS);
+    djgp_push_string(djgp,
+                     "#define CC_BUFFER_BINDING_SUBD_UV %i\n",
+                     BUFFER_SUBD_VERTEX_UVS);
 
     djgp_push_file(djgp, PATH_TO_SHADER_DIRECTORY "CatmullClark_Scatter.glsl");
 }
@@ -155,12 +163,13 @@ LoadCatmullClarkProgram(
     const char *sourceFile,
     bool halfEdgeWrite,
     bool creaseWrite,
-    bool vertexWrite
+    bool vertexWrite,
+    bool uvWrite
 ) {
     djg_program *djgp = djgp_create();
     GLuint *glp = &g_gl.programs[programID];
 
-    LoadCatmullClarkLibrary(djgp, halfEdgeWrite, creaseWrite, vertexWrite);
+    LoadCatmullClarkLibrary(djgp, halfEdgeWrite, creaseWrite, vertexWrite, uvWrite);
     djgp_push_file(djgp, sourceFile);
     djgp_push_string(djgp, "#ifdef COMPUTE_SHADER\n#endif");
     if (!djgp_to_gl(djgp, 450, false, true, glp)) {
@@ -179,7 +188,7 @@ bool LoadCageFacePointsProgram()
     LOG("Loading {Program-Cage-Face-Points}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_CageFacePoints_Scatter.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_FACE_POINTS, srcFile, false, false, true);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_FACE_POINTS, srcFile, false, false, true, false);
 }
 
 bool LoadCageEdgePointsProgram()
@@ -187,7 +196,7 @@ bool LoadCageEdgePointsProgram()
     LOG("Loading {Program-Cage-Edge-Points}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_CageEdgePoints_Scatter.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_EDGE_POINTS, srcFile, false, false, true);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_EDGE_POINTS, srcFile, false, false, true, false);
 }
 
 bool LoadCageVertexPointsProgram()
@@ -195,7 +204,7 @@ bool LoadCageVertexPointsProgram()
     LOG("Loading {Program-Cage-Vertex-Points}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_CageVertexPoints_Scatter.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_VERTEX_POINTS, srcFile, false, false, true);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_VERTEX_POINTS, srcFile, false, false, true, false);
 }
 
 bool LoadCageHalfedgeRefinementProgram()
@@ -203,7 +212,7 @@ bool LoadCageHalfedgeRefinementProgram()
     LOG("Loading {Program-Refine-Cage-Halfedges}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_RefineCageHalfedges.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_HALFEDGES, srcFile, true, false, false);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_HALFEDGES, srcFile, true, false, false, false);
 }
 
 bool LoadCageCreaseRefinementProgram()
@@ -211,7 +220,7 @@ bool LoadCageCreaseRefinementProgram()
     LOG("Loading {Program-Refine-Cage-Creases}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_RefineCageCreases.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_CREASES, srcFile, false, true, false);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_CREASES, srcFile, false, true, false, false);
 }
 
 bool LoadFacePointsProgram()
@@ -219,7 +228,7 @@ bool LoadFacePointsProgram()
     LOG("Loading {Program-Face-Points}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_FacePoints_Scatter.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_FACE_POINTS, srcFile, false, false, true);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_FACE_POINTS, srcFile, false, false, true, false);
 }
 
 bool LoadEdgeRefinementProgram()
@@ -227,7 +236,7 @@ bool LoadEdgeRefinementProgram()
     LOG("Loading {Program-Edge-Points}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_EdgePoints_Scatter.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_EDGE_POINTS, srcFile, false, false, true);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_EDGE_POINTS, srcFile, false, false, true, false);
 }
 
 bool LoadVertexRefinementProgram()
@@ -235,7 +244,7 @@ bool LoadVertexRefinementProgram()
     LOG("Loading {Program-Vertex-Points}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_VertexPoints_Scatter.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_VERTEX_POINTS, srcFile, false, false, true);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_VERTEX_POINTS, srcFile, false, false, true, false);
 }
 
 bool LoadHalfedgeRefinementProgram()
@@ -243,7 +252,7 @@ bool LoadHalfedgeRefinementProgram()
     LOG("Loading {Program-Refine-Halfedges}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_RefineHalfedges.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_HALFEDGES, srcFile, true, false, false);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_HALFEDGES, srcFile, true, false, false, false);
 }
 
 bool LoadCreaseRefinementProgram()
@@ -251,7 +260,7 @@ bool LoadCreaseRefinementProgram()
     LOG("Loading {Program-Refine-Creases}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_RefineCreases.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_CREASES, srcFile, false, true, false);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_CREASES, srcFile, false, true, false, false);
 }
 
 #ifndef CC_DISABLE_UV
@@ -260,7 +269,7 @@ bool LoadCageVertexUvRefinementProgram()
     LOG("Loading {Program-Refine-Cage-Uvs}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_RefineCageVertexUvs.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_VERTEX_UVS, srcFile, true, false, false);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_CAGE_VERTEX_UVS, srcFile, false, false, false, true);
 }
 
 bool LoadVertexUvRefinementProgram()
@@ -268,7 +277,7 @@ bool LoadVertexUvRefinementProgram()
     LOG("Loading {Program-Refine-Vertex-Uvs}");
     const char *srcFile = PATH_TO_SHADER_DIRECTORY "cc_RefineVertexUvs.glsl";
 
-    return LoadCatmullClarkProgram(PROGRAM_SUBD_VERTEX_UVS, srcFile, true, false, false);
+    return LoadCatmullClarkProgram(PROGRAM_SUBD_VERTEX_UVS, srcFile, false, false, false, true);
 }
 #endif
 
@@ -400,6 +409,20 @@ bool LoadSubdCreaseBuffer(const cc_Subd *subd)
                                   GL_MAP_READ_BIT);
 }
 
+#ifndef CC_DISABLE_UV
+bool LoadSubdVertexUvBuffer(const cc_Subd *subd)
+{
+    if (ccm_UvCount(subd->cage) > 0) {
+        return LoadCatmullClarkBuffer(BUFFER_SUBD_VERTEX_UVS,
+                                      sizeof(cc_VertexUv) * ccs_CumulativeHalfedgeCount(subd),
+                                      NULL,
+                                      GL_MAP_READ_BIT);
+    } else {
+        return true;
+    }
+}
+#endif
+
 bool LoadCageCounterBuffer(const cc_Mesh *cage)
 {
     const struct {
@@ -447,6 +470,9 @@ bool LoadBuffers(const cc_Subd *subd)
     if (success) success = LoadSubdVertexPointBuffer(subd);
     if (success) success = LoadSubdHalfedgeBuffer(subd);
     if (success) success = LoadSubdCreaseBuffer(subd);
+#ifndef CC_DISABLE_UV
+    if (success) success = LoadSubdVertexUvBuffer(subd);
+#endif
     if (success) success = LoadSubdMaxDepthBuffer(subd);
 
     return success;
@@ -717,6 +743,24 @@ void GetCreases(cc_Subd *subd)
     glUnmapNamedBuffer(*buffer);
 }
 
+#ifndef CC_DISABLE_UV
+void GetVertexUvs(cc_Subd *subd)
+{
+    const GLuint *buffer = &g_gl.buffers[BUFFER_SUBD_VERTEX_UVS];
+
+    if (ccm_UvCount(subd->cage) > 0) {
+        const cc_VertexUv *uvs =
+                (cc_VertexUv *)glMapNamedBuffer(*buffer, GL_READ_ONLY);
+
+        memcpy(subd->uvs,
+               uvs,
+               ccs_CumulativeHalfedgeCount(subd) * sizeof(cc_VertexUv));
+
+        glUnmapNamedBuffer(*buffer);
+    }
+}
+#endif
+
 
 /*******************************************************************************
  * ExportToObj -- Exports subd to the OBJ file format
@@ -943,6 +987,9 @@ int main(int argc, char **argv)
         GetHalfedges(subd);
         GetVertices(subd);
         GetCreases(subd);
+#ifndef CC_DISABLE_UV
+        GetVertexUvs(subd);
+#endif
 
         for (int32_t depth = 0; depth <= ccs_MaxDepth(subd); ++depth) {
             char buf[64];
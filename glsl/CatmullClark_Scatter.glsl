@@ -12,9 +12,6 @@ struct cc_Halfedge_SemiRegular {
     int twinID;
     int edgeID;
     int vertexID;
-#ifndef CC_DISABLE_UV
-    int uvID;
-#endif
 };
 
 struct cc_Crease {
@@ -62,6 +59,9 @@ struct cc_Crease {
 #ifndef CC_BUFFER_BINDING_SUBD_CREASE
 #   error User must specify the binding of the subd crease buffer
 #endif
+#if !defined(CC_DISABLE_UV) && !defined(CC_BUFFER_BINDING_SUBD_UV)
+#   error User must specify the binding of the subd uv buffer
+#endif
 
 layout(std430, binding = CC_BUFFER_BINDING_CAGE_VERTEX_TO_HALFEDGE)
 readonly buffer ccm_HalfedgeToVertexBuffer {
@@ -136,6 +136,16 @@ buffer ccs_CreaseBuffer {
     cc_Crease ccsu_Creases[];
 };
 
+#ifndef CC_DISABLE_UV
+layout(std430, binding = CC_BUFFER_BINDING_SUBD_UV)
+#ifndef CCS_UV_WRITE
+readonly
+#endif
+buffer ccs_UvBuffer {
+    float ccsu_Uvs[];
+};
+#endif
+
 
 // -----------------------------------------------------------------------------
 
@@ -239,31 +249,6 @@ vec3 ccs_HalfedgeNormal(int halfedgeID);
 // -----------------------------------------------------------------------------
 
 
-/*******************************************************************************
- * UV Encoding / Decoding routines
- *
- */
-vec2 cc__DecodeUv(int uvEncoded)
-{
-    const uint tmp = uint(uvEncoded);
-    const vec2 uv = vec2(
-        ((tmp >>  0) & 0xFFFFu) / 65535.0f,
-        ((tmp >> 16) & 0xFFFFu) / 65535.0f
-    );
-
-    return uv;
-}
-
-int cc__EncodeUv(vec2 uv)
-{
-    const uint u = uint(round(uv[0] * 65535.0f));
-    const uint v = uint(round(uv[1] * 65535.0f));
-    const uint tmp = ((u & 0xFFFFu) | ((v & 0xFFFFu) << 16));
-
-    return int(tmp);
-}
-
-
 /*******************************************************************************
  * FaceCount -- Returns the number of faces
  *
@@ -893,14 +878,14 @@ vec3 ccs_HalfedgeVertexPoint(int halfedgeID, int depth)
 }
 
 #ifndef CC_DISABLE_UV
-int ccs__HalfedgeUvID(int halfedgeID, int depth)
-{
-    return ccs__Halfedge(halfedgeID, depth).uvID;
-}
-
 vec2 ccs_HalfedgeVertexUv(int halfedgeID, int depth)
 {
-    return cc__DecodeUv(ccs__HalfedgeUvID(halfedgeID, depth));
+    const int stride = ccs_CumulativeHalfedgeCountAtDepth(depth - 1);
+    const int uvID = stride + halfedgeID;
+    const float x = ccsu_Uvs[2 * uvID + 0];
+    const float y = ccsu_Uvs[2 * uvID + 1];
+
+    return vec2(x, y);
 }
 #endif
 
@@ -8,7 +8,8 @@ layout (local_size_x = CC_LOCAL_SIZE_X,
 
 void WriteHalfedgeUv(int halfedgeID, vec2 uv)
 {
-    ccsu_Halfedges[halfedgeID].uvID = cc__EncodeUv(uv);
+    ccsu_Uvs[2 * halfedgeID + 0] = uv.x;
+    ccsu_Uvs[2 * halfedgeID + 1] = uv.y;
 }
 
 void main()
@@ -12,7 +12,10 @@ void WriteHalfedgeUv(int halfedgeID, vec2 uv, int depth)
 {
     const int stride = ccs_CumulativeHalfedgeCountAtDepth(depth);
 
-    ccsu_Halfedges[stride + halfedgeID].uvID = cc__EncodeUv(uv);
+    const int uvID = stride + halfedgeID;
+
+    ccsu_Uvs[2 * uvID + 0] = uv.x;
+    ccsu_Uvs[2 * uvID + 1] = uv.y;
 }
 
 void main()